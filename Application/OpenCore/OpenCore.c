@@ -34,6 +34,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcConsoleLib.h>
 #include <Library/OcCpuLib.h>
 #include <Library/OcDevicePathLib.h>
+#include <Library/OcMiscLib.h>
 #include <Library/OcStorageLib.h>
 #include <Library/OcVariableLib.h>
 #include <Library/PrintLib.h>
@@ -96,6 +97,11 @@ OcStartImage (
               LaunchInText ? EfiConsoleControlScreenText : EfiConsoleControlScreenGraphics
               );
 
+  //
+  // Picker and image loading spans are complete at this point.
+  //
+  OcTraceFlush (OcGetTSCFrequency ());
+
   Status = gBS->StartImage (
                   ImageHandle,
                   ExitDataSize,
@@ -122,21 +128,28 @@ OcMain (
   OC_PRIVILEGE_CONTEXT  *Privilege;
 
   DEBUG ((DEBUG_INFO, "OC: OcMiscEarlyInit...\n"));
+  OcTraceBegin ("OcMiscEarlyInit");
   Status = OcMiscEarlyInit (
              Storage,
              &mOpenCoreConfiguration,
              mOpenCoreVaultKey
              );
+  OcTraceEnd ("OcMiscEarlyInit");
 
   if (EFI_ERROR (Status)) {
     return;
   }
 
+  OcTraceBegin ("OcCpuScanProcessor");
   OcCpuScanProcessor (&mOpenCoreCpuInfo);
+  OcTraceEnd ("OcCpuScanProcessor");
 
   DEBUG ((DEBUG_INFO, "OC: OcLoadNvramSupport...\n"));
+  OcTraceBegin ("OcLoadNvramSupport");
   OcLoadNvramSupport (Storage, &mOpenCoreConfiguration);
+  OcTraceEnd ("OcLoadNvramSupport");
   DEBUG ((DEBUG_INFO, "OC: OcMiscMiddleInit...\n"));
+  OcTraceBegin ("OcMiscMiddleInit");
   OcMiscMiddleInit (
     Storage,
     &mOpenCoreConfiguration,
@@ -145,22 +158,35 @@ OcMain (
     mStorageHandle,
     mOpenCoreConfiguration.Booter.Quirks.ForceBooterSignature ? mOpenCoreBooterHash : NULL
     );
+  OcTraceEnd ("OcMiscMiddleInit");
   DEBUG ((DEBUG_INFO, "OC: OcLoadUefiSupport...\n"));
+  OcTraceBegin ("OcLoadUefiSupport");
   OcLoadUefiSupport (Storage, &mOpenCoreConfiguration, &mOpenCoreCpuInfo, mOpenCoreBooterHash);
+  OcTraceEnd ("OcLoadUefiSupport");
   DEBUG_CODE_BEGIN ();
   DEBUG ((DEBUG_INFO, "OC: OcMiscLoadSystemReport...\n"));
   OcMiscLoadSystemReport (&mOpenCoreConfiguration, mStorageHandle);
   DEBUG_CODE_END ();
   DEBUG ((DEBUG_INFO, "OC: OcLoadAcpiSupport...\n"));
+  OcTraceBegin ("OcLoadAcpiSupport");
   OcLoadAcpiSupport (&mOpenCoreStorage, &mOpenCoreConfiguration);
+  OcTraceEnd ("OcLoadAcpiSupport");
   DEBUG ((DEBUG_INFO, "OC: OcLoadPlatformSupport...\n"));
+  OcTraceBegin ("OcLoadPlatformSupport");
   OcLoadPlatformSupport (&mOpenCoreConfiguration, &mOpenCoreCpuInfo);
+  OcTraceEnd ("OcLoadPlatformSupport");
   DEBUG ((DEBUG_INFO, "OC: OcLoadDevPropsSupport...\n"));
+  OcTraceBegin ("OcLoadDevPropsSupport");
   OcLoadDevPropsSupport (&mOpenCoreConfiguration);
+  OcTraceEnd ("OcLoadDevPropsSupport");
   DEBUG ((DEBUG_INFO, "OC: OcMiscLateInit...\n"));
+  OcTraceBegin ("OcMiscLateInit");
   OcMiscLateInit (Storage, &mOpenCoreConfiguration);
+  OcTraceEnd ("OcMiscLateInit");
   DEBUG ((DEBUG_INFO, "OC: OcLoadKernelSupport...\n"));
+  OcTraceBegin ("OcLoadKernelSupport");
   OcLoadKernelSupport (&mOpenCoreStorage, &mOpenCoreConfiguration, &mOpenCoreCpuInfo);
+  OcTraceEnd ("OcLoadKernelSupport");
 
   if (mOpenCoreConfiguration.Misc.Security.EnablePassword) {
     mOpenCorePrivilege.CurrentLevel = OcPrivilegeUnauthorized;
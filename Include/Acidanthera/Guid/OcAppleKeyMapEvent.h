@@ -0,0 +1,26 @@
+/** @file
+  OpenCore Apple Key Map event group GUID identifiers.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#ifndef OC_APPLE_KEY_MAP_EVENT_H
+#define OC_APPLE_KEY_MAP_EVENT_H
+
+///
+/// Event group signalled by OpenCore Apple Key Map Database whenever the
+/// keys or modifiers stored in any of its key stroke buffers change.
+/// Apple Event uses it to process key changes without waiting for its
+/// next poll tick.
+///
+#define OC_APPLE_KEY_MAP_CHANGED_EVENT_GROUP_GUID  \
+  { 0xA1376417, 0xC94B, 0x4B0B,                    \
+    { 0xA2, 0xA1, 0x9D, 0x35, 0x56, 0xD9, 0xDC, 0xE6 } }
+
+///
+/// Exported GUID identifiers.
+///
+extern EFI_GUID  gOcAppleKeyMapChangedEventGroupGuid;
+
+#endif // OC_APPLE_KEY_MAP_EVENT_H
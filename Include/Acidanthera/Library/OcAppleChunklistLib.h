@@ -26,6 +26,12 @@ typedef struct OC_APPLE_CHUNKLIST_CONTEXT_ {
   CONST APPLE_CHUNKLIST_CHUNK    *Chunks;
   APPLE_CHUNKLIST_SIG            *Signature;
   UINT8                          Hash[SHA256_DIGEST_SIZE];
+  //
+  // Incremental data verification state.
+  //
+  UINTN                          ChunkIndex;
+  UINT32                         ChunkOffset;
+  SHA256_CONTEXT                 ChunkHashContext;
 } OC_APPLE_CHUNKLIST_CONTEXT;
 
 //
@@ -74,4 +80,46 @@ OcAppleChunklistVerifyData (
   IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
   );
 
+/**
+  Starts incremental data verification against a chunklist context.
+  The chunklist signature must have been verified.
+
+  @param[in,out] Context  The Context to verify against.
+**/
+VOID
+OcAppleChunklistVerifyDataInit (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  );
+
+/**
+  Verifies the next portion of data against a chunklist context.
+  Data beyond the last chunk is ignored.
+
+  @param[in,out] Context  The Context to verify against.
+  @param[in]     Data     Data following previously verified data.
+  @param[in]     Size     Size of Data in bytes.
+
+  @retval TRUE   All chunks completed so far are valid.
+  @retval FALSE  The data failed verification.
+**/
+BOOLEAN
+OcAppleChunklistVerifyDataUpdate (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context,
+  IN     CONST VOID                  *Data,
+  IN     UINTN                       Size
+  );
+
+/**
+  Finishes incremental data verification against a chunklist context.
+
+  @param[in,out] Context  The Context to verify against.
+
+  @retval TRUE   All chunks were provided and are valid.
+  @retval FALSE  The data failed verification.
+**/
+BOOLEAN
+OcAppleChunklistVerifyDataFinal (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  );
+
 #endif // APPLE_CHUNKLIST_LIB_H
@@ -41,6 +41,11 @@ typedef struct {
   UINT32                         DmgFileSize;
   VOID                           *ChunklistBuffer;
   UINT32                         ChunklistFileSize;
+  //
+  // DmgFile data was already verified against ChunklistBuffer while it was
+  // downloaded, only the chunklist signature needs to be checked.
+  //
+  BOOLEAN                        DmgFileVerified;
 } OC_APPLE_DISK_IMAGE_PRELOAD_CONTEXT;
 
 BOOLEAN
@@ -50,10 +55,22 @@ OcAppleDiskImageInitializeContext (
   IN  UINTN                              FileSize
   );
 
+/**
+  Load disk image file into RAM disk and initialise its context.
+
+  @param[out]    Context           Disk image context.
+  @param[in]     File              Disk image file open for reading.
+  @param[in,out] ChunklistContext  Chunklist context with verified signature
+                                   to verify the data against while it is
+                                   loaded, optional.
+
+  @retval TRUE on success.
+**/
 BOOLEAN
 OcAppleDiskImageInitializeFromFile (
-  OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  EFI_FILE_PROTOCOL            *File
+  OUT    OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_FILE_PROTOCOL            *File,
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT   *ChunklistContext OPTIONAL
   );
 
 VOID
@@ -284,6 +284,11 @@ typedef struct {
   //
   XML_DOCUMENT                           *PrelinkedInfoDocument;
   //
+  // Original PRELINK_INFO_SECTION contents within Prelinked. Unchanged plist
+  // entries are exported from here as is. NULL when the section is overwritten.
+  //
+  CONST CHAR8                            *PrelinkedInfoSource;
+  //
   // Reference for PRELINK_INFO_DICTIONARY_KEY in PlistDocument.
   // This reference is used for quick path during kext injection.
   //
@@ -447,6 +452,10 @@ typedef struct {
   //
   LIST_ENTRY           InjectedDependencies;
   //
+  // List of bundle identifiers of injected kexts.
+  //
+  LIST_ENTRY           InjectedIdentifiers;
+  //
   // List of kext patches for built-in shipping kexts.
   //
   LIST_ENTRY           PatchedKexts;
@@ -463,7 +472,8 @@ typedef struct {
   //
   BOOLEAN              Is32Bit;
   //
-  // Flag to indicate if above list is valid. List is built during the first read from SLE.
+  // Flag to indicate if above list is valid. List is built during the first read from SLE,
+  // with Info.plist files of built-in kexts read on demand.
   //
   BOOLEAN              BuiltInKextsValid;
 } CACHELESS_CONTEXT;
@@ -677,6 +687,18 @@ KernelApplyQuirk (
   IN     UINT32             KernelVersion
   );
 
+/**
+  Get target bundle identifier of the specified quirk.
+
+  @param[in] Name  KERNEL_QUIRK_NAME specifying the quirk name.
+
+  @returns Bundle identifier or NULL for kernel quirks.
+**/
+CONST CHAR8 *
+KernelGetQuirkIdentifier (
+  IN KERNEL_QUIRK_NAME  Name
+  );
+
 /**
   Read Apple kernel for target architecture (possibly decompressing)
   into pool allocated buffer. If CpuType does not exist in fat
@@ -705,6 +727,25 @@ ReadAppleKernel (
   OUT UINT8                 *Digest  OPTIONAL
   );
 
+/**
+  Check whether the file looks like an Apple kernel of the requested
+  architecture without reading it completely. Only the headers are read
+  and compressed kernels are decompressed just enough to see the Mach-O
+  magic, so the result does not guarantee ReadAppleKernel success.
+
+  @param[in]  File     File handle instance.
+  @param[in]  Is32Bit  Requested kernel architecture.
+
+  @retval EFI_SUCCESS            File may be a kernel of the requested architecture.
+  @retval EFI_NOT_FOUND          File has no kernel of the requested architecture.
+  @retval EFI_INVALID_PARAMETER  File is not a kernel.
+**/
+EFI_STATUS
+ProbeAppleKernel (
+  IN EFI_FILE_PROTOCOL  *File,
+  IN BOOLEAN            Is32Bit
+  );
+
 /**
   Read mkext for target architecture (possibly decompressing)
   into pool allocated buffer. If CpuType does not exist in fat
@@ -68,12 +68,32 @@ OcAppleRamDiskWrite (
   IN CONST VOID                         *Buffer
   );
 
+/**
+  Verify next portion of file data being loaded into RAM disk.
+
+  @param[in]  Context  Verification context.
+  @param[in]  Data     File data following previously verified data.
+  @param[in]  Size     Size of Data in bytes.
+
+  @retval TRUE when the data is valid.
+**/
+typedef
+BOOLEAN
+(*OC_APPLE_RAM_DISK_LOAD_VERIFY) (
+  IN VOID        *Context,
+  IN CONST VOID  *Data,
+  IN UINTN       Size
+  );
+
 /**
   Load file into RAM disk as it is.
 
-  @param[in]  ExtentTable Allocated extent table.
-  @param[in]  File        File protocol open for reading.
-  @param[in]  FileSize    Amount of data to write.
+  @param[in]  ExtentTable    Allocated extent table.
+  @param[in]  File           File protocol open for reading.
+  @param[in]  FileSize       Amount of data to write.
+  @param[in]  Verify         Verification function called for every read
+                             portion of the file in order, optional.
+  @param[in]  VerifyContext  Verification function context, optional.
 
   @retval TRUE on success.
 **/
@@ -81,7 +101,9 @@ BOOLEAN
 OcAppleRamDiskLoadFile (
   IN OUT CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
   IN     EFI_FILE_PROTOCOL                  *File,
-  IN     UINTN                              FileSize
+  IN     UINTN                              FileSize,
+  IN     OC_APPLE_RAM_DISK_LOAD_VERIFY      Verify         OPTIONAL,
+  IN     VOID                               *VerifyContext OPTIONAL
   );
 
 /**
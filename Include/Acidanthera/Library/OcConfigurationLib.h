@@ -828,6 +828,84 @@ OcConfigurationInit (
   IN  OUT  UINT32        *ErrorCount  OPTIONAL
   );
 
+/**
+  Root configuration sections, as reported by OcConfigurationReload.
+**/
+#define OC_CONFIG_SECTION_ACPI               BIT0
+#define OC_CONFIG_SECTION_BOOTER             BIT1
+#define OC_CONFIG_SECTION_DEVICE_PROPERTIES  BIT2
+#define OC_CONFIG_SECTION_KERNEL             BIT3
+#define OC_CONFIG_SECTION_MISC               BIT4
+#define OC_CONFIG_SECTION_NVRAM              BIT5
+#define OC_CONFIG_SECTION_PLATFORM_INFO      BIT6
+#define OC_CONFIG_SECTION_UEFI               BIT7
+
+/**
+  Reload configuration from updated plist data, reparsing only the root
+  sections which changed since the previous document.
+
+  When Document points to NULL, Config is initialised from scratch as with
+  OcConfigurationInit. Otherwise Config must be the result of parsing Document,
+  and only the changed sections are reset to defaults and parsed again.
+  On success Document is replaced with the new document, and the previous one
+  is freed. On failure Config and Document are left unchanged.
+
+  @param[in,out]  Config           Configuration structure.
+  @param[in]      Buffer           Configuration buffer in plist format, referenced
+                                   by the resulting document and modified in place.
+  @param[in]      Size             Configuration buffer size.
+  @param[in,out]  Document         Previously parsed document or NULL, free with
+                                   XmlDocumentFree after OcConfigurationFree.
+  @param[out]     ChangedSections  Mask of OC_CONFIG_SECTION values reparsed. Optional.
+  @param[in]      Report           Changed schema path callback. Optional.
+  @param[in]      Context          Report callback context. Optional.
+  @param[in,out]  ErrorCount       Errors detected in the reparsed sections. Optional.
+
+  @retval  EFI_SUCCESS on success
+**/
+EFI_STATUS
+OcConfigurationReload (
+  IN OUT  OC_GLOBAL_CONFIG     *Config,
+  IN OUT  VOID                 *Buffer,
+  IN      UINT32               Size,
+  IN OUT  XML_DOCUMENT         **Document,
+  OUT     UINT32               *ChangedSections  OPTIONAL,
+  IN      OC_SERIALIZE_REPORT  Report           OPTIONAL,
+  IN      VOID                 *Context          OPTIONAL,
+  IN OUT  UINT32               *ErrorCount       OPTIONAL
+  );
+
+/**
+  Export configuration into a binary snapshot, which can be loaded
+  without plist parsing by the same build.
+
+  @param[in]   Config        Configuration structure.
+  @param[out]  SnapshotSize  Snapshot size.
+
+  @retval  Snapshot allocated from pool or NULL.
+**/
+VOID *
+OcConfigurationExportSnapshot (
+  IN   OC_GLOBAL_CONFIG  *Config,
+  OUT  UINT32            *SnapshotSize
+  );
+
+/**
+  Initialize configuration with binary snapshot data.
+
+  @param[out]  Config        Configuration structure.
+  @param[in]   Snapshot      Snapshot from OcConfigurationExportSnapshot, may be read-only.
+  @param[in]   SnapshotSize  Snapshot size.
+
+  @retval  EFI_SUCCESS on success
+**/
+EFI_STATUS
+OcConfigurationInitFromSnapshot (
+  OUT  OC_GLOBAL_CONFIG  *Config,
+  IN   CONST VOID        *Snapshot,
+  IN   UINT32            SnapshotSize
+  );
+
 /**
   Free configuration structure.
 
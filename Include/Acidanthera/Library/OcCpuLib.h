@@ -361,4 +361,17 @@ OcGetTSCFrequency (
   VOID
   );
 
+/**
+  Check whether the last TSC frequency was a provisional estimate taken
+  before ACPI PM timer calibration completion. Calibration is completed by
+  OcCpuScanProcessor, this only reads cached state and is safe at any TPL.
+
+  @retval TRUE when OcGetTSCFrequency should be called again once
+               calibration completes.
+**/
+BOOLEAN
+OcIsTSCFrequencyEstimate (
+  VOID
+  );
+
 #endif // OC_CPU_LIB_H_
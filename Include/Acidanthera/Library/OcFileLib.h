@@ -25,6 +25,7 @@
 #include <Protocol/DevicePath.h>
 #include <Protocol/BlockIo.h>
 #include <Protocol/BlockIo2.h>
+#include <Protocol/OcPartitionEntries.h>
 
 /**
   Maximum safe volume label size.
@@ -292,6 +293,40 @@ OcGetNewestFileFromDirectory (
   OUT EFI_FILE_INFO                **FileInfo
   );
 
+/**
+  Gets all files from the specified directory in a single pass, sorted
+  from newest to oldest. Files with equal modification time keep directory
+  order, matching repeated OcGetNewestFileFromDirectory calls.
+
+  @param[in]      Directory             The directory EFI_FILE_PROTOCOL instance.
+  @param[in]      FileNameStartsWith    Skip files not starting with this value.
+  @param[out]     FileInfos             Array of EFI_FILE_INFO allocated from pool memory.
+                                        Free with OcFreeSortedFilesFromDirectory.
+  @param[out]     FileInfoCount         Number of files in FileInfos.
+
+  @retval EFI_SUCCESS on success.
+  @retval EFI_NOT_FOUND when no matching files are found.
+**/
+EFI_STATUS
+OcGetSortedFilesFromDirectory (
+  IN     EFI_FILE_PROTOCOL  *Directory,
+  IN     CHAR16             *FileNameStartsWith OPTIONAL,
+  OUT EFI_FILE_INFO         ***FileInfos,
+  OUT UINTN                 *FileInfoCount
+  );
+
+/**
+  Free files returned by OcGetSortedFilesFromDirectory.
+
+  @param[in]      FileInfos             Array of EFI_FILE_INFO.
+  @param[in]      FileInfoCount         Number of files in FileInfos.
+**/
+VOID
+OcFreeSortedFilesFromDirectory (
+  IN EFI_FILE_INFO  **FileInfos,
+  IN UINTN          FileInfoCount
+  );
+
 /**
   Ensure specified file is directory or file as specified by IsDirectory.
 
@@ -625,17 +660,9 @@ OcDiskWrite (
   IN VOID             *Buffer
   );
 
-/**
-  OC partition list.
-**/
-typedef struct {
-  UINT32                 NumPartitions;
-  UINT32                 PartitionEntrySize;
-  EFI_PARTITION_ENTRY    FirstEntry[];
-} OC_PARTITION_ENTRIES;
-
 /**
   Retrieve the disk GPT partitions, if applicable.
+  Entries cached on the disk handle are reused while the media is unchanged.
 
   @param[in]  DiskHandle   Disk device handle to retrive partition table from.
   @param[in]  UseBlockIo2  Use 2nd revision of Block I/O if available.
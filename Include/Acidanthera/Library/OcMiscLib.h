@@ -36,6 +36,37 @@
 #define SECONDS_TO_NANOSECONDS(x)  ((x) * 1000000000)
 #define MS_TO_NANOSECONDS(x)       ((x) * 1000000)
 
+/**
+  Compare data against a pattern a machine word at a time.
+
+  @param[in]  Pattern      Pattern to compare with.
+  @param[in]  PatternMask  Pattern mask, applied to data bytes, optional.
+  @param[in]  PatternSize  Pattern size in bytes.
+  @param[in]  Data         Data to compare, at least PatternSize bytes.
+
+  @retval TRUE when (Data & PatternMask) equals Pattern.
+**/
+BOOLEAN
+MatchPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data
+  );
+
+/**
+  Locate the first pattern occurrence at or after DataOff.
+  The search is anchored on the least common pattern byte.
+
+  @param[in]      Pattern      Pattern to search for.
+  @param[in]      PatternMask  Pattern mask, applied to data bytes, optional.
+  @param[in]      PatternSize  Pattern size in bytes.
+  @param[in]      Data         Data to search in.
+  @param[in]      DataSize     Data size in bytes.
+  @param[in,out]  DataOff      Offset to start from, match offset on success.
+
+  @retval TRUE when the pattern was found.
+**/
 BOOLEAN
 FindPattern (
   IN CONST UINT8   *Pattern,
@@ -220,6 +251,50 @@ OcConsoleFlush (
   VOID
   );
 
+/**
+  Maximum number of completed trace spans kept before the oldest get overwritten.
+**/
+#define OC_TRACE_SPAN_MAX  256
+
+/**
+  Maximum nesting of trace spans.
+**/
+#define OC_TRACE_DEPTH_MAX  16
+
+/**
+  Start boot phase trace span. Spans must be properly nested.
+
+  @param[in]  Name  Span name, static string without quotes or backslashes.
+**/
+VOID
+OcTraceBegin (
+  IN CONST CHAR8  *Name
+  );
+
+/**
+  Complete the innermost boot phase trace span.
+
+  @param[in]  Name  Span name, same as passed to OcTraceBegin.
+**/
+VOID
+OcTraceEnd (
+  IN CONST CHAR8  *Name
+  );
+
+/**
+  Print trace spans completed since the previous call to the log as
+  Chrome trace JSON array entries, one per line with OCTR prefix.
+  The trace can be extracted from the log with
+  sed -n 's/.*OCTR: {/{/p' and loaded into Perfetto or
+  chrome://tracing after prepending [.
+
+  @param[in]  TscFrequency  TSC frequency in Hz, nothing is printed when 0.
+**/
+VOID
+OcTraceFlush (
+  IN UINT64  TscFrequency
+  );
+
 /**
   Internal worker macro that calls DebugPrint().
 
@@ -235,6 +235,77 @@ ParseSerialized (
   IN  OUT  UINT32          *ErrorCount  OPTIONAL
   );
 
+//
+// Parse only the root entries selected by SectionMask from an already parsed
+// document. Bit N selects root schema entry N, entries past bit 31 are only
+// parsed with MAX_UINT32 mask. Unselected entries are left untouched.
+//
+BOOLEAN
+ParseSerializedSections (
+  OUT  VOID                *Serialized,
+  IN       OC_SCHEMA_INFO  *RootSchema,
+  IN       XML_DOCUMENT    *Document,
+  IN       UINT32          SectionMask,
+  IN  OUT  UINT32          *ErrorCount  OPTIONAL
+  );
+
+//
+// Maximum length of a schema path passed to OC_SERIALIZE_REPORT.
+//
+#define OC_SERIALIZE_PATH_MAX  256
+
+//
+// Changed schema path callback, Path is a slash separated
+// list of schema names, e.g. Kernel/Quirks/XhciPortLimit.
+//
+typedef
+VOID
+(*OC_SERIALIZE_REPORT) (
+  IN  VOID         *Context  OPTIONAL,
+  IN  CONST CHAR8  *Path
+  );
+
+//
+// Compare two serialized documents against the schema and return the mask
+// of root entries to pass to ParseSerializedSections. Nested dictionaries are
+// compared key by key, any other value is reported as a whole. Comments and
+// keys without schema are ignored. MAX_UINT32 is returned when either root is
+// invalid or the schema is too large for the mask.
+//
+UINT32
+DiffSerialized (
+  IN  OC_SCHEMA_INFO       *RootSchema,
+  IN  XML_DOCUMENT         *OldDocument,
+  IN  XML_DOCUMENT         *NewDocument,
+  IN  OC_SERIALIZE_REPORT  Report       OPTIONAL,
+  IN  VOID                 *Context     OPTIONAL
+  );
+
+//
+// Export serialized data into a binary snapshot allocated from pool.
+// The snapshot is bound to the schema layout and may be imported back
+// without XML parsing. Only builtin appliers are supported.
+//
+VOID *
+ExportSerializedSnapshot (
+  IN   CONST VOID      *Serialized,
+  IN   OC_SCHEMA_INFO  *RootSchema,
+  OUT  UINT32          *SnapshotSize
+  );
+
+//
+// Import binary snapshot into constructed serialized data.
+// Snapshot is only read and may be a read-only mapping.
+// Partially imported data must be destructed on failure.
+//
+BOOLEAN
+ImportSerializedSnapshot (
+  OUT  VOID            *Serialized,
+  IN   OC_SCHEMA_INFO  *RootSchema,
+  IN   CONST VOID      *Snapshot,
+  IN   UINT32          SnapshotSize
+  );
+
 //
 // Retrieve typed field pointer from offset
 //
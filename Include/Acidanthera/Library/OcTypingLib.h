@@ -36,6 +36,7 @@
 typedef PACKED struct {
   APPLE_KEY_CODE    AppleKeyCode;
   CHAR16            UnicodeChar;
+  UINT64            EventTime;
 } OC_TYPING_BUFFER_ENTRY;
 
 typedef PACKED struct {
@@ -46,6 +47,10 @@ typedef PACKED struct {
   UINTN                     Head;
   UINTN                     Tail;
   UINT64                    *KeyTimes;   // only used in DEBUG builds with OC_TRACE_KEY_TIMES defined
+  UINT64                    PendingKeyTime;
+  UINT64                    LatencyCount;
+  UINT64                    LatencyTotal;
+  UINT64                    LatencyMax;
 } OC_TYPING_CONTEXT;
 
 #pragma pack()
@@ -94,6 +99,19 @@ OcGetNextKeystroke (
   OUT CHAR16              *UnicodeChar
   );
 
+/**
+  Record key latency of the last keystroke returned by OcGetNextKeystroke.
+  Meant to be called when the consumer is ready for the next input, i.e.
+  after it has handled and redrawn for the previous key. Does nothing if
+  no key was returned since the last call.
+
+  @param[in]      Context             Typing handler context.
+**/
+VOID
+OcRecordKeyLatency (
+  IN OC_TYPING_CONTEXT  *Context
+  );
+
 /**
   Flush typing buffer.
 
@@ -21,6 +21,8 @@
 
 #define OPEN_CORE_NVRAM_USED_FILENAME  L"nvram.used"
 
+#define OPEN_CORE_NVRAM_BINARY_FILENAME  L"nvram.bin"
+
 #define OPEN_CORE_NVRAM_ATTR  (EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
 
 #define OPEN_CORE_NVRAM_NV_ATTR  (EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS | EFI_VARIABLE_NON_VOLATILE)
@@ -150,6 +150,53 @@ XmlDocumentExport (
   IN   BOOLEAN             PrependPlistInfo
   );
 
+/**
+  Calculate the size of a document export into a caller provided buffer.
+  When Source is given, nodes whose subtree changed since parsing are marked,
+  so that only they are serialised by XmlDocumentExportToBuffer.
+
+  @param[in,out]  Document          XML_DOCUMENT to export.
+  @param[in]      Source            Unmodified contents of the buffer the document
+                                    was parsed from. Optional.
+  @param[in]      Skip              Number of root levels to be skipped before exporting, normally 0.
+  @param[in]      PrependPlistInfo  TRUE to prepend XML plist doc info to exported document.
+  @param[out]     Length            Resulting length of the export without trailing '\0'.
+
+  @retval TRUE on success.
+**/
+BOOLEAN
+XmlDocumentExportSize (
+  IN OUT  XML_DOCUMENT  *Document,
+  IN      CONST CHAR8   *Source  OPTIONAL,
+  IN      UINT32        Skip,
+  IN      BOOLEAN       PrependPlistInfo,
+  OUT     UINT32        *Length
+  );
+
+/**
+  Export parsed document into a caller provided buffer. Nodes left intact
+  since parsing are copied from Source verbatim.
+
+  @param[in]  Document          XML_DOCUMENT to export.
+  @param[in]  Source            Same as passed to XmlDocumentExportSize. Optional.
+  @param[in]  Skip              Same as passed to XmlDocumentExportSize.
+  @param[in]  PrependPlistInfo  Same as passed to XmlDocumentExportSize.
+  @param[out] Buffer            Buffer of XmlDocumentExportSize length plus one
+                                byte for trailing '\0'. Must not overlap Source.
+
+  @warning XmlDocumentExportSize must be called right before this function.
+
+  @return Exported length without trailing '\0'.
+**/
+UINT32
+XmlDocumentExportToBuffer (
+  IN   CONST XML_DOCUMENT  *Document,
+  IN   CONST CHAR8         *Source  OPTIONAL,
+  IN   UINT32              Skip,
+  IN   BOOLEAN             PrependPlistInfo,
+  OUT  CHAR8               *Buffer
+  );
+
 /**
   Free all resources associated with the document. All XML_NODE
   references obtained through the document will be invalidated.
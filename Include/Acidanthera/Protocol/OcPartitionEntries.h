@@ -0,0 +1,64 @@
+/** @file
+  Copyright (C) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#ifndef OC_PARTITION_ENTRIES_PROTOCOL_H
+#define OC_PARTITION_ENTRIES_PROTOCOL_H
+
+#include <Uefi.h>
+#include <Uefi/UefiGpt.h>
+
+//
+// OC_PARTITION_ENTRIES_PROTOCOL_GUID
+// 994FD542-C632-4063-B112-F0751E158559
+//
+// Differs from the GUID OcFileLib used privately for the previous layout
+// without MediaId, Verified and Header, so that drivers built with either
+// layout never interpret each other's instances.
+//
+#define OC_PARTITION_ENTRIES_PROTOCOL_GUID  \
+  { 0x994FD542, 0xC632, 0x4063, \
+    { 0xB1, 0x12, 0xF0, 0x75, 0x1E, 0x15, 0x85, 0x59 } }
+
+/**
+  Parsed GPT partition entry array cached on the disk handle.
+
+  The instance is published by OpenPartitionDxe once the header and entry
+  array CRCs were verified, or by OcFileLib on first lookup otherwise.
+  Instances are never freed once installed, as the per-partition entry
+  pointers handed out by OcFileLib point into them. A cache with MediaId
+  not matching the current Block I/O media is stale and gets uninstalled
+  and replaced with a new instance. OpenPartitionDxe additionally compares
+  the on-disk primary header against Header before reusing the entries.
+**/
+typedef struct {
+  ///
+  /// Block I/O media identifier the entries were read from.
+  ///
+  UINT32                        MediaId;
+  ///
+  /// Header and entry array CRCs were verified.
+  ///
+  BOOLEAN                       Verified;
+  ///
+  /// Primary GPT header the entries were read through.
+  ///
+  EFI_PARTITION_TABLE_HEADER    Header;
+  ///
+  /// Number of entries in the entry array.
+  ///
+  UINT32                        NumPartitions;
+  ///
+  /// Size of each entry in the entry array.
+  ///
+  UINT32                        PartitionEntrySize;
+  ///
+  /// Entry array, PartitionEntrySize bytes per entry.
+  ///
+  EFI_PARTITION_ENTRY           FirstEntry[];
+} OC_PARTITION_ENTRIES;
+
+extern EFI_GUID  gOcPartitionEntriesProtocolGuid;
+
+#endif // OC_PARTITION_ENTRIES_PROTOCOL_H
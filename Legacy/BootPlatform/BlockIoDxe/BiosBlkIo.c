@@ -614,6 +614,7 @@ BiosBlockIoDriverBindingStop (
            ChildHandleBuffer[Index]
            );
 
+    BiosBlockIoCacheFree (BiosBlockIoPrivate);
     gBS->FreePool (BiosBlockIoPrivate);
   }
 
@@ -422,4 +422,104 @@ SetBiosInitBlockIoDevicePath (
   OUT EFI_DEVICE_PATH_PROTOCOL  **DevicePath
   );
 
+/**
+  Read blocks from the device bypassing the sector cache.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Lba            The starting Logical Block Address to read from.
+  @param  BufferSize     Size of Buffer, must be a multiple of device block size.
+  @param  Buffer         A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS    The data was read correctly from the device.
+  @retval Others         The read failed.
+
+**/
+typedef
+EFI_STATUS
+(*BIOS_BLOCK_IO_DEVICE_READ) (
+  IN  BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN  EFI_LBA            Lba,
+  IN  UINTN              BufferSize,
+  OUT VOID               *Buffer
+  );
+
+/**
+  Read BufferSize bytes from Lba into Buffer through the sector cache.
+  The request must already be validated by the caller.
+
+  Small reads are served from 4 KB cache lines, cache misses are filled
+  with a single device read covering the remaining request and, for
+  sequential access, a growing read-ahead window.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Lba            The starting Logical Block Address to read from.
+  @param  BufferSize     Size of Buffer, must be a multiple of device block size.
+  @param  Buffer         A pointer to the destination buffer for the data.
+  @param  DeviceRead     Device read routine.
+
+  @retval EFI_SUCCESS    The data was read correctly.
+  @retval Others         The device read failed.
+
+**/
+EFI_STATUS
+BiosBlockIoCacheRead (
+  IN  BIOS_BLOCK_IO_DEV          *BiosBlockIoDev,
+  IN  EFI_LBA                    Lba,
+  IN  UINTN                      BufferSize,
+  OUT VOID                       *Buffer,
+  IN  BIOS_BLOCK_IO_DEVICE_READ  DeviceRead
+  );
+
+/**
+  Update cached sectors after a successful device write.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Lba            The starting Logical Block Address written.
+  @param  BufferSize     Size of Buffer, must be a multiple of device block size.
+  @param  Buffer         A pointer to the written data.
+
+**/
+VOID
+BiosBlockIoCacheWrite (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN EFI_LBA            Lba,
+  IN UINTN              BufferSize,
+  IN VOID               *Buffer
+  );
+
+/**
+  Drop all cached sectors.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+
+**/
+VOID
+BiosBlockIoCacheInvalidate (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev
+  );
+
+/**
+  Log sector cache statistics.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Force          Log even if there was little activity since last report.
+
+**/
+VOID
+BiosBlockIoCacheReport (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN BOOLEAN            Force
+  );
+
+/**
+  Free sector cache.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+
+**/
+VOID
+BiosBlockIoCacheFree (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev
+  );
+
 #endif
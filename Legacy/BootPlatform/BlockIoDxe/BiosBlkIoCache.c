@@ -0,0 +1,418 @@
+/** @file
+  Write-through sector cache with sequential read-ahead for INT 13 devices.
+
+  Every device access is a real mode thunk, which dominates the cost of
+  small filesystem reads. Reads smaller than BIOS_BLOCK_IO_CACHE_BYPASS_SIZE
+  are therefore served from per-device cache lines, and misses are filled
+  with as few thunks as possible.
+
+Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BiosBlkIo.h"
+
+//
+// Number of thunks between periodic statistics reports.
+//
+#define BIOS_BLOCK_IO_CACHE_REPORT_THUNKS  1024
+
+/**
+  Set up the cache for the current media.
+
+  @param  Cache   Sector cache.
+  @param  Media   Block I/O media.
+
+**/
+STATIC
+VOID
+CacheSetup (
+  IN OUT BIOS_BLOCK_IO_CACHE  *Cache,
+  IN     EFI_BLOCK_IO_MEDIA   *Media
+  )
+{
+  ZeroMem (Cache->Lines, sizeof (Cache->Lines));
+  Cache->Initialized = TRUE;
+  Cache->MediaId     = Media->MediaId;
+  Cache->LineBlocks  = 0;
+  Cache->LineShift   = 0;
+  Cache->ReadAhead   = 0;
+  Cache->NextLba     = MAX_UINT64;
+
+  //
+  // Block size is a power of two for all known INT 13 devices.
+  // Anything unusual is left uncached.
+  //
+  if (  (Media->BlockSize == 0)
+     || (Media->BlockSize > BIOS_BLOCK_IO_CACHE_LINE_SIZE)
+     || ((BIOS_BLOCK_IO_CACHE_LINE_SIZE % Media->BlockSize) != 0))
+  {
+    return;
+  }
+
+  if (Cache->Data == NULL) {
+    Cache->Data = AllocatePool (BIOS_BLOCK_IO_CACHE_LINES * BIOS_BLOCK_IO_CACHE_LINE_SIZE);
+    if (Cache->Data == NULL) {
+      return;
+    }
+  }
+
+  if (Cache->FillBuffer == NULL) {
+    Cache->FillBuffer = AllocatePool (BIOS_BLOCK_IO_CACHE_MAX_FILL * BIOS_BLOCK_IO_CACHE_LINE_SIZE);
+    if (Cache->FillBuffer == NULL) {
+      return;
+    }
+  }
+
+  Cache->LineBlocks = BIOS_BLOCK_IO_CACHE_LINE_SIZE / Media->BlockSize;
+  Cache->LineShift  = (UINT32)HighBitSet32 (Cache->LineBlocks);
+}
+
+/**
+  Find cached line.
+
+  @param  Cache   Sector cache.
+  @param  LineLba First block of the line.
+
+  @return Cache line index or BIOS_BLOCK_IO_CACHE_LINES when not cached.
+
+**/
+STATIC
+UINTN
+CacheLookup (
+  IN BIOS_BLOCK_IO_CACHE  *Cache,
+  IN EFI_LBA              LineLba
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < BIOS_BLOCK_IO_CACHE_LINES; ++Index) {
+    if (Cache->Lines[Index].Valid && (Cache->Lines[Index].Lba == LineLba)) {
+      return Index;
+    }
+  }
+
+  return BIOS_BLOCK_IO_CACHE_LINES;
+}
+
+/**
+  Store line data in the least recently used cache line.
+
+  @param  Cache   Sector cache.
+  @param  LineLba First block of the line.
+  @param  Data    Line data.
+
+**/
+STATIC
+VOID
+CacheInsert (
+  IN OUT BIOS_BLOCK_IO_CACHE  *Cache,
+  IN     EFI_LBA              LineLba,
+  IN     CONST UINT8          *Data
+  )
+{
+  UINTN  Index;
+  UINTN  Victim;
+
+  Victim = 0;
+  for (Index = 0; Index < BIOS_BLOCK_IO_CACHE_LINES; ++Index) {
+    if (!Cache->Lines[Index].Valid) {
+      Victim = Index;
+      break;
+    }
+
+    if (Cache->Lines[Index].LastUsed < Cache->Lines[Victim].LastUsed) {
+      Victim = Index;
+    }
+  }
+
+  Cache->Lines[Victim].Lba      = LineLba;
+  Cache->Lines[Victim].Valid    = TRUE;
+  Cache->Lines[Victim].LastUsed = ++Cache->Tick;
+  CopyMem (
+    Cache->Data + Victim * BIOS_BLOCK_IO_CACHE_LINE_SIZE,
+    Data,
+    BIOS_BLOCK_IO_CACHE_LINE_SIZE
+    );
+}
+
+/**
+  Fill cache lines starting with the missing line at LineLba.
+
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  LineLba        First block of the missing line.
+  @param  EndLba         End of the current request (exclusive).
+  @param  DeviceRead     Device read routine.
+
+  @retval EFI_SUCCESS    Lines were filled, FillBuffer starts with LineLba.
+  @retval Others         The device read failed.
+
+**/
+STATIC
+EFI_STATUS
+CacheFill (
+  IN BIOS_BLOCK_IO_DEV          *BiosBlockIoDev,
+  IN EFI_LBA                    LineLba,
+  IN EFI_LBA                    EndLba,
+  IN BIOS_BLOCK_IO_DEVICE_READ  DeviceRead
+  )
+{
+  EFI_STATUS           Status;
+  BIOS_BLOCK_IO_CACHE  *Cache;
+  UINT64               MediaLines;
+  UINTN                Count;
+  UINTN                Index;
+
+  Cache = &BiosBlockIoDev->Cache;
+
+  //
+  // Lines still needed by this request plus the read-ahead window,
+  // limited to full lines within the media.
+  //
+  Count      = (UINTN)RShiftU64 (EndLba - LineLba + Cache->LineBlocks - 1, Cache->LineShift);
+  Count     += Cache->ReadAhead;
+  MediaLines = RShiftU64 (BiosBlockIoDev->BlockIo.Media->LastBlock + 1 - LineLba, Cache->LineShift);
+  if (Count > MediaLines) {
+    Count = (UINTN)MediaLines;
+  }
+
+  if (Count > BIOS_BLOCK_IO_CACHE_MAX_FILL) {
+    Count = BIOS_BLOCK_IO_CACHE_MAX_FILL;
+  }
+
+  //
+  // Do not read lines which are already cached.
+  //
+  for (Index = 1; Index < Count; ++Index) {
+    if (CacheLookup (Cache, LineLba + LShiftU64 (Index, Cache->LineShift)) != BIOS_BLOCK_IO_CACHE_LINES) {
+      Count = Index;
+      break;
+    }
+  }
+
+  Status = DeviceRead (
+             BiosBlockIoDev,
+             LineLba,
+             Count * BIOS_BLOCK_IO_CACHE_LINE_SIZE,
+             Cache->FillBuffer
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (Index = 0; Index < Count; ++Index) {
+    CacheInsert (
+      Cache,
+      LineLba + LShiftU64 (Index, Cache->LineShift),
+      Cache->FillBuffer + Index * BIOS_BLOCK_IO_CACHE_LINE_SIZE
+      );
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+BiosBlockIoCacheRead (
+  IN  BIOS_BLOCK_IO_DEV          *BiosBlockIoDev,
+  IN  EFI_LBA                    Lba,
+  IN  UINTN                      BufferSize,
+  OUT VOID                       *Buffer,
+  IN  BIOS_BLOCK_IO_DEVICE_READ  DeviceRead
+  )
+{
+  EFI_STATUS           Status;
+  EFI_BLOCK_IO_MEDIA   *Media;
+  BIOS_BLOCK_IO_CACHE  *Cache;
+  UINT8                *Target;
+  UINTN                BlockSize;
+  EFI_LBA              EndLba;
+  EFI_LBA              LineLba;
+  UINTN                LineIndex;
+  UINTN                Offset;
+  UINTN                Size;
+
+  Media = BiosBlockIoDev->BlockIo.Media;
+  Cache = &BiosBlockIoDev->Cache;
+
+  if (!Cache->Initialized || (Cache->MediaId != Media->MediaId)) {
+    CacheSetup (Cache, Media);
+  }
+
+  BlockSize = Media->BlockSize;
+  EndLba    = Lba + BufferSize / BlockSize;
+
+  //
+  // Grow read-ahead window while the access stays sequential.
+  //
+  if (Lba == Cache->NextLba) {
+    Cache->ReadAhead = Cache->ReadAhead == 0 ? 1 : MIN (Cache->ReadAhead * 2, BIOS_BLOCK_IO_CACHE_MAX_FILL);
+  } else {
+    Cache->ReadAhead = 0;
+  }
+
+  Cache->NextLba = EndLba;
+
+  if ((Cache->LineBlocks == 0) || (BufferSize >= BIOS_BLOCK_IO_CACHE_BYPASS_SIZE)) {
+    Status = DeviceRead (BiosBlockIoDev, Lba, BufferSize, Buffer);
+    BiosBlockIoCacheReport (BiosBlockIoDev, FALSE);
+    return Status;
+  }
+
+  Status = EFI_SUCCESS;
+  Target = Buffer;
+
+  while (BufferSize > 0) {
+    LineLba = Lba & ~((EFI_LBA)Cache->LineBlocks - 1);
+    Offset  = (UINTN)(Lba - LineLba) * BlockSize;
+    Size    = MIN (BufferSize, BIOS_BLOCK_IO_CACHE_LINE_SIZE - Offset);
+
+    if (LineLba + Cache->LineBlocks - 1 > Media->LastBlock) {
+      //
+      // Partial line at the end of the media is not cached.
+      //
+      Status = DeviceRead (BiosBlockIoDev, Lba, Size, Target);
+    } else {
+      LineIndex = CacheLookup (Cache, LineLba);
+      if (LineIndex != BIOS_BLOCK_IO_CACHE_LINES) {
+        ++Cache->Hits;
+        Cache->Lines[LineIndex].LastUsed = ++Cache->Tick;
+        CopyMem (Target, Cache->Data + LineIndex * BIOS_BLOCK_IO_CACHE_LINE_SIZE + Offset, Size);
+      } else {
+        ++Cache->Misses;
+        Status = CacheFill (BiosBlockIoDev, LineLba, EndLba, DeviceRead);
+        if (!EFI_ERROR (Status)) {
+          CopyMem (Target, Cache->FillBuffer + Offset, Size);
+        } else if ((Status != EFI_MEDIA_CHANGED) && (Media->MediaId == Cache->MediaId)) {
+          //
+          // Fill may fail on unreadable sectors outside of the request, retry just the request.
+          //
+          Cache->ReadAhead = 0;
+          Status           = DeviceRead (BiosBlockIoDev, Lba, Size, Target);
+        }
+      }
+    }
+
+    if (EFI_ERROR (Status)) {
+      Cache->NextLba = MAX_UINT64;
+      break;
+    }
+
+    Lba        += Size / BlockSize;
+    Target     += Size;
+    BufferSize -= Size;
+  }
+
+  BiosBlockIoCacheReport (BiosBlockIoDev, FALSE);
+  return Status;
+}
+
+VOID
+BiosBlockIoCacheWrite (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN EFI_LBA            Lba,
+  IN UINTN              BufferSize,
+  IN VOID               *Buffer
+  )
+{
+  BIOS_BLOCK_IO_CACHE  *Cache;
+  UINTN                BlockSize;
+  EFI_LBA              EndLba;
+  EFI_LBA              LineLba;
+  EFI_LBA              LineEndLba;
+  EFI_LBA              CopyLba;
+  EFI_LBA              CopyEndLba;
+  UINTN                Index;
+
+  Cache = &BiosBlockIoDev->Cache;
+
+  if (  !Cache->Initialized
+     || (Cache->LineBlocks == 0)
+     || (Cache->MediaId != BiosBlockIoDev->BlockIo.Media->MediaId))
+  {
+    return;
+  }
+
+  BlockSize = BiosBlockIoDev->BlockIo.Media->BlockSize;
+  EndLba    = Lba + BufferSize / BlockSize;
+
+  for (Index = 0; Index < BIOS_BLOCK_IO_CACHE_LINES; ++Index) {
+    if (!Cache->Lines[Index].Valid) {
+      continue;
+    }
+
+    LineLba    = Cache->Lines[Index].Lba;
+    LineEndLba = LineLba + Cache->LineBlocks;
+    if ((LineEndLba <= Lba) || (LineLba >= EndLba)) {
+      continue;
+    }
+
+    CopyLba    = MAX (LineLba, Lba);
+    CopyEndLba = MIN (LineEndLba, EndLba);
+    CopyMem (
+      Cache->Data + Index * BIOS_BLOCK_IO_CACHE_LINE_SIZE + (UINTN)(CopyLba - LineLba) * BlockSize,
+      (UINT8 *)Buffer + (UINTN)(CopyLba - Lba) * BlockSize,
+      (UINTN)(CopyEndLba - CopyLba) * BlockSize
+      );
+  }
+}
+
+VOID
+BiosBlockIoCacheInvalidate (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev
+  )
+{
+  BiosBlockIoDev->Cache.Initialized = FALSE;
+}
+
+VOID
+BiosBlockIoCacheReport (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN BOOLEAN            Force
+  )
+{
+  BIOS_BLOCK_IO_CACHE  *Cache;
+  UINT64               Lookups;
+
+  Cache = &BiosBlockIoDev->Cache;
+
+  if (  (Cache->Thunks == Cache->ReportedThunks)
+     || (!Force && (Cache->Thunks - Cache->ReportedThunks < BIOS_BLOCK_IO_CACHE_REPORT_THUNKS)))
+  {
+    return;
+  }
+
+  Cache->ReportedThunks = Cache->Thunks;
+  Lookups               = Cache->Hits + Cache->Misses;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "BBIO: Drive %02x cache %Lu hits %Lu misses (%Lu%%), %Lu thunks\n",
+    BiosBlockIoDev->Bios.Number,
+    Cache->Hits,
+    Cache->Misses,
+    Lookups != 0 ? DivU64x64Remainder (MultU64x32 (Cache->Hits, 100), Lookups, NULL) : 0,
+    Cache->Thunks
+    ));
+}
+
+VOID
+BiosBlockIoCacheFree (
+  IN BIOS_BLOCK_IO_DEV  *BiosBlockIoDev
+  )
+{
+  BiosBlockIoCacheReport (BiosBlockIoDev, TRUE);
+
+  if (BiosBlockIoDev->Cache.Data != NULL) {
+    FreePool (BiosBlockIoDev->Cache.Data);
+    BiosBlockIoDev->Cache.Data = NULL;
+  }
+
+  if (BiosBlockIoDev->Cache.FillBuffer != NULL) {
+    FreePool (BiosBlockIoDev->Cache.FillBuffer);
+    BiosBlockIoDev->Cache.FillBuffer = NULL;
+  }
+
+  BiosBlockIoDev->Cache.Initialized = FALSE;
+}
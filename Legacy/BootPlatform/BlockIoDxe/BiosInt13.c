@@ -387,36 +387,28 @@ GetDriveParameters (
 //
 
 /**
-  Read BufferSize bytes from Lba into Buffer.
+  Read blocks from the device bypassing the sector cache.
 
-  @param  This       Indicates a pointer to the calling context.
-  @param  MediaId    Id of the media, changes every time the media is replaced.
-  @param  Lba        The starting Logical Block Address to read from
-  @param  BufferSize Size of Buffer, must be a multiple of device block size.
-  @param  Buffer     A pointer to the destination buffer for the data. The caller is
-                     responsible for either having implicit or explicit ownership of the buffer.
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Lba            The starting Logical Block Address to read from.
+  @param  BufferSize     Size of Buffer, must be a multiple of device block size.
+  @param  Buffer         A pointer to the destination buffer for the data.
 
   @retval EFI_SUCCESS           The data was read correctly from the device.
   @retval EFI_DEVICE_ERROR      The device reported an error while performing the read.
-  @retval EFI_NO_MEDIA          There is no media in the device.
-  @retval EFI_MEDIA_CHANGED     The MediaId does not matched the current device.
-  @retval EFI_BAD_BUFFER_SIZE   The Buffer was not a multiple of the block size of the device.
-  @retval EFI_INVALID_PARAMETER The read request contains LBAs that are not valid,
-                                or the buffer is not on proper alignment.
+  @retval EFI_MEDIA_CHANGED     The media was changed.
 
 **/
+STATIC
 EFI_STATUS
-EFIAPI
-Edd30BiosReadBlocks (
-  IN  EFI_BLOCK_IO_PROTOCOL  *This,
-  IN  UINT32                 MediaId,
-  IN  EFI_LBA                Lba,
-  IN  UINTN                  BufferSize,
-  OUT VOID                   *Buffer
+Edd30BiosReadDevice (
+  IN  BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN  EFI_LBA            Lba,
+  IN  UINTN              BufferSize,
+  OUT VOID               *Buffer
   )
 {
   EFI_BLOCK_IO_MEDIA         *Media;
-  BIOS_BLOCK_IO_DEV          *BiosBlockIoDev;
   EDD_DEVICE_ADDRESS_PACKET  *AddressPacket;
   IA32_REGISTER_SET          Regs;
   UINT64                     TransferBuffer;
@@ -428,37 +420,12 @@ Edd30BiosReadBlocks (
   UINTN                      MaxTransferBlocks;
   EFI_BLOCK_IO_PROTOCOL      *BlockIo;
 
-  Media     = This->Media;
+  Media     = BiosBlockIoDev->BlockIo.Media;
   BlockSize = Media->BlockSize;
 
   ZeroMem (&Regs, sizeof (IA32_REGISTER_SET));
 
-  if (MediaId != Media->MediaId) {
-    return EFI_MEDIA_CHANGED;
-  }
-
-  if (Lba > Media->LastBlock) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if ((Lba + (BufferSize / BlockSize) - 1) > Media->LastBlock) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (BufferSize % BlockSize != 0) {
-    return EFI_BAD_BUFFER_SIZE;
-  }
-
-  if (Buffer == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (BufferSize == 0) {
-    return EFI_SUCCESS;
-  }
-
-  BiosBlockIoDev = BIOS_BLOCK_IO_FROM_THIS (This);
-  AddressPacket  = mEddBufferUnder1Mb;
+  AddressPacket = mEddBufferUnder1Mb;
 
   MaxTransferBlocks = MAX_EDD11_XFER / BlockSize;
 
@@ -483,6 +450,7 @@ Edd30BiosReadBlocks (
     Regs.E.DS = EFI_SEGMENT (AddressPacket);
 
     CarryFlag = OcLegacyThunkBiosInt86 (BiosBlockIoDev->ThunkContext, BiosBlockIoDev->Legacy8259, 0x13, &Regs);
+    BiosBlockIoDev->Cache.Thunks++;
     DEBUG (
       (
        DEBUG_BLKIO, "Edd30BiosReadBlocks: INT 13 42 DL=%02x : CF=%d AH=%02x\n", BiosBlockIoDev->Bios.Number,
@@ -530,6 +498,71 @@ Edd30BiosReadBlocks (
   return EFI_SUCCESS;
 }
 
+/**
+  Read BufferSize bytes from Lba into Buffer.
+
+  @param  This       Indicates a pointer to the calling context.
+  @param  MediaId    Id of the media, changes every time the media is replaced.
+  @param  Lba        The starting Logical Block Address to read from
+  @param  BufferSize Size of Buffer, must be a multiple of device block size.
+  @param  Buffer     A pointer to the destination buffer for the data. The caller is
+                     responsible for either having implicit or explicit ownership of the buffer.
+
+  @retval EFI_SUCCESS           The data was read correctly from the device.
+  @retval EFI_DEVICE_ERROR      The device reported an error while performing the read.
+  @retval EFI_NO_MEDIA          There is no media in the device.
+  @retval EFI_MEDIA_CHANGED     The MediaId does not matched the current device.
+  @retval EFI_BAD_BUFFER_SIZE   The Buffer was not a multiple of the block size of the device.
+  @retval EFI_INVALID_PARAMETER The read request contains LBAs that are not valid,
+                                or the buffer is not on proper alignment.
+
+**/
+EFI_STATUS
+EFIAPI
+Edd30BiosReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  BIOS_BLOCK_IO_DEV   *BiosBlockIoDev;
+  UINTN               BlockSize;
+
+  Media     = This->Media;
+  BlockSize = Media->BlockSize;
+
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if (Lba > Media->LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Lba + (BufferSize / BlockSize) - 1) > Media->LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize % BlockSize != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  BiosBlockIoDev = BIOS_BLOCK_IO_FROM_THIS (This);
+
+  return BiosBlockIoCacheRead (BiosBlockIoDev, Lba, BufferSize, Buffer, Edd30BiosReadDevice);
+}
+
 /**
   Write BufferSize bytes from Lba into Buffer.
 
@@ -632,6 +665,7 @@ Edd30BiosWriteBlocks (
     Regs.E.DS = EFI_SEGMENT (AddressPacket);
 
     CarryFlag = OcLegacyThunkBiosInt86 (BiosBlockIoDev->ThunkContext, BiosBlockIoDev->Legacy8259, 0x13, &Regs);
+    BiosBlockIoDev->Cache.Thunks++;
     DEBUG (
       (
        DEBUG_BLKIO, "Edd30BiosWriteBlocks: INT 13 43 DL=%02x : CF=%d AH=%02x\n", BiosBlockIoDev->Bios.Number,
@@ -641,6 +675,7 @@ Edd30BiosWriteBlocks (
 
     Media->MediaPresent = TRUE;
     if (CarryFlag != 0) {
+      BiosBlockIoCacheInvalidate (BiosBlockIoDev);
       //
       // Return Error Status
       //
@@ -673,6 +708,8 @@ Edd30BiosWriteBlocks (
       return EFI_DEVICE_ERROR;
     }
 
+    BiosBlockIoCacheWrite (BiosBlockIoDev, Lba, NumberOfBlocks * BlockSize, (VOID *)(UINTN)TransferBuffer);
+
     Media->ReadOnly  = FALSE;
     TransferByteSize = NumberOfBlocks * BlockSize;
     BufferSize       = BufferSize - TransferByteSize;
@@ -726,6 +763,8 @@ BiosBlockIoReset (
 
   BiosBlockIoDev = BIOS_BLOCK_IO_FROM_THIS (This);
 
+  BiosBlockIoCacheInvalidate (BiosBlockIoDev);
+
   ZeroMem (&Regs, sizeof (IA32_REGISTER_SET));
 
   Regs.H.AH = 0x00;
@@ -766,36 +805,28 @@ BiosBlockIoReset (
 //
 
 /**
-  Read BufferSize bytes from Lba into Buffer.
+  Read blocks from the device bypassing the sector cache.
 
-  @param  This       Indicates a pointer to the calling context.
-  @param  MediaId    Id of the media, changes every time the media is replaced.
-  @param  Lba        The starting Logical Block Address to read from
-  @param  BufferSize Size of Buffer, must be a multiple of device block size.
-  @param  Buffer     A pointer to the destination buffer for the data. The caller is
-                     responsible for either having implicit or explicit ownership of the buffer.
+  @param  BiosBlockIoDev Instance of block I/O device.
+  @param  Lba            The starting Logical Block Address to read from.
+  @param  BufferSize     Size of Buffer, must be a multiple of device block size.
+  @param  Buffer         A pointer to the destination buffer for the data.
 
   @retval EFI_SUCCESS           The data was read correctly from the device.
   @retval EFI_DEVICE_ERROR      The device reported an error while performing the read.
-  @retval EFI_NO_MEDIA          There is no media in the device.
-  @retval EFI_MEDIA_CHANGED     The MediaId does not matched the current device.
-  @retval EFI_BAD_BUFFER_SIZE   The Buffer was not a multiple of the block size of the device.
-  @retval EFI_INVALID_PARAMETER The read request contains LBAs that are not valid,
-                                or the buffer is not on proper alignment.
+  @retval EFI_MEDIA_CHANGED     The media was changed.
 
 **/
+STATIC
 EFI_STATUS
-EFIAPI
-Edd11BiosReadBlocks (
-  IN  EFI_BLOCK_IO_PROTOCOL  *This,
-  IN  UINT32                 MediaId,
-  IN  EFI_LBA                Lba,
-  IN  UINTN                  BufferSize,
-  OUT VOID                   *Buffer
+Edd11BiosReadDevice (
+  IN  BIOS_BLOCK_IO_DEV  *BiosBlockIoDev,
+  IN  EFI_LBA            Lba,
+  IN  UINTN              BufferSize,
+  OUT VOID               *Buffer
   )
 {
   EFI_BLOCK_IO_MEDIA         *Media;
-  BIOS_BLOCK_IO_DEV          *BiosBlockIoDev;
   EDD_DEVICE_ADDRESS_PACKET  *AddressPacket;
   IA32_REGISTER_SET          Regs;
   UINT64                     TransferBuffer;
@@ -807,37 +838,12 @@ Edd11BiosReadBlocks (
   UINTN                      MaxTransferBlocks;
   EFI_BLOCK_IO_PROTOCOL      *BlockIo;
 
-  Media     = This->Media;
+  Media     = BiosBlockIoDev->BlockIo.Media;
   BlockSize = Media->BlockSize;
 
   ZeroMem (&Regs, sizeof (IA32_REGISTER_SET));
 
-  if (MediaId != Media->MediaId) {
-    return EFI_MEDIA_CHANGED;
-  }
-
-  if (Lba > Media->LastBlock) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if ((Lba + (BufferSize / BlockSize) - 1) > Media->LastBlock) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (BufferSize % BlockSize != 0) {
-    return EFI_BAD_BUFFER_SIZE;
-  }
-
-  if (Buffer == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (BufferSize == 0) {
-    return EFI_SUCCESS;
-  }
-
-  BiosBlockIoDev = BIOS_BLOCK_IO_FROM_THIS (This);
-  AddressPacket  = mEddBufferUnder1Mb;
+  AddressPacket = mEddBufferUnder1Mb;
 
   MaxTransferBlocks = MAX_EDD11_XFER / BlockSize;
 
@@ -868,6 +874,7 @@ Edd11BiosReadBlocks (
     Regs.E.DS = EFI_SEGMENT (AddressPacket);
 
     CarryFlag = OcLegacyThunkBiosInt86 (BiosBlockIoDev->ThunkContext, BiosBlockIoDev->Legacy8259, 0x13, &Regs);
+    BiosBlockIoDev->Cache.Thunks++;
     DEBUG (
       (
        DEBUG_BLKIO, "Edd11BiosReadBlocks: INT 13 42 DL=%02x : CF=%d AH=%02x : LBA 0x%lx  Block(s) %0d \n",
@@ -916,6 +923,71 @@ Edd11BiosReadBlocks (
   return EFI_SUCCESS;
 }
 
+/**
+  Read BufferSize bytes from Lba into Buffer.
+
+  @param  This       Indicates a pointer to the calling context.
+  @param  MediaId    Id of the media, changes every time the media is replaced.
+  @param  Lba        The starting Logical Block Address to read from
+  @param  BufferSize Size of Buffer, must be a multiple of device block size.
+  @param  Buffer     A pointer to the destination buffer for the data. The caller is
+                     responsible for either having implicit or explicit ownership of the buffer.
+
+  @retval EFI_SUCCESS           The data was read correctly from the device.
+  @retval EFI_DEVICE_ERROR      The device reported an error while performing the read.
+  @retval EFI_NO_MEDIA          There is no media in the device.
+  @retval EFI_MEDIA_CHANGED     The MediaId does not matched the current device.
+  @retval EFI_BAD_BUFFER_SIZE   The Buffer was not a multiple of the block size of the device.
+  @retval EFI_INVALID_PARAMETER The read request contains LBAs that are not valid,
+                                or the buffer is not on proper alignment.
+
+**/
+EFI_STATUS
+EFIAPI
+Edd11BiosReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  BIOS_BLOCK_IO_DEV   *BiosBlockIoDev;
+  UINTN               BlockSize;
+
+  Media     = This->Media;
+  BlockSize = Media->BlockSize;
+
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if (Lba > Media->LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Lba + (BufferSize / BlockSize) - 1) > Media->LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize % BlockSize != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  BiosBlockIoDev = BIOS_BLOCK_IO_FROM_THIS (This);
+
+  return BiosBlockIoCacheRead (BiosBlockIoDev, Lba, BufferSize, Buffer, Edd11BiosReadDevice);
+}
+
 /**
   Write BufferSize bytes from Lba into Buffer.
 
@@ -1026,6 +1098,7 @@ Edd11BiosWriteBlocks (
     CopyMem ((VOID *)(UINTN)TransferBuffer, Buffer, TransferByteSize);
 
     CarryFlag = OcLegacyThunkBiosInt86 (BiosBlockIoDev->ThunkContext, BiosBlockIoDev->Legacy8259, 0x13, &Regs);
+    BiosBlockIoDev->Cache.Thunks++;
     DEBUG (
       (
        DEBUG_BLKIO, "Edd11BiosWriteBlocks: INT 13 43 DL=%02x : CF=%d AH=%02x\n: LBA 0x%lx  Block(s) %0d \n",
@@ -1034,6 +1107,7 @@ Edd11BiosWriteBlocks (
       );
     Media->MediaPresent = TRUE;
     if (CarryFlag != 0) {
+      BiosBlockIoCacheInvalidate (BiosBlockIoDev);
       //
       // Return Error Status
       //
@@ -1066,6 +1140,8 @@ Edd11BiosWriteBlocks (
       return EFI_DEVICE_ERROR;
     }
 
+    BiosBlockIoCacheWrite (BiosBlockIoDev, Lba, TransferByteSize, Buffer);
+
     Media->ReadOnly = FALSE;
     BufferSize      = BufferSize - TransferByteSize;
     Buffer          = (VOID *)((UINT8 *)Buffer + TransferByteSize);
@@ -181,6 +181,49 @@ typedef struct {
   EDD_DRIVE_PARAMETERS    Parameters;
 } BIOS_LEGACY_DRIVE;
 
+//
+// Sector cache line size, must be a power of two.
+//
+#define BIOS_BLOCK_IO_CACHE_LINE_SIZE  SIZE_4KB
+
+//
+// Number of cache lines per device.
+//
+#define BIOS_BLOCK_IO_CACHE_LINES  256
+
+//
+// Maximum number of cache lines filled by a single device read.
+//
+#define BIOS_BLOCK_IO_CACHE_MAX_FILL  (MAX_EDD11_XFER / BIOS_BLOCK_IO_CACHE_LINE_SIZE)
+
+//
+// Reads of this size or larger bypass the cache.
+//
+#define BIOS_BLOCK_IO_CACHE_BYPASS_SIZE  (BIOS_BLOCK_IO_CACHE_LINE_SIZE * 8)
+
+typedef struct {
+  EFI_LBA    Lba;
+  UINT32     LastUsed;
+  BOOLEAN    Valid;
+} BIOS_BLOCK_IO_CACHE_LINE;
+
+typedef struct {
+  UINT8                       *Data;
+  UINT8                       *FillBuffer;
+  BIOS_BLOCK_IO_CACHE_LINE    Lines[BIOS_BLOCK_IO_CACHE_LINES];
+  BOOLEAN                     Initialized;
+  UINT32                      MediaId;
+  UINT32                      LineBlocks;
+  UINT32                      LineShift;
+  UINT32                      Tick;
+  UINT32                      ReadAhead;
+  EFI_LBA                     NextLba;
+  UINT64                      Hits;
+  UINT64                      Misses;
+  UINT64                      Thunks;
+  UINT64                      ReportedThunks;
+} BIOS_BLOCK_IO_CACHE;
+
 #define BIOS_CONSOLE_BLOCK_IO_DEV_SIGNATURE  SIGNATURE_32 ('b', 'b', 'i', 'o')
 typedef struct {
   UINTN                       Signature;
@@ -195,6 +238,7 @@ typedef struct {
   THUNK_CONTEXT               *ThunkContext;
 
   BIOS_LEGACY_DRIVE           Bios;
+  BIOS_BLOCK_IO_CACHE         Cache;
 } BIOS_BLOCK_IO_DEV;
 
 #define BIOS_BLOCK_IO_FROM_THIS(a)  CR (a, BIOS_BLOCK_IO_DEV, BlockIo, BIOS_CONSOLE_BLOCK_IO_DEV_SIGNATURE)
@@ -129,76 +129,115 @@ OcAppleChunklistVerifySignature (
   return Result;
 }
 
-BOOLEAN
-OcAppleChunklistVerifyData (
-  IN OUT OC_APPLE_CHUNKLIST_CONTEXT         *Context,
-  IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+VOID
+OcAppleChunklistVerifyDataInit (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
   )
 {
-  BOOLEAN  Result;
-
-  UINTN                        Index;
-  UINT8                        ChunkHash[SHA256_DIGEST_SIZE];
-  CONST APPLE_CHUNKLIST_CHUNK  *CurrentChunk;
-  UINTN                        CurrentOffset;
-
-  UINT32  ChunkDataSize;
-  VOID    *ChunkData;
-
   ASSERT (Context != NULL);
   ASSERT (Context->Chunks != NULL);
-  ASSERT (ExtentTable != NULL);
 
   DEBUG_CODE (
     ASSERT (Context->Signature == NULL);
     );
 
-  ChunkDataSize = 0;
-  for (Index = 0; Index < Context->ChunkCount; ++Index) {
-    CurrentChunk = &Context->Chunks[Index];
-    if (ChunkDataSize < CurrentChunk->Length) {
-      ChunkDataSize = CurrentChunk->Length;
+  Context->ChunkIndex  = 0;
+  Context->ChunkOffset = 0;
+  Sha256Init (&Context->ChunkHashContext);
+}
+
+BOOLEAN
+OcAppleChunklistVerifyDataUpdate (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context,
+  IN     CONST VOID                  *Data,
+  IN     UINTN                       Size
+  )
+{
+  CONST UINT8                  *DataBytes;
+  CONST APPLE_CHUNKLIST_CHUNK  *CurrentChunk;
+  UINT32                       LocalSize;
+  UINT8                        ChunkHash[SHA256_DIGEST_SIZE];
+
+  ASSERT (Context != NULL);
+  ASSERT ((Data != NULL) || (Size == 0));
+
+  DataBytes = Data;
+
+  while (Size > 0 && Context->ChunkIndex < Context->ChunkCount) {
+    CurrentChunk = &Context->Chunks[Context->ChunkIndex];
+    LocalSize    = (UINT32)MIN (Size, CurrentChunk->Length - Context->ChunkOffset);
+
+    Sha256Update (&Context->ChunkHashContext, DataBytes, LocalSize);
+
+    Context->ChunkOffset += LocalSize;
+    DataBytes            += LocalSize;
+    Size                 -= LocalSize;
+
+    if (Context->ChunkOffset == CurrentChunk->Length) {
+      //
+      // Calculate checksum of data and ensure they match.
+      //
+      DEBUG ((
+        DEBUG_VERBOSE,
+        "OCCL: Validating chunk %lu of %lu\n",
+        (UINT64)Context->ChunkIndex + 1,
+        (UINT64)Context->ChunkCount
+        ));
+      Sha256Final (&Context->ChunkHashContext, ChunkHash);
+      if (CompareMem (ChunkHash, CurrentChunk->Checksum, SHA256_DIGEST_SIZE) != 0) {
+        return FALSE;
+      }
+
+      ++Context->ChunkIndex;
+      Context->ChunkOffset = 0;
+      Sha256Init (&Context->ChunkHashContext);
     }
   }
 
-  ChunkData = AllocatePool (ChunkDataSize);
-  if (ChunkData == NULL) {
-    return FALSE;
-  }
+  return TRUE;
+}
 
-  CurrentOffset = 0;
-  for (Index = 0; Index < Context->ChunkCount; Index++) {
-    CurrentChunk = &Context->Chunks[Index];
+BOOLEAN
+OcAppleChunklistVerifyDataFinal (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT  *Context
+  )
+{
+  ASSERT (Context != NULL);
+
+  return Context->ChunkIndex == Context->ChunkCount;
+}
+
+BOOLEAN
+OcAppleChunklistVerifyData (
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT         *Context,
+  IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+  )
+{
+  BOOLEAN  Result;
+  UINT32   Index;
 
-    Result = OcAppleRamDiskRead (
-               ExtentTable,
-               CurrentOffset,
-               CurrentChunk->Length,
-               ChunkData
+  ASSERT (Context != NULL);
+  ASSERT (Context->Chunks != NULL);
+  ASSERT (ExtentTable != NULL);
+
+  OcAppleChunklistVerifyDataInit (Context);
+
+  //
+  // Hash extents in place instead of copying every chunk out of them.
+  //
+  for (Index = 0; Index < ExtentTable->ExtentCount; ++Index) {
+    ASSERT (ExtentTable->Extents[Index].Start <= MAX_UINTN);
+    ASSERT (ExtentTable->Extents[Index].Length <= MAX_UINTN);
+
+    Result = OcAppleChunklistVerifyDataUpdate (
+               Context,
+               (VOID *)(UINTN)ExtentTable->Extents[Index].Start,
+               (UINTN)ExtentTable->Extents[Index].Length
                );
     if (!Result) {
-      FreePool (ChunkData);
-      return FALSE;
-    }
-
-    //
-    // Calculate checksum of data and ensure they match.
-    //
-    DEBUG ((
-      DEBUG_VERBOSE,
-      "OCCL: Validating chunk %lu of %lu\n",
-      (UINT64)Index + 1,
-      (UINT64)Context->ChunkCount
-      ));
-    Sha256 (ChunkHash, ChunkData, CurrentChunk->Length);
-    if (CompareMem (ChunkHash, CurrentChunk->Checksum, SHA256_DIGEST_SIZE) != 0) {
-      FreePool (ChunkData);
       return FALSE;
     }
-
-    CurrentOffset += CurrentChunk->Length;
   }
 
-  FreePool (ChunkData);
-  return TRUE;
+  return OcAppleChunklistVerifyDataFinal (Context);
 }
@@ -193,10 +193,22 @@ OcAppleDiskImageInitializeContext (
   return TRUE;
 }
 
+STATIC
+BOOLEAN
+InternalVerifyChunklistData (
+  IN VOID        *Context,
+  IN CONST VOID  *Data,
+  IN UINTN       Size
+  )
+{
+  return OcAppleChunklistVerifyDataUpdate (Context, Data, Size);
+}
+
 BOOLEAN
 OcAppleDiskImageInitializeFromFile (
-  OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  EFI_FILE_PROTOCOL            *File
+  OUT    OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_FILE_PROTOCOL            *File,
+  IN OUT OC_APPLE_CHUNKLIST_CONTEXT   *ChunklistContext OPTIONAL
   )
 {
   EFI_STATUS  Status;
@@ -220,7 +232,22 @@ OcAppleDiskImageInitializeFromFile (
     return FALSE;
   }
 
-  Result = OcAppleRamDiskLoadFile (ExtentTable, File, FileSize);
+  if (ChunklistContext != NULL) {
+    OcAppleChunklistVerifyDataInit (ChunklistContext);
+    Result = OcAppleRamDiskLoadFile (
+               ExtentTable,
+               File,
+               FileSize,
+               InternalVerifyChunklistData,
+               ChunklistContext
+               );
+    if (Result) {
+      Result = OcAppleChunklistVerifyDataFinal (ChunklistContext);
+    }
+  } else {
+    Result = OcAppleRamDiskLoadFile (ExtentTable, File, FileSize, NULL, NULL);
+  }
+
   if (!Result) {
     DEBUG ((DEBUG_INFO, "OCDI: Failed to load DMG file\n"));
 
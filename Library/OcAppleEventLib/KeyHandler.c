@@ -18,6 +18,8 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <AppleMacEfi.h>
 
+#include <Guid/OcAppleKeyMapEvent.h>
+
 #include <IndustryStandard/AppleHid.h>
 
 #include <Protocol/AppleKeyMapAggregator.h>
@@ -51,6 +53,9 @@ STATIC BOOLEAN  mCLockOn = FALSE;
 // mKeyStrokePollEvent
 STATIC EFI_EVENT  mKeyStrokePollEvent = NULL;
 
+// mKeyMapChangedEvent
+STATIC EFI_EVENT  mKeyMapChangedEvent = NULL;
+
 // mModifiers
 STATIC APPLE_MODIFIER_MAP  mModifiers = 0;
 
@@ -719,6 +724,30 @@ InternalKeyStrokePollNotifyFunction (
   }
 }
 
+// InternalKeyMapChangedNotifyFunction
+STATIC
+VOID
+EFIAPI
+InternalKeyMapChangedNotifyFunction (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DEBUG ((DEBUG_VERBOSE, "InternalKeyMapChangedNotifyFunction\n"));
+
+  if (mKeyStrokePollEvent == NULL) {
+    return;
+  }
+
+  InternalKeyStrokePollNotifyFunction (Event, Context);
+
+  //
+  // Key repeat is counted in poll ticks, restart the period so that
+  // this extra poll does not shorten the next repeat interval.
+  //
+  gBS->SetTimer (mKeyStrokePollEvent, TimerPeriodic, KEY_STROKE_POLL_FREQUENCY);
+}
+
 // InternalInitializeKeyHandler
 STATIC
 VOID
@@ -768,6 +797,29 @@ EventCreateKeyStrokePollEvent (
     Status = ((mKeyStrokePollEvent == NULL)
                ? EFI_OUT_OF_RESOURCES
                : EFI_SUCCESS);
+
+    //
+    // Key map database signals key changes where supported, so that
+    // they are handled immediately rather than on the next poll tick.
+    // Polling remains for other key map producers and for key repeat.
+    //
+    if (  !EFI_ERROR (Status)
+       && (gBS->Hdr.HeaderSize > OFFSET_OF (EFI_BOOT_SERVICES, CreateEventEx)))
+    {
+      Status = gBS->CreateEventEx (
+                      EVT_NOTIFY_SIGNAL,
+                      TPL_CALLBACK,
+                      InternalKeyMapChangedNotifyFunction,
+                      NULL,
+                      &gOcAppleKeyMapChangedEventGroupGuid,
+                      &mKeyMapChangedEvent
+                      );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_INFO, "OCAE: Failed to create key map change event - %r\n", Status));
+        mKeyMapChangedEvent = NULL;
+        Status              = EFI_SUCCESS;
+      }
+    }
   }
 
   return Status;
@@ -781,6 +833,11 @@ EventCancelKeyStrokePollEvent (
 {
   DEBUG ((DEBUG_VERBOSE, "EventCancelKeyStrokePollEvent\n"));
 
+  if (mKeyMapChangedEvent != NULL) {
+    gBS->CloseEvent (mKeyMapChangedEvent);
+    mKeyMapChangedEvent = NULL;
+  }
+
   EventLibCancelEvent (mKeyStrokePollEvent);
 
   mKeyStrokePollEvent = NULL;
@@ -70,6 +70,16 @@ STATIC BOOLEAN  mHasDigestOverride;
 STATIC UINT8    mOriginalDigest[SHA384_DIGEST_SIZE];
 STATIC UINT8    mOverrideDigest[SHA384_DIGEST_SIZE];
 
+///
+/// Digests of signatures which passed RSA verification. The same apticket
+/// is used for every object of a boot (kernelcache, immutable kexts, root
+/// hash), so the certificate chain and manifest body signatures repeat.
+///
+#define OC_IMG4_VERIFIED_CACHE_SIZE  8
+
+STATIC UINT8  mVerifiedSignatures[OC_IMG4_VERIFIED_CACHE_SIZE][SHA384_DIGEST_SIZE];
+STATIC UINTN  mVerifiedSignatureCount;
+
 STATIC
 OC_SB_MODEL_DESC *
 InternalGetModelInfo (
@@ -108,6 +118,40 @@ InternalGetModelInfo (
   return NULL;
 }
 
+STATIC
+VOID
+InternalGetSignatureKey (
+  OUT UINT8             *Key,
+  IN  CONST UINT8       *Modulus,
+  IN  UINTN             ModulusSize,
+  IN  UINT32            Exponent,
+  IN  CONST UINT8       *Signature,
+  IN  UINTN             SignatureSize,
+  IN  CONST UINT8       *Data,
+  IN  UINTN             DataSize,
+  IN  OC_SIG_HASH_TYPE  AlgoType
+  )
+{
+  SHA384_CONTEXT  Context;
+  UINT64          Sizes[3];
+
+  //
+  // Include the sizes so that the concatenation is unambiguous.
+  //
+  Sizes[0] = ModulusSize;
+  Sizes[1] = SignatureSize;
+  Sizes[2] = DataSize;
+
+  Sha384Init (&Context);
+  Sha384Update (&Context, (CONST UINT8 *)Sizes, sizeof (Sizes));
+  Sha384Update (&Context, (CONST UINT8 *)&Exponent, sizeof (Exponent));
+  Sha384Update (&Context, (CONST UINT8 *)&AlgoType, sizeof (AlgoType));
+  Sha384Update (&Context, Modulus, ModulusSize);
+  Sha384Update (&Context, Signature, SignatureSize);
+  Sha384Update (&Context, Data, DataSize);
+  Sha384Final (&Context, Key);
+}
+
 bool
 DERImg4VerifySignature (
   DERByte        *Modulus,
@@ -121,6 +165,9 @@ DERImg4VerifySignature (
   )
 {
   OC_SIG_HASH_TYPE  AlgoType;
+  UINT8             Key[SHA384_DIGEST_SIZE];
+  UINTN             Index;
+  BOOLEAN           Result;
 
   ASSERT (Modulus != NULL);
   ASSERT (ModulusSize > 0);
@@ -140,16 +187,48 @@ DERImg4VerifySignature (
     return false;
   }
 
-  return RsaVerifySigDataFromData (
-           Modulus,
-           ModulusSize,
-           Exponent,
-           Signature,
-           SignatureSize,
-           Data,
-           DataSize,
-           AlgoType
-           );
+  //
+  // Every input to the verification is covered by the key, thus a match
+  // yields the same result as repeating the RSA operation.
+  //
+  InternalGetSignatureKey (
+    Key,
+    Modulus,
+    ModulusSize,
+    Exponent,
+    Signature,
+    SignatureSize,
+    Data,
+    DataSize,
+    AlgoType
+    );
+
+  for (Index = 0; Index < MIN (mVerifiedSignatureCount, OC_IMG4_VERIFIED_CACHE_SIZE); ++Index) {
+    if (CompareMem (mVerifiedSignatures[Index], Key, sizeof (Key)) == 0) {
+      return true;
+    }
+  }
+
+  Result = RsaVerifySigDataFromData (
+             Modulus,
+             ModulusSize,
+             Exponent,
+             Signature,
+             SignatureSize,
+             Data,
+             DataSize,
+             AlgoType
+             );
+  if (Result) {
+    CopyMem (
+      mVerifiedSignatures[mVerifiedSignatureCount % OC_IMG4_VERIFIED_CACHE_SIZE],
+      Key,
+      sizeof (Key)
+      );
+    ++mVerifiedSignatureCount;
+  }
+
+  return Result;
 }
 
 CONST CHAR8 *
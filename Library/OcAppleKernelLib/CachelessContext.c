@@ -32,13 +32,36 @@
 
 STATIC
 VOID
-FreeBuiltInKext (
-  IN BUILTIN_KEXT  *BuiltinKext
+FreeKextDependencies (
+  IN OUT LIST_ENTRY  *Dependencies
   )
 {
   DEPEND_KEXT  *DependKext;
   LIST_ENTRY   *KextLink;
 
+  while (!IsListEmpty (Dependencies)) {
+    KextLink   = GetFirstNode (Dependencies);
+    DependKext = GET_DEPEND_KEXT_FROM_LINK (KextLink);
+    RemoveEntryList (KextLink);
+
+    if (DependKext->Identifier != NULL) {
+      FreePool (DependKext->Identifier);
+    }
+
+    FreePool (DependKext);
+  }
+}
+
+STATIC
+VOID
+FreeBuiltInKext (
+  IN BUILTIN_KEXT  *BuiltinKext
+  )
+{
+  if (BuiltinKext->RelativePath != NULL) {
+    FreePool (BuiltinKext->RelativePath);
+  }
+
   if (BuiltinKext->PlistPath != NULL) {
     FreePool (BuiltinKext->PlistPath);
   }
@@ -55,26 +78,16 @@ FreeBuiltInKext (
     FreePool (BuiltinKext->BinaryPath);
   }
 
-  while (!IsListEmpty (&BuiltinKext->Dependencies)) {
-    KextLink   = GetFirstNode (&BuiltinKext->Dependencies);
-    DependKext = GET_DEPEND_KEXT_FROM_LINK (KextLink);
-    RemoveEntryList (KextLink);
-
-    if (DependKext->Identifier != NULL) {
-      FreePool (DependKext->Identifier);
-    }
-
-    FreePool (DependKext);
-  }
+  FreeKextDependencies (&BuiltinKext->Dependencies);
 
   FreePool (BuiltinKext);
 }
 
 STATIC
-EFI_STATUS
-AddKextDependency (
-  IN OUT LIST_ENTRY   *Dependencies,
-  IN     CONST CHAR8  *Identifier
+BOOLEAN
+IsKextDependencyPresent (
+  IN LIST_ENTRY   *Dependencies,
+  IN CONST CHAR8  *Identifier
   )
 {
   DEPEND_KEXT  *DependKext;
@@ -85,12 +98,28 @@ AddKextDependency (
     DependKext = GET_DEPEND_KEXT_FROM_LINK (KextLink);
 
     if (AsciiStrCmp (DependKext->Identifier, Identifier) == 0) {
-      return EFI_SUCCESS;
+      return TRUE;
     }
 
     KextLink = GetNextNode (Dependencies, KextLink);
   }
 
+  return FALSE;
+}
+
+STATIC
+EFI_STATUS
+AddKextDependency (
+  IN OUT LIST_ENTRY   *Dependencies,
+  IN     CONST CHAR8  *Identifier
+  )
+{
+  DEPEND_KEXT  *DependKext;
+
+  if (IsKextDependencyPresent (Dependencies, Identifier)) {
+    return EFI_SUCCESS;
+  }
+
   DependKext = AllocateZeroPool (sizeof (*DependKext));
   if (DependKext == NULL) {
     return EFI_OUT_OF_RESOURCES;
@@ -135,38 +164,40 @@ AddKextDependencies (
   return EFI_SUCCESS;
 }
 
+/**
+  Enumerate kext bundles in an Extensions or PlugIns directory.
+  Only bundle names are recorded, Info.plist files are parsed on demand
+  by ParseBuiltinKext while resolving dependencies.
+
+  @param[in,out] Context       Cacheless context.
+  @param[in]     File          Directory to enumerate.
+  @param[in]     RelativePath  Directory path relative to Extensions directory,
+                               NULL for Extensions directory itself.
+  @param[in]     ReadPlugins   Enumerate PlugIns directories of found kexts.
+
+  @retval EFI_SUCCESS on success.
+**/
 STATIC
 EFI_STATUS
 ScanExtensions (
   IN OUT CACHELESS_CONTEXT  *Context,
   IN     EFI_FILE_PROTOCOL  *File,
-  IN     CONST CHAR16       *FilePath,
+  IN     CONST CHAR16       *RelativePath  OPTIONAL,
   IN     BOOLEAN            ReadPlugins
   )
 {
   EFI_STATUS         Status;
   EFI_FILE_PROTOCOL  *FileKext;
-  EFI_FILE_PROTOCOL  *FilePlist;
+  EFI_FILE_PROTOCOL  *FileContents;
   EFI_FILE_PROTOCOL  *FilePlugins;
   EFI_FILE_INFO      *FileInfo;
   UINTN              FileInfoSize;
   BOOLEAN            UseContents;
 
-  CHAR8         *InfoPlist;
-  UINT32        InfoPlistSize;
-  XML_DOCUMENT  *InfoPlistDocument;
-  XML_NODE      *InfoPlistRoot;
-  XML_NODE      *InfoPlistValue;
-  XML_NODE      *InfoPlistLibraries;
-  XML_NODE      *InfoPlistLibraries64;
-  CONST CHAR8   *TmpKeyValue;
-  UINT32        FieldCount;
-  UINT32        FieldIndex;
-
   BUILTIN_KEXT  *BuiltinKext;
   CHAR16        TmpPath[256];
 
-  DEBUG ((DEBUG_INFO, "OCAK: Scanning %s...\n", FilePath));
+  DEBUG ((DEBUG_INFO, "OCAK: Scanning %s%a%s...\n", Context->ExtensionsDirFileName, RelativePath != NULL ? "\\" : "", RelativePath != NULL ? RelativePath : L""));
 
   FileInfo = AllocatePool (SIZE_1KB);
   if (FileInfo == NULL) {
@@ -184,7 +215,6 @@ ScanExtensions (
     FileInfoSize = SIZE_1KB - sizeof (CHAR16);
     Status       = File->Read (File, &FileInfoSize, FileInfo);
     if (EFI_ERROR (Status)) {
-      FileKext->Close (FileKext);
       File->SetPosition (File, 0);
       FreePool (FileInfo);
       return Status;
@@ -201,235 +231,54 @@ ScanExtensions (
         // Determine if Contents directory exists.
         // If not, we'll use the root of the kext.
         //
-        Status      = FileKext->Open (FileKext, &FilePlist, L"Contents", EFI_FILE_MODE_READ, EFI_FILE_DIRECTORY);
-        UseContents = !EFI_ERROR (Status);
-
-        //
-        // There are some kexts that do not have an Info.plist, but do have PlugIns.
-        // This was observed in some versions of 10.4.
-        //
-        Status = FileKext->Open (
-                             FileKext,
-                             &FilePlist,
-                             UseContents ? L"Contents\\Info.plist" : L"Info.plist",
-                             EFI_FILE_MODE_READ,
-                             0
-                             );
+        Status = FileKext->Open (FileKext, &FileContents, L"Contents", EFI_FILE_MODE_READ, EFI_FILE_DIRECTORY);
         if (!EFI_ERROR (Status)) {
-          //
-          // Parse Info.plist.
-          //
-          Status = OcAllocateCopyFileData (FilePlist, (UINT8 **)&InfoPlist, &InfoPlistSize);
-          FilePlist->Close (FilePlist);
-          if (EFI_ERROR (Status)) {
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return Status;
-          }
-
-          InfoPlistDocument = XmlDocumentParse (InfoPlist, InfoPlistSize, FALSE);
-          if (InfoPlistDocument == NULL) {
-            FreePool (InfoPlist);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_INVALID_PARAMETER;
-          }
-
-          InfoPlistRoot = PlistNodeCast (PlistDocumentRoot (InfoPlistDocument), PLIST_NODE_TYPE_DICT);
-          if (InfoPlistRoot == NULL) {
-            XmlDocumentFree (InfoPlistDocument);
-            FreePool (InfoPlist);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_INVALID_PARAMETER;
-          }
-
-          //
-          // Add to built-in kexts list.
-          //
-          BuiltinKext = AllocateZeroPool (sizeof (*BuiltinKext));
-          if (BuiltinKext == NULL) {
-            XmlDocumentFree (InfoPlistDocument);
-            FreePool (InfoPlist);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_OUT_OF_RESOURCES;
-          }
-
-          BuiltinKext->Signature = BUILTIN_KEXT_SIGNATURE;
-          InitializeListHead (&BuiltinKext->Dependencies);
-
-          //
-          // Search for plist properties.
-          //
-          InfoPlistLibraries = NULL;
-          FieldCount         = PlistDictChildren (InfoPlistRoot);
-          for (FieldIndex = 0; FieldIndex < FieldCount; ++FieldIndex) {
-            TmpKeyValue = PlistKeyValue (PlistDictChild (InfoPlistRoot, FieldIndex, &InfoPlistValue));
-            if (TmpKeyValue == NULL) {
-              continue;
-            }
-
-            if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_EXECUTABLE_KEY) == 0) {
-              BuiltinKext->BinaryFileName = AsciiStrCopyToUnicode (XmlNodeContent (InfoPlistValue), 0);
-              if (BuiltinKext->BinaryFileName == NULL) {
-                FreeBuiltInKext (BuiltinKext);
-                XmlDocumentFree (InfoPlistDocument);
-                FreePool (InfoPlist);
-                FileKext->Close (FileKext);
-                File->SetPosition (File, 0);
-                FreePool (FileInfo);
-                return EFI_OUT_OF_RESOURCES;
-              }
-            } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
-              BuiltinKext->Identifier = AllocateCopyPool (AsciiStrSize (XmlNodeContent (InfoPlistValue)), XmlNodeContent (InfoPlistValue));
-              if (BuiltinKext->Identifier == NULL) {
-                FreeBuiltInKext (BuiltinKext);
-                XmlDocumentFree (InfoPlistDocument);
-                FreePool (InfoPlist);
-                FileKext->Close (FileKext);
-                File->SetPosition (File, 0);
-                FreePool (FileInfo);
-                return EFI_OUT_OF_RESOURCES;
-              }
-            } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_OS_BUNDLE_REQUIRED_KEY) == 0) {
-              //
-              // If OSBundleRequired is present and is not Safe Boot, no action is required.
-              //
-              if (AsciiStrCmp (XmlNodeContent (InfoPlistValue), OS_BUNDLE_REQUIRED_SAFE_BOOT) != 0) {
-                BuiltinKext->OSBundleRequiredValue = KEXT_OSBUNDLE_REQUIRED_VALID;
-              } else {
-                BuiltinKext->OSBundleRequiredValue = KEXT_OSBUNDLE_REQUIRED_INVALID;
-              }
-            } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_LIBRARIES_KEY) == 0) {
-              if (!Context->Is32Bit && (InfoPlistLibraries64 == NULL)) {
-                InfoPlistLibraries = PlistNodeCast (InfoPlistValue, PLIST_NODE_TYPE_DICT);
-                if (InfoPlistLibraries == NULL) {
-                  FreeBuiltInKext (BuiltinKext);
-                  XmlDocumentFree (InfoPlistDocument);
-                  FreePool (InfoPlist);
-                  FileKext->Close (FileKext);
-                  File->SetPosition (File, 0);
-                  FreePool (FileInfo);
-                  return EFI_INVALID_PARAMETER;
-                }
-              }
-            } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_LIBRARIES_64_KEY) == 0) {
-              InfoPlistLibraries64 = PlistNodeCast (InfoPlistValue, PLIST_NODE_TYPE_DICT);
-              if (InfoPlistLibraries64 == NULL) {
-                FreeBuiltInKext (BuiltinKext);
-                XmlDocumentFree (InfoPlistDocument);
-                FreePool (InfoPlist);
-                FileKext->Close (FileKext);
-                File->SetPosition (File, 0);
-                FreePool (FileInfo);
-                return EFI_INVALID_PARAMETER;
-              }
-
-              if (!Context->Is32Bit) {
-                InfoPlistLibraries = InfoPlistLibraries64;
-              }
-            }
-          }
-
-          if (InfoPlistLibraries != NULL) {
-            Status = AddKextDependencies (&BuiltinKext->Dependencies, InfoPlistLibraries);
-            if (EFI_ERROR (Status)) {
-              FreeBuiltInKext (BuiltinKext);
-              XmlDocumentFree (InfoPlistDocument);
-              FreePool (InfoPlist);
-              FileKext->Close (FileKext);
-              File->SetPosition (File, 0);
-              FreePool (FileInfo);
-              return Status;
-            }
-          }
-
-          XmlDocumentFree (InfoPlistDocument);
-          FreePool (InfoPlist);
-
-          if (BuiltinKext->Identifier == NULL) {
-            FreeBuiltInKext (BuiltinKext);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_INVALID_PARAMETER;
-          }
-
-          //
-          // Create plist path.
-          //
-          Status = OcUnicodeSafeSPrint (
-                     TmpPath,
-                     sizeof (TmpPath),
-                     L"%s\\%s\\%s",
-                     FilePath,
-                     FileInfo->FileName,
-                     UseContents ? L"Contents\\Info.plist" : L"Info.plist"
-                     );
-          if (EFI_ERROR (Status)) {
-            FreeBuiltInKext (BuiltinKext);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_INVALID_PARAMETER;
-          }
+          FileContents->Close (FileContents);
+          UseContents = TRUE;
+        } else {
+          UseContents = FALSE;
+        }
 
-          BuiltinKext->PlistPath = AllocateCopyPool (StrSize (TmpPath), TmpPath);
-          if (BuiltinKext->PlistPath == NULL) {
-            FreeBuiltInKext (BuiltinKext);
-            FileKext->Close (FileKext);
-            File->SetPosition (File, 0);
-            FreePool (FileInfo);
-            return EFI_OUT_OF_RESOURCES;
-          }
+        if (RelativePath != NULL) {
+          Status = OcUnicodeSafeSPrint (TmpPath, sizeof (TmpPath), L"%s\\%s", RelativePath, FileInfo->FileName);
+        } else {
+          Status = OcUnicodeSafeSPrint (TmpPath, sizeof (TmpPath), L"%s", FileInfo->FileName);
+        }
 
-          //
-          // Create binary path. If plist is in root of kext, binary is also there.
-          //
-          if (BuiltinKext->BinaryFileName != NULL) {
-            Status = OcUnicodeSafeSPrint (
-                       TmpPath,
-                       sizeof (TmpPath),
-                       L"%s\\%s\\%s%s",
-                       FilePath,
-                       FileInfo->FileName,
-                       UseContents ? L"Contents\\MacOS\\" : L"",
-                       BuiltinKext->BinaryFileName
-                       );
-            if (EFI_ERROR (Status)) {
-              FreeBuiltInKext (BuiltinKext);
-              FileKext->Close (FileKext);
-              File->SetPosition (File, 0);
-              FreePool (FileInfo);
-              return EFI_INVALID_PARAMETER;
-            }
+        if (EFI_ERROR (Status)) {
+          FileKext->Close (FileKext);
+          File->SetPosition (File, 0);
+          FreePool (FileInfo);
+          return EFI_INVALID_PARAMETER;
+        }
 
-            BuiltinKext->BinaryPath = AllocateCopyPool (StrSize (TmpPath), TmpPath);
-            if (BuiltinKext->BinaryPath == NULL) {
-              FreeBuiltInKext (BuiltinKext);
-              FileKext->Close (FileKext);
-              File->SetPosition (File, 0);
-              FreePool (FileInfo);
-              return EFI_OUT_OF_RESOURCES;
-            }
-          }
+        //
+        // Add to built-in kexts list. Kexts without Info.plist are kept
+        // as well, they are skipped once found to have no identifier.
+        // This was observed in some versions of 10.4.
+        //
+        BuiltinKext = AllocateZeroPool (sizeof (*BuiltinKext));
+        if (BuiltinKext == NULL) {
+          FileKext->Close (FileKext);
+          File->SetPosition (File, 0);
+          FreePool (FileInfo);
+          return EFI_OUT_OF_RESOURCES;
+        }
 
-          InsertTailList (&Context->BuiltInKexts, &BuiltinKext->Link);
-          DEBUG ((
-            DEBUG_VERBOSE,
-            "OCAK: Discovered bundle %a %s %s %u\n",
-            BuiltinKext->Identifier,
-            BuiltinKext->PlistPath,
-            BuiltinKext->BinaryPath,
-            BuiltinKext->OSBundleRequiredValue
-            ));
+        BuiltinKext->Signature = BUILTIN_KEXT_SIGNATURE;
+        InitializeListHead (&BuiltinKext->Dependencies);
+        BuiltinKext->UseContents  = UseContents;
+        BuiltinKext->RelativePath = AllocateCopyPool (StrSize (TmpPath), TmpPath);
+        if (BuiltinKext->RelativePath == NULL) {
+          FreeBuiltInKext (BuiltinKext);
+          FileKext->Close (FileKext);
+          File->SetPosition (File, 0);
+          FreePool (FileInfo);
+          return EFI_OUT_OF_RESOURCES;
         }
 
+        InsertTailList (&Context->BuiltInKexts, &BuiltinKext->Link);
+
         //
         // Scan PlugIns directory.
         //
@@ -439,13 +288,14 @@ ScanExtensions (
             Status = OcUnicodeSafeSPrint (
                        TmpPath,
                        sizeof (TmpPath),
-                       L"%s\\%s\\%s",
-                       FilePath,
-                       FileInfo->FileName,
+                       L"%s\\%s",
+                       BuiltinKext->RelativePath,
                        UseContents ? L"Contents\\PlugIns" : L"PlugIns"
                        );
+            if (!EFI_ERROR (Status)) {
+              Status = ScanExtensions (Context, FilePlugins, TmpPath, FALSE);
+            }
 
-            Status = ScanExtensions (Context, FilePlugins, TmpPath, FALSE);
             FilePlugins->Close (FilePlugins);
             if (EFI_ERROR (Status)) {
               FileKext->Close (FileKext);
@@ -472,6 +322,277 @@ ScanExtensions (
   return EFI_SUCCESS;
 }
 
+/**
+  Read Info.plist of enumerated built-in kext.
+
+  @param[in,out] Context      Cacheless context.
+  @param[in,out] BuiltinKext  Built-in kext not yet parsed.
+
+  @retval EFI_SUCCESS on success.
+**/
+STATIC
+EFI_STATUS
+ParseBuiltinKext (
+  IN OUT CACHELESS_CONTEXT  *Context,
+  IN OUT BUILTIN_KEXT       *BuiltinKext
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *FilePlist;
+
+  CHAR8         *InfoPlist;
+  UINT32        InfoPlistSize;
+  XML_DOCUMENT  *InfoPlistDocument;
+  XML_NODE      *InfoPlistRoot;
+  XML_NODE      *InfoPlistValue;
+  XML_NODE      *InfoPlistLibraries;
+  XML_NODE      *InfoPlistLibraries64;
+  CONST CHAR8   *TmpKeyValue;
+  CONST CHAR8   *Identifier;
+  UINT32        FieldCount;
+  UINT32        FieldIndex;
+
+  CHAR16  TmpPath[256];
+
+  ASSERT (!BuiltinKext->Parsed);
+
+  BuiltinKext->Parsed = TRUE;
+
+  Status = OcUnicodeSafeSPrint (
+             TmpPath,
+             sizeof (TmpPath),
+             L"%s\\%s",
+             BuiltinKext->RelativePath,
+             BuiltinKext->UseContents ? L"Contents\\Info.plist" : L"Info.plist"
+             );
+  if (EFI_ERROR (Status)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = Context->ExtensionsDir->Open (Context->ExtensionsDir, &FilePlist, TmpPath, EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Parse Info.plist.
+  //
+  Status = OcAllocateCopyFileData (FilePlist, (UINT8 **)&InfoPlist, &InfoPlistSize);
+  FilePlist->Close (FilePlist);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  InfoPlistDocument = XmlDocumentParse (InfoPlist, InfoPlistSize, FALSE);
+  if (InfoPlistDocument == NULL) {
+    FreePool (InfoPlist);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  InfoPlistRoot = PlistNodeCast (PlistDocumentRoot (InfoPlistDocument), PLIST_NODE_TYPE_DICT);
+  if (InfoPlistRoot == NULL) {
+    XmlDocumentFree (InfoPlistDocument);
+    FreePool (InfoPlist);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Search for plist properties.
+  //
+  Identifier           = NULL;
+  InfoPlistLibraries   = NULL;
+  InfoPlistLibraries64 = NULL;
+  FieldCount           = PlistDictChildren (InfoPlistRoot);
+  for (FieldIndex = 0; FieldIndex < FieldCount; ++FieldIndex) {
+    TmpKeyValue = PlistKeyValue (PlistDictChild (InfoPlistRoot, FieldIndex, &InfoPlistValue));
+    if (TmpKeyValue == NULL) {
+      continue;
+    }
+
+    if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_EXECUTABLE_KEY) == 0) {
+      if (BuiltinKext->BinaryFileName == NULL) {
+        BuiltinKext->BinaryFileName = AsciiStrCopyToUnicode (XmlNodeContent (InfoPlistValue), 0);
+        if (BuiltinKext->BinaryFileName == NULL) {
+          XmlDocumentFree (InfoPlistDocument);
+          FreePool (InfoPlist);
+          return EFI_OUT_OF_RESOURCES;
+        }
+      }
+    } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
+      Identifier = XmlNodeContent (InfoPlistValue);
+    } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_OS_BUNDLE_REQUIRED_KEY) == 0) {
+      //
+      // If OSBundleRequired is present and is not Safe Boot, no action is required.
+      //
+      if (AsciiStrCmp (XmlNodeContent (InfoPlistValue), OS_BUNDLE_REQUIRED_SAFE_BOOT) != 0) {
+        BuiltinKext->OSBundleRequiredValue = KEXT_OSBUNDLE_REQUIRED_VALID;
+      } else {
+        BuiltinKext->OSBundleRequiredValue = KEXT_OSBUNDLE_REQUIRED_INVALID;
+      }
+    } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_LIBRARIES_KEY) == 0) {
+      if (!Context->Is32Bit && (InfoPlistLibraries64 == NULL)) {
+        InfoPlistLibraries = PlistNodeCast (InfoPlistValue, PLIST_NODE_TYPE_DICT);
+        if (InfoPlistLibraries == NULL) {
+          XmlDocumentFree (InfoPlistDocument);
+          FreePool (InfoPlist);
+          return EFI_INVALID_PARAMETER;
+        }
+      }
+    } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_LIBRARIES_64_KEY) == 0) {
+      InfoPlistLibraries64 = PlistNodeCast (InfoPlistValue, PLIST_NODE_TYPE_DICT);
+      if (InfoPlistLibraries64 == NULL) {
+        XmlDocumentFree (InfoPlistDocument);
+        FreePool (InfoPlist);
+        return EFI_INVALID_PARAMETER;
+      }
+
+      if (!Context->Is32Bit) {
+        InfoPlistLibraries = InfoPlistLibraries64;
+      }
+    }
+  }
+
+  if ((Identifier == NULL) || (*Identifier == '\0')) {
+    XmlDocumentFree (InfoPlistDocument);
+    FreePool (InfoPlist);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (InfoPlistLibraries != NULL) {
+    Status = AddKextDependencies (&BuiltinKext->Dependencies, InfoPlistLibraries);
+    if (EFI_ERROR (Status)) {
+      XmlDocumentFree (InfoPlistDocument);
+      FreePool (InfoPlist);
+      return Status;
+    }
+  }
+
+  //
+  // Create plist path.
+  //
+  Status = OcUnicodeSafeSPrint (
+             TmpPath,
+             sizeof (TmpPath),
+             L"%s\\%s\\%s",
+             Context->ExtensionsDirFileName,
+             BuiltinKext->RelativePath,
+             BuiltinKext->UseContents ? L"Contents\\Info.plist" : L"Info.plist"
+             );
+  if (EFI_ERROR (Status)) {
+    XmlDocumentFree (InfoPlistDocument);
+    FreePool (InfoPlist);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  BuiltinKext->PlistPath = AllocateCopyPool (StrSize (TmpPath), TmpPath);
+  if (BuiltinKext->PlistPath == NULL) {
+    XmlDocumentFree (InfoPlistDocument);
+    FreePool (InfoPlist);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Create binary path. If plist is in root of kext, binary is also there.
+  //
+  if (BuiltinKext->BinaryFileName != NULL) {
+    Status = OcUnicodeSafeSPrint (
+               TmpPath,
+               sizeof (TmpPath),
+               L"%s\\%s\\%s%s",
+               Context->ExtensionsDirFileName,
+               BuiltinKext->RelativePath,
+               BuiltinKext->UseContents ? L"Contents\\MacOS\\" : L"",
+               BuiltinKext->BinaryFileName
+               );
+    if (EFI_ERROR (Status)) {
+      XmlDocumentFree (InfoPlistDocument);
+      FreePool (InfoPlist);
+      return EFI_INVALID_PARAMETER;
+    }
+
+    BuiltinKext->BinaryPath = AllocateCopyPool (StrSize (TmpPath), TmpPath);
+    if (BuiltinKext->BinaryPath == NULL) {
+      XmlDocumentFree (InfoPlistDocument);
+      FreePool (InfoPlist);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  //
+  // Identifier is set last, as the kext may only be looked up once complete.
+  //
+  BuiltinKext->Identifier = AllocateCopyPool (AsciiStrSize (Identifier), Identifier);
+  XmlDocumentFree (InfoPlistDocument);
+  FreePool (InfoPlist);
+  if (BuiltinKext->Identifier == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "OCAK: Discovered bundle %a %s %s %u\n",
+    BuiltinKext->Identifier,
+    BuiltinKext->PlistPath,
+    BuiltinKext->BinaryPath,
+    BuiltinKext->OSBundleRequiredValue
+    ));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether built-in kext bundle name suggests it provides the identifier.
+  This holds for the vast majority of kexts, e.g. IOACPIFamily.kext provides
+  com.apple.iokit.IOACPIFamily. Kernel interface pseudo-kexts do not follow
+  the pattern and are located in System.kext PlugIns.
+
+  @param[in] BuiltinKext  Built-in kext.
+  @param[in] Identifier   Bundle identifier.
+
+  @retval TRUE when the kext is likely to provide the identifier.
+**/
+STATIC
+BOOLEAN
+IsBuiltinKextCandidate (
+  IN BUILTIN_KEXT  *BuiltinKext,
+  IN CONST CHAR8   *Identifier
+  )
+{
+  CONST CHAR16  *BundleName;
+  CONST CHAR8   *Walker;
+  UINTN         Index;
+
+  if (  OcAsciiStartsWith (Identifier, "com.apple.kpi.", FALSE)
+     || OcAsciiStartsWith (Identifier, "com.apple.kernel", FALSE))
+  {
+    return OcUnicodeStartsWith (BuiltinKext->RelativePath, L"System.kext\\", TRUE);
+  }
+
+  BundleName = BuiltinKext->RelativePath;
+  for (Index = 0; BuiltinKext->RelativePath[Index] != L'\0'; ++Index) {
+    if (BuiltinKext->RelativePath[Index] == L'\\') {
+      BundleName = &BuiltinKext->RelativePath[Index + 1];
+    }
+  }
+
+  for (Walker = Identifier; *Walker != '\0'; ++Walker) {
+    if (*Walker == '.') {
+      Identifier = Walker + 1;
+    }
+  }
+
+  //
+  // Compare bundle name without .kext extension to the last identifier component.
+  //
+  for (Index = 0; Identifier[Index] != '\0'; ++Index) {
+    if (CharToUpper (BundleName[Index]) != (CHAR16)AsciiCharToUpper (Identifier[Index])) {
+      return FALSE;
+    }
+  }
+
+  return StrCmp (&BundleName[Index], L".kext") == 0;
+}
+
 STATIC
 PATCHED_KEXT *
 LookupPatchedKextForIdentifier (
@@ -496,27 +617,65 @@ LookupPatchedKextForIdentifier (
   return NULL;
 }
 
+/**
+  Find built-in kext by bundle identifier, parsing Info.plist files on demand.
+  Kexts, which bundle names match the identifier, are parsed first.
+
+  @param[in,out] Context     Cacheless context.
+  @param[in]     Identifier  Bundle identifier.
+  @param[in]     FullScan    Parse all remaining kexts when not found by bundle name.
+
+  @retval Built-in kext or NULL.
+**/
 STATIC
 BUILTIN_KEXT *
 LookupBuiltinKextForIdentifier (
   IN OUT CACHELESS_CONTEXT  *Context,
-  IN     CONST CHAR8        *Identifier
+  IN     CONST CHAR8        *Identifier,
+  IN     BOOLEAN            FullScan
   )
 {
+  EFI_STATUS    Status;
   BUILTIN_KEXT  *BuiltinKext;
   LIST_ENTRY    *KextLink;
+  UINTN         Pass;
 
   KextLink = GetFirstNode (&Context->BuiltInKexts);
   while (!IsNull (&Context->BuiltInKexts, KextLink)) {
     BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
 
-    if (AsciiStrCmp (Identifier, BuiltinKext->Identifier) == 0) {
+    if ((BuiltinKext->Identifier != NULL) && (AsciiStrCmp (Identifier, BuiltinKext->Identifier) == 0)) {
       return BuiltinKext;
     }
 
     KextLink = GetNextNode (&Context->BuiltInKexts, KextLink);
   }
 
+  for (Pass = 0; Pass < (FullScan ? 2 : 1); ++Pass) {
+    KextLink = GetFirstNode (&Context->BuiltInKexts);
+    while (!IsNull (&Context->BuiltInKexts, KextLink)) {
+      BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
+      KextLink    = GetNextNode (&Context->BuiltInKexts, KextLink);
+
+      if (BuiltinKext->Parsed || ((Pass == 0) && !IsBuiltinKextCandidate (BuiltinKext, Identifier))) {
+        continue;
+      }
+
+      Status = ParseBuiltinKext (Context, BuiltinKext);
+      if (EFI_ERROR (Status)) {
+        if (Status != EFI_NOT_FOUND) {
+          DEBUG ((DEBUG_INFO, "OCAK: Failed to parse built-in kext %s - %r\n", BuiltinKext->RelativePath, Status));
+        }
+
+        continue;
+      }
+
+      if (AsciiStrCmp (Identifier, BuiltinKext->Identifier) == 0) {
+        return BuiltinKext;
+      }
+    }
+  }
+
   return NULL;
 }
 
@@ -534,7 +693,9 @@ LookupBuiltinKextForPlistPath (
   while (!IsNull (&Context->BuiltInKexts, KextLink)) {
     BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
 
-    if (StrCmp (PlistPath, BuiltinKext->PlistPath) == 0) {
+    if (  (BuiltinKext->PlistPath != NULL)
+       && (StrCmp (PlistPath, BuiltinKext->PlistPath) == 0))
+    {
       return BuiltinKext;
     }
 
@@ -584,7 +745,16 @@ ScanDependencies (
 
   DEBUG ((DEBUG_VERBOSE, "OCAK: Scanning dependencies for %a\n", Identifier));
 
-  BuiltinKext = LookupBuiltinKextForIdentifier (Context, Identifier);
+  //
+  // Identifiers provided by injected kexts are only looked up by bundle name,
+  // avoiding parsing every built-in kext for the common case of plugins
+  // depending on injected kexts.
+  //
+  BuiltinKext = LookupBuiltinKextForIdentifier (
+                  Context,
+                  Identifier,
+                  !IsKextDependencyPresent (&Context->InjectedIdentifiers, Identifier)
+                  );
   if ((BuiltinKext == NULL) || (BuiltinKext->OSBundleRequiredValue == KEXT_OSBUNDLE_REQUIRED_VALID)) {
     //
     // Injected kexts may have dependencies on other injected kexts, which we do not need to handle.
@@ -724,6 +894,7 @@ CachelessContextInit (
 
   InitializeListHead (&Context->InjectedKexts);
   InitializeListHead (&Context->InjectedDependencies);
+  InitializeListHead (&Context->InjectedIdentifiers);
   InitializeListHead (&Context->PatchedKexts);
   InitializeListHead (&Context->BuiltInKexts);
 
@@ -785,21 +956,12 @@ CachelessContextFree (
     BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
     RemoveEntryList (KextLink);
 
-    if (BuiltinKext->PlistPath != NULL) {
-      FreePool (BuiltinKext->PlistPath);
-    }
-
-    if (BuiltinKext->Identifier != NULL) {
-      FreePool (BuiltinKext->Identifier);
-    }
-
-    if (BuiltinKext->BinaryFileName != NULL) {
-      FreePool (BuiltinKext->BinaryFileName);
-    }
-
-    FreePool (BuiltinKext);
+    FreeBuiltInKext (BuiltinKext);
   }
 
+  FreeKextDependencies (&Context->InjectedDependencies);
+  FreeKextDependencies (&Context->InjectedIdentifiers);
+
   ZeroMem (Context, sizeof (*Context));
 }
 
@@ -826,6 +988,7 @@ CachelessContextAddKext (
   UINT32        FieldCount;
   UINT32        FieldIndex;
   CONST CHAR8   *BundleVerStr;
+  CONST CHAR8   *BundleIdentifier;
 
   BOOLEAN  Failed;
   BOOLEAN  IsLoadable;
@@ -885,6 +1048,7 @@ CachelessContextAddKext (
   // Search for plist properties.
   //
   InfoPlistLibraries = NULL;
+  BundleIdentifier   = NULL;
   FieldCount         = PlistDictChildren (InfoPlistRoot);
   for (FieldIndex = 0; FieldIndex < FieldCount; ++FieldIndex) {
     TmpKeyValue = PlistKeyValue (PlistDictChild (InfoPlistRoot, FieldIndex, &InfoPlistValue));
@@ -892,7 +1056,9 @@ CachelessContextAddKext (
       continue;
     }
 
-    if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_EXECUTABLE_KEY) == 0) {
+    if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
+      BundleIdentifier = XmlNodeContent (InfoPlistValue);
+    } else if (AsciiStrCmp (TmpKeyValue, INFO_BUNDLE_EXECUTABLE_KEY) == 0) {
       //
       // We are not supposed to check for this, it is XNU responsibility, which reliably panics.
       // However, to avoid certain users making this kind of mistake, we still provide some
@@ -1021,6 +1187,14 @@ CachelessContextAddKext (
     NewKext->PlistDataSize = NewPlistDataSize;
   }
 
+  //
+  // Remember injected identifiers to avoid searching for them in built-in kexts.
+  // This is merely an optimisation, so failures are ignored.
+  //
+  if ((BundleIdentifier != NULL) && (*BundleIdentifier != '\0')) {
+    AddKextDependency (&Context->InjectedIdentifiers, BundleIdentifier);
+  }
+
   XmlDocumentFree (InfoPlistDocument);
   FreePool (TmpInfoPlist);
 
@@ -1431,7 +1605,7 @@ CachelessContextHookBuiltin (
     //
     // Build list of kexts in system Extensions directory.
     //
-    Status = ScanExtensions (Context, Context->ExtensionsDir, Context->ExtensionsDirFileName, TRUE);
+    Status = ScanExtensions (Context, Context->ExtensionsDir, NULL, TRUE);
     if (EFI_ERROR (Status)) {
       return Status;
     }
@@ -1443,7 +1617,7 @@ CachelessContextHookBuiltin (
     while (!IsNull (&Context->PatchedKexts, KextLink)) {
       PatchedKext = GET_PATCHED_KEXT_FROM_LINK (KextLink);
 
-      BuiltinKext = LookupBuiltinKextForIdentifier (Context, PatchedKext->Identifier);
+      BuiltinKext = LookupBuiltinKextForIdentifier (Context, PatchedKext->Identifier, TRUE);
       if (BuiltinKext == NULL) {
         //
         // Kext is not present, skip.
@@ -154,6 +154,18 @@ typedef struct {
   //
   LIST_ENTRY    Link;
   //
+  // Bundle path relative to Extensions directory.
+  //
+  CHAR16        *RelativePath;
+  //
+  // Bundle has Contents directory.
+  //
+  BOOLEAN       UseContents;
+  //
+  // Info.plist was read. Only set Identifier marks valid kexts.
+  //
+  BOOLEAN       Parsed;
+  //
   // Plist path.
   //
   CHAR16        *PlistPath;
@@ -20,6 +20,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcAppleKernelLib.h>
 #include <Library/PrintLib.h>
 #include <Library/OcFileLib.h>
+#include <Library/OcMiscLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/UefiLib.h>
 
@@ -55,10 +56,11 @@ PatchAppleCpuPmCfgLock (
   IN     UINT32           KernelVersion
   )
 {
-  UINTN  Count;
-  UINT8  *Walker;
-  UINT8  *WalkerEnd;
-  UINT8  *WalkerTmp;
+  UINTN   Count;
+  UINT8   *Walker;
+  UINT8   *WalkerEnd;
+  UINT8   *WalkerTmp;
+  UINT32  Offset;
 
   //
   // NOTE: As of macOS 13.0 AICPUPM kext is removed.
@@ -80,21 +82,20 @@ PatchAppleCpuPmCfgLock (
   //
   while (Walker < WalkerEnd) {
     //
-    // Match (e)cx E2h assignment.
+    // Both (e)cx E2h assignments share <B9 E2 00>, mov cx is prefixed with 66h.
+    // Look for it at any offset up to WalkerEnd to match mov cx right before.
     //
-    if (  (Walker[0] == mMovEcxE2[0])
-       && (Walker[1] == mMovEcxE2[1])
-       && (Walker[2] == mMovEcxE2[2])
-       && (Walker[3] == mMovEcxE2[3])
-       && (Walker[4] == mMovEcxE2[4]))
-    {
+    Offset = 0;
+    if (!FindPattern (&mMovCxE2[1], NULL, sizeof (mMovCxE2) - 1, Walker, (UINT32)(WalkerEnd - Walker) + sizeof (mMovCxE2) - 1, &Offset)) {
+      break;
+    }
+
+    Walker += Offset;
+
+    if ((Offset > 0) && (Walker[-1] == mMovCxE2[0])) {
+      Walker += sizeof (mMovCxE2) - 1;
+    } else if ((Walker < WalkerEnd) && MatchPattern (mMovEcxE2, NULL, sizeof (mMovEcxE2), Walker)) {
       Walker += sizeof (mMovEcxE2);
-    } else if (  (Walker[0] == mMovCxE2[0])
-              && (Walker[1] == mMovCxE2[1])
-              && (Walker[2] == mMovCxE2[2])
-              && (Walker[3] == mMovCxE2[3]))
-    {
-      Walker += sizeof (mMovCxE2);
     } else {
       ++Walker;
       continue;
@@ -578,9 +579,11 @@ PatchAppleXcpmForceBoost (
   IN     UINT32           KernelVersion
   )
 {
-  UINT8  *Start;
-  UINT8  *Last;
-  UINT8  *Current;
+  UINT8    *Start;
+  UINT8    *Last;
+  UINT8    *Current;
+  UINT32   Offset;
+  BOOLEAN  Found;
 
   //
   // This is a kernel patch, so Patcher cannot be NULL.
@@ -598,30 +601,28 @@ PatchAppleXcpmForceBoost (
   Start   = (UINT8 *)MachoGetMachHeader (&Patcher->MachContext);
   Last    = Start + MachoGetInnerSize (&Patcher->MachContext) - EFI_PAGE_SIZE * 2;
   Start  += EFI_PAGE_SIZE;
-  Current = Start;
+  Current = NULL;
+  Offset  = 0;
+  Found   = FALSE;
 
-  while (Current < Last) {
-    //
-    // Compare <mov ecx, 0x199> in common.
-    //
-    if (  (Current[0] == mPerfCtrlFind1[0])
-       && (Current[1] == mPerfCtrlFind1[1])
-       && (Current[2] == mPerfCtrlFind1[2])
-       && (Current[3] == mPerfCtrlFind1[3]))
+  //
+  // Compare <mov ecx, 0x199> in common.
+  //
+  while (FindPattern (mPerfCtrlFind1, NULL, 4, Start, (UINT32)(Last - Start) + 3, &Offset)) {
+    Current = Start + Offset;
+    if (  MatchPattern (&mPerfCtrlFind1[4], NULL, sizeof (mPerfCtrlFind1) - 4, &Current[4])
+       || MatchPattern (&mPerfCtrlFind2[4], NULL, sizeof (mPerfCtrlFind2) - 4, &Current[4])
+       || MatchPattern (&mPerfCtrlFind3[4], NULL, sizeof (mPerfCtrlFind3) - 4, &Current[4])
+       || MatchPattern (&mPerfCtrlFind4[4], NULL, sizeof (mPerfCtrlFind4) - 4, &Current[4]))
     {
-      if (  (CompareMem (&Current[4], &mPerfCtrlFind1[4], sizeof (mPerfCtrlFind1) - 4) == 0)
-         || (CompareMem (&Current[4], &mPerfCtrlFind2[4], sizeof (mPerfCtrlFind2) - 4) == 0)
-         || (CompareMem (&Current[4], &mPerfCtrlFind3[4], sizeof (mPerfCtrlFind3) - 4) == 0)
-         || (CompareMem (&Current[4], &mPerfCtrlFind4[4], sizeof (mPerfCtrlFind4) - 4) == 0))
-      {
-        break;
-      }
+      Found = TRUE;
+      break;
     }
 
-    ++Current;
+    ++Offset;
   }
 
-  if (Current == Last) {
+  if (!Found) {
     DEBUG ((DEBUG_WARN, "OCAK: [FAIL] Failed to locate MSR_IA32_PERF_CONTROL write for XcpmForceBoost patch\n"));
     return EFI_NOT_FOUND;
   }
@@ -1525,6 +1526,12 @@ CONST UINT8
   0x66, 0xBA, 0xF8, 0x03  ///< mov dx, 0x03F[8-9A-F]
 };
 
+STATIC
+CONST UINT8
+  mSerialDevicePmioMask[] = {
+  0xFF, 0xFF, 0xF8, 0xFF
+};
+
 STATIC
 UINTN
   mPmioRegisterBase = 0;  ///< To be set by PatchSetPciSerialDevice()
@@ -1567,12 +1574,13 @@ PatchCustomPciSerialPmio (
   IN OUT PATCHER_CONTEXT  *Patcher
   )
 {
-  UINTN  Count;
-  UINT8  *Walker;
-  UINT8  *WalkerPmio;
-  UINTN  Pmio;
-  UINT8  *WalkerEnd;
-  UINT8  *WalkerTmp;
+  UINTN   Count;
+  UINT8   *Walker;
+  UINT8   *WalkerPmio;
+  UINTN   Pmio;
+  UINT8   *WalkerEnd;
+  UINT8   *WalkerTmp;
+  UINT32  Offset;
 
   //
   // This is a kernel patch, so Patcher cannot be NULL.
@@ -1584,49 +1592,58 @@ PatchCustomPciSerialPmio (
   WalkerEnd = Walker + MachoGetInnerSize (&Patcher->MachContext) - mInOutMaxDistance;
 
   while (Walker < WalkerEnd) {
-    if (  (Walker[0] == mSerialDevicePmioFind[0])
-       && (Walker[1] == mSerialDevicePmioFind[1])
-       && ((Walker[2] & 0xF8U) == mSerialDevicePmioFind[2])
-       && (Walker[3] == mSerialDevicePmioFind[3]))
+    Offset = 0;
+    if (!FindPattern (
+           mSerialDevicePmioFind,
+           mSerialDevicePmioMask,
+           sizeof (mSerialDevicePmioFind),
+           Walker,
+           (UINT32)(WalkerEnd - Walker) + sizeof (mSerialDevicePmioFind) - 1,
+           &Offset
+           ))
     {
-      DEBUG ((
-        DEBUG_VERBOSE,
-        "OCAK: Matched PMIO serial register base <%02X %02X %02X %02X>\n",
-        Walker[0],
-        Walker[1],
-        Walker[2],
-        Walker[3]
-        ));
-      WalkerPmio = &Walker[2];
+      break;
+    }
+
+    Walker += Offset;
+
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "OCAK: Matched PMIO serial register base <%02X %02X %02X %02X>\n",
+      Walker[0],
+      Walker[1],
+      Walker[2],
+      Walker[3]
+      ));
+    WalkerPmio = &Walker[2];
+
+    WalkerTmp = Walker + mInOutMaxDistance;
+    while (Walker < WalkerTmp) {
+      //
+      // Locate instruction in (0xEC) or out (0xEE).
+      //
+      if ((*Walker == 0xEC) || (*Walker == 0xEE)) {
+        DEBUG ((
+          DEBUG_VERBOSE,
+          "OCAK: Matched PMIO serial register base context %a <%02X>, patching register base\n",
+          *Walker == 0xEC ? "in" : "out",
+          *Walker
+          ));
 
-      WalkerTmp = Walker + mInOutMaxDistance;
-      while (Walker < WalkerTmp) {
         //
-        // Locate instruction in (0xEC) or out (0xEE).
+        // Patch PMIO.
         //
-        if ((*Walker == 0xEC) || (*Walker == 0xEE)) {
-          DEBUG ((
-            DEBUG_VERBOSE,
-            "OCAK: Matched PMIO serial register base context %a <%02X>, patching register base\n",
-            *Walker == 0xEC ? "in" : "out",
-            *Walker
-            ));
-
-          //
-          // Patch PMIO.
-          //
-          DEBUG ((DEBUG_VERBOSE, "OCAK: Before register base patch <%02X %02X>\n", WalkerPmio[0], WalkerPmio[1]));
-          Pmio          = mPmioRegisterBase + (*WalkerPmio & 7U) * mPmioRegisterStride;
-          WalkerPmio[0] = Pmio & 0xFFU;
-          WalkerPmio[1] = (Pmio >> 8U) & 0xFFU;
-          DEBUG ((DEBUG_VERBOSE, "OCAK: After register base patch <%02X %02X>\n", WalkerPmio[0], WalkerPmio[1]));
-
-          ++Count;
-          break;
-        }
-
-        ++Walker;
+        DEBUG ((DEBUG_VERBOSE, "OCAK: Before register base patch <%02X %02X>\n", WalkerPmio[0], WalkerPmio[1]));
+        Pmio          = mPmioRegisterBase + (*WalkerPmio & 7U) * mPmioRegisterStride;
+        WalkerPmio[0] = Pmio & 0xFFU;
+        WalkerPmio[1] = (Pmio >> 8U) & 0xFFU;
+        DEBUG ((DEBUG_VERBOSE, "OCAK: After register base patch <%02X %02X>\n", WalkerPmio[0], WalkerPmio[1]));
+
+        ++Count;
+        break;
       }
+
+      ++Walker;
     }
 
     //
@@ -3021,3 +3038,13 @@ KernelApplyQuirk (
 
   return gKernelQuirks[Name].PatchFunction (Patcher, KernelVersion);
 }
+
+CONST CHAR8 *
+KernelGetQuirkIdentifier (
+  IN KERNEL_QUIRK_NAME  Name
+  )
+{
+  ASSERT (Name < KernelQuirkMax);
+
+  return gKernelQuirks[Name].Identifier;
+}
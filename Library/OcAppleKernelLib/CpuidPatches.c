@@ -20,6 +20,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcAppleKernelLib.h>
 #include <Library/PrintLib.h>
 #include <Library/OcFileLib.h>
+#include <Library/OcMiscLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/UefiLib.h>
 
@@ -939,21 +940,22 @@ PatchKernelCpuId (
 
   Record    = CpuidSetInfo;
   FoundSize = 0;
+  Index     = 0;
 
-  for (Index = 0; Index < EFI_PAGE_SIZE; ++Index, ++Record) {
-    if (  (Record[0] == mKernelCpuIdFindRelNew[0])
-       && (Record[1] == mKernelCpuIdFindRelNew[1])
-       && (Record[2] == mKernelCpuIdFindRelNew[2])
-       && (Record[3] == mKernelCpuIdFindRelNew[3]))
-    {
-      if (CompareMem (Record, mKernelCpuIdFindRelNew, sizeof (mKernelCpuIdFindRelNew)) == 0) {
-        FoundSize = sizeof (mKernelCpuIdFindRelNew);
-        break;
-      } else if (CompareMem (Record, mKernelCpuIdFindRelOld, sizeof (mKernelCpuIdFindRelOld)) == 0) {
-        FoundSize = sizeof (mKernelCpuIdFindRelOld);
-        break;
-      }
+  //
+  // Search the first page for the common 4-byte prefix, then tell both versions apart.
+  //
+  while (FindPattern (mKernelCpuIdFindRelNew, NULL, 4, CpuidSetInfo, EFI_PAGE_SIZE + 3, &Index)) {
+    Record = CpuidSetInfo + Index;
+    if (MatchPattern (mKernelCpuIdFindRelNew, NULL, sizeof (mKernelCpuIdFindRelNew), Record)) {
+      FoundSize = sizeof (mKernelCpuIdFindRelNew);
+      break;
+    } else if (MatchPattern (mKernelCpuIdFindRelOld, NULL, sizeof (mKernelCpuIdFindRelOld), Record)) {
+      FoundSize = sizeof (mKernelCpuIdFindRelOld);
+      break;
     }
+
+    ++Index;
   }
 
   FoundReleaseKernel = FoundSize > 0;
@@ -997,21 +999,21 @@ PatchKernelCpuId (
       0x90
       );
     Record += FoundSize;
+    Index   = 0;
+
+    if (FindPattern (mKernelCpuidFindMcRel, NULL, sizeof (mKernelCpuidFindMcRel), Record, EFI_PAGE_SIZE - 1, &Index)) {
+      Record         += Index;
+      McPatch         = (INTERNAL_MICROCODE_PATCH *)Record;
+      McPatch->EdxCmd = 0xBA;
+      McPatch->EdxVal = CpuInfo->MicrocodeRevision;
+      SetMem (
+        Record + sizeof (INTERNAL_MICROCODE_PATCH),
+        sizeof (mKernelCpuidFindMcRel) - sizeof (INTERNAL_MICROCODE_PATCH),
+        0x90
+        );
 
-    for (Index = 0; Index < EFI_PAGE_SIZE - sizeof (mKernelCpuidFindMcRel); ++Index, ++Record) {
-      if (CompareMem (Record, mKernelCpuidFindMcRel, sizeof (mKernelCpuidFindMcRel)) == 0) {
-        McPatch         = (INTERNAL_MICROCODE_PATCH *)Record;
-        McPatch->EdxCmd = 0xBA;
-        McPatch->EdxVal = CpuInfo->MicrocodeRevision;
-        SetMem (
-          Record + sizeof (INTERNAL_MICROCODE_PATCH),
-          sizeof (mKernelCpuidFindMcRel) - sizeof (INTERNAL_MICROCODE_PATCH),
-          0x90
-          );
-
-        DEBUG ((DEBUG_INFO, "OCAK: [OK] Patch success CPUID release\n"));
-        return EFI_SUCCESS;
-      }
+      DEBUG ((DEBUG_INFO, "OCAK: [OK] Patch success CPUID release\n"));
+      return EFI_SUCCESS;
     }
   } else {
     //
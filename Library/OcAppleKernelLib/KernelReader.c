@@ -414,6 +414,165 @@ ReadAppleKernelImage (
   }
 }
 
+STATIC
+EFI_STATUS
+ProbeAppleKernelMagic (
+  IN UINT32   Magic,
+  IN BOOLEAN  Is32Bit,
+  IN UINT32   Offset
+  )
+{
+  if (  (Is32Bit && (Magic == MACH_HEADER_SIGNATURE))
+     || (!Is32Bit && (Magic == MACH_HEADER_64_SIGNATURE)))
+  {
+    return EFI_SUCCESS;
+  }
+
+  if ((Magic == MACH_HEADER_SIGNATURE) || (Magic == MACH_HEADER_64_SIGNATURE)) {
+    DEBUG ((DEBUG_VERBOSE, "OCAK: Probed kernel arch mismatch %08X at %08X\n", Magic, Offset));
+    return EFI_NOT_FOUND;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "OCAK: Probed invalid kernel magic %08X at %08X\n", Magic, Offset));
+  return EFI_INVALID_PARAMETER;
+}
+
+STATIC
+EFI_STATUS
+ProbeCompressedHeader (
+  IN EFI_FILE_PROTOCOL  *File,
+  IN UINT8              *Buffer,
+  IN UINT32             Offset,
+  IN BOOLEAN            Is32Bit
+  )
+{
+  EFI_STATUS        Status;
+  MACH_COMP_HEADER  *CompHeader;
+  UINT8             *CompressedBuffer;
+  UINT32            CompressionType;
+  UINT32            CompressedSize;
+  UINT32            DecompressedSize;
+  UINT32            PrefixSize;
+  UINT32            Magic;
+  UINTN             MagicSize;
+
+  CompHeader       = (MACH_COMP_HEADER *)Buffer;
+  CompressionType  = CompHeader->Compression;
+  CompressedSize   = SwapBytes32 (CompHeader->Compressed);
+  DecompressedSize = SwapBytes32 (CompHeader->Decompressed);
+
+  if (  (CompressedSize > OC_COMPRESSION_MAX_LENGTH)
+     || (CompressedSize == 0)
+     || (DecompressedSize > OC_COMPRESSION_MAX_LENGTH)
+     || (DecompressedSize < KERNEL_HEADER_SIZE)
+     || (  (CompressionType != MACH_COMPRESSED_BINARY_INVERT_LZVN)
+        && (CompressionType != MACH_COMPRESSED_BINARY_INVERT_LZSS)))
+  {
+    DEBUG ((DEBUG_VERBOSE, "OCAK: Probed comp kernel invalid comp %u or decomp %u at %08X\n", CompressedSize, DecompressedSize, Offset));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Both decoders stop once the destination is full, so decompressing
+  // a short prefix of the stream is enough to reach the Mach-O magic.
+  //
+  PrefixSize       = MIN (CompressedSize, KERNEL_HEADER_SIZE);
+  CompressedBuffer = AllocatePool (PrefixSize);
+  if (CompressedBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = OcGetFileData (File, Offset + sizeof (MACH_COMP_HEADER), PrefixSize, CompressedBuffer);
+  if (EFI_ERROR (Status)) {
+    FreePool (CompressedBuffer);
+    return Status;
+  }
+
+  Magic = 0;
+  if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+    MagicSize = DecompressLZVN ((UINT8 *)&Magic, sizeof (Magic), CompressedBuffer, PrefixSize);
+  } else {
+    MagicSize = DecompressLZSS ((UINT8 *)&Magic, sizeof (Magic), CompressedBuffer, PrefixSize);
+  }
+
+  FreePool (CompressedBuffer);
+
+  if (MagicSize != sizeof (Magic)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return ProbeAppleKernelMagic (Magic, Is32Bit, Offset);
+}
+
+EFI_STATUS
+ProbeAppleKernel (
+  IN EFI_FILE_PROTOCOL  *File,
+  IN BOOLEAN            Is32Bit
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Buffer;
+  UINT32      Magic;
+  UINT32      Offset;
+  UINT32      FileSize;
+  UINT32      FatSize;
+
+  Buffer = AllocatePool (KERNEL_HEADER_SIZE);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Offset = 0;
+  Status = OcGetFileData (File, Offset, KERNEL_HEADER_SIZE, Buffer);
+  if (EFI_ERROR (Status)) {
+    FreePool (Buffer);
+    return Status;
+  }
+
+  Magic = *(UINT32 *)Buffer;
+
+  if ((Magic == MACH_FAT_BINARY_SIGNATURE) || (Magic == MACH_FAT_BINARY_INVERT_SIGNATURE)) {
+    //
+    // Only the requested slice matters, the caller rejects the other one anyway.
+    //
+    Status = OcGetFileSize (File, &FileSize);
+    if (!EFI_ERROR (Status) && (KERNEL_HEADER_SIZE >= FileSize)) {
+      Status = EFI_INVALID_PARAMETER;
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Status = FatGetArchitectureOffset (
+                 Buffer,
+                 KERNEL_HEADER_SIZE,
+                 FileSize,
+                 Is32Bit ? MachCpuTypeI386 : MachCpuTypeX8664,
+                 &Offset,
+                 &FatSize
+                 );
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Status = OcGetFileData (File, Offset, KERNEL_HEADER_SIZE, Buffer);
+    }
+
+    if (EFI_ERROR (Status)) {
+      FreePool (Buffer);
+      return Status;
+    }
+
+    Magic = *(UINT32 *)Buffer;
+  }
+
+  if (Magic == MACH_COMPRESSED_BINARY_INVERT_SIGNATURE) {
+    Status = ProbeCompressedHeader (File, Buffer, Offset, Is32Bit);
+  } else {
+    Status = ProbeAppleKernelMagic (Magic, Is32Bit, Offset);
+  }
+
+  FreePool (Buffer);
+  return Status;
+}
+
 EFI_STATUS
 ReadAppleKernel (
   IN     EFI_FILE_PROTOCOL  *File,
@@ -392,6 +392,8 @@ InternalKxldStateBuildLinkedVtables (
   Kext->LinkedVtables   = LinkedVtables;
   Kext->NumberOfVtables = NumVtables;
 
+  InternalIndexLinkedVtables (Kext);
+
   return EFI_SUCCESS;
 }
 
@@ -369,7 +369,12 @@ PrelinkedContextInit (
   // it starts with a <dict> node.
   //
   if (Context->IsKernelCollection) {
-    DocumentRoot = PlistDocumentRoot (Context->PrelinkedInfoDocument);
+    //
+    // Original plist remains in place under __KREMLIN_START, while legacy
+    // prelinked format reuses its space for the injected kexts.
+    //
+    Context->PrelinkedInfoSource = (CONST CHAR8 *)&Context->Prelinked[Context->PrelinkedInfoSection->Section64.Offset];
+    DocumentRoot                 = PlistDocumentRoot (Context->PrelinkedInfoDocument);
   } else {
     DocumentRoot = XmlDocumentRoot (Context->PrelinkedInfoDocument);
   }
@@ -760,7 +765,6 @@ PrelinkedInjectComplete (
   )
 {
   EFI_STATUS  Status;
-  CHAR8       *ExportedInfo;
   UINT32      ExportedInfoSize;
   UINT32      NewSize;
   UINT32      KextsSize;
@@ -794,8 +798,14 @@ PrelinkedInjectComplete (
     }
   }
 
-  ExportedInfo = XmlDocumentExport (Context->PrelinkedInfoDocument, &ExportedInfoSize, 0, FALSE);
-  if (ExportedInfo == NULL) {
+  if (!XmlDocumentExportSize (
+         Context->PrelinkedInfoDocument,
+         Context->PrelinkedInfoSource,
+         0,
+         FALSE,
+         &ExportedInfoSize
+         ))
+  {
     return EFI_OUT_OF_RESOURCES;
   }
 
@@ -807,7 +817,6 @@ PrelinkedInjectComplete (
   if (  BaseOverflowAddU32 (Context->PrelinkedSize, MACHO_ALIGN (ExportedInfoSize), &NewSize)
      || (NewSize > Context->PrelinkedAllocSize))
   {
-    FreePool (ExportedInfo);
     return EFI_BUFFER_TOO_SMALL;
   }
 
@@ -815,21 +824,23 @@ PrelinkedInjectComplete (
   //
   // This is a potential optimisation for smaller kexts allowing us to use less space.
   // This requires disable __KREMLIN relocation segment addition.
+  // The original plist is overwritten here, so it cannot be used as export source.
   //
   if (Context->IsKernelCollection && (MACHO_ALIGN (ExportedInfoSize) <= Context->PrelinkedInfoSegment->Size)) {
-    CopyMem (
-      &Context->Prelinked[Context->PrelinkedInfoSegment->FileOffset],
-      ExportedInfo,
-      ExportedInfoSize
-      );
+    XmlDocumentExportSize (Context->PrelinkedInfoDocument, NULL, 0, FALSE, &ExportedInfoSize);
+    ExportedInfoSize = XmlDocumentExportToBuffer (
+                         Context->PrelinkedInfoDocument,
+                         NULL,
+                         0,
+                         FALSE,
+                         (CHAR8 *)&Context->Prelinked[Context->PrelinkedInfoSegment->FileOffset]
+                         ) + 1;
 
     ZeroMem (
       &Context->Prelinked[Context->PrelinkedInfoSegment->FileOffset + ExportedInfoSize],
       Context->PrelinkedInfoSegment->FileSize - ExportedInfoSize
       );
 
-    FreePool (ExportedInfo);
-
     return EFI_SUCCESS;
   }
 
@@ -867,10 +878,15 @@ PrelinkedInjectComplete (
     Context->InnerInfoSection->Offset         = Context->PrelinkedSize;
   }
 
-  CopyMem (
-    &Context->Prelinked[Context->PrelinkedSize],
-    ExportedInfo,
-    ExportedInfoSize
+  //
+  // Export directly into the kernel, copying unchanged entries from the original plist.
+  //
+  XmlDocumentExportToBuffer (
+    Context->PrelinkedInfoDocument,
+    Context->PrelinkedInfoSource,
+    0,
+    FALSE,
+    (CHAR8 *)&Context->Prelinked[Context->PrelinkedSize]
     );
 
   ZeroMem (
@@ -895,8 +911,6 @@ PrelinkedInjectComplete (
                                  );
   }
 
-  FreePool (ExportedInfo);
-
   return EFI_SUCCESS;
 }
 
@@ -138,6 +138,15 @@ struct PRELINKED_KEXT_ {
   // Scanned vtable buffer. Iterated with GET_NEXT_PRELINKED_VTABLE.
   //
   PRELINKED_VTABLE            *LinkedVtables;
+  //
+  // Open addressing hash index over LinkedVtables by name, may be NULL.
+  // Contains VtableIndexMask + 1 slots.
+  //
+  CONST PRELINKED_VTABLE      **VtableIndex;
+  //
+  // Vtable index slot mask.
+  //
+  UINT32                      VtableIndexMask;
 };
 
 //
@@ -391,6 +400,52 @@ InternalGetOcVtableByName (
   IN CONST CHAR8        *Name
   );
 
+/**
+  Create vtable name index for up to MaxVtables vtables of the kext.
+  The index is optional, lookups fall back to LinkedVtables walk when
+  it could not be allocated.
+
+  @param[in,out] Kext        Kext to create the index for.
+  @param[in]     MaxVtables  Maximum number of vtables to be indexed.
+**/
+VOID
+InternalCreateVtableIndex (
+  IN OUT PRELINKED_KEXT  *Kext,
+  IN     UINT32          MaxVtables
+  );
+
+/**
+  Add vtable to kext vtable name index.
+
+  @param[in,out] Kext    Kext with the index.
+  @param[in]     Vtable  Vtable from Kext LinkedVtables.
+**/
+VOID
+InternalInsertVtableIndex (
+  IN OUT PRELINKED_KEXT          *Kext,
+  IN     CONST PRELINKED_VTABLE  *Vtable
+  );
+
+/**
+  Create vtable name index for all kext LinkedVtables.
+
+  @param[in,out] Kext  Kext to create the index for.
+**/
+VOID
+InternalIndexLinkedVtables (
+  IN OUT PRELINKED_KEXT  *Kext
+  );
+
+/**
+  Free kext vtable name index.
+
+  @param[in,out] Kext  Kext to free the index of.
+**/
+VOID
+InternalFreeVtableIndex (
+  IN OUT PRELINKED_KEXT  *Kext
+  );
+
 //
 // Prelink
 //
@@ -567,6 +567,8 @@ InternalScanBuildLinkedVtables (
   Kext->NumberOfVtables = NumVtables;
   Kext->LinkedVtables   = LinkedVtables;
 
+  InternalIndexLinkedVtables (Kext);
+
   return EFI_SUCCESS;
 }
 
@@ -700,6 +702,8 @@ InternalFreePrelinkedKext (
     Kext->LinkedVtables = NULL;
   }
 
+  InternalFreeVtableIndex (Kext);
+
   FreePool (Kext);
 }
 
@@ -1277,5 +1281,7 @@ InternalLinkPrelinkedKext (
     Kext->NumberOfVtables = 0;
   }
 
+  InternalFreeVtableIndex (Kext);
+
   return Kext;
 }
@@ -17,6 +17,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <IndustryStandard/AppleMachoImage.h>
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/BaseOverflowLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -25,20 +26,164 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include "PrelinkedInternal.h"
 
+//
+// Number of dependency vtable lookup results cached while patching a kext.
+// Most classes share a few superclasses, e.g. IOService and OSMetaClass.
+//
+#define VTABLE_LOOKUP_CACHE_SIZE  64
+
+typedef struct {
+  UINT32                    Hash;
+  CONST PRELINKED_VTABLE    *Vtable;
+} VTABLE_LOOKUP_CACHE_ENTRY;
+
+typedef struct {
+  //
+  // Kext being patched, its vtables are added during patching.
+  //
+  PRELINKED_KEXT               *Kext;
+  //
+  // Dependency closure of Kext in lookup order.
+  //
+  PRELINKED_KEXT               **Dependencies;
+  UINT32                       NumDependencies;
+  //
+  // Dependency lookup results by name hash.
+  //
+  VTABLE_LOOKUP_CACHE_ENTRY    Cache[VTABLE_LOOKUP_CACHE_SIZE];
+} VTABLE_LOOKUP_CONTEXT;
+
+STATIC
+UINT32
+InternalHashVtableName (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a, vtable names are long mangled strings with a common prefix.
+  //
+  Hash = 0x811C9DC5U;
+  while (*Name != '\0') {
+    Hash ^= (UINT8)*Name;
+    Hash *= 0x01000193U;
+    ++Name;
+  }
+
+  return Hash;
+}
+
+VOID
+InternalCreateVtableIndex (
+  IN OUT PRELINKED_KEXT  *Kext,
+  IN     UINT32          MaxVtables
+  )
+{
+  UINT32  NumSlots;
+
+  ASSERT (Kext->VtableIndex == NULL);
+
+  if ((MaxVtables == 0) || (MaxVtables > MAX_UINT32 / (4 * sizeof (*Kext->VtableIndex)))) {
+    return;
+  }
+
+  //
+  // Keep the load factor at or below 50%.
+  //
+  NumSlots = GetPowerOfTwo32 (MaxVtables * 2 - 1) << 1U;
+
+  Kext->VtableIndex = AllocateZeroPool (NumSlots * sizeof (*Kext->VtableIndex));
+  if (Kext->VtableIndex == NULL) {
+    return;
+  }
+
+  Kext->VtableIndexMask = NumSlots - 1;
+}
+
+VOID
+InternalInsertVtableIndex (
+  IN OUT PRELINKED_KEXT          *Kext,
+  IN     CONST PRELINKED_VTABLE  *Vtable
+  )
+{
+  UINT32  Slot;
+
+  if (Kext->VtableIndex == NULL) {
+    return;
+  }
+
+  Slot = InternalHashVtableName (Vtable->Name) & Kext->VtableIndexMask;
+  while (Kext->VtableIndex[Slot] != NULL) {
+    //
+    // Keep the first vtable with this name to match LinkedVtables walk order.
+    //
+    if (AsciiStrCmp (Kext->VtableIndex[Slot]->Name, Vtable->Name) == 0) {
+      return;
+    }
+
+    Slot = (Slot + 1) & Kext->VtableIndexMask;
+  }
+
+  Kext->VtableIndex[Slot] = Vtable;
+}
+
+VOID
+InternalIndexLinkedVtables (
+  IN OUT PRELINKED_KEXT  *Kext
+  )
+{
+  CONST PRELINKED_VTABLE  *Vtable;
+  UINT32                  Index;
+
+  InternalCreateVtableIndex (Kext, Kext->NumberOfVtables);
+
+  for (
+       Index = 0, Vtable = Kext->LinkedVtables;
+       Index < Kext->NumberOfVtables;
+       ++Index, Vtable = GET_NEXT_PRELINKED_VTABLE (Vtable)
+       )
+  {
+    InternalInsertVtableIndex (Kext, Vtable);
+  }
+}
+
+VOID
+InternalFreeVtableIndex (
+  IN OUT PRELINKED_KEXT  *Kext
+  )
+{
+  if (Kext->VtableIndex != NULL) {
+    FreePool (Kext->VtableIndex);
+    Kext->VtableIndex     = NULL;
+    Kext->VtableIndexMask = 0;
+  }
+}
+
+STATIC
 CONST PRELINKED_VTABLE *
-InternalGetOcVtableByNameWorker (
-  IN PRELINKED_CONTEXT  *Context,
-  IN PRELINKED_KEXT     *Kext,
-  IN CONST CHAR8        *Name
+InternalGetKextVtableByName (
+  IN PRELINKED_KEXT  *Kext,
+  IN CONST CHAR8     *Name,
+  IN UINT32          Hash
   )
 {
   CONST PRELINKED_VTABLE  *Vtable;
+  UINT32                  Index;
+  UINT32                  Slot;
 
-  UINTN           Index;
-  PRELINKED_KEXT  *Dependency;
-  INTN            Result;
+  if (Kext->VtableIndex != NULL) {
+    Slot = Hash & Kext->VtableIndexMask;
+    while (Kext->VtableIndex[Slot] != NULL) {
+      if (AsciiStrCmp (Kext->VtableIndex[Slot]->Name, Name) == 0) {
+        return Kext->VtableIndex[Slot];
+      }
 
-  Kext->Processed = TRUE;
+      Slot = (Slot + 1) & Kext->VtableIndexMask;
+    }
+
+    return NULL;
+  }
 
   for (
        Index = 0, Vtable = Kext->LinkedVtables;
@@ -46,12 +191,35 @@ InternalGetOcVtableByNameWorker (
        ++Index, Vtable = GET_NEXT_PRELINKED_VTABLE (Vtable)
        )
   {
-    Result = AsciiStrCmp (Vtable->Name, Name);
-    if (Result == 0) {
+    if (AsciiStrCmp (Vtable->Name, Name) == 0) {
       return Vtable;
     }
   }
 
+  return NULL;
+}
+
+STATIC
+CONST PRELINKED_VTABLE *
+InternalGetOcVtableByNameWorker (
+  IN PRELINKED_CONTEXT  *Context,
+  IN PRELINKED_KEXT     *Kext,
+  IN CONST CHAR8        *Name,
+  IN UINT32             Hash
+  )
+{
+  CONST PRELINKED_VTABLE  *Vtable;
+
+  UINTN           Index;
+  PRELINKED_KEXT  *Dependency;
+
+  Kext->Processed = TRUE;
+
+  Vtable = InternalGetKextVtableByName (Kext, Name, Hash);
+  if (Vtable != NULL) {
+    return Vtable;
+  }
+
   for (Index = 0; Index < ARRAY_SIZE (Kext->Dependencies); ++Index) {
     Dependency = Kext->Dependencies[Index];
     if (Dependency == NULL) {
@@ -62,7 +230,7 @@ InternalGetOcVtableByNameWorker (
       continue;
     }
 
-    Vtable = InternalGetOcVtableByName (Context, Dependency, Name);
+    Vtable = InternalGetOcVtableByNameWorker (Context, Dependency, Name, Hash);
     if (Vtable != NULL) {
       return Vtable;
     }
@@ -80,13 +248,144 @@ InternalGetOcVtableByName (
 {
   CONST PRELINKED_VTABLE  *Vtable;
 
-  Vtable = InternalGetOcVtableByNameWorker (Context, Kext, Name);
+  Vtable = InternalGetOcVtableByNameWorker (
+             Context,
+             Kext,
+             Name,
+             InternalHashVtableName (Name)
+             );
 
   InternalUnlockContextKexts (Context);
 
   return Vtable;
 }
 
+STATIC
+UINT32
+InternalCollectVtableDependencies (
+  IN     PRELINKED_KEXT  *Kext,
+  IN OUT PRELINKED_KEXT  **Dependencies  OPTIONAL,
+  IN     UINT32          NumDependencies
+  )
+{
+  PRELINKED_KEXT  *Dependency;
+  UINTN           Index;
+
+  //
+  // Same depth-first order as InternalGetOcVtableByNameWorker.
+  //
+  Kext->Processed = TRUE;
+
+  for (Index = 0; Index < ARRAY_SIZE (Kext->Dependencies); ++Index) {
+    Dependency = Kext->Dependencies[Index];
+    if (Dependency == NULL) {
+      break;
+    }
+
+    if (Dependency->Processed) {
+      continue;
+    }
+
+    if (Dependencies != NULL) {
+      Dependencies[NumDependencies] = Dependency;
+    }
+
+    NumDependencies = InternalCollectVtableDependencies (
+                        Dependency,
+                        Dependencies,
+                        NumDependencies + 1
+                        );
+  }
+
+  return NumDependencies;
+}
+
+/**
+  Prepare vtable lookup over Kext and its dependency closure.
+  Kext vtables may be added while the lookup is in use.
+**/
+STATIC
+BOOLEAN
+InternalInitVtableLookup (
+  IN  PRELINKED_CONTEXT      *Context,
+  IN  PRELINKED_KEXT         *Kext,
+  OUT VTABLE_LOOKUP_CONTEXT  *Lookup
+  )
+{
+  ZeroMem (Lookup, sizeof (*Lookup));
+  Lookup->Kext = Kext;
+
+  Lookup->NumDependencies = InternalCollectVtableDependencies (Kext, NULL, 0);
+  InternalUnlockContextKexts (Context);
+
+  if (Lookup->NumDependencies == 0) {
+    return TRUE;
+  }
+
+  Lookup->Dependencies = AllocatePool (Lookup->NumDependencies * sizeof (*Lookup->Dependencies));
+  if (Lookup->Dependencies == NULL) {
+    return FALSE;
+  }
+
+  InternalCollectVtableDependencies (Kext, Lookup->Dependencies, 0);
+  InternalUnlockContextKexts (Context);
+
+  return TRUE;
+}
+
+STATIC
+VOID
+InternalFreeVtableLookup (
+  IN OUT VTABLE_LOOKUP_CONTEXT  *Lookup
+  )
+{
+  if (Lookup->Dependencies != NULL) {
+    FreePool (Lookup->Dependencies);
+    Lookup->Dependencies = NULL;
+  }
+}
+
+STATIC
+CONST PRELINKED_VTABLE *
+InternalLookupVtable (
+  IN OUT VTABLE_LOOKUP_CONTEXT  *Lookup,
+  IN     CONST CHAR8            *Name
+  )
+{
+  CONST PRELINKED_VTABLE     *Vtable;
+  VTABLE_LOOKUP_CACHE_ENTRY  *Entry;
+  UINT32                     Hash;
+  UINT32                     Index;
+
+  Hash = InternalHashVtableName (Name);
+
+  Vtable = InternalGetKextVtableByName (Lookup->Kext, Name, Hash);
+  if (Vtable != NULL) {
+    return Vtable;
+  }
+
+  //
+  // Dependencies do not change while patching, so their results can be cached.
+  //
+  Entry = &Lookup->Cache[Hash % VTABLE_LOOKUP_CACHE_SIZE];
+  if (  (Entry->Vtable != NULL) && (Entry->Hash == Hash)
+     && (AsciiStrCmp (Entry->Vtable->Name, Name) == 0))
+  {
+    return Entry->Vtable;
+  }
+
+  for (Index = 0; Index < Lookup->NumDependencies; ++Index) {
+    Vtable = InternalGetKextVtableByName (Lookup->Dependencies[Index], Name, Hash);
+    if (Vtable != NULL) {
+      Entry->Hash   = Hash;
+      Entry->Vtable = Vtable;
+      return Vtable;
+    }
+  }
+
+  return NULL;
+}
+
 STATIC
 VOID
 InternalConstructVtablePrelinked (
@@ -580,10 +879,12 @@ InternalInitializeVtablePatchData (
   return FALSE;
 }
 
+STATIC
 BOOLEAN
-InternalPatchByVtables (
-  IN     PRELINKED_CONTEXT  *Context,
-  IN OUT PRELINKED_KEXT     *Kext
+InternalPatchByVtablesWorker (
+  IN     PRELINKED_CONTEXT      *Context,
+  IN OUT PRELINKED_KEXT         *Kext,
+  IN OUT VTABLE_LOOKUP_CONTEXT  *Lookup
   )
 {
   OC_VTABLE_PATCH_ENTRY  *Entries;
@@ -706,6 +1007,8 @@ InternalPatchByVtables (
     return FALSE;
   }
 
+  InternalCreateVtableIndex (Kext, NumTables * 2);
+
   CurrentVtable = Kext->LinkedVtables;
   //
   // Patch via the previously retrieved SMCPs.
@@ -796,11 +1099,7 @@ InternalPatchByVtables (
       //
       // Get the super vtable if it's been patched
       //
-      SuperVtable = InternalGetOcVtableByName (
-                      Context,
-                      Kext,
-                      SuperVtableName
-                      );
+      SuperVtable = InternalLookupVtable (Lookup, SuperVtableName);
       if (SuperVtable == NULL) {
         continue;
       }
@@ -857,6 +1156,7 @@ InternalPatchByVtables (
         return FALSE;
       }
 
+      InternalInsertVtableIndex (Kext, CurrentVtable);
       CurrentVtable = GET_NEXT_PRELINKED_VTABLE (CurrentVtable);
       //
       // Get the meta vtable name from the class name
@@ -870,11 +1170,7 @@ InternalPatchByVtables (
         return FALSE;
       }
 
-      MetaVtable = InternalGetOcVtableByName (
-                     Context,
-                     Kext,
-                     VtableName
-                     );
+      MetaVtable = InternalLookupVtable (Lookup, VtableName);
       if (MetaVtable != NULL) {
         return FALSE;
       }
@@ -884,11 +1180,7 @@ InternalPatchByVtables (
       // we know that every class's metaclass inherits directly from
       // OSMetaClass, so we just hardcode that vtable name here.
       //
-      SuperVtable = InternalGetOcVtableByName (
-                      Context,
-                      Kext,
-                      OS_METACLASS_VTABLE_NAME
-                      );
+      SuperVtable = InternalLookupVtable (Lookup, OS_METACLASS_VTABLE_NAME);
       if (SuperVtable == NULL) {
         return FALSE;
       }
@@ -914,6 +1206,7 @@ InternalPatchByVtables (
         return FALSE;
       }
 
+      InternalInsertVtableIndex (Kext, CurrentVtable);
       CurrentVtable = GET_NEXT_PRELINKED_VTABLE (CurrentVtable);
 
       Kext->NumberOfVtables += 2;
@@ -935,3 +1228,23 @@ InternalPatchByVtables (
 
   return TRUE;
 }
+
+BOOLEAN
+InternalPatchByVtables (
+  IN     PRELINKED_CONTEXT  *Context,
+  IN OUT PRELINKED_KEXT     *Kext
+  )
+{
+  VTABLE_LOOKUP_CONTEXT  Lookup;
+  BOOLEAN                Result;
+
+  if (!InternalInitVtableLookup (Context, Kext, &Lookup)) {
+    return FALSE;
+  }
+
+  Result = InternalPatchByVtablesWorker (Context, Kext, &Lookup);
+
+  InternalFreeVtableLookup (&Lookup);
+
+  return Result;
+}
@@ -17,6 +17,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 **/
 
 #include <AppleMacEfi.h>
+#include <Guid/OcAppleKeyMapEvent.h>
 #include <IndustryStandard/AppleHid.h>
 #include <Protocol/AppleKeyMapAggregator.h>
 #include <Protocol/AppleKeyMapDatabase.h>
@@ -59,6 +60,7 @@ typedef struct {
   APPLE_KEY_CODE                       *KeyCodeBuffer;
   UINTN                                KeyCodeBufferLength;
   LIST_ENTRY                           KeyStrokesInfoList;
+  EFI_EVENT                            KeysChangedEvent;
   APPLE_KEY_MAP_DATABASE_PROTOCOL      Database;
   APPLE_KEY_MAP_AGGREGATOR_PROTOCOL    Aggregator;
 } KEY_MAP_AGGREGATOR_DATA;
@@ -548,6 +550,18 @@ InternalSetKeyStrokeBufferKeys (
     Status = EFI_OUT_OF_RESOURCES;
 
     if (KeyStrokesInfo->KeyCodeBufferLength >= NumberOfKeyCodes) {
+      //
+      // Most producers report their buffer on every poll, so only wake
+      // consumers when the contents actually change.
+      //
+      if (  (KeyMapAggregatorData->KeysChangedEvent != NULL)
+         && (  (KeyStrokesInfo->NumberOfKeyCodes != NumberOfKeyCodes)
+            || (KeyStrokesInfo->Modifiers != Modifiers)
+            || (CompareMem (&KeyStrokesInfo->KeyCodes[0], KeyCodes, NumberOfKeyCodes * sizeof (*KeyCodes)) != 0)))
+      {
+        gBS->SignalEvent (KeyMapAggregatorData->KeysChangedEvent);
+      }
+
       KeyStrokesInfo->NumberOfKeyCodes = NumberOfKeyCodes;
       KeyStrokesInfo->Modifiers        = Modifiers;
 
@@ -566,6 +580,22 @@ InternalSetKeyStrokeBufferKeys (
 
 STATIC APPLE_KEY_MAP_DATABASE_PROTOCOL  *mKeyMapDatabase = NULL;
 
+/**
+  Key map change group member owned by the database itself.
+
+  @param[in] Event    Event being signalled.
+  @param[in] Context  Event context.
+**/
+STATIC
+VOID
+EFIAPI
+InternalKeysChangedNotifyFunction (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+}
+
 /**
   Returns the previously install Apple Key Map Database protocol.
 
@@ -654,6 +684,24 @@ OcAppleKeyMapInstallProtocols (
 
   InitializeListHead (&KeyMapAggregatorData->KeyStrokesInfoList);
 
+  //
+  // Event groups are unavailable on EFI 1.1 firmware, consumers keep polling there.
+  //
+  if (gBS->Hdr.HeaderSize > OFFSET_OF (EFI_BOOT_SERVICES, CreateEventEx)) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    InternalKeysChangedNotifyFunction,
+                    NULL,
+                    &gOcAppleKeyMapChangedEventGroupGuid,
+                    &KeyMapAggregatorData->KeysChangedEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OCKM: Failed to create key map change event - %r\n", Status));
+      KeyMapAggregatorData->KeysChangedEvent = NULL;
+    }
+  }
+
   NewHandle = NULL;
   Status    = gBS->InstallMultipleProtocolInterfaces (
                      &NewHandle,
@@ -664,6 +712,10 @@ OcAppleKeyMapInstallProtocols (
                      NULL
                      );
   if (EFI_ERROR (Status)) {
+    if (KeyMapAggregatorData->KeysChangedEvent != NULL) {
+      gBS->CloseEvent (KeyMapAggregatorData->KeysChangedEvent);
+    }
+
     FreePool (KeyMapAggregatorData);
     return NULL;
   }
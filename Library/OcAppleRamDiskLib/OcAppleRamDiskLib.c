@@ -39,6 +39,101 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
   ASSERT ((ExtentTable)->ExtentCount > 0);                                     \
   ASSERT ((ExtentTable)->ExtentCount <= ARRAY_SIZE ((ExtentTable)->Extents))
 
+///
+/// Starting RAM disk offsets of the extents of the last table allocated by
+/// this library for logarithmic lookup. Tables are never modified after
+/// allocation, other tables fall back to linear lookup.
+///
+STATIC CONST APPLE_RAM_DISK_EXTENT_TABLE  *mIndexedExtentTable;
+STATIC UINTN                              mExtentOffsets[APPLE_RAM_DISK_MAX_EXTENTS + 1];
+
+/**
+  Build extent offset index for ExtentTable.
+
+  @param[in]  ExtentTable  Allocated extent table.
+**/
+STATIC
+VOID
+InternalIndexExtentTable (
+  IN CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+  )
+{
+  UINT32  Index;
+
+  //
+  // As per the allocation algorithm, the sum over all Extent->Length must be
+  // smaller than MAX_UINTN.
+  //
+  mExtentOffsets[0] = 0;
+  for (Index = 0; Index < ExtentTable->ExtentCount; ++Index) {
+    mExtentOffsets[Index + 1] = mExtentOffsets[Index] + (UINTN)ExtentTable->Extents[Index].Length;
+  }
+
+  mIndexedExtentTable = ExtentTable;
+}
+
+/**
+  Find extent containing Offset.
+
+  @param[in]   ExtentTable    Allocated extent table.
+  @param[in]   Offset         Offset in RAM disk.
+  @param[out]  ExtentOffset   Starting offset of the found extent.
+
+  @retval Extent index or ExtentTable->ExtentCount when out of range.
+**/
+STATIC
+UINT32
+InternalFindExtent (
+  IN  CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
+  IN  UINTN                              Offset,
+  OUT UINTN                              *ExtentOffset
+  )
+{
+  UINT32  Index;
+  UINT32  Start;
+  UINT32  End;
+  UINT32  Curr;
+  UINTN   CurrentOffset;
+
+  if (ExtentTable == mIndexedExtentTable) {
+    if (Offset >= mExtentOffsets[ExtentTable->ExtentCount]) {
+      return ExtentTable->ExtentCount;
+    }
+
+    //
+    // Find the last extent starting at or before Offset.
+    // Extents are never empty, thus starting offsets are strictly ascending.
+    //
+    Start = 0;
+    End   = ExtentTable->ExtentCount - 1;
+    while (Start < End) {
+      Curr = (Start + End + 1) / 2;
+      if (mExtentOffsets[Curr] <= Offset) {
+        Start = Curr;
+      } else {
+        End = Curr - 1;
+      }
+    }
+
+    *ExtentOffset = mExtentOffsets[Start];
+    return Start;
+  }
+
+  for (
+       Index = 0, CurrentOffset = 0;
+       Index < ExtentTable->ExtentCount;
+       CurrentOffset += (UINTN)ExtentTable->Extents[Index].Length, ++Index
+       )
+  {
+    if ((Offset - CurrentOffset) < ExtentTable->Extents[Index].Length) {
+      *ExtentOffset = CurrentOffset;
+      return Index;
+    }
+  }
+
+  return ExtentTable->ExtentCount;
+}
+
 /**
   Insert allocated area into extent list. If no extent list
   was created, then it gets allocated.
@@ -339,6 +434,10 @@ OcAppleRamDiskAllocate (
     ExtentTable = InternalAppleRamDiskAllocate (Size, MemoryType, FALSE);
   }
 
+  if (ExtentTable != NULL) {
+    InternalIndexExtentTable (ExtentTable);
+  }
+
   DEBUG ((
     DEBUG_BULK_INFO,
     "OCRAM: Extent allocation of %u bytes (%x) gave %p\n",
@@ -378,7 +477,7 @@ OcAppleRamDiskRead (
   // smaller than MAX_UINTN.
   //
   for (
-       Index = 0, CurrentOffset = 0;
+       Index = InternalFindExtent (ExtentTable, Offset, &CurrentOffset);
        Index < ExtentTable->ExtentCount;
        ++Index, CurrentOffset += (UINTN)Extent->Length
        )
@@ -437,7 +536,7 @@ OcAppleRamDiskWrite (
   // smaller than MAX_UINTN.
   //
   for (
-       Index = 0, CurrentOffset = 0;
+       Index = InternalFindExtent (ExtentTable, Offset, &CurrentOffset);
        Index < ExtentTable->ExtentCount;
        ++Index, CurrentOffset += (UINTN)Extent->Length
        )
@@ -472,7 +571,9 @@ BOOLEAN
 OcAppleRamDiskLoadFile (
   IN CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
   IN EFI_FILE_PROTOCOL                  *File,
-  IN UINTN                              FileSize
+  IN UINTN                              FileSize,
+  IN OC_APPLE_RAM_DISK_LOAD_VERIFY      Verify         OPTIONAL,
+  IN VOID                               *VerifyContext OPTIONAL
   )
 {
   EFI_STATUS      Status;
@@ -538,6 +639,15 @@ OcAppleRamDiskLoadFile (
       Sha256Update (&Ctx, TmpBuffer, ReadSize);
       DEBUG_CODE_END ();
 
+      //
+      // Verify the data while it is still in cache to avoid another pass.
+      //
+      if ((Verify != NULL) && !Verify (VerifyContext, TmpBuffer, ReadSize)) {
+        DEBUG ((DEBUG_INFO, "OCRAM: Verification failed at 0x%Lx\n", FilePosition));
+        FreePool (TmpBuffer);
+        return FALSE;
+      }
+
       CopyMem (ExtentBuffer, TmpBuffer, ReadSize);
 
       FilePosition += ReadSize;
@@ -610,6 +720,10 @@ OcAppleRamDiskFree (
   ASSERT (ExtentTable->Extents[0].Start <= MAX_UINTN);
   ASSERT (ExtentTable->Extents[0].Length <= MAX_UINTN);
 
+  if (ExtentTable == mIndexedExtentTable) {
+    mIndexedExtentTable = NULL;
+  }
+
   //
   // Extents are allocated in the first page.
   //
@@ -260,4 +260,52 @@ BlitLibVideoToBuffer270 (
   IN     UINTN                       DeltaPixels
   );
 
+/**
+  Copy pixel rectangle between rotated layouts with cache-sized tiles.
+  Pixel (X, Y) of the rectangle is read from Source + X * SourceStepX
+  + Y * SourceStepY and written to Destination + X * DestinationStepX
+  + Y * DestinationStepY. Columns are walked along Y within each tile,
+  so the steps along Y should address the frame buffer contiguously.
+
+  @param[in]  Configure         Pointer to a configuration which was successfully
+                                created by FrameBufferBltConfigure ().
+  @param[out] Destination       Destination pixel for rectangle origin.
+  @param[in]  DestinationStepX  Destination pixel step along X.
+  @param[in]  DestinationStepY  Destination pixel step along Y.
+  @param[in]  Source            Source pixel for rectangle origin.
+  @param[in]  SourceStepX       Source pixel step along X.
+  @param[in]  SourceStepY       Source pixel step along Y.
+  @param[in]  Width             Width (in pixels).
+  @param[in]  Height            Height.
+**/
+VOID
+BlitLibCopyRotated (
+  IN  OC_BLIT_CONFIGURE  *Configure,
+  OUT UINT32             *Destination,
+  IN  INTN               DestinationStepX,
+  IN  INTN               DestinationStepY,
+  IN  CONST UINT32       *Source,
+  IN  INTN               SourceStepX,
+  IN  INTN               SourceStepY,
+  IN  UINTN              Width,
+  IN  UINTN              Height
+  );
+
+/**
+  Copy pixel line in reverse order converting pixel format when needed.
+
+  @param[in]  Configure    Pointer to a configuration which was successfully
+                           created by FrameBufferBltConfigure ().
+  @param[out] Destination  Destination line.
+  @param[in]  Source       Source line.
+  @param[in]  Width        Width (in pixels).
+**/
+VOID
+BlitLibCopyReversed (
+  IN  OC_BLIT_CONFIGURE  *Configure,
+  OUT UINT32             *Destination,
+  IN  CONST UINT32       *Source,
+  IN  UINTN              Width
+  );
+
 #endif // BLIT_INTERNAL_H
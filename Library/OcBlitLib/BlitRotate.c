@@ -0,0 +1,112 @@
+/** @file
+  OcBlitLib - Library to perform blt operations on a frame buffer.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "BlitInternal.h"
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+
+//
+// 16 pixels make a 64-byte cache line, so each tile touches 16 lines
+// on either side of the copy.
+//
+#define BLIT_TILE_SIZE  16
+
+STATIC
+UINT32
+BlitLibConvertPixel (
+  IN OC_BLIT_CONFIGURE  *Configure,
+  IN UINT32             Uint32
+  )
+{
+  return (UINT32)(
+                  (((Uint32 << Configure->PixelShl[0]) >> Configure->PixelShr[0]) &
+                   Configure->PixelMasks.RedMask) |
+                  (((Uint32 << Configure->PixelShl[1]) >> Configure->PixelShr[1]) &
+                   Configure->PixelMasks.GreenMask) |
+                  (((Uint32 << Configure->PixelShl[2]) >> Configure->PixelShr[2]) &
+                   Configure->PixelMasks.BlueMask)
+                  );
+}
+
+VOID
+BlitLibCopyRotated (
+  IN  OC_BLIT_CONFIGURE  *Configure,
+  OUT UINT32             *Destination,
+  IN  INTN               DestinationStepX,
+  IN  INTN               DestinationStepY,
+  IN  CONST UINT32       *Source,
+  IN  INTN               SourceStepX,
+  IN  INTN               SourceStepY,
+  IN  UINTN              Width,
+  IN  UINTN              Height
+  )
+{
+  UINT32        *DestinationWalker;
+  CONST UINT32  *SourceWalker;
+  UINTN         TileX;
+  UINTN         TileY;
+  UINTN         TileWidth;
+  UINTN         TileHeight;
+  UINTN         IndexX;
+  UINTN         IndexY;
+  BOOLEAN       Convert;
+
+  Convert = Configure->PixelFormat != PixelBlueGreenRedReserved8BitPerColor;
+
+  for (TileY = 0; TileY < Height; TileY += BLIT_TILE_SIZE) {
+    TileHeight = MIN (BLIT_TILE_SIZE, Height - TileY);
+
+    for (TileX = 0; TileX < Width; TileX += BLIT_TILE_SIZE) {
+      TileWidth = MIN (BLIT_TILE_SIZE, Width - TileX);
+
+      for (IndexX = TileX; IndexX < TileX + TileWidth; IndexX++) {
+        DestinationWalker = Destination + (INTN)IndexX * DestinationStepX + (INTN)TileY * DestinationStepY;
+        SourceWalker      = Source + (INTN)IndexX * SourceStepX + (INTN)TileY * SourceStepY;
+
+        if (!Convert) {
+          for (IndexY = 0; IndexY < TileHeight; IndexY++) {
+            *DestinationWalker = *SourceWalker;
+            DestinationWalker += DestinationStepY;
+            SourceWalker      += SourceStepY;
+          }
+        } else {
+          for (IndexY = 0; IndexY < TileHeight; IndexY++) {
+            *DestinationWalker = BlitLibConvertPixel (Configure, *SourceWalker);
+            DestinationWalker += DestinationStepY;
+            SourceWalker      += SourceStepY;
+          }
+        }
+      }
+    }
+  }
+}
+
+VOID
+BlitLibCopyReversed (
+  IN  OC_BLIT_CONFIGURE  *Configure,
+  OUT UINT32             *Destination,
+  IN  CONST UINT32       *Source,
+  IN  UINTN              Width
+  )
+{
+  UINTN  Index;
+
+  Source += Width - 1;
+
+  if (Configure->PixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
+    for (Index = 0; Index < Width; Index++) {
+      Destination[Index] = *Source--;
+    }
+  } else {
+    for (Index = 0; Index < Width; Index++) {
+      Destination[Index] = BlitLibConvertPixel (Configure, *Source--);
+    }
+  }
+}
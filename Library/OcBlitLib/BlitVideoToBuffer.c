@@ -91,53 +91,26 @@ BlitLibVideoToBuffer90 (
 {
   UINT32  *Source;
   UINT32  *Destination;
-  UINT32  *SourceWalker;
-  UINT32  *DestinationWalker;
-  UINTN   IndexX;
   UINTN   PixelsPerScanLine;
-  UINT32  Uint32;
 
   PixelsPerScanLine = Configure->PixelsPerScanLine;
 
   Destination = (UINT32 *)BltBuffer
                 + DestinationY * DeltaPixels + DestinationX;
   Source = (UINT32 *)Configure->FrameBuffer
-           + (Configure->Width - SourceY - 1);
-
-  if (Configure->PixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source;
-      for (IndexX = SourceX; IndexX < SourceX + Width; IndexX++) {
-        *DestinationWalker++ = SourceWalker[IndexX * PixelsPerScanLine];
-      }
-
-      Source--;
-      Destination += DeltaPixels;
-      Height--;
-    }
-  } else {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source;
-      for (IndexX = SourceX; IndexX < SourceX + Width; IndexX++) {
-        Uint32               = SourceWalker[IndexX * PixelsPerScanLine];
-        *DestinationWalker++ =
-          (UINT32)(
-                   (((Uint32 << Configure->PixelShl[0]) >> Configure->PixelShr[0]) &
-                    Configure->PixelMasks.RedMask) |
-                   (((Uint32 << Configure->PixelShl[1]) >> Configure->PixelShr[1]) &
-                    Configure->PixelMasks.GreenMask) |
-                   (((Uint32 << Configure->PixelShl[2]) >> Configure->PixelShr[2]) &
-                    Configure->PixelMasks.BlueMask)
-                   );
-      }
-
-      Source--;
-      Destination += DeltaPixels;
-      Height--;
-    }
-  }
+           + SourceX * PixelsPerScanLine + (Configure->Width - SourceY - 1);
+
+  BlitLibCopyRotated (
+    Configure,
+    Destination,
+    1,
+    (INTN)DeltaPixels,
+    Source,
+    (INTN)PixelsPerScanLine,
+    -1,
+    Width,
+    Height
+    );
 
   return EFI_SUCCESS;
 }
@@ -157,12 +130,10 @@ BlitLibVideoToBuffer180 (
 {
   UINT32  *Source;
   UINT32  *Destination;
-  UINT32  *SourceWalker;
-  UINT32  *DestinationWalker;
-  UINTN   IndexX;
+  UINTN   WidthInBytes;
   UINTN   PixelsPerScanLine;
-  UINT32  Uint32;
 
+  WidthInBytes      = Width * BYTES_PER_PIXEL;
   PixelsPerScanLine = Configure->PixelsPerScanLine;
 
   SourceX = Configure->Width  - SourceX - Width;
@@ -173,39 +144,15 @@ BlitLibVideoToBuffer180 (
   Source = (UINT32 *)Configure->FrameBuffer
            + (SourceY + (Height - 1)) * PixelsPerScanLine + SourceX;
 
-  if (Configure->PixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source + (Width - 1);
-      for (IndexX = 0; IndexX < Width; IndexX++) {
-        *DestinationWalker++ = *SourceWalker--;
-      }
-
-      Source      -= PixelsPerScanLine;
-      Destination += DeltaPixels;
-      Height--;
-    }
-  } else {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source + (Width - 1);
-      for (IndexX = 0; IndexX < Width; IndexX++) {
-        Uint32               = *SourceWalker--;
-        *DestinationWalker++ =
-          (UINT32)(
-                   (((Uint32 << Configure->PixelShl[0]) >> Configure->PixelShr[0]) &
-                    Configure->PixelMasks.RedMask) |
-                   (((Uint32 << Configure->PixelShl[1]) >> Configure->PixelShr[1]) &
-                    Configure->PixelMasks.GreenMask) |
-                   (((Uint32 << Configure->PixelShl[2]) >> Configure->PixelShr[2]) &
-                    Configure->PixelMasks.BlueMask)
-                   );
-      }
-
-      Source      -= PixelsPerScanLine;
-      Destination += DeltaPixels;
-      Height--;
-    }
+  //
+  // Read frame buffer lines at once and reverse them in cached memory.
+  //
+  while (Height > 0) {
+    CopyMem (Configure->LineBuffer, Source, WidthInBytes);
+    BlitLibCopyReversed (Configure, Destination, (UINT32 *)Configure->LineBuffer, Width);
+    Source      -= PixelsPerScanLine;
+    Destination += DeltaPixels;
+    Height--;
   }
 
   return EFI_SUCCESS;
@@ -226,56 +173,26 @@ BlitLibVideoToBuffer270 (
 {
   UINT32  *Source;
   UINT32  *Destination;
-  UINT32  *SourceWalker;
-  UINT32  *DestinationWalker;
-  UINTN   IndexX;
-  UINTN   LastX;
   UINTN   PixelsPerScanLine;
-  UINT32  Uint32;
 
   PixelsPerScanLine = Configure->PixelsPerScanLine;
 
   Destination = (UINT32 *)BltBuffer
                 + DestinationY * DeltaPixels + DestinationX;
   Source = (UINT32 *)Configure->FrameBuffer
-           + SourceY;
-
-  if (Configure->PixelFormat == PixelBlueGreenRedReserved8BitPerColor) {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source;
-      LastX             = Configure->Height - SourceX - 1;
-      for (IndexX = 0; IndexX < Width; IndexX++) {
-        *DestinationWalker++ = SourceWalker[(LastX - IndexX) * PixelsPerScanLine];
-      }
-
-      Source++;
-      Destination += DeltaPixels;
-      Height--;
-    }
-  } else {
-    while (Height > 0) {
-      DestinationWalker = Destination;
-      SourceWalker      = Source;
-      LastX             = Configure->Height - SourceX - 1;
-      for (IndexX = 0; IndexX < Width; IndexX++) {
-        Uint32               = SourceWalker[(LastX - IndexX) * PixelsPerScanLine];
-        *DestinationWalker++ =
-          (UINT32)(
-                   (((Uint32 << Configure->PixelShl[0]) >> Configure->PixelShr[0]) &
-                    Configure->PixelMasks.RedMask) |
-                   (((Uint32 << Configure->PixelShl[1]) >> Configure->PixelShr[1]) &
-                    Configure->PixelMasks.GreenMask) |
-                   (((Uint32 << Configure->PixelShl[2]) >> Configure->PixelShr[2]) &
-                    Configure->PixelMasks.BlueMask)
-                   );
-      }
-
-      Source++;
-      Destination += DeltaPixels;
-      Height--;
-    }
-  }
+           + (Configure->Height - SourceX - 1) * PixelsPerScanLine + SourceY;
+
+  BlitLibCopyRotated (
+    Configure,
+    Destination,
+    1,
+    (INTN)DeltaPixels,
+    Source,
+    -(INTN)PixelsPerScanLine,
+    1,
+    Width,
+    Height
+    );
 
   return EFI_SUCCESS;
 }
@@ -199,7 +199,7 @@ ExpandShortFormBootPath (
 **/
 STATIC
 INTERNAL_ENTRY_VISIBILITY
-ReadEntryVisibility (
+ReadEntryVisibilityUncached (
   IN OC_PICKER_CONTEXT         *Context,
   IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath
   )
@@ -298,6 +298,32 @@ ReadEntryVisibility (
   return BootEntryNormal;
 }
 
+/**
+  Check boot entry visibility by device path, reusing the result of previous scans.
+
+  @param[in]  Context      Picker context.
+  @param[in]  DevicePath   Device path of the entry.
+
+  @return Entry visibility
+**/
+STATIC
+INTERNAL_ENTRY_VISIBILITY
+ReadEntryVisibility (
+  IN OC_PICKER_CONTEXT         *Context,
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath
+  )
+{
+  INTERNAL_ENTRY_VISIBILITY  Visibility;
+
+  if (InternalScanCacheGetVisibility (DevicePath, &Visibility)) {
+    return Visibility;
+  }
+
+  Visibility = ReadEntryVisibilityUncached (Context, DevicePath);
+  InternalScanCacheSetVisibility (DevicePath, Visibility);
+  return Visibility;
+}
+
 /**
   Register bootable entry on the filesystem.
 
@@ -893,61 +919,29 @@ InternalAddBootEntryFromCustomEntry (
 }
 
 /**
-  Create bootable entries from bless policy.
-  This function may create more than one entry, and for APFS
-  it will likely produce a sequence of 'OS, RECOVERY' entry pairs.
+  Obtain blessed device path of the filesystem.
 
-  @param[in,out] BootContext         Context of filesystems.
-  @param[in,out] FileSystem          Filesystem to scan for bless.
-  @param[in]     PredefinedPaths     The predefined boot file locations to scan.
-  @param[in]     NumPredefinedPaths  The number of elements in PredefinedPaths.
-  @param[in]     LazyScan            Lazy filesystem scanning.
-  @param[in]     Deduplicate         Ensure that duplicated entries are not added.
+  @param[in]  BootContext         Context of filesystems.
+  @param[in]  FileSystem          Filesystem to scan for bless.
+  @param[in]  PredefinedPaths     The predefined boot file locations to scan.
+  @param[in]  NumPredefinedPaths  The number of elements in PredefinedPaths.
+  @param[out] DevicePath          Blessed, possibly multi-instance, device path.
 
-  @retval EFI_STATUS for last created option.
+  @retval EFI_SUCCESS when something is blessed.
 **/
 STATIC
 EFI_STATUS
-AddBootEntryFromBless (
-  IN OUT OC_BOOT_CONTEXT     *BootContext,
-  IN OUT OC_BOOT_FILESYSTEM  *FileSystem,
-  IN     CONST CHAR16        **PredefinedPaths,
-  IN     UINTN               NumPredefinedPaths,
-  IN     BOOLEAN             LazyScan,
-  IN     BOOLEAN             Deduplicate
+GetBlessedDevicePath (
+  IN  OC_BOOT_CONTEXT           *BootContext,
+  IN  OC_BOOT_FILESYSTEM        *FileSystem,
+  IN  CONST CHAR16              **PredefinedPaths,
+  IN  UINTN                     NumPredefinedPaths,
+  OUT EFI_DEVICE_PATH_PROTOCOL  **DevicePath
   )
 {
   EFI_STATUS                       Status;
-  EFI_STATUS                       PrimaryStatus;
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *SimpleFs;
-  EFI_DEVICE_PATH_PROTOCOL         *DevicePath;
-  EFI_DEVICE_PATH_PROTOCOL         *DevicePathWalker;
-  EFI_DEVICE_PATH_PROTOCOL         *NewDevicePath;
-  UINTN                            NewDevicePathSize;
-  EFI_DEVICE_PATH_PROTOCOL         *HdDevicePath;
-  UINTN                            HdPrefixSize;
-  INTN                             CmpResult;
   EFI_FILE_PROTOCOL                *Root;
-  CHAR16                           *RecoveryPath;
-  EFI_FILE_PROTOCOL                *RecoveryRoot;
-  EFI_HANDLE                       RecoveryDeviceHandle;
-
-  //
-  // We need to ensure that blessed device paths are on the same filesystem.
-  // Read the prefix path.
-  //
-  Status = gBS->HandleProtocol (
-                  FileSystem->Handle,
-                  &gEfiDevicePathProtocolGuid,
-                  (VOID **)&HdDevicePath
-                  );
-  if (EFI_ERROR (Status)) {
-    return EFI_UNSUPPORTED;
-  }
-
-  DebugPrintDevicePath (DEBUG_INFO, "OCB: Adding bless entry on disk", HdDevicePath);
-
-  HdPrefixSize = GetDevicePathSize (HdDevicePath) - END_DEVICE_PATH_LENGTH;
 
   //
   // Custom bless paths have the priority, try to look them up first.
@@ -967,7 +961,7 @@ AddBootEntryFromBless (
                    Root,
                    (CONST CHAR16 **)BootContext->PickerContext->CustomBootPaths,
                    BootContext->PickerContext->NumCustomBootPaths,
-                   &DevicePath,
+                   DevicePath,
                    NULL
                    );
 
@@ -986,15 +980,101 @@ AddBootEntryFromBless (
                FileSystem->Handle,
                PredefinedPaths,
                NumPredefinedPaths,
-               &DevicePath
+               DevicePath
                );
   }
 
+  return Status;
+}
+
+/**
+  Create bootable entries from bless policy.
+  This function may create more than one entry, and for APFS
+  it will likely produce a sequence of 'OS, RECOVERY' entry pairs.
+
+  @param[in,out] BootContext         Context of filesystems.
+  @param[in,out] FileSystem          Filesystem to scan for bless.
+  @param[in]     PredefinedPaths     The predefined boot file locations to scan.
+  @param[in]     NumPredefinedPaths  The number of elements in PredefinedPaths.
+  @param[in]     LazyScan            Lazy filesystem scanning.
+  @param[in]     Deduplicate         Ensure that duplicated entries are not added.
+
+  @retval EFI_STATUS for last created option.
+**/
+STATIC
+EFI_STATUS
+AddBootEntryFromBless (
+  IN OUT OC_BOOT_CONTEXT     *BootContext,
+  IN OUT OC_BOOT_FILESYSTEM  *FileSystem,
+  IN     CONST CHAR16        **PredefinedPaths,
+  IN     UINTN               NumPredefinedPaths,
+  IN     BOOLEAN             LazyScan,
+  IN     BOOLEAN             Deduplicate
+  )
+{
+  EFI_STATUS                Status;
+  EFI_STATUS                PrimaryStatus;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePathWalker;
+  EFI_DEVICE_PATH_PROTOCOL  *NewDevicePath;
+  UINTN                     NewDevicePathSize;
+  EFI_DEVICE_PATH_PROTOCOL  *HdDevicePath;
+  UINTN                     HdPrefixSize;
+  INTN                      CmpResult;
+  CHAR16                    *RecoveryPath;
+  EFI_FILE_PROTOCOL         *RecoveryRoot;
+  EFI_HANDLE                RecoveryDeviceHandle;
+
   //
-  // If both custom and normal found nothing, then nothing is blessed.
+  // We need to ensure that blessed device paths are on the same filesystem.
+  // Read the prefix path.
   //
+  Status = gBS->HandleProtocol (
+                  FileSystem->Handle,
+                  &gEfiDevicePathProtocolGuid,
+                  (VOID **)&HdDevicePath
+                  );
   if (EFI_ERROR (Status)) {
-    return Status;
+    return EFI_UNSUPPORTED;
+  }
+
+  DebugPrintDevicePath (DEBUG_INFO, "OCB: Adding bless entry on disk", HdDevicePath);
+
+  HdPrefixSize = GetDevicePathSize (HdDevicePath) - END_DEVICE_PATH_LENGTH;
+
+  //
+  // Reuse bless lookup from previous scans when the volume did not change.
+  //
+  if (InternalScanCacheGetBless (FileSystem->Handle, PredefinedPaths, NumPredefinedPaths, &Status, &DevicePath)) {
+    //
+    // Nothing is blessed.
+    //
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  } else {
+    Status = GetBlessedDevicePath (
+               BootContext,
+               FileSystem,
+               PredefinedPaths,
+               NumPredefinedPaths,
+               &DevicePath
+               );
+
+    InternalScanCacheSetBless (
+      FileSystem->Handle,
+      PredefinedPaths,
+      NumPredefinedPaths,
+      Status,
+      EFI_ERROR (Status) ? NULL : DevicePath
+      );
+
+    //
+    // If both custom and normal found nothing, then nothing is blessed.
+    //
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   //
@@ -1737,7 +1817,7 @@ AddFileSystemEntry (
   EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
   CHAR16                    *TextDevicePath;
 
-  Status = InternalCheckScanPolicy (
+  Status = InternalScanCacheCheckScanPolicy (
              FileSystemHandle,
              BootContext->PickerContext->ScanPolicy,
              &IsExternal
@@ -0,0 +1,591 @@
+/** @file
+  Per-volume boot entry scan cache.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include "BootManagementInternal.h"
+
+#include <Guid/Gpt.h>
+
+#include <Protocol/BlockIo.h>
+#include <Protocol/DevicePath.h>
+#include <Protocol/SimpleFileSystem.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DevicePathLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcBootManagementLib.h>
+#include <Library/OcDevicePathLib.h>
+#include <Library/OcFileLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+///
+/// Cached visibility of a single boot path.
+///
+typedef struct {
+  LIST_ENTRY                   Link;
+  EFI_DEVICE_PATH_PROTOCOL     *DevicePath;
+  INTERNAL_ENTRY_VISIBILITY    Visibility;
+} INTERNAL_SCAN_CACHE_VISIBILITY;
+
+///
+/// Cached scan results of a single volume.
+///
+typedef struct {
+  //
+  // Link in mScanCache.
+  //
+  LIST_ENTRY                  Link;
+  //
+  // Filesystem handle.
+  //
+  EFI_HANDLE                  Handle;
+  //
+  // Unique partition GUID at the time of caching, zero when not on GPT.
+  //
+  EFI_GUID                    PartitionUuid;
+  //
+  // Block I/O media id at the time of caching, zero without Block I/O.
+  //
+  UINT32                      MediaId;
+  //
+  // Set from protocol notifications when the volume is reinstalled.
+  //
+  BOOLEAN                     Stale;
+  //
+  // Scan policy the filesystem was checked against.
+  //
+  BOOLEAN                     HasPolicy;
+  UINT32                      ScanPolicy;
+  EFI_STATUS                  PolicyStatus;
+  BOOLEAN                     IsExternal;
+  //
+  // Bless lookup result. BlessDevicePath is multi-instance and only valid on success.
+  //
+  BOOLEAN                     HasBless;
+  CONST CHAR16                **BlessPaths;
+  UINTN                       NumBlessPaths;
+  EFI_STATUS                  BlessStatus;
+  EFI_DEVICE_PATH_PROTOCOL    *BlessDevicePath;
+  //
+  // List of INTERNAL_SCAN_CACHE_VISIBILITY.
+  //
+  LIST_ENTRY                  Visibility;
+} INTERNAL_SCAN_CACHE_ENTRY;
+
+STATIC LIST_ENTRY  mScanCache = INITIALIZE_LIST_HEAD_VARIABLE (mScanCache);
+STATIC BOOLEAN     mScanCacheMonitored;
+STATIC VOID        *mScanCacheFsEventKey;
+STATIC VOID        *mScanCacheBlockIoEventKey;
+STATIC UINTN       mScanCacheHits;
+STATIC UINTN       mScanCacheMisses;
+
+STATIC
+VOID
+ScanCacheMarkStale (
+  IN VOID  *EventKey
+  )
+{
+  EFI_STATUS                 Status;
+  UINTN                      BufferSize;
+  EFI_HANDLE                 Handle;
+  LIST_ENTRY                 *Link;
+  INTERNAL_SCAN_CACHE_ENTRY  *Entry;
+
+  while (TRUE) {
+    BufferSize = sizeof (EFI_HANDLE);
+    Status     = gBS->LocateHandle (
+                        ByRegisterNotify,
+                        NULL,
+                        EventKey,
+                        &BufferSize,
+                        &Handle
+                        );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    //
+    // Only flag entries here, the list is owned by the scanning code.
+    //
+    for (
+         Link = GetFirstNode (&mScanCache);
+         !IsNull (&mScanCache, Link);
+         Link = GetNextNode (&mScanCache, Link))
+    {
+      Entry = BASE_CR (Link, INTERNAL_SCAN_CACHE_ENTRY, Link);
+      if (Entry->Handle == Handle) {
+        Entry->Stale = TRUE;
+      }
+    }
+  }
+}
+
+STATIC
+VOID
+EFIAPI
+ScanCacheFileSystemArrived (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  ScanCacheMarkStale (mScanCacheFsEventKey);
+}
+
+STATIC
+VOID
+EFIAPI
+ScanCacheBlockIoArrived (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  ScanCacheMarkStale (mScanCacheBlockIoEventKey);
+}
+
+STATIC
+EFI_STATUS
+ScanCacheMonitorProtocol (
+  IN  EFI_GUID          *Protocol,
+  IN  EFI_EVENT_NOTIFY  NotifyFunction,
+  OUT EFI_EVENT         *Event,
+  OUT VOID              **EventKey
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  NotifyFunction,
+                  NULL,
+                  Event
+                  );
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->RegisterProtocolNotify (
+                    Protocol,
+                    *Event,
+                    EventKey
+                    );
+
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (*Event);
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Start monitoring volume changes. Without monitoring the cache is not used.
+
+  @retval TRUE when volume changes are monitored.
+**/
+STATIC
+BOOLEAN
+ScanCacheIsUsable (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   FsEvent;
+  EFI_EVENT   BlockIoEvent;
+
+  if (mScanCacheMonitored) {
+    return TRUE;
+  }
+
+  Status = ScanCacheMonitorProtocol (
+             &gEfiSimpleFileSystemProtocolGuid,
+             ScanCacheFileSystemArrived,
+             &FsEvent,
+             &mScanCacheFsEventKey
+             );
+  if (!EFI_ERROR (Status)) {
+    Status = ScanCacheMonitorProtocol (
+               &gEfiBlockIoProtocolGuid,
+               ScanCacheBlockIoArrived,
+               &BlockIoEvent,
+               &mScanCacheBlockIoEventKey
+               );
+    if (EFI_ERROR (Status)) {
+      //
+      // Closing the event also drops its notify registration, so the next
+      // scan starts over without leaving a duplicate behind.
+      //
+      gBS->CloseEvent (FsEvent);
+      mScanCacheFsEventKey = NULL;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCB: Scan cache disabled, no volume monitoring - %r\n", Status));
+    return FALSE;
+  }
+
+  mScanCacheMonitored = TRUE;
+  return TRUE;
+}
+
+STATIC
+VOID
+ScanCacheGetIdentity (
+  IN  EFI_HANDLE  Handle,
+  OUT EFI_GUID    *PartitionUuid,
+  OUT UINT32      *MediaId
+  )
+{
+  EFI_STATUS                 Status;
+  CONST EFI_PARTITION_ENTRY  *PartitionEntry;
+  EFI_BLOCK_IO_PROTOCOL      *BlockIo;
+
+  PartitionEntry = OcGetGptPartitionEntry (Handle);
+  if (PartitionEntry != NULL) {
+    CopyGuid (PartitionUuid, &PartitionEntry->UniquePartitionGUID);
+  } else {
+    ZeroMem (PartitionUuid, sizeof (*PartitionUuid));
+  }
+
+  Status = gBS->HandleProtocol (
+                  Handle,
+                  &gEfiBlockIoProtocolGuid,
+                  (VOID **)&BlockIo
+                  );
+  if (!EFI_ERROR (Status) && (BlockIo->Media != NULL)) {
+    *MediaId = BlockIo->Media->MediaId;
+  } else {
+    *MediaId = 0;
+  }
+}
+
+STATIC
+VOID
+ScanCacheFreeEntry (
+  IN INTERNAL_SCAN_CACHE_ENTRY  *Entry
+  )
+{
+  LIST_ENTRY                      *Link;
+  INTERNAL_SCAN_CACHE_VISIBILITY  *Visibility;
+
+  RemoveEntryList (&Entry->Link);
+
+  while (!IsListEmpty (&Entry->Visibility)) {
+    Link       = GetFirstNode (&Entry->Visibility);
+    Visibility = BASE_CR (Link, INTERNAL_SCAN_CACHE_VISIBILITY, Link);
+    RemoveEntryList (Link);
+    FreePool (Visibility->DevicePath);
+    FreePool (Visibility);
+  }
+
+  if (Entry->BlessDevicePath != NULL) {
+    FreePool (Entry->BlessDevicePath);
+  }
+
+  FreePool (Entry);
+}
+
+/**
+  Find valid cache entry for the filesystem, dropping it if the volume changed.
+
+  @param[in] Handle   Filesystem handle.
+  @param[in] Create   Allocate new entry when none is found.
+
+  @returns Cache entry or NULL.
+**/
+STATIC
+INTERNAL_SCAN_CACHE_ENTRY *
+ScanCacheLookup (
+  IN EFI_HANDLE  Handle,
+  IN BOOLEAN     Create
+  )
+{
+  EFI_TPL                    OldTpl;
+  LIST_ENTRY                 *Link;
+  INTERNAL_SCAN_CACHE_ENTRY  *Entry;
+  INTERNAL_SCAN_CACHE_ENTRY  *Found;
+  EFI_GUID                   PartitionUuid;
+  UINT32                     MediaId;
+
+  if (!ScanCacheIsUsable ()) {
+    return NULL;
+  }
+
+  ScanCacheGetIdentity (Handle, &PartitionUuid, &MediaId);
+
+  Found  = NULL;
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  for (
+       Link = GetFirstNode (&mScanCache);
+       !IsNull (&mScanCache, Link);
+       Link = GetNextNode (&mScanCache, Link))
+  {
+    Entry = BASE_CR (Link, INTERNAL_SCAN_CACHE_ENTRY, Link);
+    if (Entry->Handle == Handle) {
+      if (  Entry->Stale
+         || (Entry->MediaId != MediaId)
+         || !CompareGuid (&Entry->PartitionUuid, &PartitionUuid))
+      {
+        DEBUG ((DEBUG_INFO, "OCB: Dropping stale scan cache for fs %p\n", Handle));
+        ScanCacheFreeEntry (Entry);
+      } else {
+        Found = Entry;
+      }
+
+      break;
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if ((Found != NULL) || !Create) {
+    return Found;
+  }
+
+  Found = AllocateZeroPool (sizeof (*Found));
+  if (Found == NULL) {
+    return NULL;
+  }
+
+  Found->Handle  = Handle;
+  Found->MediaId = MediaId;
+  CopyGuid (&Found->PartitionUuid, &PartitionUuid);
+  InitializeListHead (&Found->Visibility);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  InsertTailList (&mScanCache, &Found->Link);
+  gBS->RestoreTPL (OldTpl);
+
+  return Found;
+}
+
+EFI_STATUS
+InternalScanCacheCheckScanPolicy (
+  IN  EFI_HANDLE  Handle,
+  IN  UINT32      Policy,
+  OUT BOOLEAN     *External OPTIONAL
+  )
+{
+  INTERNAL_SCAN_CACHE_ENTRY  *Entry;
+  EFI_STATUS                 Status;
+  BOOLEAN                    IsExternal;
+
+  Entry = ScanCacheLookup (Handle, TRUE);
+  if ((Entry != NULL) && Entry->HasPolicy && (Entry->ScanPolicy == Policy)) {
+    ++mScanCacheHits;
+    if (External != NULL) {
+      *External = Entry->IsExternal;
+    }
+
+    return Entry->PolicyStatus;
+  }
+
+  ++mScanCacheMisses;
+
+  IsExternal = FALSE;
+  Status     = InternalCheckScanPolicy (Handle, Policy, &IsExternal);
+
+  if (Entry != NULL) {
+    Entry->HasPolicy    = TRUE;
+    Entry->ScanPolicy   = Policy;
+    Entry->PolicyStatus = Status;
+    Entry->IsExternal   = IsExternal;
+  }
+
+  if (External != NULL) {
+    *External = IsExternal;
+  }
+
+  return Status;
+}
+
+BOOLEAN
+InternalScanCacheGetBless (
+  IN  EFI_HANDLE                Handle,
+  IN  CONST CHAR16              **PredefinedPaths,
+  IN  UINTN                     NumPredefinedPaths,
+  OUT EFI_STATUS                *Status,
+  OUT EFI_DEVICE_PATH_PROTOCOL  **DevicePath
+  )
+{
+  INTERNAL_SCAN_CACHE_ENTRY  *Entry;
+
+  Entry = ScanCacheLookup (Handle, FALSE);
+  if (  (Entry == NULL)
+     || !Entry->HasBless
+     || (Entry->BlessPaths != PredefinedPaths)
+     || (Entry->NumBlessPaths != NumPredefinedPaths))
+  {
+    ++mScanCacheMisses;
+    return FALSE;
+  }
+
+  *Status = Entry->BlessStatus;
+  if (!EFI_ERROR (*Status)) {
+    *DevicePath = DuplicateDevicePath (Entry->BlessDevicePath);
+    if (*DevicePath == NULL) {
+      return FALSE;
+    }
+  }
+
+  ++mScanCacheHits;
+  DEBUG ((DEBUG_INFO, "OCB: Using cached bless for fs %p - %r\n", Handle, *Status));
+  return TRUE;
+}
+
+VOID
+InternalScanCacheSetBless (
+  IN EFI_HANDLE                Handle,
+  IN CONST CHAR16              **PredefinedPaths,
+  IN UINTN                     NumPredefinedPaths,
+  IN EFI_STATUS                Status,
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath  OPTIONAL
+  )
+{
+  INTERNAL_SCAN_CACHE_ENTRY  *Entry;
+  EFI_DEVICE_PATH_PROTOCOL   *CachedPath;
+
+  Entry = ScanCacheLookup (Handle, TRUE);
+  if (Entry == NULL) {
+    return;
+  }
+
+  CachedPath = NULL;
+  if (!EFI_ERROR (Status)) {
+    ASSERT (DevicePath != NULL);
+    CachedPath = DuplicateDevicePath (DevicePath);
+    if (CachedPath == NULL) {
+      return;
+    }
+  }
+
+  if (Entry->BlessDevicePath != NULL) {
+    FreePool (Entry->BlessDevicePath);
+  }
+
+  Entry->HasBless        = TRUE;
+  Entry->BlessPaths      = PredefinedPaths;
+  Entry->NumBlessPaths   = NumPredefinedPaths;
+  Entry->BlessStatus     = Status;
+  Entry->BlessDevicePath = CachedPath;
+}
+
+/**
+  Find cache entry of the filesystem containing the device path.
+**/
+STATIC
+INTERNAL_SCAN_CACHE_ENTRY *
+ScanCacheLookupByDevicePath (
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath,
+  IN BOOLEAN                   Create
+  )
+{
+  EFI_STATUS                Status;
+  EFI_DEVICE_PATH_PROTOCOL  *RemainingDevicePath;
+  EFI_HANDLE                Handle;
+
+  RemainingDevicePath = DevicePath;
+  Status              = gBS->LocateDevicePath (
+                               &gEfiSimpleFileSystemProtocolGuid,
+                               &RemainingDevicePath,
+                               &Handle
+                               );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  return ScanCacheLookup (Handle, Create);
+}
+
+BOOLEAN
+InternalScanCacheGetVisibility (
+  IN  EFI_DEVICE_PATH_PROTOCOL   *DevicePath,
+  OUT INTERNAL_ENTRY_VISIBILITY  *Visibility
+  )
+{
+  INTERNAL_SCAN_CACHE_ENTRY       *Entry;
+  LIST_ENTRY                      *Link;
+  INTERNAL_SCAN_CACHE_VISIBILITY  *Cached;
+
+  Entry = ScanCacheLookupByDevicePath (DevicePath, FALSE);
+  if (Entry == NULL) {
+    ++mScanCacheMisses;
+    return FALSE;
+  }
+
+  for (
+       Link = GetFirstNode (&Entry->Visibility);
+       !IsNull (&Entry->Visibility, Link);
+       Link = GetNextNode (&Entry->Visibility, Link))
+  {
+    Cached = BASE_CR (Link, INTERNAL_SCAN_CACHE_VISIBILITY, Link);
+    if (IsDevicePathEqual (Cached->DevicePath, DevicePath)) {
+      ++mScanCacheHits;
+      *Visibility = Cached->Visibility;
+      return TRUE;
+    }
+  }
+
+  ++mScanCacheMisses;
+  return FALSE;
+}
+
+VOID
+InternalScanCacheSetVisibility (
+  IN EFI_DEVICE_PATH_PROTOCOL   *DevicePath,
+  IN INTERNAL_ENTRY_VISIBILITY  Visibility
+  )
+{
+  INTERNAL_SCAN_CACHE_ENTRY       *Entry;
+  INTERNAL_SCAN_CACHE_VISIBILITY  *Cached;
+
+  Entry = ScanCacheLookupByDevicePath (DevicePath, TRUE);
+  if (Entry == NULL) {
+    return;
+  }
+
+  Cached = AllocatePool (sizeof (*Cached));
+  if (Cached == NULL) {
+    return;
+  }
+
+  Cached->DevicePath = DuplicateDevicePath (DevicePath);
+  if (Cached->DevicePath == NULL) {
+    FreePool (Cached);
+    return;
+  }
+
+  Cached->Visibility = Visibility;
+  InsertTailList (&Entry->Visibility, &Cached->Link);
+}
+
+VOID
+InternalScanCacheInvalidate (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCB: Flushing scan cache (hits %u, misses %u)\n",
+    (UINT32)mScanCacheHits,
+    (UINT32)mScanCacheMisses
+    ));
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  while (!IsListEmpty (&mScanCache)) {
+    ScanCacheFreeEntry (BASE_CR (GetFirstNode (&mScanCache), INTERNAL_SCAN_CACHE_ENTRY, Link));
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  mScanCacheHits   = 0;
+  mScanCacheMisses = 0;
+}
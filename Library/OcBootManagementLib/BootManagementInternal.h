@@ -131,6 +131,96 @@ InternalCheckScanPolicy (
   OUT BOOLEAN     *External OPTIONAL
   );
 
+/**
+  Check filesystem scan policy, reusing the result of previous scans
+  unless the volume changed since then.
+
+  @param[in]  Handle     Filesystem handle.
+  @param[in]  Policy     Scan policy.
+  @param[out] External   Whether the filesystem is external, optional.
+
+  @retval EFI_SUCCESS when the filesystem is allowed by the policy.
+**/
+EFI_STATUS
+InternalScanCacheCheckScanPolicy (
+  IN  EFI_HANDLE  Handle,
+  IN  UINT32      Policy,
+  OUT BOOLEAN     *External OPTIONAL
+  );
+
+/**
+  Obtain cached bless lookup result for the filesystem.
+
+  @param[in]  Handle               Filesystem handle.
+  @param[in]  PredefinedPaths      Predefined boot file locations used for lookup.
+  @param[in]  NumPredefinedPaths   Number of elements in PredefinedPaths.
+  @param[out] Status               Cached lookup status.
+  @param[out] DevicePath           Copy of blessed device path on success, caller frees.
+
+  @retval TRUE when cached result was returned.
+**/
+BOOLEAN
+InternalScanCacheGetBless (
+  IN  EFI_HANDLE                Handle,
+  IN  CONST CHAR16              **PredefinedPaths,
+  IN  UINTN                     NumPredefinedPaths,
+  OUT EFI_STATUS                *Status,
+  OUT EFI_DEVICE_PATH_PROTOCOL  **DevicePath
+  );
+
+/**
+  Store bless lookup result for the filesystem.
+
+  @param[in]  Handle               Filesystem handle.
+  @param[in]  PredefinedPaths      Predefined boot file locations used for lookup.
+  @param[in]  NumPredefinedPaths   Number of elements in PredefinedPaths.
+  @param[in]  Status               Lookup status.
+  @param[in]  DevicePath           Blessed device path on success.
+**/
+VOID
+InternalScanCacheSetBless (
+  IN EFI_HANDLE                Handle,
+  IN CONST CHAR16              **PredefinedPaths,
+  IN UINTN                     NumPredefinedPaths,
+  IN EFI_STATUS                Status,
+  IN EFI_DEVICE_PATH_PROTOCOL  *DevicePath  OPTIONAL
+  );
+
+/**
+  Obtain cached visibility of the boot path.
+
+  @param[in]  DevicePath   Boot entry device path.
+  @param[out] Visibility   Cached visibility.
+
+  @retval TRUE when cached visibility was returned.
+**/
+BOOLEAN
+InternalScanCacheGetVisibility (
+  IN  EFI_DEVICE_PATH_PROTOCOL   *DevicePath,
+  OUT INTERNAL_ENTRY_VISIBILITY  *Visibility
+  );
+
+/**
+  Store visibility of the boot path.
+
+  @param[in]  DevicePath   Boot entry device path.
+  @param[in]  Visibility   Entry visibility.
+**/
+VOID
+InternalScanCacheSetVisibility (
+  IN EFI_DEVICE_PATH_PROTOCOL   *DevicePath,
+  IN INTERNAL_ENTRY_VISIBILITY  Visibility
+  );
+
+/**
+  Drop all cached scan results, e.g. after launching an entry,
+  which may have changed volume contents.
+**/
+VOID
+InternalScanCacheInvalidate (
+  VOID
+  );
+
 EFI_DEVICE_PATH_PROTOCOL *
 InternalLoadDmg (
   IN OUT INTERNAL_DMG_LOAD_CONTEXT            *Context,
@@ -108,76 +108,74 @@ InternalGetFirstDeviceBootFilePath (
 }
 
 STATIC
-EFI_DEVICE_PATH_PROTOCOL *
-InternalGetDiskImageBootFile (
-  OUT INTERNAL_DMG_LOAD_CONTEXT  *Context,
-  IN  OC_DMG_LOADING_SUPPORT     DmgLoading,
-  IN  UINTN                      DmgFileSize,
-  IN  VOID                       *ChunklistBuffer OPTIONAL,
-  IN  UINT32                     ChunklistBufferSize OPTIONAL
+BOOLEAN
+InternalInitializeDmgChunklist (
+  OUT OC_APPLE_CHUNKLIST_CONTEXT  *ChunklistContext,
+  IN  VOID                        *ChunklistBuffer OPTIONAL,
+  IN  UINT32                      ChunklistBufferSize OPTIONAL
   )
 {
-  EFI_DEVICE_PATH_PROTOCOL  *DevPath;
-
-  BOOLEAN                     Result;
-  OC_APPLE_CHUNKLIST_CONTEXT  ChunklistContext;
-
-  CONST EFI_DEVICE_PATH_PROTOCOL  *DmgDevicePath;
-  UINTN                           DmgDevicePathSize;
+  BOOLEAN  Result;
 
-  ASSERT (Context != NULL);
-  ASSERT (DmgFileSize > 0);
+  ASSERT (ChunklistContext != NULL);
 
-  if (DmgLoading == OcDmgLoadingAppleSigned) {
-    if (ChunklistBuffer == NULL) {
-      DEBUG ((DEBUG_WARN, "OCB: Missing DMG signature, aborting\n"));
-      return NULL;
-    }
+  if (ChunklistBuffer == NULL) {
+    DEBUG ((DEBUG_WARN, "OCB: Missing DMG signature, aborting\n"));
+    return FALSE;
+  }
 
-    ASSERT (ChunklistBufferSize > 0);
+  ASSERT (ChunklistBufferSize > 0);
+
+  Result = OcAppleChunklistInitializeContext (
+             ChunklistContext,
+             ChunklistBuffer,
+             ChunklistBufferSize
+             );
+  if (!Result) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCB: Failed to initialise DMG Chunklist context\n"
+      ));
+    return FALSE;
+  }
 
-    Result = OcAppleChunklistInitializeContext (
-               &ChunklistContext,
-               ChunklistBuffer,
-               ChunklistBufferSize
-               );
-    if (!Result) {
-      DEBUG ((
-        DEBUG_INFO,
-        "OCB: Failed to initialise DMG Chunklist context\n"
-        ));
-      return NULL;
-    }
+  //
+  // FIXME: Properly abstract OcAppleKeysLib.
+  //
+  Result = OcAppleChunklistVerifySignature (
+             ChunklistContext,
+             PkDataBase[0].PublicKey
+             );
 
-    //
-    // FIXME: Properly abstract OcAppleKeysLib.
-    //
+  if (!Result) {
     Result = OcAppleChunklistVerifySignature (
-               &ChunklistContext,
-               PkDataBase[0].PublicKey
+               ChunklistContext,
+               PkDataBase[1].PublicKey
                );
+  }
 
-    if (!Result) {
-      Result = OcAppleChunklistVerifySignature (
-                 &ChunklistContext,
-                 PkDataBase[1].PublicKey
-                 );
-    }
+  if (!Result) {
+    DEBUG ((DEBUG_WARN, "OCB: DMG is not trusted, aborting\n"));
+    return FALSE;
+  }
 
-    if (!Result) {
-      DEBUG ((DEBUG_WARN, "OCB: DMG is not trusted, aborting\n"));
-      return NULL;
-    }
+  return TRUE;
+}
 
-    Result = OcAppleDiskImageVerifyData (
-               Context->DmgContext,
-               &ChunklistContext
-               );
-    if (!Result) {
-      DEBUG ((DEBUG_WARN, "OCB: DMG has been altered\n"));
-      return NULL;
-    }
-  }
+STATIC
+EFI_DEVICE_PATH_PROTOCOL *
+InternalGetDiskImageBootFile (
+  OUT INTERNAL_DMG_LOAD_CONTEXT  *Context,
+  IN  UINTN                      DmgFileSize
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL  *DevPath;
+
+  CONST EFI_DEVICE_PATH_PROTOCOL  *DmgDevicePath;
+  UINTN                           DmgDevicePathSize;
+
+  ASSERT (Context != NULL);
+  ASSERT (DmgFileSize > 0);
 
   Context->BlockIoHandle = OcAppleDiskImageInstallBlockIo (
                              Context->DmgContext,
@@ -339,6 +337,8 @@ InternalLoadDmg (
   UINT32             ChunklistFileSize;
   VOID               *ChunklistBuffer;
 
+  OC_APPLE_CHUNKLIST_CONTEXT  ChunklistContext;
+
   CHAR16  *DevPathText;
 
   ASSERT (Context != NULL);
@@ -414,28 +414,6 @@ InternalLoadDmg (
         return NULL;
       }
     }
-
-    Context->DmgContext = AllocatePool (sizeof (*Context->DmgContext));
-    if (Context->DmgContext == NULL) {
-      DEBUG ((DEBUG_INFO, "OCB: Failed to allocate DMG context\n"));
-      return NULL;
-    }
-
-    Result = OcAppleDiskImageInitializeFromFile (Context->DmgContext, DmgFile);
-
-    DmgFile->Close (DmgFile);
-
-    if (!Result) {
-      DEBUG ((DEBUG_INFO, "OCB: Failed to initialise DMG from file\n"));
-
-      if (DmgPreloadContext->DmgFile == NULL) {
-        FreePool (DmgFileInfo);
-        DmgDir->Close (DmgDir);
-      }
-
-      FreePool (Context->DmgContext);
-      return NULL;
-    }
   }
 
   ChunklistBuffer   = NULL;
@@ -492,13 +470,71 @@ InternalLoadDmg (
     DmgDir->Close (DmgDir);
   }
 
-  DevPath = InternalGetDiskImageBootFile (
-              Context,
-              DmgLoading,
-              DmgFileSize,
-              ChunklistBuffer,
-              ChunklistFileSize
-              );
+  //
+  // Verify the chunklist signature before loading the DMG, so that the chunks
+  // can be verified while they are read and a DMG which is not trusted
+  // is not loaded at all.
+  //
+  if (DmgLoading == OcDmgLoadingAppleSigned) {
+    Result = InternalInitializeDmgChunklist (
+               &ChunklistContext,
+               ChunklistBuffer,
+               ChunklistFileSize
+               );
+  } else {
+    Result = TRUE;
+  }
+
+  if (DmgPreloadContext->DmgContext == NULL) {
+    if (Result) {
+      Context->DmgContext = AllocatePool (sizeof (*Context->DmgContext));
+      if (Context->DmgContext == NULL) {
+        DEBUG ((DEBUG_INFO, "OCB: Failed to allocate DMG context\n"));
+        Result = FALSE;
+      }
+    }
+
+    if (Result && (DmgLoading == OcDmgLoadingAppleSigned) && DmgPreloadContext->DmgFileVerified) {
+      DEBUG ((DEBUG_INFO, "OCB: DMG chunks were verified while downloading\n"));
+    }
+
+    if (Result) {
+      Result = OcAppleDiskImageInitializeFromFile (
+                 Context->DmgContext,
+                 DmgFile,
+                 ((DmgLoading == OcDmgLoadingAppleSigned) && !DmgPreloadContext->DmgFileVerified) ? &ChunklistContext : NULL
+                 );
+      if (!Result) {
+        DEBUG ((DEBUG_INFO, "OCB: Failed to initialise DMG from file\n"));
+        FreePool (Context->DmgContext);
+      }
+    }
+
+    DmgFile->Close (DmgFile);
+
+    if (!Result) {
+      if (ChunklistBuffer != NULL) {
+        FreePool (ChunklistBuffer);
+      }
+
+      return NULL;
+    }
+  } else if (Result && (DmgLoading == OcDmgLoadingAppleSigned)) {
+    Result = OcAppleDiskImageVerifyData (
+               Context->DmgContext,
+               &ChunklistContext
+               );
+    if (!Result) {
+      DEBUG ((DEBUG_WARN, "OCB: DMG has been altered\n"));
+    }
+  }
+
+  if (Result) {
+    DevPath = InternalGetDiskImageBootFile (Context, DmgFileSize);
+  } else {
+    DevPath = NULL;
+  }
+
   Context->DevicePath = DevPath;
 
   if (DevPath != NULL) {
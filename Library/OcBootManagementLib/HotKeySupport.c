@@ -273,9 +273,10 @@ GetPickerKeyInfo (
   }
 
   //
-  // Apple Event typing
+  // Apple Event typing, the previous key has been handled and drawn by now.
   //
   Keys = &Key;
+  OcRecordKeyLatency (Context->HotKeyContext->TypingContext);
   OcGetNextKeystroke (Context->HotKeyContext->TypingContext, &Modifiers, Keys, &UnicodeChar);
   if (*Keys == 0) {
     NumKeys = 0;
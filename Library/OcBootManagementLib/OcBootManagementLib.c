@@ -342,7 +342,9 @@ OcRunBootPicker (
        || IsApplePickerSelection
           )
     {
+      OcTraceBegin ("OcScanForDefaultBootEntry");
       BootContext = OcScanForDefaultBootEntry (Context, IsApplePickerSelection);
+      OcTraceEnd ("OcScanForDefaultBootEntry");
     } else {
       ASSERT (
         Context->PickerCommand == OcPickerShowPicker
@@ -350,7 +352,9 @@ OcRunBootPicker (
              || Context->PickerCommand == OcPickerBootAppleRecovery
         );
 
+      OcTraceBegin ("OcScanForBootEntries");
       BootContext = OcScanForBootEntries (Context);
+      OcTraceEnd ("OcScanForBootEntries");
     }
 
     //
@@ -509,6 +513,11 @@ OcRunBootPicker (
 
       OcRestoreNvramProtection (FwRuntime);
 
+      //
+      // Launched entry may have changed bless, visibility or volume contents.
+      //
+      InternalScanCacheInvalidate ();
+
       //
       // Do not wait on successful return code.
       //
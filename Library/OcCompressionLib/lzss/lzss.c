@@ -86,6 +86,11 @@ struct encode_state {
 
 
 /*******************************************************************************
+ * Matches are resolved straight from the output buffer instead of copying
+ * every byte through the ring buffer. Ring position r holds output byte
+ * r - (N - F) modulo N, and positions not written yet hold spaces, so match
+ * distance is derived from the ring position and bytes preceding the output
+ * read as spaces.
 *******************************************************************************/
 u_int32_t decompress_lzss(
     u_int8_t       * dst,
@@ -93,45 +98,64 @@ u_int32_t decompress_lzss(
     u_int8_t       * src,
     u_int32_t        srclen)
 {
-    /* ring buffer of size N, with extra F-1 bytes to aid string comparison */
-    u_int8_t text_buf[N + F - 1];
     u_int8_t * dststart = dst;
     const u_int8_t * dstend = dst + dstlen;
     const u_int8_t * srcend = src + srclen;
-    int  i, j, k, r;
-    u_int8_t c;
+    const u_int8_t * match;
+    u_int32_t i, j, k, dist, written;
     unsigned int flags;
 
     if (dstlen > OC_COMPRESSION_MAX_LENGTH || srclen > OC_COMPRESSION_MAX_LENGTH) {
         return 0;
     }
 
-    dst = dststart;
-    memset(text_buf, ' ', N - F);
-    r = N - F;
     flags = 0;
     for ( ; ; ) {
         if (((flags >>= 1) & 0x100) == 0) {
-            if (src < srcend) c = *src++; else break;
-            flags = c | 0xFF00;  /* uses higher byte cleverly */
-        }   /* to count eight */
+            if (src < srcend) flags = *src++ | 0xFF00; else break;
+            /* eight literals in a row */
+            if (flags == 0xFFFF && srcend - src >= 8 && dstend - dst >= 8) {
+                lzss_copy(dst, src, 8);
+                src += 8;
+                dst += 8;
+                flags = 0;
+                continue;
+            }
+        }
         if (flags & 1) {
-            if (src < srcend) c = *src++; else break;
-            if (dst < dstend) *dst++ = c; else break;
-            text_buf[r++] = c;
-            r &= (N - 1);
+            if (src >= srcend || dst >= dstend) break;
+            *dst++ = *src++;
+            continue;
+        }
+        if (srcend - src < 2) break;
+        i = src[0] | ((src[1] & 0xF0) << 4);
+        j = (src[1] & 0x0F) + THRESHOLD + 1;
+        src += 2;
+
+        written = (u_int32_t)(dst - dststart);
+        dist = (written + N - F - i) & (N - 1);
+        if (dist == 0) dist = N;
+        if (j > (u_int32_t)(dstend - dst)) j = (u_int32_t)(dstend - dst);
+
+        if (dist > written) {
+            for (k = 0; k < j; k++)
+                dst[k] = (written + k < dist) ? ' ' : dststart[written + k - dist];
+        } else if (dist >= 16 && dstend - dst >= 32) {
+            /* F is 18, so two copies always cover the match */
+            match = dst - dist;
+            lzss_copy(dst, match, 16);
+            if (j > 16) lzss_copy(dst + 16, match + 16, 16);
+        } else if (dist >= 8 && dstend - dst >= 24) {
+            match = dst - dist;
+            for (k = 0; k < j; k += 8)
+                lzss_copy(dst + k, match + k, 8);
         } else {
-            if (src < srcend) i = *src++; else break;
-            if (src < srcend) j = *src++; else break;
-            i |= ((j & 0xF0) << 4);
-            j  =  (j & 0x0F) + THRESHOLD;
-            for (k = 0; k <= j; k++) {
-                c = text_buf[(i + k) & (N - 1)];
-                if (dst < dstend) *dst++ = c; else break;
-                text_buf[r++] = c;
-                r &= (N - 1);
-            }
+            match = dst - dist;
+            for (k = 0; k < j; k++)
+                dst[k] = match[k];
         }
+        dst += j;
+        if (dst == dstend) break;
     }
 
     return (u_int32_t)(dst - dststart);
@@ -148,10 +172,14 @@ u_int32_t decompress_lzss(
  * Note there are 256 trees. */
 static void init_state(struct encode_state *sp)
 {
+    int  i;
+
     bzero(sp, sizeof(*sp));
     memset(&sp->text_buf[0], ' ', N - F);
-    bzero(&sp->rchild[N + 1], 256 * sizeof(sp->rchild[0]));
-    bzero(&sp->parent[0], N * sizeof(sp->parent[0]));
+    for (i = N + 1; i <= N + 256; i++)
+        sp->rchild[i] = NIL;
+    for (i = 0; i < N; i++)
+        sp->parent[i] = NIL;
 }
 
 /*
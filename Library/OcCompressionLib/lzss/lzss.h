@@ -59,4 +59,13 @@ typedef UINT32 u_int32_t;
 #endif
 #define bzero(Dst, Size) ZeroMem ((Dst), (Size))
 
+//
+// Small constant size copies are inlined by the compiler.
+//
+#if defined(__GNUC__) || defined(__clang__)
+#define lzss_copy(Dst, Src, Size) __builtin_memcpy ((Dst), (Src), (Size))
+#else
+#define lzss_copy(Dst, Src, Size) CopyMem ((Dst), (Src), (Size))
+#endif
+
 #endif // LZSS_H
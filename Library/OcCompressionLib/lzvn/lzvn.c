@@ -76,32 +76,55 @@ typedef struct {
 
 } lzvn_decoder_state;
 
+/*! @abstract Fixed size copy, inlined by the compiler where possible (memcpy
+ * may be an out of line CopyMem call in firmware builds). */
+#if defined(__GNUC__) || defined(__clang__)
+#  define lzvn_memcpy __builtin_memcpy
+#else
+#  define lzvn_memcpy memcpy
+#endif
+
 /*! @abstract Load bytes from memory location SRC. */
 LZFSE_INLINE uint16_t load2(const void *ptr) {
   uint16_t data;
-  memcpy(&data, ptr, sizeof data);
+  lzvn_memcpy(&data, ptr, sizeof data);
   return data;
 }
 
 LZFSE_INLINE uint32_t load4(const void *ptr) {
   uint32_t data;
-  memcpy(&data, ptr, sizeof data);
+  lzvn_memcpy(&data, ptr, sizeof data);
   return data;
 }
 
 LZFSE_INLINE uint64_t load8(const void *ptr) {
   uint64_t data;
-  memcpy(&data, ptr, sizeof data);
+  lzvn_memcpy(&data, ptr, sizeof data);
   return data;
 }
 
 /*! @abstract Store bytes to memory location DST. */
 LZFSE_INLINE void store4(void *ptr, uint32_t data) {
-  memcpy(ptr, &data, sizeof data);
+  lzvn_memcpy(ptr, &data, sizeof data);
 }
 
 LZFSE_INLINE void store8(void *ptr, uint64_t data) {
-  memcpy(ptr, &data, sizeof data);
+  lzvn_memcpy(ptr, &data, sizeof data);
+}
+
+/*! @abstract Copy 16 or 32 bytes from SRC to DST. All bytes are loaded before
+ * storing, so SRC must not overlap the stored range, i.e. DST - SRC must be
+ * at least the copy size. */
+LZFSE_INLINE void copy16(void *dst, const void *src) {
+  unsigned char data[16];
+  lzvn_memcpy(data, src, sizeof data);
+  lzvn_memcpy(dst, data, sizeof data);
+}
+
+LZFSE_INLINE void copy32(void *dst, const void *src) {
+  unsigned char data[32];
+  lzvn_memcpy(data, src, sizeof data);
+  lzvn_memcpy(dst, data, sizeof data);
 }
 
 /*! @abstract Extracts \p width bits from \p container, starting with \p lsb; if
@@ -542,14 +565,35 @@ copy_match:
   //
   //  i.e. it splats the previous byte. This means that we need to be very
   //  careful about using wide loads or stores to perform the copy operation.
-  if (__builtin_expect(dst_len >= M + 7 && D >= 8, 1)) {
+  if (__builtin_expect(dst_len >= M + 31 && D >= 32, 1)) {
     //  We are not near the end of the buffer, and the match distance
-    //  is at least eight. Thus, we can safely loop using eight byte
-    //  copies. The last of these may slop over the intended end of
-    //  the match, but this is OK because we know we have a safety bound
-    //  away from the end of the destination buffer.
+    //  is at least 32. Thus, we can safely loop using 32 byte copies.
+    //  The last of these may slop over the intended end of the match,
+    //  but this is OK because we know we have a safety bound away from
+    //  the end of the destination buffer.
+    for (size_t i = 0; i < M; i += 32)
+      copy32(&dst_ptr[i], dst_ptr + i - D);
+  } else if (dst_len >= M + 15 && D >= 16) {
+    //  Same with 16 byte copies for distances of at least 16.
+    for (size_t i = 0; i < M; i += 16)
+      copy16(&dst_ptr[i], dst_ptr + i - D);
+  } else if (dst_len >= M + 7 && D >= 8) {
+    //  Same with eight byte copies for distances of at least eight.
     for (size_t i = 0; i < M; i += 8)
       store8(&dst_ptr[i], load8(dst_ptr + i - D));
+  } else if (dst_len >= M + 7 && D != 0) {
+    //  The match distance is below eight, so the match is a pattern
+    //  repeating every D bytes. Expand the first eight bytes one by one,
+    //  after which the pattern also repeats every P bytes for the smallest
+    //  multiple P of D that is at least eight, and continue with eight
+    //  byte copies at that distance.
+    size_t P = D;
+    while (P < 8)
+      P += D;
+    for (size_t i = 0; i < 8; ++i)
+      dst_ptr[i] = *(dst_ptr + i - D);
+    for (size_t i = 8; i < M; i += 8)
+      store8(&dst_ptr[i], load8(dst_ptr + i - P));
   } else if (M <= dst_len) {
     //  Either the match distance is too small, or we are too close to
     //  the end of the buffer to safely use eight byte copies. Fall back
@@ -616,6 +660,10 @@ sml_m:
     return; // source truncated
   M = (size_t)extract(opc, 0, 4);
   PTR_LEN_INC(src_ptr, src_len, opc_len);
+  //  A match before any previous distance would copy the output onto
+  //  itself and expose stale destination contents, reject it.
+  if (D == 0)
+    goto invalid_match_distance;
   goto copy_match;
 
 #if HAVE_LABELS_AS_VALUES
@@ -634,6 +682,8 @@ lrg_m:
     return; // source truncated
   M = src_ptr[1] + 16;
   PTR_LEN_INC(src_ptr, src_len, opc_len);
+  if (D == 0)
+    goto invalid_match_distance;
   goto copy_match;
 
 // ===============================================================
@@ -693,10 +743,14 @@ copy_literal:
     return; // source truncated
   PTR_LEN_INC(src_ptr, src_len, opc_len);
   //  Now we copy the literal from the source pointer to the destination.
-  if (dst_len >= L + 7 && src_len >= L + 7) {
+  if (dst_len >= L + 31 && src_len >= L + 31) {
     //  We are not near the end of the source or destination buffers; thus
     //  we can safely copy the literal using wide copies, without worrying
     //  about reading or writing past the end of either buffer.
+    for (size_t i = 0; i < L; i += 32)
+      copy32(&dst_ptr[i], &src_ptr[i]);
+  } else if (dst_len >= L + 7 && src_len >= L + 7) {
+    //  Same with eight byte copies closer to the end of the buffers.
     for (size_t i = 0; i < L; i += 8)
       store8(&dst_ptr[i], load8(&src_ptr[i]));
   } else if (L <= dst_len) {
@@ -31,7 +31,7 @@ OC_STRUCTORS (OC_BOOTER_QUIRKS, ())
 OC_STRUCTORS (OC_BOOTER_CONFIG, ())
 
 OC_MAP_STRUCTORS (OC_DEV_PROP_ADD_MAP)
-OC_STRUCTORS (OC_DEV_PROP_DELETE_ENTRY, ())
+OC_ARRAY_STRUCTORS (OC_DEV_PROP_DELETE_ENTRY)
 OC_MAP_STRUCTORS (OC_DEV_PROP_DELETE_MAP)
 OC_STRUCTORS (OC_DEV_PROP_CONFIG, ())
 
@@ -58,9 +58,9 @@ OC_ARRAY_STRUCTORS (OC_MISC_TOOLS_ARRAY)
 OC_STRUCTORS (OC_MISC_CONFIG, ())
 
 OC_MAP_STRUCTORS (OC_NVRAM_ADD_MAP)
-OC_STRUCTORS (OC_NVRAM_DELETE_ENTRY, ())
+OC_ARRAY_STRUCTORS (OC_NVRAM_DELETE_ENTRY)
 OC_MAP_STRUCTORS (OC_NVRAM_DELETE_MAP)
-OC_STRUCTORS (OC_NVRAM_LEGACY_ENTRY, ())
+OC_ARRAY_STRUCTORS (OC_NVRAM_LEGACY_ENTRY)
 OC_MAP_STRUCTORS (OC_NVRAM_LEGACY_MAP)
 OC_STRUCTORS (OC_NVRAM_CONFIG, ())
 
@@ -898,6 +898,37 @@ OC_SCHEMA_INFO
   .Dict = { mRootConfigurationNodes, ARRAY_SIZE (mRootConfigurationNodes) }
 };
 
+//
+// Root configuration storage in mRootConfigurationNodes order.
+//
+typedef struct {
+  UINT32         Offset;
+  UINT32         Size;
+  OC_STRUCTOR    Construct;
+  OC_STRUCTOR    Destruct;
+} OC_CONFIG_SECTION;
+
+#define OC_CONFIG_SECTION_ENTRY(Type, Field) \
+  { OFFSET_OF (OC_GLOBAL_CONFIG, Field), sizeof (Type), Type ## _CONSTRUCT, Type ## _DESTRUCT }
+
+STATIC
+CONST OC_CONFIG_SECTION
+  mConfigurationSections[] = {
+  OC_CONFIG_SECTION_ENTRY (OC_ACPI_CONFIG,     Acpi),
+  OC_CONFIG_SECTION_ENTRY (OC_BOOTER_CONFIG,   Booter),
+  OC_CONFIG_SECTION_ENTRY (OC_DEV_PROP_CONFIG, DeviceProperties),
+  OC_CONFIG_SECTION_ENTRY (OC_KERNEL_CONFIG,   Kernel),
+  OC_CONFIG_SECTION_ENTRY (OC_MISC_CONFIG,     Misc),
+  OC_CONFIG_SECTION_ENTRY (OC_NVRAM_CONFIG,    Nvram),
+  OC_CONFIG_SECTION_ENTRY (OC_PLATFORM_CONFIG, PlatformInfo),
+  OC_CONFIG_SECTION_ENTRY (OC_UEFI_CONFIG,     Uefi)
+};
+
+STATIC_ASSERT (
+  ARRAY_SIZE (mConfigurationSections) == ARRAY_SIZE (mRootConfigurationNodes),
+  "Configuration sections must match root schema"
+  );
+
 EFI_STATUS
 OcConfigurationInit (
   OUT  OC_GLOBAL_CONFIG  *Config,
@@ -926,3 +957,97 @@ OcConfigurationFree (
 {
   OC_GLOBAL_CONFIG_DESTRUCT (Config, sizeof (*Config));
 }
+
+EFI_STATUS
+OcConfigurationReload (
+  IN OUT  OC_GLOBAL_CONFIG     *Config,
+  IN OUT  VOID                 *Buffer,
+  IN      UINT32               Size,
+  IN OUT  XML_DOCUMENT         **Document,
+  OUT     UINT32               *ChangedSections  OPTIONAL,
+  IN      OC_SERIALIZE_REPORT  Report           OPTIONAL,
+  IN      VOID                 *Context          OPTIONAL,
+  IN OUT  UINT32               *ErrorCount       OPTIONAL
+  )
+{
+  XML_DOCUMENT  *NewDocument;
+  UINT32        Changed;
+  UINT32        Index;
+  VOID          *Section;
+
+  NewDocument = XmlDocumentParse (Buffer, Size, FALSE);
+  if (  (NewDocument == NULL)
+     || (PlistNodeCast (PlistDocumentRoot (NewDocument), PLIST_NODE_TYPE_DICT) == NULL))
+  {
+    DEBUG ((DEBUG_INFO, "OCS: Couldn't parse updated configuration\n"));
+    if (NewDocument != NULL) {
+      XmlDocumentFree (NewDocument);
+    }
+
+    if (ErrorCount != NULL) {
+      ++*ErrorCount;
+    }
+
+    return EFI_UNSUPPORTED;
+  }
+
+  if (*Document == NULL) {
+    OC_GLOBAL_CONFIG_CONSTRUCT (Config, sizeof (*Config));
+    Changed = MAX_UINT32;
+  } else {
+    Changed = DiffSerialized (&mRootConfigurationInfo, *Document, NewDocument, Report, Context);
+
+    for (Index = 0; Index < ARRAY_SIZE (mConfigurationSections); ++Index) {
+      if ((Changed & (1U << Index)) != 0) {
+        Section = (UINT8 *)Config + mConfigurationSections[Index].Offset;
+        mConfigurationSections[Index].Destruct (Section, mConfigurationSections[Index].Size);
+        mConfigurationSections[Index].Construct (Section, mConfigurationSections[Index].Size);
+      }
+    }
+
+    XmlDocumentFree (*Document);
+  }
+
+  DEBUG ((DEBUG_INFO, "OCS: Reparsing configuration sections %X\n", Changed));
+
+  if (Changed != 0) {
+    ParseSerializedSections (Config, &mRootConfigurationInfo, NewDocument, Changed, ErrorCount);
+  }
+
+  *Document = NewDocument;
+
+  if (ChangedSections != NULL) {
+    *ChangedSections = Changed & ((1U << ARRAY_SIZE (mConfigurationSections)) - 1);
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID *
+OcConfigurationExportSnapshot (
+  IN   OC_GLOBAL_CONFIG  *Config,
+  OUT  UINT32            *SnapshotSize
+  )
+{
+  return ExportSerializedSnapshot (Config, &mRootConfigurationInfo, SnapshotSize);
+}
+
+EFI_STATUS
+OcConfigurationInitFromSnapshot (
+  OUT  OC_GLOBAL_CONFIG  *Config,
+  IN   CONST VOID        *Snapshot,
+  IN   UINT32            SnapshotSize
+  )
+{
+  BOOLEAN  Success;
+
+  OC_GLOBAL_CONFIG_CONSTRUCT (Config, sizeof (*Config));
+  Success = ImportSerializedSnapshot (Config, &mRootConfigurationInfo, Snapshot, SnapshotSize);
+
+  if (!Success) {
+    OC_GLOBAL_CONFIG_DESTRUCT (Config, sizeof (*Config));
+    return EFI_UNSUPPORTED;
+  }
+
+  return EFI_SUCCESS;
+}
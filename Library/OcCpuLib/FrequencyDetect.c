@@ -169,9 +169,227 @@ InternalGetPmTimerAddr (
   return TimerAddr;
 }
 
+//
+// Bracketed reads taken for each calibration sample. The one with the shortest
+// TSC bracket is kept, which rejects reads delayed by SMIs or slow I/O.
+//
+#define OC_TSC_CALIBRATION_SAMPLES  8
+
+//
+// 71591 clocks of ACPI timer (20ms) for the provisional estimate.
+//
+#define OC_TSC_ESTIMATE_TICKS  (V_ACPI_TMR_FREQUENCY / 50)
+
+//
+// 357954 clocks of ACPI timer (100ms) as the minimal calibration window.
+//
+#define OC_TSC_CALIBRATION_TICKS  (V_ACPI_TMR_FREQUENCY / 10)
+
+//
+// ACPI PM timers are 24-bit or 32-bit, only the low 24 bits are used.
+//
+#define OC_ACPI_TICKS_MASK  0x00FFFFFFU
+
+typedef struct {
+  UINT64    Tsc;
+  UINT32    AcpiTick;
+} OC_TSC_CALIBRATION_SAMPLE;
+
+//
+// Calibration window start, taken on first use and kept for the whole boot,
+// so that the final measurement can be completed without waiting when enough
+// time has passed.
+//
+STATIC UINT16                     mTscCalibrationTimer;
+STATIC OC_TSC_CALIBRATION_SAMPLE  mTscCalibrationStart;
+STATIC UINT64                     mTscEstimate;
+
+//
+// Set when the estimate was returned while the calibration window is still
+// running, and cleared once a precise request completes calibration.
+//
+STATIC BOOLEAN  mTscEstimatePending;
+
+STATIC
+VOID
+InternalReadTscCalibrationSample (
+  IN  UINT16                     TimerAddr,
+  OUT OC_TSC_CALIBRATION_SAMPLE  *Sample
+  )
+{
+  UINT64   Tsc0;
+  UINT64   Tsc1;
+  UINT64   Bracket;
+  UINT32   AcpiTick;
+  UINT32   Index;
+  BOOLEAN  HasInterrupts;
+
+  Bracket = MAX_UINT64;
+
+  HasInterrupts = SaveAndDisableInterrupts ();
+  for (Index = 0; Index < OC_TSC_CALIBRATION_SAMPLES; ++Index) {
+    Tsc0     = AsmReadTsc ();
+    AcpiTick = IoRead32 (TimerAddr);
+    Tsc1     = AsmReadTsc ();
+
+    if (Tsc1 - Tsc0 < Bracket) {
+      Bracket          = Tsc1 - Tsc0;
+      Sample->Tsc      = Tsc0 + RShiftU64 (Bracket, 1);
+      Sample->AcpiTick = AcpiTick;
+    }
+  }
+
+  if (HasInterrupts) {
+    EnableInterrupts ();
+  }
+}
+
+/**
+  Take calibration window start sample and a provisional estimate.
+
+  @retval TRUE when calibration is started.
+**/
+STATIC
+BOOLEAN
+InternalStartTscCalibration (
+  VOID
+  )
+{
+  UINT16   TimerAddr;
+  UINT64   TscTicksDelta;
+  UINT32   AcpiTick0;
+  UINT32   AcpiTick1;
+  UINT32   AcpiTicksDelta;
+  BOOLEAN  HasInterrupts;
+  EFI_TPL  PrevTpl;
+
+  if (mTscCalibrationTimer != 0) {
+    return TRUE;
+  }
+
+  TimerAddr = (UINT16)InternalGetPmTimerAddr (NULL);
+  if (TimerAddr == 0) {
+    return FALSE;
+  }
+
+  //
+  // Check that timer is advancing (it does not on some virtual machines).
+  //
+  AcpiTick0 = IoRead32 (TimerAddr);
+  gBS->Stall (500);
+  AcpiTick1 = IoRead32 (TimerAddr);
+
+  if (AcpiTick0 == AcpiTick1) {
+    return FALSE;
+  }
+
+  //
+  // Disable all events to ensure that nobody interrupts us.
+  //
+  PrevTpl       = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  HasInterrupts = SaveAndDisableInterrupts ();
+  InternalReadTscCalibrationSample (TimerAddr, &mTscCalibrationStart);
+  AsmMeasureTicks (OC_TSC_ESTIMATE_TICKS, TimerAddr, &AcpiTicksDelta, &TscTicksDelta);
+  if (HasInterrupts) {
+    EnableInterrupts ();
+  }
+
+  gBS->RestoreTPL (PrevTpl);
+
+  mTscEstimate = DivU64x32 (
+                   MultU64x32 (TscTicksDelta, V_ACPI_TMR_FREQUENCY),
+                   AcpiTicksDelta
+                   );
+  if (mTscEstimate == 0) {
+    return FALSE;
+  }
+
+  mTscCalibrationTimer = TimerAddr;
+  return TRUE;
+}
+
+/**
+  Complete calibration over the window since InternalStartTscCalibration,
+  waiting for the window to reach its minimal length.
+
+  @retval  The calculated TSC frequency or 0.
+**/
+STATIC
+UINT64
+InternalFinishTscCalibration (
+  VOID
+  )
+{
+  OC_TSC_CALIBRATION_SAMPLE  End;
+  UINT64                     TscTicksDelta;
+  UINT64                     AcpiTicksDelta;
+  UINT64                     AcpiTicksExpected;
+  UINT32                     AcpiTicksWrapped;
+  UINT32                     AcpiTicksOffset;
+
+  if (mTscCalibrationTimer == 0) {
+    return 0;
+  }
+
+  while (TRUE) {
+    InternalReadTscCalibrationSample (mTscCalibrationTimer, &End);
+
+    //
+    // Very long windows overflow below, start over.
+    //
+    TscTicksDelta = End.Tsc - mTscCalibrationStart.Tsc;
+    if (TscTicksDelta >= DivU64x32 (MAX_UINT64, V_ACPI_TMR_FREQUENCY)) {
+      mTscCalibrationTimer = 0;
+      return 0;
+    }
+
+    //
+    // The timer wraps every 4.6 seconds, use the provisional estimate to tell
+    // the number of wraps and take the closest value with matching low bits.
+    //
+    AcpiTicksExpected = DivU64x64Remainder (
+                          MultU64x32 (TscTicksDelta, V_ACPI_TMR_FREQUENCY),
+                          mTscEstimate,
+                          NULL
+                          );
+    AcpiTicksWrapped = (End.AcpiTick - mTscCalibrationStart.AcpiTick) & OC_ACPI_TICKS_MASK;
+    AcpiTicksOffset  = (AcpiTicksWrapped - (UINT32)AcpiTicksExpected) & OC_ACPI_TICKS_MASK;
+    AcpiTicksDelta   = AcpiTicksExpected + AcpiTicksOffset;
+    if (AcpiTicksOffset > (OC_ACPI_TICKS_MASK >> 1U)) {
+      AcpiTicksDelta -= OC_ACPI_TICKS_MASK + 1;
+    }
+
+    if ((INT64)AcpiTicksDelta >= OC_TSC_CALIBRATION_TICKS) {
+      break;
+    }
+
+    //
+    // Stall for the remaining time and take another sample, the firmware
+    // stall precision does not matter here.
+    //
+    if ((INT64)AcpiTicksDelta < 0) {
+      AcpiTicksDelta = 0;
+    }
+
+    gBS->Stall (
+           (UINTN)DivU64x32 (
+                    MultU64x32 (OC_TSC_CALIBRATION_TICKS - AcpiTicksDelta, 1000000),
+                    V_ACPI_TMR_FREQUENCY
+                    ) + 1
+           );
+  }
+
+  return DivU64x64Remainder (
+           MultU64x32 (TscTicksDelta, V_ACPI_TMR_FREQUENCY),
+           AcpiTicksDelta,
+           NULL
+           );
+}
+
 UINT64
 InternalCalculateTSCFromPMTimer (
-  IN BOOLEAN  Recalculate
+  IN BOOLEAN  Recalculate,
+  IN BOOLEAN  AllowEstimate
   )
 {
   //
@@ -179,18 +397,11 @@ InternalCalculateTSCFromPMTimer (
   // this frequency on module entry to initialise a TimerLib instance, and at
   // a later point in time to gather CPU information.
   //
-  STATIC UINT64  TSCFrequency = 0;
+  STATIC UINT64      TSCFrequency   = 0;
+  STATIC EFI_STATUS  VariableStatus = EFI_NOT_STARTED;
 
-  UINT16      TimerAddr;
-  UINTN       VariableSize;
-  UINT64      TscTicksDelta;
-  UINT32      AcpiTick0;
-  UINT32      AcpiTick1;
-  UINT32      AcpiTicksDelta;
-  UINT32      AcpiTicksDuration;
-  BOOLEAN     HasInterrupts;
-  EFI_TPL     PrevTpl;
-  EFI_STATUS  Status;
+  UINTN   VariableSize;
+  UINT64  Estimate;
 
   //
   // Do not use ACPI PM timer in ring 3 (e.g. emulator).
@@ -200,19 +411,18 @@ InternalCalculateTSCFromPMTimer (
   }
 
   //
-  // Decide whether we need to store the frequency.
+  // Decide whether we need to store the frequency. The variable is only
+  // read once, as estimate requests may come before the calibration ends.
   //
-  if (TSCFrequency == 0) {
-    VariableSize = sizeof (TSCFrequency);
-    Status       = gRT->GetVariable (
-                          OC_ACPI_CPU_FREQUENCY_VARIABLE_NAME,
-                          &gOcVendorVariableGuid,
-                          NULL,
-                          &VariableSize,
-                          &TSCFrequency
-                          );
-  } else {
-    Status = EFI_ALREADY_STARTED;
+  if ((TSCFrequency == 0) && (VariableStatus == EFI_NOT_STARTED)) {
+    VariableSize   = sizeof (TSCFrequency);
+    VariableStatus = gRT->GetVariable (
+                            OC_ACPI_CPU_FREQUENCY_VARIABLE_NAME,
+                            &gOcVendorVariableGuid,
+                            NULL,
+                            &VariableSize,
+                            &TSCFrequency
+                            );
   }
 
   if (Recalculate) {
@@ -220,52 +430,56 @@ InternalCalculateTSCFromPMTimer (
   }
 
   if (TSCFrequency == 0) {
-    TimerAddr = (UINT16)InternalGetPmTimerAddr (NULL);
+    //
+    // Estimate requests may come at any TPL, e.g. from TimerLib delays, so they
+    // only start the window on first use, normally from TimerLib constructor.
+    // Calibration is completed and stored by precise requests, which come from
+    // OcCpuScanProcessor at a low TPL.
+    //
+    if (AllowEstimate) {
+      if ((mTscEstimate == 0) && !InternalStartTscCalibration ()) {
+        return 0;
+      }
 
-    if (TimerAddr != 0) {
-      //
-      // Check that timer is advancing (it does not on some virtual machines).
-      //
-      AcpiTick0 = IoRead32 (TimerAddr);
-      gBS->Stall (500);
-      AcpiTick1 = IoRead32 (TimerAddr);
-
-      if (AcpiTick0 != AcpiTick1) {
-        //
-        // ACPI PM timers are usually of 24-bit length, but there are some less common cases of 32-bit length also.
-        // When the maximal number is reached, it overflows.
-        // The code below can handle overflow with AcpiTicksTarget of up to 24-bit size,
-        // on both available sizes of ACPI PM Timers (24-bit and 32-bit).
-        //
-        // 357954 clocks of ACPI timer (200ms)
-        //
-        AcpiTicksDuration = V_ACPI_TMR_FREQUENCY / 10;
-
-        //
-        // Disable all events to ensure that nobody interrupts us.
-        //
-        PrevTpl       = gBS->RaiseTPL (TPL_HIGH_LEVEL);
-        HasInterrupts = SaveAndDisableInterrupts ();
-        AsmMeasureTicks (AcpiTicksDuration, TimerAddr, &AcpiTicksDelta, &TscTicksDelta);
-        if (HasInterrupts) {
-          EnableInterrupts ();
-        }
+      mTscEstimatePending = mTscCalibrationTimer != 0;
+      return mTscEstimate;
+    }
 
-        gBS->RestoreTPL (PrevTpl);
+    mTscEstimatePending = FALSE;
 
-        TSCFrequency = DivU64x32 (
-                         MultU64x32 (TscTicksDelta, V_ACPI_TMR_FREQUENCY),
-                         AcpiTicksDelta
-                         );
-      }
+    //
+    // Most of the time the window is long enough once precise value is needed.
+    //
+    if (!InternalStartTscCalibration ()) {
+      return 0;
+    }
+
+    TSCFrequency = InternalFinishTscCalibration ();
+    if ((TSCFrequency == 0) && InternalStartTscCalibration ()) {
+      TSCFrequency = InternalFinishTscCalibration ();
+    }
+
+    if (TSCFrequency == 0) {
+      return 0;
+    }
+
+    //
+    // Cross-check the window against the estimate, discard it when something
+    // went wrong, e.g. the firmware reprogrammed the timer meanwhile.
+    //
+    Estimate = mTscEstimate;
+    if (ABS ((INT64)TSCFrequency - (INT64)Estimate) > OC_CPU_FREQUENCY_TOLERANCE) {
+      mTscCalibrationTimer = 0;
+      TSCFrequency         = 0;
+      return 0;
     }
 
-    DEBUG ((DEBUG_VERBOSE, "TscFrequency %lld\n", TSCFrequency));
+    DEBUG ((DEBUG_VERBOSE, "TscFrequency %lld estimate %lld\n", TSCFrequency, Estimate));
 
     //
     // Set the variable if not present and valid.
     //
-    if ((TSCFrequency != 0) && (Status == EFI_NOT_FOUND)) {
+    if (VariableStatus == EFI_NOT_FOUND) {
       //
       // Do not use OcSetSystemVariable() as this may be called by a
       // constructor.
@@ -277,6 +491,7 @@ InternalCalculateTSCFromPMTimer (
              sizeof (TSCFrequency),
              &TSCFrequency
              );
+      VariableStatus = EFI_ALREADY_STARTED;
     }
   }
 
@@ -580,7 +795,7 @@ InternalCalculateARTFrequencyIntel (
           // Calculate it by dividing the TSC frequency by the TSC ratio.
           //
           if ((ARTFrequency == 0) && (MaxId >= CPUID_PROCESSOR_FREQUENCY)) {
-            CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate);
+            CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate, FALSE);
             ARTFrequency        = BaseMultThenDivU64x64x32 (
                                     CPUFrequencyFromTSC,
                                     CpuidDenominatorEax,
@@ -777,7 +992,7 @@ OcGetTSCFrequency (
     if (CPUFrequency == 0) {
       CPUFrequency = InternalCalculateTSCFromApplePlatformInfo (NULL, FALSE);
       if (CPUFrequency == 0) {
-        CPUFrequency = InternalCalculateTSCFromPMTimer (FALSE);
+        CPUFrequency = InternalCalculateTSCFromPMTimer (FALSE, TRUE);
         if (CPUFrequency == 0) {
           //
           // Assume at least some frequency, so that we always work.
@@ -794,3 +1009,11 @@ OcGetTSCFrequency (
   //
   return CPUFrequency;
 }
+
+BOOLEAN
+OcIsTSCFrequencyEstimate (
+  VOID
+  )
+{
+  return mTscEstimatePending;
+}
@@ -119,13 +119,19 @@ InternalGetPmTimerAddr (
 /**
   Calculate the TSC frequency via PM timer
 
-  @param[in] Recalculate  Do not re-use previously cached information.
+  The measurement window starts on the first call and is completed once it
+  is long enough, so that time spent booting in between is not wasted.
+
+  @param[in] Recalculate    Do not re-use previously cached information.
+  @param[in] AllowEstimate  Return a provisional estimate instead of waiting
+                            for the measurement window to complete.
 
   @retval  The calculated TSC frequency.
 **/
 UINT64
 InternalCalculateTSCFromPMTimer (
-  IN BOOLEAN  Recalculate
+  IN BOOLEAN  Recalculate,
+  IN BOOLEAN  AllowEstimate
   );
 
 /**
@@ -495,7 +495,7 @@ ScanIntelProcessor (
       DEBUG_CODE_END ();
       Cpu->CPUFrequencyFromApple = InternalCalculateTSCFromApplePlatformInfo (NULL, Recalculate);
       if ((Cpu->CPUFrequencyFromApple == 0) || Recalculate) {
-        Cpu->CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate);
+        Cpu->CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate, FALSE);
       }
     }
 
@@ -659,7 +659,7 @@ ScanAmdProcessor (
   //           the invariant TSC.
   //
   if (Cpu->CPUFrequencyFromVMT == 0) {
-    Cpu->CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate);
+    Cpu->CPUFrequencyFromTSC = InternalCalculateTSCFromPMTimer (Recalculate, FALSE);
     Cpu->CPUFrequency        = Cpu->CPUFrequencyFromTSC;
   }
 
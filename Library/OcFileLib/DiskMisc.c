@@ -32,10 +32,6 @@
 #include <Library/OcFileLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
-STATIC EFI_GUID  mInternalDiskPartitionEntriesProtocolGuid = {
-  0x1A81704, 0x3442, 0x4A7D, { 0x87, 0x40, 0xF4, 0xEC, 0x5B, 0xBE, 0x59, 0x77 }
-};
-
 STATIC EFI_GUID  mInternalPartitionEntryProtocolGuid = {
   0x9FC6B19, 0xB8A1, 0x4A01, { 0x8D, 0xB1, 0x87, 0x94, 0xE7, 0x63, 0x4C, 0xA5 }
 };
@@ -576,6 +572,7 @@ OcGetDiskPartitions (
   )
 {
   OC_PARTITION_ENTRIES  *PartEntries;
+  OC_PARTITION_ENTRIES  *CachedEntries;
 
   EFI_STATUS  Status;
   BOOLEAN     Result;
@@ -583,6 +580,7 @@ OcGetDiskPartitions (
   OC_DISK_CONTEXT  DiskContext;
 
   EFI_LBA                     PartEntryLBA;
+  EFI_PARTITION_TABLE_HEADER  Header;
   UINT32                      NumPartitions;
   UINT32                      PartEntrySize;
   UINTN                       PartEntriesSize;
@@ -592,19 +590,30 @@ OcGetDiskPartitions (
 
   ASSERT (DiskHandle != NULL);
 
+  Status = OcDiskInitializeContext (&DiskContext, DiskHandle, UseBlockIo2);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  //
+  // Entries may be cached by OpenPartitionDxe or by a previous call.
+  // Stale entries are replaced but not freed, as pointers into them
+  // may have been handed out by OcGetGptPartitionEntry.
+  //
   Status = gBS->HandleProtocol (
                   DiskHandle,
-                  &mInternalDiskPartitionEntriesProtocolGuid,
-                  (VOID **)&PartEntries
+                  &gOcPartitionEntriesProtocolGuid,
+                  (VOID **)&CachedEntries
                   );
   if (!EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_VERBOSE, "OCPI: Located cached partition entries\n"));
-    return PartEntries;
-  }
+    if (CachedEntries->MediaId == DiskContext.MediaId) {
+      DEBUG ((DEBUG_VERBOSE, "OCPI: Located cached partition entries (verified %d)\n", CachedEntries->Verified));
+      return CachedEntries;
+    }
 
-  Status = OcDiskInitializeContext (&DiskContext, DiskHandle, UseBlockIo2);
-  if (EFI_ERROR (Status)) {
-    return NULL;
+    DEBUG ((DEBUG_INFO, "OCPI: Cached partition entries are stale\n"));
+  } else {
+    CachedEntries = NULL;
   }
 
   //
@@ -652,6 +661,7 @@ OcGetDiskPartitions (
 
   NumPartitions = GptHeader->NumberOfPartitionEntries;
   PartEntryLBA  = GptHeader->PartitionEntryLBA;
+  CopyMem (&Header, GptHeader, sizeof (Header));
 
   FreePool (GptHeader);
 
@@ -664,7 +674,7 @@ OcGetDiskPartitions (
   PartEntriesSize = ALIGN_VALUE (PartEntriesSize, DiskContext.BlockSize);
 
   Result = BaseOverflowAddUN (
-             sizeof (PartEntries),
+             sizeof (*PartEntries),
              PartEntriesSize,
              &PartEntriesStructSize
              );
@@ -702,14 +712,26 @@ OcGetDiskPartitions (
     return NULL;
   }
 
+  PartEntries->MediaId            = DiskContext.MediaId;
+  PartEntries->Verified           = FALSE;
+  CopyMem (&PartEntries->Header, &Header, sizeof (PartEntries->Header));
   PartEntries->NumPartitions      = NumPartitions;
   PartEntries->PartitionEntrySize = PartEntrySize;
   //
   // FIXME: This causes the handle to be dangling if the device is detached.
   //
+  if (CachedEntries != NULL) {
+    gBS->UninstallMultipleProtocolInterfaces (
+           DiskHandle,
+           &gOcPartitionEntriesProtocolGuid,
+           CachedEntries,
+           NULL
+           );
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &DiskHandle,
-                  &mInternalDiskPartitionEntriesProtocolGuid,
+                  &gOcPartitionEntriesProtocolGuid,
                   PartEntries,
                   NULL
                   );
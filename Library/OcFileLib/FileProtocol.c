@@ -654,3 +654,148 @@ OcScanDirectory (
 
   return Status;
 }
+
+VOID
+OcFreeSortedFilesFromDirectory (
+  IN EFI_FILE_INFO  **FileInfos,
+  IN UINTN          FileInfoCount
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < FileInfoCount; ++Index) {
+    FreePool (FileInfos[Index]);
+  }
+
+  if (FileInfos != NULL) {
+    FreePool (FileInfos);
+  }
+}
+
+EFI_STATUS
+OcGetSortedFilesFromDirectory (
+  IN     EFI_FILE_PROTOCOL  *Directory,
+  IN     CHAR16             *FileNameStartsWith OPTIONAL,
+  OUT EFI_FILE_INFO         ***FileInfos,
+  OUT UINTN                 *FileInfoCount
+  )
+{
+  EFI_STATUS     Status;
+  EFI_FILE_INFO  *FileInfoCurrent;
+  EFI_FILE_INFO  **Sorted;
+  EFI_FILE_INFO  **NewSorted;
+  UINTN          FileInfoSize;
+  UINTN          Count;
+  UINTN          Capacity;
+  UINTN          Index;
+  UINT32         EpochCurrent;
+
+  ASSERT (Directory != NULL);
+  ASSERT (FileInfos != NULL);
+  ASSERT (FileInfoCount != NULL);
+
+  *FileInfos     = NULL;
+  *FileInfoCount = 0;
+
+  Status = OcEnsureDirectoryFile (Directory, TRUE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  FileInfoCurrent = AllocatePool (SIZE_1KB);
+  if (FileInfoCurrent == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Sorted   = NULL;
+  Count    = 0;
+  Capacity = 0;
+
+  Directory->SetPosition (Directory, 0);
+
+  while (TRUE) {
+    //
+    // Apple's HFS+ driver does not adhere to the spec and will return zero for
+    // EFI_BUFFER_TOO_SMALL. EFI_FILE_INFO structures larger than 1KB are
+    // unrealistic as the filename is the only variable.
+    //
+    FileInfoSize = SIZE_1KB - sizeof (CHAR16);
+    Status       = Directory->Read (Directory, &FileInfoSize, FileInfoCurrent);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    if (FileInfoSize == 0) {
+      break;
+    }
+
+    //
+    // Skip any files that do not start with the desired filename.
+    //
+    if (FileNameStartsWith != NULL) {
+      if (StrnCmp (FileInfoCurrent->FileName, FileNameStartsWith, StrLen (FileNameStartsWith)) != 0) {
+        continue;
+      }
+    }
+
+    if (Count == Capacity) {
+      Capacity  = Capacity == 0 ? 16 : Capacity * 2;
+      NewSorted = ReallocatePool (Count * sizeof (*Sorted), Capacity * sizeof (*Sorted), Sorted);
+      if (NewSorted == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        break;
+      }
+
+      Sorted = NewSorted;
+    }
+
+    //
+    // Insert after all entries not older than the current one.
+    //
+    EpochCurrent = EfiTimeToEpoch (&FileInfoCurrent->ModificationTime);
+    DEBUG ((DEBUG_VERBOSE, "OCFS: Current file %s with time %u\n", FileInfoCurrent->FileName, EpochCurrent));
+
+    Index = Count;
+    while ((Index > 0) && (EfiTimeToEpoch (&Sorted[Index - 1]->ModificationTime) < EpochCurrent)) {
+      Sorted[Index] = Sorted[Index - 1];
+      --Index;
+    }
+
+    //
+    // Ensure the file name is terminated for a full 1KB entry.
+    //
+    ((CHAR8 *)FileInfoCurrent)[FileInfoSize]     = '\0';
+    ((CHAR8 *)FileInfoCurrent)[FileInfoSize + 1] = '\0';
+
+    Sorted[Index] = AllocateCopyPool (FileInfoSize + sizeof (CHAR16), FileInfoCurrent);
+    if (Sorted[Index] == NULL) {
+      CopyMem (&Sorted[Index], &Sorted[Index + 1], (Count - Index) * sizeof (*Sorted));
+      Status = EFI_OUT_OF_RESOURCES;
+      break;
+    }
+
+    ++Count;
+  }
+
+  Directory->SetPosition (Directory, 0);
+  FreePool (FileInfoCurrent);
+
+  if (EFI_ERROR (Status)) {
+    OcFreeSortedFilesFromDirectory (Sorted, Count);
+    return Status;
+  }
+
+  if (Count == 0) {
+    DEBUG ((DEBUG_VERBOSE, "OCFS: No matching files found\n"));
+    if (Sorted != NULL) {
+      FreePool (Sorted);
+    }
+
+    return EFI_NOT_FOUND;
+  }
+
+  *FileInfos     = Sorted;
+  *FileInfoCount = Count;
+
+  return EFI_SUCCESS;
+}
@@ -2,7 +2,7 @@
  * Hash service fix for AMI EFIs with broken SHA implementations.
  *
  * Forcibly reinstalls EFI_HASH_PROTOCOL with working MD5, SHA-1,
- * SHA-256 implementations.
+ * SHA-256, SHA-384, SHA-512 implementations.
  *
  * Author: Joel Hoener <athre0z@zyantific.com>
  */
@@ -23,6 +23,31 @@ STATIC EFI_SERVICE_BINDING_PROTOCOL  mHashBindingProto = {
   &HSDestroyChild
 };
 
+STATIC CONST HS_ALGORITHM  mHashAlgorithms[] = {
+  { &gEfiHashAlgorithmSha256Guid, HsAlgorithmSha256, sizeof (EFI_SHA256_HASH), sizeof (SHA256_CONTEXT) },
+  { &gEfiHashAlgorithmSha1Guid,   HsAlgorithmSha1,   sizeof (EFI_SHA1_HASH),   sizeof (SHA1_CONTEXT)   },
+  { &gEfiHashAlgorithmSha384Guid, HsAlgorithmSha384, sizeof (EFI_SHA384_HASH), sizeof (SHA384_CONTEXT) },
+  { &gEfiHashAlgorithmSha512Guid, HsAlgorithmSha512, sizeof (EFI_SHA512_HASH), sizeof (SHA512_CONTEXT) },
+  { &gEfiHashAlgorithmMD5Guid,    HsAlgorithmMd5,    sizeof (EFI_MD5_HASH),    sizeof (MD5_CONTEXT)    }
+};
+
+STATIC
+CONST HS_ALGORITHM *
+HSLookupAlgorithm (
+  IN CONST EFI_GUID  *HashAlgorithm
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mHashAlgorithms); ++Index) {
+    if (CompareGuid (mHashAlgorithms[Index].Guid, HashAlgorithm)) {
+      return &mHashAlgorithms[Index];
+    }
+  }
+
+  return NULL;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -32,22 +57,19 @@ HSGetHashSize (
   OUT UINTN                    *HashSize
   )
 {
+  CONST HS_ALGORITHM  *Algorithm;
+
   if (!HashAlgorithm || !HashSize) {
     return EFI_INVALID_PARAMETER;
   }
 
-  if (CompareGuid (&gEfiHashAlgorithmMD5Guid, HashAlgorithm)) {
-    *HashSize = sizeof (EFI_MD5_HASH);
-    return EFI_SUCCESS;
-  } else if (CompareGuid (&gEfiHashAlgorithmSha1Guid, HashAlgorithm)) {
-    *HashSize = sizeof (EFI_SHA1_HASH);
-    return EFI_SUCCESS;
-  } else if (CompareGuid (&gEfiHashAlgorithmSha256Guid, HashAlgorithm)) {
-    *HashSize = sizeof (EFI_SHA256_HASH);
-    return EFI_SUCCESS;
+  Algorithm = HSLookupAlgorithm (HashAlgorithm);
+  if (Algorithm == NULL) {
+    return EFI_UNSUPPORTED;
   }
 
-  return EFI_UNSUPPORTED;
+  *HashSize = Algorithm->HashSize;
+  return EFI_SUCCESS;
 }
 
 STATIC
@@ -62,8 +84,9 @@ HSHash (
   IN OUT EFI_HASH_OUTPUT      *Hash
   )
 {
-  HS_PRIVATE_DATA  *PrivateData;
-  HS_CONTEXT_DATA  CtxCopy;
+  HS_PRIVATE_DATA     *PrivateData;
+  CONST HS_ALGORITHM  *Algorithm;
+  HS_CONTEXT_DATA     CtxCopy;
 
   if (!This || !HashAlgorithm || !Message || !Hash || !MessageSize || (MessageSize > MAX_UINTN)) {
     return EFI_INVALID_PARAMETER;
@@ -71,36 +94,98 @@ HSHash (
 
   PrivateData = HS_PRIVATE_FROM_PROTO (This);
 
-  if (CompareGuid (&gEfiHashAlgorithmMD5Guid, HashAlgorithm)) {
-    if (!Extend) {
-      Md5Init (&PrivateData->Ctx.Md5);
+  //
+  // Extending the running context does not need another algorithm lookup.
+  //
+  Algorithm = PrivateData->Algorithm;
+  if (  !Extend
+     || (Algorithm == NULL)
+     || ((HashAlgorithm != Algorithm->Guid) && !CompareGuid (HashAlgorithm, Algorithm->Guid)))
+  {
+    Algorithm = HSLookupAlgorithm (HashAlgorithm);
+    if (Algorithm == NULL) {
+      return EFI_UNSUPPORTED;
     }
 
-    Md5Update (&PrivateData->Ctx.Md5, Message, (UINTN)MessageSize);
-    CopyMem (&CtxCopy, &PrivateData->Ctx, sizeof (PrivateData->Ctx));
-    Md5Final (&CtxCopy.Md5, *Hash->Md5Hash);
-    return EFI_SUCCESS;
-  } else if (CompareGuid (&gEfiHashAlgorithmSha1Guid, HashAlgorithm)) {
-    if (!Extend) {
-      Sha1Init (&PrivateData->Ctx.Sha1);
-    }
+    //
+    // Extending a context of another (or no) algorithm is not meaningful, start anew.
+    //
+    Extend                 = FALSE;
+    PrivateData->Algorithm = Algorithm;
+  }
 
-    Sha1Update (&PrivateData->Ctx.Sha1, Message, (UINTN)MessageSize);
-    CopyMem (&CtxCopy, &PrivateData->Ctx, sizeof (PrivateData->Ctx));
-    Sha1Final (&CtxCopy.Sha1, *Hash->Sha1Hash);
-    return EFI_SUCCESS;
-  } else if (CompareGuid (&gEfiHashAlgorithmSha256Guid, HashAlgorithm)) {
-    if (!Extend) {
-      Sha256Init (&PrivateData->Ctx.Sha256);
-    }
+  switch (Algorithm->Id) {
+    case HsAlgorithmMd5:
+      if (!Extend) {
+        Md5Init (&PrivateData->Ctx.Md5);
+      }
+
+      Md5Update (&PrivateData->Ctx.Md5, Message, (UINTN)MessageSize);
+      break;
+    case HsAlgorithmSha1:
+      if (!Extend) {
+        Sha1Init (&PrivateData->Ctx.Sha1);
+      }
+
+      Sha1Update (&PrivateData->Ctx.Sha1, Message, (UINTN)MessageSize);
+      break;
+    case HsAlgorithmSha256:
+      if (!Extend) {
+        Sha256Init (&PrivateData->Ctx.Sha256);
+      }
+
+      Sha256Update (&PrivateData->Ctx.Sha256, Message, (UINTN)MessageSize);
+      break;
+    case HsAlgorithmSha384:
+      if (!Extend) {
+        Sha384Init (&PrivateData->Ctx.Sha384);
+      }
+
+      //
+      // SHA-384 and SHA-512 use AVX transform when vector acceleration is enabled.
+      //
+      Sha384Update (&PrivateData->Ctx.Sha384, Message, (UINTN)MessageSize);
+      break;
+    case HsAlgorithmSha512:
+      if (!Extend) {
+        Sha512Init (&PrivateData->Ctx.Sha512);
+      }
+
+      Sha512Update (&PrivateData->Ctx.Sha512, Message, (UINTN)MessageSize);
+      break;
+    default:
+      ASSERT (FALSE);
+      return EFI_UNSUPPORTED;
+  }
 
-    Sha256Update (&PrivateData->Ctx.Sha256, Message, (UINTN)MessageSize);
-    CopyMem (&CtxCopy, &PrivateData->Ctx, sizeof (PrivateData->Ctx));
-    Sha256Final (&CtxCopy.Sha256, *Hash->Sha256Hash);
-    return EFI_SUCCESS;
+  //
+  // Finalise a copy to allow extending the context later.
+  // Only copy the context of the algorithm in use, not the whole union.
+  //
+  CopyMem (&CtxCopy, &PrivateData->Ctx, Algorithm->ContextSize);
+
+  switch (Algorithm->Id) {
+    case HsAlgorithmMd5:
+      Md5Final (&CtxCopy.Md5, *Hash->Md5Hash);
+      break;
+    case HsAlgorithmSha1:
+      Sha1Final (&CtxCopy.Sha1, *Hash->Sha1Hash);
+      break;
+    case HsAlgorithmSha256:
+      Sha256Final (&CtxCopy.Sha256, *Hash->Sha256Hash);
+      break;
+    case HsAlgorithmSha384:
+      Sha384Final (&CtxCopy.Sha384, *Hash->Sha384Hash);
+      break;
+    case HsAlgorithmSha512:
+      Sha512Final (&CtxCopy.Sha512, *Hash->Sha512Hash);
+      break;
+    default:
+      break;
   }
 
-  return EFI_UNSUPPORTED;
+  SecureZeroMem (&CtxCopy, Algorithm->ContextSize);
+  return EFI_SUCCESS;
 }
 
 STATIC
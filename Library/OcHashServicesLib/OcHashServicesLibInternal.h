@@ -2,7 +2,7 @@
  * Hash service fix for AMI EFIs with broken SHA implementations.
  *
  * Forcibly reinstalls EFI_HASH_PROTOCOL with working MD5, SHA-1,
- * SHA-256 implementations.
+ * SHA-256, SHA-384, SHA-512 implementations.
  *
  * Author: Joel Hoener <athre0z@zyantific.com>
  */
@@ -18,12 +18,33 @@ typedef union _HS_CONTEXT_DATA {
   MD5_CONTEXT       Md5;
   SHA1_CONTEXT      Sha1;
   SHA256_CONTEXT    Sha256;
+  SHA384_CONTEXT    Sha384;
+  SHA512_CONTEXT    Sha512;
 } HS_CONTEXT_DATA;
 
+typedef enum _HS_ALGORITHM_ID {
+  HsAlgorithmMd5,
+  HsAlgorithmSha1,
+  HsAlgorithmSha256,
+  HsAlgorithmSha384,
+  HsAlgorithmSha512
+} HS_ALGORITHM_ID;
+
+typedef struct _HS_ALGORITHM {
+  EFI_GUID           *Guid;
+  HS_ALGORITHM_ID    Id;
+  UINTN              HashSize;
+  UINTN              ContextSize;
+} HS_ALGORITHM;
+
 typedef struct _HS_PRIVATE_DATA {
-  HS_CONTEXT_DATA      Ctx;
-  UINTN                Signature;
-  EFI_HASH_PROTOCOL    Proto;
+  HS_CONTEXT_DATA       Ctx;
+  //
+  // Algorithm of the running context, resolved when it is started.
+  //
+  CONST HS_ALGORITHM    *Algorithm;
+  UINTN                 Signature;
+  EFI_HASH_PROTOCOL     Proto;
 } HS_PRIVATE_DATA;
 
 #define HS_PRIVATE_SIGNATURE  SIGNATURE_32('H','S','r','v')
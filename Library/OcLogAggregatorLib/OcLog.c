@@ -27,6 +27,7 @@
 #include <Library/OcDataHubLib.h>
 #include <Library/OcDebugLogLib.h>
 #include <Library/OcFileLib.h>
+#include <Library/OcFlexArrayLib.h>
 #include <Library/OcMiscLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/OcTimerLib.h>
@@ -141,29 +142,143 @@ GetLogPath (
 }
 
 STATIC
-EFI_STATUS
-GetLogPrefix (
-  IN   CONST CHAR8  *FormattedString,
-  OUT  CHAR8        *Prefix
+UINTN
+GetLogPrefixCharIndex (
+  IN CHAR8  Char
   )
 {
-  UINTN  Pos;
-  CHAR8  Char;
+  //
+  // Except for colon, a valid prefix must be either 0-9, or uppercase letter.
+  //
+  if (IsAsciiNumber (Char)) {
+    return Char - '0';
+  }
+
+  if ((Char >= 'A') && (Char <= 'Z')) {
+    return Char - 'A' + 10;
+  }
+
+  return MAX_UINTN;
+}
+
+/**
+  Build LogModules prefix trie, so that each log line costs at most
+  OC_LOG_PREFIX_CHAR_MAX node lookups regardless of the number of modules.
+
+  @param[in,out] Private     Log private data.
+  @param[in]     LogModules  Comma-separated module list without leading sign.
+**/
+STATIC
+VOID
+BuildLogPrefixFilter (
+  IN OUT OC_LOG_PRIVATE_DATA  *Private,
+  IN     CONST CHAR8          *LogModules
+  )
+{
+  OC_FLEX_ARRAY       *FlexFilters;
+  OC_LOG_FILTER_NODE  *Nodes;
+  UINTN               MaxNodes;
+  UINTN               NodeCount;
+  UINTN               Node;
+  UINTN               Index;
+  UINTN               Pos;
+  UINTN               CharIndex;
+  CHAR8               **Value;
+
+  FlexFilters = OcStringSplit (LogModules, L',', OcStringFormatAscii);
+  if (FlexFilters == NULL) {
+    return;
+  }
+
+  //
+  // Each module adds at most OC_LOG_PREFIX_CHAR_MAX nodes after the root.
+  //
+  MaxNodes = MIN (1 + FlexFilters->Count * OC_LOG_PREFIX_CHAR_MAX, MAX_UINT16);
+  Nodes    = AllocateZeroPool (MaxNodes * sizeof (*Nodes));
+  if (Nodes == NULL) {
+    OcFlexArrayFree (&FlexFilters);
+    return;
+  }
 
-  ASSERT (FormattedString != NULL);
-  ASSERT (Prefix != NULL);
+  NodeCount = 1;
 
-  Pos = 0;
-  while (TRUE) {
-    Char = FormattedString[Pos];
+  for (Index = 0; Index < FlexFilters->Count; ++Index) {
+    Value = (CHAR8 **)OcFlexArrayItemAt (FlexFilters, Index);
+    ASSERT (Value != NULL);
 
     //
-    // If we reached end of string, then ':' was not found.
+    // Lines without a valid prefix are matched against "?".
     //
-    if (Char == '\0') {
-      return EFI_NOT_FOUND;
+    if (AsciiStrCmp (*Value, "?") == 0) {
+      Private->FilterUnknownPrefix = TRUE;
+      continue;
     }
 
+    Node = 0;
+    for (Pos = 0; (*Value)[Pos] != '\0'; ++Pos) {
+      CharIndex = GetLogPrefixCharIndex ((*Value)[Pos]);
+      if ((Pos == OC_LOG_PREFIX_CHAR_MAX) || (CharIndex == MAX_UINTN)) {
+        //
+        // No log line can have this prefix.
+        //
+        break;
+      }
+
+      if (Nodes[Node].Children[CharIndex] == 0) {
+        if (NodeCount == MaxNodes) {
+          break;
+        }
+
+        Nodes[Node].Children[CharIndex] = (UINT16)NodeCount;
+        ++NodeCount;
+      }
+
+      Node = Nodes[Node].Children[CharIndex];
+    }
+
+    if ((Pos > 0) && ((*Value)[Pos] == '\0')) {
+      Nodes[Node].Terminal = TRUE;
+    }
+  }
+
+  OcFlexArrayFree (&FlexFilters);
+
+  Private->FilterNodes = Nodes;
+}
+
+/**
+  Match log prefix, i.e. up to OC_LOG_PREFIX_CHAR_MAX characters of 0-9 or A-Z
+  followed by colon, against LogModules prefix trie.
+
+  @param[in]  Private  Log private data with FilterNodes.
+  @param[in]  String   Formatted log line or its format string.
+  @param[out] Matched  Whether the prefix is listed in LogModules.
+
+  @retval EFI_SUCCESS    String starts with a valid prefix.
+  @retval EFI_NOT_FOUND  String has no valid prefix.
+**/
+STATIC
+EFI_STATUS
+MatchLogPrefix (
+  IN  CONST OC_LOG_PRIVATE_DATA  *Private,
+  IN  CONST CHAR8                *String,
+  OUT BOOLEAN                    *Matched
+  )
+{
+  UINTN  Pos;
+  UINTN  Node;
+  UINTN  CharIndex;
+  CHAR8  Char;
+
+  ASSERT (Private->FilterNodes != NULL);
+  ASSERT (String != NULL);
+
+  Node     = 0;
+  *Matched = TRUE;
+
+  for (Pos = 0; ; ++Pos) {
+    Char = String[Pos];
+
     //
     // Match the first occurrence of colon.
     //
@@ -180,69 +295,77 @@ GetLogPrefix (
 
     //
     // If size of prefix would exceed OC_LOG_PREFIX_CHAR_MAX, then not found.
+    // This also covers reaching the end of string.
     //
-    if (Pos == OC_LOG_PREFIX_CHAR_MAX) {
+    CharIndex = GetLogPrefixCharIndex (Char);
+    if ((Pos == OC_LOG_PREFIX_CHAR_MAX) || (CharIndex == MAX_UINTN)) {
       return EFI_NOT_FOUND;
     }
 
     //
-    // Except for colon, a valid prefix must be either 0-9, or uppercase letter.
+    // Keep validating the prefix after leaving the trie.
     //
-    if (!(IsAsciiNumber (Char) || ((Char >= 'A') && (Char <= 'Z')))) {
-      return EFI_NOT_FOUND;
+    if (*Matched) {
+      Node = Private->FilterNodes[Node].Children[CharIndex];
+      if (Node == 0) {
+        *Matched = FALSE;
+      }
     }
+  }
 
-    ++Pos;
+  if (*Matched) {
+    *Matched = Private->FilterNodes[Node].Terminal;
   }
 
-  CopyMem (Prefix, FormattedString, Pos);
-  Prefix[Pos] = '\0';
   return EFI_SUCCESS;
 }
 
+/**
+  Check whether log line should be discarded due to LogModules.
+
+  @param[in]  Private      Log private data.
+  @param[in]  String       Formatted log line or its format string.
+  @param[in]  MustHaveTag  Only decide when String starts with a valid prefix.
+  @param[out] Filtered     Whether the line should be discarded.
+
+  @retval EFI_SUCCESS    Filtered is set.
+  @retval EFI_NOT_FOUND  MustHaveTag is set and String has no valid prefix.
+**/
 STATIC
-BOOLEAN
+EFI_STATUS
 IsPrefixFiltered (
-  IN   CONST CHAR8          *FormattedString,
-  IN   CONST OC_FLEX_ARRAY  *FlexFilters    OPTIONAL,
-  IN   BOOLEAN              BlacklistFiltering
+  IN  CONST OC_LOG_PRIVATE_DATA  *Private,
+  IN  CONST CHAR8                *String,
+  IN  BOOLEAN                    MustHaveTag,
+  OUT BOOLEAN                    *Filtered
   )
 {
-  UINTN       Index;
-  CHAR8       Prefix[OC_LOG_PREFIX_CHAR_MAX + 1];
   EFI_STATUS  Status;
-  CHAR8       **Value;
-
-  ASSERT (FormattedString != NULL);
+  BOOLEAN     Matched;
 
   //
   // Do not filter without filters.
   //
-  if (FlexFilters == NULL) {
-    return FALSE;
+  if (Private->FilterNodes == NULL) {
+    *Filtered = FALSE;
+    return EFI_SUCCESS;
   }
 
-  Status = GetLogPrefix (FormattedString, Prefix);
+  Status = MatchLogPrefix (Private, String, &Matched);
   if (EFI_ERROR (Status)) {
-    AsciiStrCpyS (Prefix, ARRAY_SIZE (Prefix), "?");
-  }
-
-  for (Index = 0; Index < FlexFilters->Count; ++Index) {
-    Value = (CHAR8 **)OcFlexArrayItemAt (FlexFilters, Index);
-    ASSERT (Value != NULL);
-
-    if (AsciiStrCmp (Prefix, *Value) == 0) {
-      //
-      // Upon matching, return TRUE (i.e. not to print logs) if blacklisted.
-      //
-      return BlacklistFiltering;
+    if (MustHaveTag) {
+      return Status;
     }
+
+    Matched = Private->FilterUnknownPrefix;
   }
 
   //
+  // Upon matching, return TRUE (i.e. not to print logs) if blacklisted.
   // Otherwise return default, depending on positive or negative filtering.
   //
-  return !BlacklistFiltering;
+  *Filtered = Matched ? Private->BlacklistFiltering : !Private->BlacklistFiltering;
+  return EFI_SUCCESS;
 }
 
 STATIC
@@ -251,8 +374,7 @@ InternalLogAddEntry (
   IN OC_LOG_PRIVATE_DATA  *Private,
   IN OC_LOG_PROTOCOL      *OcLog,
   IN UINTN                ErrorLevel,
-  IN CONST OC_FLEX_ARRAY  *FlexFilters    OPTIONAL,
-  IN BOOLEAN              BlacklistFiltering,
+  IN BOOLEAN              ApplyFilter,
   IN CONST CHAR8          *FormatString,
   IN VA_LIST              Marker
   )
@@ -267,6 +389,29 @@ InternalLogAddEntry (
   UINT32                      TotalSize;
   UINTN                       WriteSize;
   UINTN                       WrittenSize;
+  BOOLEAN                     Filtered;
+
+  //
+  // Always log at WARN and ERROR level.
+  //
+  if ((ErrorLevel & (DEBUG_WARN | DEBUG_ERROR)) != 0) {
+    ApplyFilter = FALSE;
+  }
+
+  //
+  // Almost every format string starts with a literal prefix, so filter
+  // before formatting to avoid the cost of discarded lines.
+  //
+  if (ApplyFilter) {
+    Status = IsPrefixFiltered (Private, FormatString, TRUE, &Filtered);
+    if (!EFI_ERROR (Status)) {
+      ApplyFilter = FALSE;
+      if (Filtered) {
+        ++Private->SuppressedLines;
+        return EFI_SUCCESS;
+      }
+    }
+  }
 
   AsciiVSPrint (
     Private->LineBuffer,
@@ -276,12 +421,14 @@ InternalLogAddEntry (
     );
 
   //
-  // Filter log after formatting string. Always log at WARN and ERROR level.
+  // Filter log after formatting string when prefix is not literal.
   //
-  if (  ((ErrorLevel & (DEBUG_WARN | DEBUG_ERROR)) == 0)
-     && IsPrefixFiltered (Private->LineBuffer, Private->FlexFilters, Private->BlacklistFiltering))
-  {
-    return EFI_SUCCESS;
+  if (ApplyFilter) {
+    IsPrefixFiltered (Private, Private->LineBuffer, FALSE, &Filtered);
+    if (Filtered) {
+      ++Private->SuppressedLines;
+      return EFI_SUCCESS;
+    }
   }
 
   //
@@ -490,6 +637,30 @@ InternalLogAddEntry (
   return Status;
 }
 
+/**
+  Add log entry bypassing LogModules filtering.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+InternalLogAddUnfilteredEntry (
+  IN OC_LOG_PRIVATE_DATA  *Private,
+  IN OC_LOG_PROTOCOL      *OcLog,
+  IN UINTN                ErrorLevel,
+  IN CONST CHAR8          *FormatString,
+  ...
+  )
+{
+  EFI_STATUS  Status;
+  VA_LIST     Marker;
+
+  VA_START (Marker, FormatString);
+  Status = InternalLogAddEntry (Private, OcLog, ErrorLevel, FALSE, FormatString, Marker);
+  VA_END (Marker);
+
+  return Status;
+}
+
 EFI_STATUS
 EFIAPI
 OcLogAddEntry (
@@ -514,7 +685,22 @@ OcLogAddEntry (
     return EFI_SUCCESS;
   }
 
-  Status = InternalLogAddEntry (Private, OcLog, ErrorLevel, Private->FlexFilters, Private->BlacklistFiltering, FormatString, Marker);
+  Status = InternalLogAddEntry (Private, OcLog, ErrorLevel, TRUE, FormatString, Marker);
+
+  //
+  // There is no reliable point to report at the end of logging,
+  // so report discarded lines periodically.
+  //
+  if (Private->SuppressedLines - Private->ReportedSuppressedLines >= OC_LOG_SUPPRESSED_REPORT_STEP) {
+    Private->ReportedSuppressedLines = Private->SuppressedLines;
+    InternalLogAddUnfilteredEntry (
+      Private,
+      OcLog,
+      DEBUG_INFO,
+      "OCL: LogModules discarded %u lines so far\n",
+      Private->SuppressedLines
+      );
+  }
 
   if (  ((ErrorLevel & OcLog->HaltLevel) != 0)
      && (AsciiStrnCmp (FormatString, "\nASSERT_RETURN_ERROR", L_STR_LEN ("\nASSERT_RETURN_ERROR")) != 0)
@@ -724,8 +910,9 @@ OcConfigureLogProtocol (
       //
       // Write filters into Private.
       //
-      Private->FlexFilters        = NULL;
-      Private->BlacklistFiltering = FALSE;
+      Private->FilterNodes         = NULL;
+      Private->FilterUnknownPrefix = FALSE;
+      Private->BlacklistFiltering  = FALSE;
       if ((*LogModules != '*') && (*LogModules != '\0')) {
         //
         // Default to positive filtering without symbol.
@@ -737,7 +924,7 @@ OcConfigureLogProtocol (
           ++LogModules;
         }
 
-        Private->FlexFilters = OcStringSplit (LogModules, L',', OcStringFormatAscii);
+        BuildLogPrefixFilter (Private, LogModules);
       }
 
       Handle = NULL;
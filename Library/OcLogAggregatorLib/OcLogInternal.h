@@ -15,8 +15,6 @@
 #ifndef OC_LOG_INTERNAL_H
 #define OC_LOG_INTERNAL_H
 
-#include <Library/OcFlexArrayLib.h>
-
 #include <Protocol/OcLog.h>
 #include <Protocol/DataHub.h>
 
@@ -28,9 +26,27 @@
 
 #define OC_LOG_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('O', 'C', 'L', 'G')
 
+///
+/// Characters allowed in log prefixes, 0-9 and A-Z.
+///
+#define OC_LOG_FILTER_ALPHABET_SIZE  36
+
+///
+/// Report the number of lines discarded by LogModules every this many lines.
+///
+#define OC_LOG_SUPPRESSED_REPORT_STEP  1024U
+
 #define OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS(a) \
   (CR (a, OC_LOG_PRIVATE_DATA, OcLog, OC_LOG_PRIVATE_DATA_SIGNATURE))
 
+///
+/// LogModules prefix trie node. Child index 0 (root) means no child.
+///
+typedef struct {
+  UINT16     Children[OC_LOG_FILTER_ALPHABET_SIZE];
+  BOOLEAN    Terminal;
+} OC_LOG_FILTER_NODE;
+
 typedef struct {
   UINT64                   Signature;
   UINT64                   TscFrequency;
@@ -48,8 +64,11 @@ typedef struct {
   UINT32                   LogCounter;
   CHAR16                   *LogFilePathName;
   EFI_DATA_HUB_PROTOCOL    *DataHub;
-  OC_FLEX_ARRAY            *FlexFilters;
+  OC_LOG_FILTER_NODE       *FilterNodes;
+  BOOLEAN                  FilterUnknownPrefix;
   BOOLEAN                  BlacklistFiltering;
+  UINT32                   SuppressedLines;
+  UINT32                   ReportedSuppressedLines;
   OC_LOG_PROTOCOL          OcLog;
 } OC_LOG_PRIVATE_DATA;
 
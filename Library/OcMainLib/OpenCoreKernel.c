@@ -21,6 +21,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/MemoryAllocationLib.h>
 #include <Library/OcAfterBootCompatLib.h>
 #include <Library/OcAppleKernelLib.h>
+#include <Library/OcCpuLib.h>
 #include <Library/OcMiscLib.h>
 #include <Library/OcAppleImg4Lib.h>
 #include <Library/OcStringLib.h>
@@ -990,17 +991,13 @@ OcKernelFuzzyMatch (
   CHAR16             *FileNameDir;
   UINTN              FileNameDirLength;
 
-  EFI_FILE_INFO  *FileInfo;
-  EFI_FILE_INFO  *FileInfoNext;
+  EFI_FILE_INFO  **FileInfos;
+  UINTN          FileInfoCount;
+  UINTN          Index;
   CHAR16         *FileNameCacheNew;
   UINTN          FileNameCacheNewLength;
   UINTN          FileNameCacheNewSize;
 
-  DIRECTORY_SEARCH_CONTEXT  Context;
-
-  FileInfo         = NULL;
-  FileNameCacheNew = NULL;
-
   //
   // Open parent directory.
   //
@@ -1019,32 +1016,27 @@ OcKernelFuzzyMatch (
   }
 
   //
-  // Search for kernelcache files, trying each one.
+  // Collect all kernelcache files newest first in a single directory pass.
   //
-  OcDirectorySeachContextInit (&Context);
-  do {
-    Status = OcGetNewestFileFromDirectory (
-               &Context,
-               FileDirectory,
-               L"kernelcache",
-               &FileInfoNext
-               );
-
-    if (EFI_ERROR (Status)) {
-      break;
-    }
-
-    if (FileInfo != NULL) {
-      FreePool (FileInfo);
-    }
-
-    if (FileNameCacheNew != NULL) {
-      FreePool (FileNameCacheNew);
-    }
-
-    FileInfo = FileInfoNext;
+  Status = OcGetSortedFilesFromDirectory (
+             FileDirectory,
+             L"kernelcache",
+             &FileInfos,
+             &FileInfoCount
+             );
+  FileDirectory->Close (FileDirectory);
+  if (EFI_ERROR (Status)) {
+    FreePool (FileNameDir);
+    return Status;
+  }
 
-    FileNameCacheNewLength = FileNameDirLength + L_STR_LEN ("\\") + StrLen (FileInfo->FileName);
+  //
+  // Try each candidate, skipping the ones which headers do not match
+  // the requested architecture before reading them completely.
+  //
+  Status = EFI_NOT_FOUND;
+  for (Index = 0; Index < FileInfoCount; ++Index) {
+    FileNameCacheNewLength = FileNameDirLength + L_STR_LEN ("\\") + StrLen (FileInfos[Index]->FileName);
     FileNameCacheNewSize   = (FileNameCacheNewLength + 1) * sizeof (*FileNameCacheNew);
     FileNameCacheNew       = AllocateZeroPool (FileNameCacheNewSize);
     if (FileNameCacheNew == NULL) {
@@ -1052,13 +1044,23 @@ OcKernelFuzzyMatch (
       break;
     }
 
-    Status = OcUnicodeSafeSPrint (FileNameCacheNew, FileNameCacheNewSize, L"%s\\%s", FileNameDir, FileInfo->FileName);
+    Status = OcUnicodeSafeSPrint (FileNameCacheNew, FileNameCacheNewSize, L"%s\\%s", FileNameDir, FileInfos[Index]->FileName);
     if (EFI_ERROR (Status)) {
+      FreePool (FileNameCacheNew);
       break;
     }
 
     Status = OcSafeFileOpen (RootFile, KernelFile, FileNameCacheNew, OpenMode, Attributes);
     if (EFI_ERROR (Status)) {
+      FreePool (FileNameCacheNew);
+      continue;
+    }
+
+    Status = ProbeAppleKernel (*KernelFile, Is32Bit);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OC: Skipping kernelcache %s - %r\n", FileNameCacheNew, Status));
+      (*KernelFile)->Close (*KernelFile);
+      FreePool (FileNameCacheNew);
       continue;
     }
 
@@ -1075,19 +1077,15 @@ OcKernelFuzzyMatch (
                LinkedExpansion,
                Digest
                );
-    if (EFI_ERROR (Status)) {
-      (*KernelFile)->Close (*KernelFile);
+    FreePool (FileNameCacheNew);
+    if (!EFI_ERROR (Status)) {
+      break;
     }
-  } while (EFI_ERROR (Status));
-
-  if (FileInfo != NULL) {
-    FreePool (FileInfo);
-  }
 
-  if (FileNameCacheNew != NULL) {
-    FreePool (FileNameCacheNew);
+    (*KernelFile)->Close (*KernelFile);
   }
 
+  OcFreeSortedFilesFromDirectory (FileInfos, FileInfoCount);
   FreePool (FileNameDir);
 
   return Status;
@@ -1323,6 +1321,7 @@ OcKernelFileOpen (
         KernelSize
         );
 
+      OcTraceBegin ("OcKernelProcessPrelinked");
       PrelinkedStatus = OcKernelProcessPrelinked (
                           mOcConfiguration,
                           mOcDarwinVersion,
@@ -1333,6 +1332,8 @@ OcKernelFileOpen (
                           LinkedExpansion,
                           ReservedExeSize
                           );
+      OcTraceEnd ("OcKernelProcessPrelinked");
+      OcTraceFlush (OcGetTSCFrequency ());
 
       DEBUG ((DEBUG_INFO, "OC: Prelinked status - %r\n", PrelinkedStatus));
 
@@ -1415,6 +1416,7 @@ OcKernelFileOpen (
       //
       // Process mkext.
       //
+      OcTraceBegin ("OcKernelProcessMkext");
       Status = OcKernelProcessMkext (
                  mOcConfiguration,
                  mOcDarwinVersion,
@@ -1423,6 +1425,8 @@ OcKernelFileOpen (
                  &KernelSize,
                  AllocatedSize
                  );
+      OcTraceEnd ("OcKernelProcessMkext");
+      OcTraceFlush (OcGetTSCFrequency ());
       DEBUG ((DEBUG_INFO, "OC: Mkext status - %r\n", Status));
       if (!EFI_ERROR (Status)) {
         Status = OcGetFileModificationTime (*NewHandle, &ModificationTime);
@@ -33,6 +33,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcDebugLogLib.h>
 #include <Library/OcDeviceMiscLib.h>
 #include <Library/OcLogAggregatorLib.h>
+#include <Library/OcMiscLib.h>
 #include <Library/OcSmbiosLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/OcVariableLib.h>
@@ -1042,6 +1043,11 @@ OcMiscBoot (
     }
   }
 
+  //
+  // Emit initialisation spans before the picker may wait for user input.
+  //
+  OcTraceFlush (OcGetTSCFrequency ());
+
   Status = OcRunBootPicker (Context);
 
   if (EFI_ERROR (Status)) {
@@ -994,7 +994,9 @@ OcLoadUefiSupport (
   OcReserveMemory (Config);
 
   if (Config->Uefi.ConnectDrivers) {
+    OcTraceBegin ("OcLoadDrivers");
     OcLoadDrivers (Storage, Config, &DriversToConnect, FALSE);
+    OcTraceEnd ("OcLoadDrivers");
     DEBUG ((DEBUG_INFO, "OC: Connecting drivers...\n"));
     if (DriversToConnect != NULL) {
       OcRegisterDriversToHighestPriority (DriversToConnect);
@@ -1009,10 +1011,14 @@ OcLoadUefiSupport (
       DEBUG ((DEBUG_INFO, "OC: Disconnecting graphics drivers done...\n"));
     }
 
+    OcTraceBegin ("OcConnectDrivers");
     OcConnectDrivers ();
+    OcTraceEnd ("OcConnectDrivers");
     DEBUG ((DEBUG_INFO, "OC: Connecting drivers done...\n"));
   } else {
+    OcTraceBegin ("OcLoadDrivers");
     OcLoadDrivers (Storage, Config, NULL, FALSE);
+    OcTraceEnd ("OcLoadDrivers");
   }
 
   DEBUG_CODE_BEGIN ();
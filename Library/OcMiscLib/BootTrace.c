@@ -0,0 +1,124 @@
+/** @file
+  Boot phase tracing.
+
+  Copyright (C) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/OcMiscLib.h>
+
+typedef struct {
+  CONST CHAR8    *Name;
+  UINT64         Start;
+  UINT64         End;
+} OC_TRACE_SPAN;
+
+//
+// Completed spans ring, mTraceSpanCount and mTraceSpanFlushed only grow.
+//
+STATIC OC_TRACE_SPAN  mTraceSpans[OC_TRACE_SPAN_MAX];
+STATIC UINT32         mTraceSpanCount;
+STATIC UINT32         mTraceSpanFlushed;
+
+//
+// Open spans, deeper ones are counted but not recorded.
+//
+STATIC OC_TRACE_SPAN  mTraceStack[OC_TRACE_DEPTH_MAX];
+STATIC UINT32         mTraceDepth;
+
+//
+// Timestamp of the first span, reported as 0.
+//
+STATIC UINT64  mTraceBase;
+
+VOID
+OcTraceBegin (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT64  Tsc;
+
+  ASSERT (Name != NULL);
+
+  Tsc = AsmReadTsc ();
+
+  if (mTraceBase == 0) {
+    mTraceBase = Tsc;
+  }
+
+  if (mTraceDepth < OC_TRACE_DEPTH_MAX) {
+    mTraceStack[mTraceDepth].Name  = Name;
+    mTraceStack[mTraceDepth].Start = Tsc;
+  }
+
+  ++mTraceDepth;
+}
+
+VOID
+OcTraceEnd (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT64         Tsc;
+  OC_TRACE_SPAN  *Span;
+
+  ASSERT (Name != NULL);
+
+  Tsc = AsmReadTsc ();
+
+  if (mTraceDepth == 0) {
+    ASSERT (FALSE);
+    return;
+  }
+
+  --mTraceDepth;
+  if (mTraceDepth >= OC_TRACE_DEPTH_MAX) {
+    return;
+  }
+
+  ASSERT (AsciiStrCmp (mTraceStack[mTraceDepth].Name, Name) == 0);
+
+  Span        = &mTraceSpans[mTraceSpanCount % OC_TRACE_SPAN_MAX];
+  Span->Name  = mTraceStack[mTraceDepth].Name;
+  Span->Start = mTraceStack[mTraceDepth].Start;
+  Span->End   = Tsc;
+  ++mTraceSpanCount;
+}
+
+VOID
+OcTraceFlush (
+  IN UINT64  TscFrequency
+  )
+{
+  OC_TRACE_SPAN  *Span;
+
+  if (TscFrequency == 0) {
+    return;
+  }
+
+  if (mTraceSpanCount - mTraceSpanFlushed > OC_TRACE_SPAN_MAX) {
+    DEBUG ((DEBUG_INFO, "OCTR: Lost %u spans\n", mTraceSpanCount - mTraceSpanFlushed - OC_TRACE_SPAN_MAX));
+    mTraceSpanFlushed = mTraceSpanCount - OC_TRACE_SPAN_MAX;
+  }
+
+  while (mTraceSpanFlushed != mTraceSpanCount) {
+    Span = &mTraceSpans[mTraceSpanFlushed % OC_TRACE_SPAN_MAX];
+
+    //
+    // Chrome trace complete event, timestamps are in microseconds.
+    //
+    DEBUG ((
+      DEBUG_INFO,
+      "OCTR: {\"name\":\"%a\",\"ph\":\"X\",\"ts\":%Lu,\"dur\":%Lu,\"pid\":1,\"tid\":1},\n",
+      Span->Name,
+      DivU64x64Remainder (MultU64x32 (Span->Start - mTraceBase, 1000000), TscFrequency, NULL),
+      DivU64x64Remainder (MultU64x32 (Span->End - Span->Start, 1000000), TscFrequency, NULL)
+      ));
+
+    ++mTraceSpanFlushed;
+  }
+}
@@ -18,20 +18,191 @@
 #include <Library/DebugLib.h>
 #include <Library/OcMiscLib.h>
 
+//
+// Byte values which dominate x86 machine code, most frequent first.
+// They make poor search anchors as they match at nearly every offset.
+//
+STATIC
+CONST UINT8
+  mCommonCodeBytes[] = {
+  0x00, 0xFF, 0x48, 0x89, 0x8B, 0x0F, 0xE8, 0x01,
+  0x45, 0x4C, 0x24, 0x85, 0x83, 0x74, 0xC7, 0x75
+};
+
+//
+// Pattern search is driven by a single anchor byte, which is located
+// a machine word at a time and only then verified against the whole
+// pattern.
+//
+typedef struct {
+  UINT32    Index;
+  UINT64    Value;
+  UINT64    Mask;
+} INTERNAL_PATTERN_ANCHOR;
+
+#define PATTERN_BYTE_BROADCAST(Byte)  (0x0101010101010101ULL * (UINT8)(Byte))
+#define PATTERN_WORD_SIZE             sizeof (UINT64)
+
+/**
+  Choose the most selective pattern byte to anchor the search on.
+
+  @retval FALSE  Every pattern byte is masked out and matches anything.
+**/
 STATIC
 BOOLEAN
-InternalFindPattern (
+InternalSelectAnchor (
+  IN  CONST UINT8              *Pattern,
+  IN  CONST UINT8              *PatternMask OPTIONAL,
+  IN  UINT32                   PatternSize,
+  OUT INTERNAL_PATTERN_ANCHOR  *Anchor
+  )
+{
+  UINT32  Index;
+  UINT32  Rank;
+  UINT32  BestRank;
+  UINT8   Mask;
+
+  BestRank = 0;
+
+  for (Index = 0; Index < PatternSize; ++Index) {
+    Mask = PatternMask != NULL ? PatternMask[Index] : 0xFF;
+    if (Mask == 0) {
+      continue;
+    }
+
+    //
+    // Fully masked bytes rank above partially masked ones, uncommon
+    // bytes rank above common ones, and the earliest byte wins a tie.
+    //
+    for (Rank = 0; Rank < ARRAY_SIZE (mCommonCodeBytes); ++Rank) {
+      if (Pattern[Index] == mCommonCodeBytes[Rank]) {
+        break;
+      }
+    }
+
+    Rank += 1;
+    if (Mask == 0xFF) {
+      Rank += ARRAY_SIZE (mCommonCodeBytes) + 1;
+    }
+
+    if (Rank > BestRank) {
+      BestRank      = Rank;
+      Anchor->Index = Index;
+      Anchor->Value = PATTERN_BYTE_BROADCAST (Pattern[Index]);
+      Anchor->Mask  = PATTERN_BYTE_BROADCAST (Mask);
+    }
+  }
+
+  return BestRank > 0;
+}
+
+/**
+  Locate the first offset in [Offset, End) whose byte matches the anchor.
+
+  @retval Offset of the matching byte or End.
+**/
+STATIC
+UINT32
+InternalFindAnchor (
+  IN CONST INTERNAL_PATTERN_ANCHOR  *Anchor,
+  IN CONST UINT8                    *Data,
+  IN UINT32                         Offset,
+  IN UINT32                         End
+  )
+{
+  UINT64  Word;
+
+  //
+  // Matching bytes become zero after the XOR, and a word with a zero byte
+  // is detected with the usual borrow trick. It may flag extra bytes past
+  // the first zero one, so the flagged word is rescanned bytewise.
+  //
+  while (End - Offset >= PATTERN_WORD_SIZE) {
+    Word = (ReadUnaligned64 ((CONST UINT64 *)&Data[Offset]) & Anchor->Mask) ^ Anchor->Value;
+    if (((Word - 0x0101010101010101ULL) & ~Word & 0x8080808080808080ULL) != 0) {
+      break;
+    }
+
+    Offset += PATTERN_WORD_SIZE;
+  }
+
+  while (Offset < End) {
+    if ((Data[Offset] & (UINT8)Anchor->Mask) == (UINT8)Anchor->Value) {
+      return Offset;
+    }
+
+    ++Offset;
+  }
+
+  return End;
+}
+
+BOOLEAN
+MatchPattern (
   IN CONST UINT8   *Pattern,
   IN CONST UINT8   *PatternMask OPTIONAL,
   IN CONST UINT32  PatternSize,
-  IN CONST UINT8   *Data,
-  IN UINT32        DataSize,
-  IN OUT UINT32    *DataOff
+  IN CONST UINT8   *Data
   )
 {
   UINT32  Index;
+  UINT64  Mask;
+
+  Index = 0;
+
+  if (PatternMask == NULL) {
+    while (PatternSize - Index >= PATTERN_WORD_SIZE) {
+      if (ReadUnaligned64 ((CONST UINT64 *)&Data[Index]) != ReadUnaligned64 ((CONST UINT64 *)&Pattern[Index])) {
+        return FALSE;
+      }
+
+      Index += PATTERN_WORD_SIZE;
+    }
+
+    while (Index < PatternSize) {
+      if (Data[Index] != Pattern[Index]) {
+        return FALSE;
+      }
+
+      ++Index;
+    }
+  } else {
+    while (PatternSize - Index >= PATTERN_WORD_SIZE) {
+      Mask = ReadUnaligned64 ((CONST UINT64 *)&PatternMask[Index]);
+      if ((ReadUnaligned64 ((CONST UINT64 *)&Data[Index]) & Mask) != ReadUnaligned64 ((CONST UINT64 *)&Pattern[Index])) {
+        return FALSE;
+      }
+
+      Index += PATTERN_WORD_SIZE;
+    }
+
+    while (Index < PatternSize) {
+      if ((Data[Index] & PatternMask[Index]) != Pattern[Index]) {
+        return FALSE;
+      }
+
+      ++Index;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+InternalFindPattern (
+  IN CONST UINT8                    *Pattern,
+  IN CONST UINT8                    *PatternMask OPTIONAL,
+  IN CONST UINT32                   PatternSize,
+  IN CONST INTERNAL_PATTERN_ANCHOR  *Anchor OPTIONAL,
+  IN CONST UINT8                    *Data,
+  IN UINT32                         DataSize,
+  IN OUT UINT32                     *DataOff
+  )
+{
   UINT32  LastOffset;
   UINT32  CurrentOffset;
+  UINT32  AnchorEnd;
 
   ASSERT (DataSize >= PatternSize);
   ASSERT (DataOff != NULL);
@@ -43,39 +214,41 @@ InternalFindPattern (
   CurrentOffset = *DataOff;
   LastOffset    = DataSize - PatternSize;
 
-  if (PatternMask == NULL) {
-    while (CurrentOffset <= LastOffset) {
-      for (Index = 0; Index < PatternSize; ++Index) {
-        if (Data[CurrentOffset + Index] != Pattern[Index]) {
-          break;
-        }
-      }
+  if (CurrentOffset > LastOffset) {
+    return FALSE;
+  }
 
-      if (Index == PatternSize) {
-        *DataOff = CurrentOffset;
-        return TRUE;
-      }
+  //
+  // Fully masked out pattern does not depend on the data.
+  //
+  if (Anchor == NULL) {
+    return MatchPattern (Pattern, PatternMask, PatternSize, &Data[CurrentOffset]);
+  }
+
+  //
+  // Anchor byte offsets stay within the data, as Anchor->Index < PatternSize.
+  //
+  AnchorEnd = LastOffset + Anchor->Index + 1;
 
-      ++CurrentOffset;
+  while (TRUE) {
+    CurrentOffset = InternalFindAnchor (Anchor, Data, CurrentOffset + Anchor->Index, AnchorEnd);
+    if (CurrentOffset == AnchorEnd) {
+      return FALSE;
     }
-  } else {
-    while (CurrentOffset <= LastOffset) {
-      for (Index = 0; Index < PatternSize; ++Index) {
-        if ((Data[CurrentOffset + Index] & PatternMask[Index]) != Pattern[Index]) {
-          break;
-        }
-      }
 
-      if (Index == PatternSize) {
-        *DataOff = CurrentOffset;
-        return TRUE;
-      }
+    CurrentOffset -= Anchor->Index;
 
-      ++CurrentOffset;
+    if (MatchPattern (Pattern, PatternMask, PatternSize, &Data[CurrentOffset])) {
+      *DataOff = CurrentOffset;
+      return TRUE;
     }
-  }
 
-  return FALSE;
+    if (CurrentOffset == LastOffset) {
+      return FALSE;
+    }
+
+    ++CurrentOffset;
+  }
 }
 
 BOOLEAN
@@ -88,14 +261,20 @@ FindPattern (
   IN OUT UINT32    *DataOff
   )
 {
+  INTERNAL_PATTERN_ANCHOR  Anchor;
+  BOOLEAN                  HasAnchor;
+
   if (DataSize < PatternSize) {
     return FALSE;
   }
 
+  HasAnchor = InternalSelectAnchor (Pattern, PatternMask, PatternSize, &Anchor);
+
   return InternalFindPattern (
            Pattern,
            PatternMask,
            PatternSize,
+           HasAnchor ? &Anchor : NULL,
            Data,
            DataSize,
            DataOff
@@ -115,14 +294,18 @@ ApplyPatch (
   IN UINT32        Skip
   )
 {
-  UINT32   ReplaceCount;
-  UINT32   DataOff;
-  BOOLEAN  Found;
+  UINT32                   ReplaceCount;
+  UINT32                   DataOff;
+  BOOLEAN                  Found;
+  INTERNAL_PATTERN_ANCHOR  Anchor;
+  BOOLEAN                  HasAnchor;
 
   if (DataSize < PatternSize) {
     return 0;
   }
 
+  HasAnchor = InternalSelectAnchor (Pattern, PatternMask, PatternSize, &Anchor);
+
   ReplaceCount = 0;
   DataOff      = 0;
 
@@ -131,6 +314,7 @@ ApplyPatch (
               Pattern,
               PatternMask,
               PatternSize,
+              HasAnchor ? &Anchor : NULL,
               Data,
               DataSize,
               &DataOff
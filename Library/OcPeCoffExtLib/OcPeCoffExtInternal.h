@@ -29,4 +29,20 @@ typedef struct APPLE_SIGNATURE_CONTEXT_ {
   UINT8                Signature[256];
 } APPLE_SIGNATURE_CONTEXT;
 
+//
+// Number of remembered successful signature verifications.
+//
+#define APPLE_VERIFIED_CACHE_SIZE  4
+
+//
+// Successful signature verification.
+// RSA verification is deterministic, so the same digest signed
+// with the same signature and key needs no repeated verification.
+//
+typedef struct APPLE_VERIFIED_SIGNATURE_ {
+  OC_RSA_PUBLIC_KEY    *PublicKey;
+  UINT8                Hash[SHA256_DIGEST_SIZE];
+  UINT8                Signature[256];
+} APPLE_VERIFIED_SIGNATURE;
+
 #endif // OC_PE_COFF_EXT_INTERNAL_H
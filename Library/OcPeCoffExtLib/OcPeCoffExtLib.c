@@ -38,6 +38,9 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include "OcPeCoffExtInternal.h"
 
+STATIC APPLE_VERIFIED_SIGNATURE  mVerifiedSignatures[APPLE_VERIFIED_CACHE_SIZE];
+STATIC UINTN                     mVerifiedSignatureCount;
+
 STATIC
 RETURN_STATUS
 PeCoffGetSecurityDirectoryEntry (
@@ -376,6 +379,51 @@ PeCoffHashAppleImage (
   Sha256Final (&HashContext, Hash);
 }
 
+/**
+  Check whether the digest was already verified against the signature,
+  e.g. for the same APFS driver embedded in several containers.
+**/
+STATIC
+BOOLEAN
+PeCoffIsAppleSignatureVerified (
+  IN CONST APPLE_SIGNATURE_CONTEXT  *SignatureContext,
+  IN CONST UINT8                    *Hash
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MIN (mVerifiedSignatureCount, APPLE_VERIFIED_CACHE_SIZE); ++Index) {
+    if (  (mVerifiedSignatures[Index].PublicKey == SignatureContext->PublicKey)
+       && (CompareMem (mVerifiedSignatures[Index].Hash, Hash, SHA256_DIGEST_SIZE) == 0)
+       && (CompareMem (
+             mVerifiedSignatures[Index].Signature,
+             SignatureContext->Signature,
+             sizeof (SignatureContext->Signature)
+             ) == 0))
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+STATIC
+VOID
+PeCoffRememberAppleSignature (
+  IN CONST APPLE_SIGNATURE_CONTEXT  *SignatureContext,
+  IN CONST UINT8                    *Hash
+  )
+{
+  APPLE_VERIFIED_SIGNATURE  *Verified;
+
+  Verified            = &mVerifiedSignatures[mVerifiedSignatureCount % APPLE_VERIFIED_CACHE_SIZE];
+  Verified->PublicKey = SignatureContext->PublicKey;
+  CopyMem (Verified->Hash, Hash, SHA256_DIGEST_SIZE);
+  CopyMem (Verified->Signature, SignatureContext->Signature, sizeof (SignatureContext->Signature));
+  ++mVerifiedSignatureCount;
+}
+
 #ifndef EFIUSER
 STATIC
 #endif
@@ -435,6 +483,11 @@ InternalPeCoffVerifyAppleSignatureFromContext (
     &Hash[0]
     );
 
+  if (PeCoffIsAppleSignatureVerified (&SignatureContext, &Hash[0])) {
+    DEBUG ((DEBUG_INFO, "OCPE: PeCoff signature already verified\n"));
+    return EFI_SUCCESS;
+  }
+
   //
   // Verify signature
   //
@@ -451,6 +504,8 @@ InternalPeCoffVerifyAppleSignatureFromContext (
     return EFI_SECURITY_VIOLATION;
   }
 
+  PeCoffRememberAppleSignature (&SignatureContext, &Hash[0]);
+
   return EFI_SUCCESS;
 }
 
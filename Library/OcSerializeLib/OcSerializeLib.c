@@ -86,11 +86,31 @@ LookupConfigSchema (
   return NULL;
 }
 
+/**
+  Check whether schema entry at Index is selected by SectionMask.
+  Entries past the mask width are only selected by a full mask.
+**/
+STATIC
+BOOLEAN
+IsSectionSelected (
+  IN UINT32  SectionMask,
+  IN UINTN   Index
+  )
+{
+  if (Index >= 32) {
+    return SectionMask == MAX_UINT32;
+  }
+
+  return (SectionMask & (1U << Index)) != 0;
+}
+
+STATIC
 VOID
-ParseSerializedDict (
+ParseSerializedDictSections (
   OUT  VOID                *Serialized,
   IN       XML_NODE        *Node,
   IN       OC_SCHEMA_INFO  *Info,
+  IN       UINT32          SectionMask,
   IN       CONST CHAR8     *Context     OPTIONAL,
   IN  OUT  UINT32          *ErrorCount  OPTIONAL
   )
@@ -132,14 +152,20 @@ ParseSerializedDict (
     NewSchema = LookupConfigSchema (Info->Dict.Schema, Info->Dict.SchemaSize, CurrentKey);
 
     if (NewSchema == NULL) {
-      DEBUG ((DEBUG_WARN, "OCS: No schema for %a at %u index, context <%a>!\n", CurrentKey, Index, Context));
-      if (ErrorCount != NULL) {
-        ++*ErrorCount;
+      if (SectionMask == MAX_UINT32) {
+        DEBUG ((DEBUG_WARN, "OCS: No schema for %a at %u index, context <%a>!\n", CurrentKey, Index, Context));
+        if (ErrorCount != NULL) {
+          ++*ErrorCount;
+        }
       }
 
       continue;
     }
 
+    if (!IsSectionSelected (SectionMask, (UINTN)(NewSchema - Info->Dict.Schema))) {
+      continue;
+    }
+
     OldValue     = CurrentValue;
     CurrentValue = PlistNodeCast (CurrentValue, NewSchema->Type);
     if (CurrentValue == NULL) {
@@ -165,7 +191,7 @@ ParseSerializedDict (
   DEBUG_CODE_BEGIN ();
 
   for (Index = 0; Index < Info->Dict.SchemaSize; ++Index) {
-    if (Info->Dict.Schema[Index].Optional) {
+    if (Info->Dict.Schema[Index].Optional || !IsSectionSelected (SectionMask, Index)) {
       continue;
     }
 
@@ -197,6 +223,18 @@ ParseSerializedDict (
   DEBUG_CODE_END ();
 }
 
+VOID
+ParseSerializedDict (
+  OUT  VOID                *Serialized,
+  IN       XML_NODE        *Node,
+  IN       OC_SCHEMA_INFO  *Info,
+  IN       CONST CHAR8     *Context     OPTIONAL,
+  IN  OUT  UINT32          *ErrorCount  OPTIONAL
+  )
+{
+  ParseSerializedDictSections (Serialized, Node, Info, MAX_UINT32, Context, ErrorCount);
+}
+
 VOID
 ParseSerializedValue (
   OUT  VOID                *Serialized,
@@ -467,6 +505,40 @@ ParseSerializedArray (
   }
 }
 
+BOOLEAN
+ParseSerializedSections (
+  OUT  VOID                *Serialized,
+  IN       OC_SCHEMA_INFO  *RootSchema,
+  IN       XML_DOCUMENT    *Document,
+  IN       UINT32          SectionMask,
+  IN  OUT  UINT32          *ErrorCount  OPTIONAL
+  )
+{
+  XML_NODE  *RootDict;
+
+  RootDict = PlistNodeCast (PlistDocumentRoot (Document), PLIST_NODE_TYPE_DICT);
+
+  if (RootDict == NULL) {
+    DEBUG ((DEBUG_INFO, "OCS: Couldn't get serialized root!\n"));
+    if (ErrorCount != NULL) {
+      ++*ErrorCount;
+    }
+
+    return FALSE;
+  }
+
+  ParseSerializedDictSections (
+    Serialized,
+    RootDict,
+    RootSchema,
+    SectionMask,
+    "root",
+    ErrorCount
+    );
+
+  return TRUE;
+}
+
 BOOLEAN
 ParseSerialized (
   OUT  VOID                *Serialized,
@@ -477,7 +549,7 @@ ParseSerialized (
   )
 {
   XML_DOCUMENT  *Document;
-  XML_NODE      *RootDict;
+  BOOLEAN       Result;
 
   Document = XmlDocumentParse (PlistBuffer, PlistSize, FALSE);
 
@@ -490,26 +562,200 @@ ParseSerialized (
     return FALSE;
   }
 
-  RootDict = PlistNodeCast (PlistDocumentRoot (Document), PLIST_NODE_TYPE_DICT);
+  Result = ParseSerializedSections (Serialized, RootSchema, Document, MAX_UINT32, ErrorCount);
 
-  if (RootDict == NULL) {
-    DEBUG ((DEBUG_INFO, "OCS: Couldn't get serialized root!\n"));
-    XmlDocumentFree (Document);
-    if (ErrorCount != NULL) {
-      ++*ErrorCount;
+  XmlDocumentFree (Document);
+  return Result;
+}
+
+/**
+  Check whether two nodes have the same name, content and children.
+**/
+STATIC
+BOOLEAN
+SerializedNodeEqual (
+  IN XML_NODE  *Left,
+  IN XML_NODE  *Right
+  )
+{
+  CONST CHAR8  *LeftString;
+  CONST CHAR8  *RightString;
+  UINT32       Children;
+  UINT32       Index;
+
+  if ((Left == NULL) || (Right == NULL)) {
+    return Left == Right;
+  }
+
+  if (AsciiStrCmp (XmlNodeName (Left), XmlNodeName (Right)) != 0) {
+    return FALSE;
+  }
+
+  LeftString  = XmlNodeContent (Left);
+  RightString = XmlNodeContent (Right);
+  if ((LeftString == NULL) || (RightString == NULL)) {
+    if (LeftString != RightString) {
+      return FALSE;
     }
+  } else if (AsciiStrCmp (LeftString, RightString) != 0) {
+    return FALSE;
+  }
 
+  Children = XmlNodeChildren (Left);
+  if (Children != XmlNodeChildren (Right)) {
     return FALSE;
   }
 
-  ParseSerializedDict (
-    Serialized,
-    RootDict,
-    RootSchema,
-    "root",
-    ErrorCount
-    );
+  for (Index = 0; Index < Children; ++Index) {
+    if (!SerializedNodeEqual (XmlNodeChild (Left, Index), XmlNodeChild (Right, Index))) {
+      return FALSE;
+    }
+  }
 
-  XmlDocumentFree (Document);
   return TRUE;
 }
+
+/**
+  Find next value for Name in the dictionary starting at *Index.
+  Duplicate keys are applied in order, so they are compared in order too.
+**/
+STATIC
+XML_NODE *
+SerializedDictNext (
+  IN     XML_NODE     *Dict      OPTIONAL,
+  IN     CONST CHAR8  *Name,
+  IN OUT UINT32       *Index
+  )
+{
+  UINT32       DictSize;
+  CONST CHAR8  *Key;
+  XML_NODE     *Value;
+
+  if (Dict == NULL) {
+    return NULL;
+  }
+
+  DictSize = PlistDictChildren (Dict);
+
+  while (*Index < DictSize) {
+    Key = PlistKeyValue (PlistDictChild (Dict, *Index, &Value));
+    ++*Index;
+    if ((Key != NULL) && (AsciiStrCmp (Key, Name) == 0)) {
+      return Value;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Compare dictionary entries described by Info and report changed schema paths.
+  Path contains the dictionary path and is restored before returning.
+
+  @retval Mask of changed entries, entries past the mask width set the top bit.
+**/
+STATIC
+UINT32
+DiffSerializedDict (
+  IN     XML_NODE             *OldDict  OPTIONAL,
+  IN     XML_NODE             *NewDict  OPTIONAL,
+  IN     OC_SCHEMA_INFO       *Info,
+  IN OUT CHAR8                *Path,
+  IN     OC_SERIALIZE_REPORT  Report   OPTIONAL,
+  IN     VOID                 *Context  OPTIONAL
+  )
+{
+  UINT32     Changed;
+  UINT32     Index;
+  UINT32     OldIndex;
+  UINT32     NewIndex;
+  UINTN      PathLength;
+  OC_SCHEMA  *Schema;
+  XML_NODE   *OldValue;
+  XML_NODE   *NewValue;
+  XML_NODE   *OldChild;
+  XML_NODE   *NewChild;
+  BOOLEAN    Differs;
+
+  Changed    = 0;
+  PathLength = AsciiStrLen (Path);
+
+  for (Index = 0; Index < Info->Dict.SchemaSize; ++Index) {
+    Schema = &Info->Dict.Schema[Index];
+
+    if (PathLength > 0) {
+      AsciiStrCatS (Path, OC_SERIALIZE_PATH_MAX, "/");
+    }
+
+    AsciiStrCatS (Path, OC_SERIALIZE_PATH_MAX, Schema->Name);
+
+    Differs  = FALSE;
+    OldIndex = 0;
+    NewIndex = 0;
+    do {
+      OldValue = SerializedDictNext (OldDict, Schema->Name, &OldIndex);
+      NewValue = SerializedDictNext (NewDict, Schema->Name, &NewIndex);
+
+      if ((OldValue == NULL) && (NewValue == NULL)) {
+        break;
+      }
+
+      //
+      // Nested dictionaries are compared per key to report exact paths.
+      //
+      OldChild = PlistNodeCast (OldValue, PLIST_NODE_TYPE_DICT);
+      NewChild = PlistNodeCast (NewValue, PLIST_NODE_TYPE_DICT);
+      if (  (Schema->Apply == ParseSerializedDict)
+         && (OldChild != NULL)
+         && (NewChild != NULL))
+      {
+        if (DiffSerializedDict (OldChild, NewChild, &Schema->Info, Path, Report, Context) != 0) {
+          Differs = TRUE;
+        }
+      } else if (!SerializedNodeEqual (OldValue, NewValue)) {
+        if ((Report != NULL) && !Differs) {
+          Report (Context, Path);
+        }
+
+        Differs = TRUE;
+      }
+    } while ((OldValue != NULL) && (NewValue != NULL));
+
+    if (Differs) {
+      Changed |= Index < 32 ? (1U << Index) : BIT31;
+    }
+
+    Path[PathLength] = '\0';
+  }
+
+  return Changed;
+}
+
+UINT32
+DiffSerialized (
+  IN  OC_SCHEMA_INFO       *RootSchema,
+  IN  XML_DOCUMENT         *OldDocument,
+  IN  XML_DOCUMENT         *NewDocument,
+  IN  OC_SERIALIZE_REPORT  Report       OPTIONAL,
+  IN  VOID                 *Context     OPTIONAL
+  )
+{
+  XML_NODE  *OldRoot;
+  XML_NODE  *NewRoot;
+  CHAR8     Path[OC_SERIALIZE_PATH_MAX];
+  UINT32    Changed;
+
+  OldRoot = PlistNodeCast (PlistDocumentRoot (OldDocument), PLIST_NODE_TYPE_DICT);
+  NewRoot = PlistNodeCast (PlistDocumentRoot (NewDocument), PLIST_NODE_TYPE_DICT);
+
+  if ((OldRoot == NULL) || (NewRoot == NULL) || (RootSchema->Dict.SchemaSize > 32)) {
+    return MAX_UINT32;
+  }
+
+  Path[0] = '\0';
+  Changed = DiffSerializedDict (OldRoot, NewRoot, RootSchema, Path, Report, Context);
+
+  DEBUG ((DEBUG_VERBOSE, "OCS: Serialized sections changed %X\n", Changed));
+
+  return Changed;
+}
@@ -0,0 +1,523 @@
+/** @file
+  Binary snapshots of serialized data.
+
+  A snapshot stores the values in schema order without any names or
+  type information, so it can only be imported with the same schema.
+  Schema layout is hashed into the header to reject foreign snapshots.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Library/OcSerializeLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BaseOverflowLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#define OC_SNAPSHOT_SIGNATURE  SIGNATURE_32 ('O', 'C', 'S', 'N')
+#define OC_SNAPSHOT_VERSION    1
+
+//
+// Snapshot header followed by the values.
+// Values:     raw field contents.
+// Blobs:      UINT32 size followed by blob contents.
+// Arrays:     UINT32 count followed by the entries.
+// Maps:       UINT32 count followed by key blob and entry pairs.
+// Dicts:      schema entries in schema order.
+//
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    SchemaHash;
+  UINT32    Size;
+} OC_SNAPSHOT_HEADER;
+
+//
+// Snapshot representation of builtin appliers.
+//
+#define OC_SNAPSHOT_KIND_DICT         0
+#define OC_SNAPSHOT_KIND_VALUE        1
+#define OC_SNAPSHOT_KIND_BLOB         2
+#define OC_SNAPSHOT_KIND_MAP          3
+#define OC_SNAPSHOT_KIND_ARRAY        4
+#define OC_SNAPSHOT_KIND_UNSUPPORTED  5
+
+typedef struct {
+  //
+  // Output buffer, NULL to only calculate the size.
+  //
+  UINT8     *Buffer;
+  UINT32    Size;
+  UINT32    Offset;
+} OC_SNAPSHOT_WRITER;
+
+typedef struct {
+  CONST UINT8    *Buffer;
+  UINT32         Size;
+  UINT32         Offset;
+} OC_SNAPSHOT_READER;
+
+STATIC
+UINT32
+SnapshotSchemaKind (
+  IN OC_SCHEMA  *Schema
+  )
+{
+  if (Schema->Apply == ParseSerializedDict) {
+    return OC_SNAPSHOT_KIND_DICT;
+  }
+
+  if (Schema->Apply == ParseSerializedValue) {
+    return OC_SNAPSHOT_KIND_VALUE;
+  }
+
+  if (Schema->Apply == ParseSerializedBlob) {
+    return OC_SNAPSHOT_KIND_BLOB;
+  }
+
+  if (Schema->Apply == ParseSerializedMap) {
+    return OC_SNAPSHOT_KIND_MAP;
+  }
+
+  if (Schema->Apply == ParseSerializedArray) {
+    return OC_SNAPSHOT_KIND_ARRAY;
+  }
+
+  return OC_SNAPSHOT_KIND_UNSUPPORTED;
+}
+
+/**
+  FNV-1a hash step.
+**/
+STATIC
+UINT32
+SnapshotHashData (
+  IN UINT32      Hash,
+  IN CONST VOID  *Data,
+  IN UINTN       Size
+  )
+{
+  CONST UINT8  *Bytes;
+  UINTN        Index;
+
+  Bytes = Data;
+  for (Index = 0; Index < Size; ++Index) {
+    Hash = (Hash ^ Bytes[Index]) * 16777619U;
+  }
+
+  return Hash;
+}
+
+STATIC
+UINT32
+SnapshotHashSchema (
+  IN UINT32     Hash,
+  IN OC_SCHEMA  *Schema
+  )
+{
+  UINT32  Kind;
+  UINT32  Index;
+
+  if (Schema->Name != NULL) {
+    Hash = SnapshotHashData (Hash, Schema->Name, AsciiStrLen (Schema->Name));
+  }
+
+  Kind = SnapshotSchemaKind (Schema);
+  Hash = SnapshotHashData (Hash, &Kind, sizeof (Kind));
+
+  switch (Kind) {
+    case OC_SNAPSHOT_KIND_DICT:
+      for (Index = 0; Index < Schema->Info.Dict.SchemaSize; ++Index) {
+        Hash = SnapshotHashSchema (Hash, &Schema->Info.Dict.Schema[Index]);
+      }
+
+      break;
+    case OC_SNAPSHOT_KIND_VALUE:
+      Hash = SnapshotHashData (Hash, &Schema->Info.Value.Field, sizeof (Schema->Info.Value.Field));
+      Hash = SnapshotHashData (Hash, &Schema->Info.Value.FieldSize, sizeof (Schema->Info.Value.FieldSize));
+      Hash = SnapshotHashData (Hash, &Schema->Info.Value.Type, sizeof (Schema->Info.Value.Type));
+      break;
+    case OC_SNAPSHOT_KIND_BLOB:
+      Hash = SnapshotHashData (Hash, &Schema->Info.Blob.Field, sizeof (Schema->Info.Blob.Field));
+      Hash = SnapshotHashData (Hash, &Schema->Info.Blob.Type, sizeof (Schema->Info.Blob.Type));
+      break;
+    case OC_SNAPSHOT_KIND_MAP:
+    case OC_SNAPSHOT_KIND_ARRAY:
+      Hash = SnapshotHashData (Hash, &Schema->Info.List.Field, sizeof (Schema->Info.List.Field));
+      Hash = SnapshotHashSchema (Hash, Schema->Info.List.Schema);
+      break;
+    default:
+      break;
+  }
+
+  return Hash;
+}
+
+STATIC
+UINT32
+SnapshotHashRoot (
+  IN OC_SCHEMA_INFO  *RootSchema
+  )
+{
+  UINT32  Hash;
+  UINT32  Index;
+
+  Hash = 2166136261U;
+  for (Index = 0; Index < RootSchema->Dict.SchemaSize; ++Index) {
+    Hash = SnapshotHashSchema (Hash, &RootSchema->Dict.Schema[Index]);
+  }
+
+  return Hash;
+}
+
+STATIC
+BOOLEAN
+SnapshotWrite (
+  IN OUT OC_SNAPSHOT_WRITER  *Writer,
+  IN     CONST VOID          *Data,
+  IN     UINT32              Size
+  )
+{
+  UINT32  End;
+
+  if (BaseOverflowAddU32 (Writer->Offset, Size, &End)) {
+    return FALSE;
+  }
+
+  if (Writer->Buffer != NULL) {
+    if (End > Writer->Size) {
+      return FALSE;
+    }
+
+    CopyMem (&Writer->Buffer[Writer->Offset], Data, Size);
+  }
+
+  Writer->Offset = End;
+  return TRUE;
+}
+
+STATIC
+CONST VOID *
+SnapshotRead (
+  IN OUT OC_SNAPSHOT_READER  *Reader,
+  IN     UINT32              Size
+  )
+{
+  CONST VOID  *Data;
+
+  if (Reader->Size - Reader->Offset < Size) {
+    return NULL;
+  }
+
+  Data            = &Reader->Buffer[Reader->Offset];
+  Reader->Offset += Size;
+  return Data;
+}
+
+STATIC
+BOOLEAN
+SnapshotReadUint32 (
+  IN OUT OC_SNAPSHOT_READER  *Reader,
+  OUT    UINT32              *Value
+  )
+{
+  CONST VOID  *Data;
+
+  Data = SnapshotRead (Reader, sizeof (*Value));
+  if (Data == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (Value, Data, sizeof (*Value));
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+ExportSnapshotBlob (
+  IN OUT OC_SNAPSHOT_WRITER  *Writer,
+  IN     VOID                *Field
+  )
+{
+  OC_DATA  *Blob;
+
+  //
+  // All blobs share OC_BLOB layout regardless of the value type.
+  //
+  Blob = Field;
+  return (  SnapshotWrite (Writer, &Blob->Size, sizeof (Blob->Size))
+          && SnapshotWrite (Writer, OC_BLOB_GET (Blob), Blob->Size));
+}
+
+STATIC
+BOOLEAN
+ExportSnapshotEntry (
+  IN OUT OC_SNAPSHOT_WRITER  *Writer,
+  IN     CONST VOID          *Serialized,
+  IN     OC_SCHEMA           *Schema
+  )
+{
+  UINT32    Kind;
+  UINT32    Index;
+  OC_ASSOC  *List;
+
+  Kind = SnapshotSchemaKind (Schema);
+
+  switch (Kind) {
+    case OC_SNAPSHOT_KIND_DICT:
+      for (Index = 0; Index < Schema->Info.Dict.SchemaSize; ++Index) {
+        if (!ExportSnapshotEntry (Writer, Serialized, &Schema->Info.Dict.Schema[Index])) {
+          return FALSE;
+        }
+      }
+
+      return TRUE;
+    case OC_SNAPSHOT_KIND_VALUE:
+      return SnapshotWrite (
+               Writer,
+               OC_SCHEMA_FIELD (Serialized, VOID, Schema->Info.Value.Field),
+               Schema->Info.Value.FieldSize
+               );
+    case OC_SNAPSHOT_KIND_BLOB:
+      return ExportSnapshotBlob (Writer, OC_SCHEMA_FIELD (Serialized, VOID, Schema->Info.Blob.Field));
+    case OC_SNAPSHOT_KIND_MAP:
+    case OC_SNAPSHOT_KIND_ARRAY:
+      //
+      // Arrays share Count and Values layout with maps.
+      //
+      List = OC_SCHEMA_FIELD (Serialized, OC_ASSOC, Schema->Info.List.Field);
+      if (!SnapshotWrite (Writer, &List->Count, sizeof (List->Count))) {
+        return FALSE;
+      }
+
+      for (Index = 0; Index < List->Count; ++Index) {
+        if ((Kind == OC_SNAPSHOT_KIND_MAP) && !ExportSnapshotBlob (Writer, List->Keys[Index])) {
+          return FALSE;
+        }
+
+        if (!ExportSnapshotEntry (Writer, List->Values[Index], Schema->Info.List.Schema)) {
+          return FALSE;
+        }
+      }
+
+      return TRUE;
+    default:
+      DEBUG ((DEBUG_INFO, "OCS: Snapshot does not support custom applier for %a\n", Schema->Name));
+      return FALSE;
+  }
+}
+
+STATIC
+BOOLEAN
+ImportSnapshotBlob (
+  IN OUT OC_SNAPSHOT_READER  *Reader,
+  OUT    VOID                *Field,
+  IN     BOOLEAN             IsString
+  )
+{
+  UINT32       Size;
+  CONST UINT8  *Data;
+  VOID         *Memory;
+
+  if (!SnapshotReadUint32 (Reader, &Size)) {
+    return FALSE;
+  }
+
+  Data = SnapshotRead (Reader, Size);
+  if (Data == NULL) {
+    return FALSE;
+  }
+
+  //
+  // Strings parsed from plist are always terminated, empty default strings have no size.
+  //
+  if (IsString && (Size > 0) && (Data[Size - 1] != '\0')) {
+    return FALSE;
+  }
+
+  Memory = OcBlobAllocate (Field, Size, NULL);
+  if (Memory == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (Memory, Data, Size);
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+ImportSnapshotEntry (
+  IN OUT OC_SNAPSHOT_READER  *Reader,
+  OUT    VOID                *Serialized,
+  IN     OC_SCHEMA           *Schema
+  )
+{
+  UINT32      Kind;
+  UINT32      Index;
+  UINT32      Count;
+  CONST VOID  *Data;
+  VOID        *Field;
+  VOID        *NewValue;
+  VOID        *NewKey;
+
+  Kind = SnapshotSchemaKind (Schema);
+
+  switch (Kind) {
+    case OC_SNAPSHOT_KIND_DICT:
+      for (Index = 0; Index < Schema->Info.Dict.SchemaSize; ++Index) {
+        if (!ImportSnapshotEntry (Reader, Serialized, &Schema->Info.Dict.Schema[Index])) {
+          return FALSE;
+        }
+      }
+
+      return TRUE;
+    case OC_SNAPSHOT_KIND_VALUE:
+      Data = SnapshotRead (Reader, Schema->Info.Value.FieldSize);
+      if (Data == NULL) {
+        return FALSE;
+      }
+
+      Field = OC_SCHEMA_FIELD (Serialized, VOID, Schema->Info.Value.Field);
+      CopyMem (Field, Data, Schema->Info.Value.FieldSize);
+
+      return (Schema->Info.Value.Type != OC_SCHEMA_VALUE_STRING)
+             || (AsciiStrnLenS (Field, Schema->Info.Value.FieldSize) < Schema->Info.Value.FieldSize);
+    case OC_SNAPSHOT_KIND_BLOB:
+      return ImportSnapshotBlob (
+               Reader,
+               OC_SCHEMA_FIELD (Serialized, VOID, Schema->Info.Blob.Field),
+               Schema->Info.Blob.Type == OC_SCHEMA_BLOB_STRING
+               );
+    case OC_SNAPSHOT_KIND_MAP:
+    case OC_SNAPSHOT_KIND_ARRAY:
+      if (!SnapshotReadUint32 (Reader, &Count)) {
+        return FALSE;
+      }
+
+      //
+      // Every entry takes at least one byte, reject counts we cannot satisfy.
+      //
+      if (Count > Reader->Size - Reader->Offset) {
+        return FALSE;
+      }
+
+      Field = OC_SCHEMA_FIELD (Serialized, VOID, Schema->Info.List.Field);
+
+      for (Index = 0; Index < Count; ++Index) {
+        if (!OcListEntryAllocate (Field, &NewValue, Kind == OC_SNAPSHOT_KIND_MAP ? &NewKey : NULL)) {
+          return FALSE;
+        }
+
+        if ((Kind == OC_SNAPSHOT_KIND_MAP) && !ImportSnapshotBlob (Reader, NewKey, TRUE)) {
+          return FALSE;
+        }
+
+        if (!ImportSnapshotEntry (Reader, NewValue, Schema->Info.List.Schema)) {
+          return FALSE;
+        }
+      }
+
+      return TRUE;
+    default:
+      DEBUG ((DEBUG_INFO, "OCS: Snapshot does not support custom applier for %a\n", Schema->Name));
+      return FALSE;
+  }
+}
+
+VOID *
+ExportSerializedSnapshot (
+  IN   CONST VOID      *Serialized,
+  IN   OC_SCHEMA_INFO  *RootSchema,
+  OUT  UINT32          *SnapshotSize
+  )
+{
+  OC_SNAPSHOT_WRITER  Writer;
+  OC_SNAPSHOT_HEADER  Header;
+  OC_SCHEMA           Root;
+
+  Root.Name     = NULL;
+  Root.Type     = PLIST_NODE_TYPE_DICT;
+  Root.Optional = FALSE;
+  Root.Apply    = ParseSerializedDict;
+  Root.Info     = *RootSchema;
+
+  //
+  // Measure first, then write into the exact size buffer.
+  //
+  ZeroMem (&Writer, sizeof (Writer));
+  Writer.Offset = sizeof (Header);
+  if (!ExportSnapshotEntry (&Writer, Serialized, &Root)) {
+    return NULL;
+  }
+
+  Writer.Size   = Writer.Offset;
+  Writer.Offset = sizeof (Header);
+  Writer.Buffer = AllocatePool (Writer.Size);
+  if (Writer.Buffer == NULL) {
+    return NULL;
+  }
+
+  if (!ExportSnapshotEntry (&Writer, Serialized, &Root) || (Writer.Offset != Writer.Size)) {
+    FreePool (Writer.Buffer);
+    return NULL;
+  }
+
+  Header.Signature  = OC_SNAPSHOT_SIGNATURE;
+  Header.Version    = OC_SNAPSHOT_VERSION;
+  Header.SchemaHash = SnapshotHashRoot (RootSchema);
+  Header.Size       = Writer.Size;
+  CopyMem (Writer.Buffer, &Header, sizeof (Header));
+
+  *SnapshotSize = Writer.Size;
+  return Writer.Buffer;
+}
+
+BOOLEAN
+ImportSerializedSnapshot (
+  OUT  VOID            *Serialized,
+  IN   OC_SCHEMA_INFO  *RootSchema,
+  IN   CONST VOID      *Snapshot,
+  IN   UINT32          SnapshotSize
+  )
+{
+  OC_SNAPSHOT_READER  Reader;
+  OC_SNAPSHOT_HEADER  Header;
+  OC_SCHEMA           Root;
+
+  if (SnapshotSize < sizeof (Header)) {
+    return FALSE;
+  }
+
+  CopyMem (&Header, Snapshot, sizeof (Header));
+  if (  (Header.Signature != OC_SNAPSHOT_SIGNATURE)
+     || (Header.Version != OC_SNAPSHOT_VERSION)
+     || (Header.Size != SnapshotSize))
+  {
+    DEBUG ((DEBUG_INFO, "OCS: Invalid snapshot header\n"));
+    return FALSE;
+  }
+
+  if (Header.SchemaHash != SnapshotHashRoot (RootSchema)) {
+    DEBUG ((DEBUG_INFO, "OCS: Snapshot schema mismatch %08X\n", Header.SchemaHash));
+    return FALSE;
+  }
+
+  Root.Name     = NULL;
+  Root.Type     = PLIST_NODE_TYPE_DICT;
+  Root.Optional = FALSE;
+  Root.Apply    = ParseSerializedDict;
+  Root.Info     = *RootSchema;
+
+  Reader.Buffer = Snapshot;
+  Reader.Size   = SnapshotSize;
+  Reader.Offset = sizeof (Header);
+
+  if (!ImportSnapshotEntry (&Reader, Serialized, &Root) || (Reader.Offset != Reader.Size)) {
+    DEBUG ((DEBUG_INFO, "OCS: Malformed snapshot at %u\n", Reader.Offset));
+    return FALSE;
+  }
+
+  return TRUE;
+}
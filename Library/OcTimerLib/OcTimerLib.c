@@ -26,7 +26,30 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/TimerLib.h>
 
-STATIC UINT64  mTscFrequency = 0;
+STATIC UINT64   mTscFrequency         = 0;
+STATIC BOOLEAN  mTscFrequencyEstimate = FALSE;
+
+/**
+  Return cached TSC frequency, replacing the estimate once calibration
+  completes. Delays may be requested at any TPL, so the frequency is only
+  queried again when it is already cached by OcCpuLib.
+
+  @retval               The timer frequency in use.
+
+**/
+STATIC
+UINT64
+InternalGetTscFrequency (
+  VOID
+  )
+{
+  if (mTscFrequencyEstimate && !OcIsTSCFrequencyEstimate ()) {
+    mTscFrequency         = OcGetTSCFrequency ();
+    mTscFrequencyEstimate = OcIsTSCFrequencyEstimate ();
+  }
+
+  return mTscFrequency;
+}
 
 /**
   Stalls the CPU for at least the given number of ticks.
@@ -77,12 +100,15 @@ MicroSecondDelay (
   IN      UINTN  MicroSeconds
   )
 {
-  if (mTscFrequency > 0) {
+  UINT64  Frequency;
+
+  Frequency = InternalGetTscFrequency ();
+  if (Frequency > 0) {
     InternalCpuDelay (
       DivU64x32 (
         MultU64x64 (
           MicroSeconds,
-          mTscFrequency
+          Frequency
           ),
         1000000u
         )
@@ -108,12 +134,15 @@ NanoSecondDelay (
   IN      UINTN  NanoSeconds
   )
 {
-  if (mTscFrequency > 0) {
+  UINT64  Frequency;
+
+  Frequency = InternalGetTscFrequency ();
+  if (Frequency > 0) {
     InternalCpuDelay (
       DivU64x32 (
         MultU64x64 (
           NanoSeconds,
-          mTscFrequency
+          Frequency
           ),
         1000000000u
         )
@@ -181,7 +210,7 @@ GetPerformanceCounterProperties (
     *EndValue = 0xffffffffffffffffULL;
   }
 
-  return mTscFrequency;
+  return InternalGetTscFrequency ();
 }
 
 /**
@@ -244,7 +273,7 @@ GetTscFrequency (
   VOID
   )
 {
-  return mTscFrequency;
+  return InternalGetTscFrequency ();
 }
 
 /**
@@ -259,7 +288,8 @@ OcTimerLibConstructor (
   VOID
   )
 {
-  mTscFrequency = OcGetTSCFrequency ();
+  mTscFrequency         = OcGetTSCFrequency ();
+  mTscFrequencyEstimate = OcIsTSCFrequencyEstimate ();
 
   return EFI_SUCCESS;
 }
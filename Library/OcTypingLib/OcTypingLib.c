@@ -79,6 +79,7 @@ HandleKeyEvent (
 
   Context->Buffer[Context->Head].AppleKeyCode = AppleKeyCode;
   Context->Buffer[Context->Head].UnicodeChar  = UnicodeChar;
+  Context->Buffer[Context->Head].EventTime    = GetPerformanceCounter ();
 
  #if defined (OC_TRACE_KEY_TIMES)
   DEBUG_CODE_BEGIN ();
@@ -119,7 +120,11 @@ OcRegisterTypingHandler (
     return Status;
   }
 
-  (*Context)->KeyTimes = NULL;
+  (*Context)->KeyTimes       = NULL;
+  (*Context)->PendingKeyTime = 0;
+  (*Context)->LatencyCount   = 0;
+  (*Context)->LatencyTotal   = 0;
+  (*Context)->LatencyMax     = 0;
 
  #if defined (OC_TRACE_KEY_TIMES)
   DEBUG_CODE_BEGIN ();
@@ -184,6 +189,16 @@ OcUnregisterTypingHandler (
 
   DEBUG ((OC_TRACE_TYPING, "OCTY: unreg c=%p h=%p k=%p\n", *Context, (*Context)->Handle, (*Context)->KeyTimes));
 
+  if ((*Context)->LatencyCount > 0) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCTY: Key latency %Lu us avg, %Lu us max over %Lu keys\n",
+      DivU64x64Remainder ((*Context)->LatencyTotal, (*Context)->LatencyCount, NULL),
+      (*Context)->LatencyMax,
+      (*Context)->LatencyCount
+      ));
+  }
+
   if ((*Context)->Handle == NULL) {
     Status = EFI_NOT_STARTED;
   } else {
@@ -264,7 +279,8 @@ OcGetNextKeystroke (
   *AppleKeyCode = Context->Buffer[NewTail].AppleKeyCode;
   *UnicodeChar  = Context->Buffer[NewTail].UnicodeChar;
 
-  Context->Tail = NewTail;
+  Context->PendingKeyTime = Context->Buffer[NewTail].EventTime;
+  Context->Tail           = NewTail;
 
  #if defined (OC_TRACE_KEY_TIMES)
   DEBUG_CODE_BEGIN ();
@@ -276,6 +292,34 @@ OcGetNextKeystroke (
  #endif
 }
 
+VOID
+OcRecordKeyLatency (
+  IN OC_TYPING_CONTEXT  *Context
+  )
+{
+  UINT64  Latency;
+
+  ASSERT (Context != NULL);
+
+  if (Context->PendingKeyTime == 0) {
+    return;
+  }
+
+  Latency = DivU64x32 (
+              GetTimeInNanoSecond (GetPerformanceCounter () - Context->PendingKeyTime),
+              1000
+              );
+
+  Context->PendingKeyTime = 0;
+  ++Context->LatencyCount;
+  Context->LatencyTotal += Latency;
+  if (Latency > Context->LatencyMax) {
+    Context->LatencyMax = Latency;
+  }
+
+  DEBUG ((OC_TRACE_TYPING, "OCTY: Key latency %Lu us\n", Latency));
+}
+
 VOID
 OcFlushTypingBuffer (
   IN OC_TYPING_CONTEXT  *Context
@@ -284,5 +328,6 @@ OcFlushTypingBuffer (
   Context->Tail             = 0;
   Context->Head             = 0;
   Context->CurrentModifiers = 0;
+  Context->PendingKeyTime   = 0;
   DEBUG ((OC_TRACE_TYPING, "OCTY: OcFlushTypingBuffer %d %d %d\n", Context->Tail, Context->Head, Context->CurrentModifiers));
 }
@@ -6,11 +6,15 @@
 **/
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/OcCryptoLib.h>
 #include <Library/OcFileLib.h>
 #include <Library/OcSerializeLib.h>
 #include <Library/OcVariableLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 
@@ -19,17 +23,70 @@
 #define BASE64_CHUNK_SIZE     (52)
 #define NVRAM_PLIST_MAX_SIZE  (BASE_1MB)
 
+#define OC_NVRAM_BINARY_SIGNATURE  SIGNATURE_32 ('O', 'C', 'N', 'V')
+#define OC_NVRAM_BINARY_VERSION    1
+
 typedef struct {
-  UINT8                     *DataBuffer;
-  UINTN                     DataBufferSize;
-  CHAR8                     *Base64Buffer;
-  UINTN                     Base64BufferSize;
-  OC_ASCII_STRING_BUFFER    *StringBuffer;
-  GUID                      SectionGuid;
+  UINT8    *Data;
+  UINTN    Size;
+  UINTN    AllocatedSize;
+} NVRAM_BINARY_BUFFER;
+
+//
+// Cached serialization of a single legacy map GUID section.
+//
+typedef struct {
+  GUID                      Guid;
   OC_NVRAM_LEGACY_ENTRY     *SchemaEntry;
-  EFI_STATUS                Status;
+  BOOLEAN                   Enabled;
+  BOOLEAN                   Cached;
+  BOOLEAN                   Dirty;
+  SHA256_CONTEXT            HashContext;
+  UINT8                     Digest[SHA256_DIGEST_SIZE];
+  UINT32                    VariableCount;
+  OC_ASCII_STRING_BUFFER    *Plist;
+  NVRAM_BINARY_BUFFER       Binary;
+} NVRAM_SECTION_CACHE;
+
+typedef struct {
+  UINT8         *DataBuffer;
+  UINTN         DataBufferSize;
+  CHAR8         *Base64Buffer;
+  UINTN         Base64BufferSize;
+  BOOLEAN       Serialize;
+  EFI_STATUS    Status;
 } NVRAM_SAVE_CONTEXT;
 
+#pragma pack(push, 1)
+
+//
+// Binary NVRAM file (nvram.bin) layout. The file is only valid for the nvram.plist
+// with the matching digest, which remains the authoritative storage.
+//
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    Size;
+  UINT32    SectionCount;
+  UINT8     PlistDigest[SHA256_DIGEST_SIZE];
+} OC_NVRAM_BINARY_HEADER;
+
+typedef struct {
+  GUID      Guid;
+  UINT32    Size;
+  UINT32    VariableCount;
+} OC_NVRAM_BINARY_SECTION;
+
+//
+// Followed by null-terminated ASCII name and data, padded to UINT32.
+//
+typedef struct {
+  UINT32    NameSize;
+  UINT32    DataSize;
+} OC_NVRAM_BINARY_VARIABLE;
+
+#pragma pack(pop)
+
 /**
   Version check for NVRAM file. Not the same as protocol revision.
 **/
@@ -82,6 +139,26 @@ STATIC
 OC_NVRAM_LEGACY_MAP
 *mLegacyMap = NULL;
 
+STATIC
+NVRAM_SECTION_CACHE
+*mSectionCache = NULL;
+
+STATIC
+UINT32
+  mSectionCount = 0;
+
+STATIC
+UINT8
+  mPlistDigest[SHA256_DIGEST_SIZE];
+
+STATIC
+BOOLEAN
+  mPlistDigestValid = FALSE;
+
+STATIC
+BOOLEAN
+  mBinaryCurrent = FALSE;
+
 STATIC
 EFI_STATUS
 LocateNvramDir (
@@ -115,6 +192,160 @@ LocateNvramDir (
   return Status;
 }
 
+/**
+  Check that the binary NVRAM file is well formed and optionally apply it.
+
+  @param[in]  Buffer           Binary NVRAM file contents.
+  @param[in]  Size             Binary NVRAM file size.
+  @param[in]  Apply            TRUE to set variables, FALSE to validate only.
+  @param[in]  LegacyOverwrite  OpenCore NVRAM LegacyOverwrite setting.
+
+  @retval EFI_SUCCESS          File is valid (and was applied).
+  @retval EFI_UNSUPPORTED      File is damaged.
+**/
+STATIC
+EFI_STATUS
+InternalProcessBinaryNvram (
+  IN UINT8    *Buffer,
+  IN UINT32   Size,
+  IN BOOLEAN  Apply,
+  IN BOOLEAN  LegacyOverwrite
+  )
+{
+  EFI_STATUS                Status;
+  OC_NVRAM_BINARY_HEADER    *Header;
+  OC_NVRAM_BINARY_SECTION   *Section;
+  OC_NVRAM_BINARY_VARIABLE  *Variable;
+  OC_NVRAM_LEGACY_ENTRY     *SchemaEntry;
+  CHAR8                     AsciiGuid[sizeof ("00000000-0000-0000-0000-000000000000")];
+  GUID                      VariableGuid;
+  CHAR8                     *VariableName;
+  UINT32                    SectionIndex;
+  UINT32                    VariableIndex;
+  UINT32                    Offset;
+  UINT32                    SectionEnd;
+  UINT32                    RecordSize;
+
+  Header = (OC_NVRAM_BINARY_HEADER *)Buffer;
+  Offset = sizeof (*Header);
+
+  for (SectionIndex = 0; SectionIndex < Header->SectionCount; ++SectionIndex) {
+    if (Size - Offset < sizeof (*Section)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    Section = (OC_NVRAM_BINARY_SECTION *)(Buffer + Offset);
+    if ((Section->Size < sizeof (*Section)) || (Section->Size > Size - Offset)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    SectionEnd = Offset + Section->Size;
+    Offset    += sizeof (*Section);
+
+    //
+    // Match nvram.plist loading, where sections are looked up by their printed GUID.
+    //
+    Status = EFI_NOT_FOUND;
+    if (Apply) {
+      AsciiSPrint (AsciiGuid, sizeof (AsciiGuid), "%g", &Section->Guid);
+      Status = OcProcessVariableGuid (AsciiGuid, &VariableGuid, mLegacyMap, &SchemaEntry);
+    }
+
+    for (VariableIndex = 0; VariableIndex < Section->VariableCount; ++VariableIndex) {
+      if (SectionEnd - Offset < sizeof (*Variable)) {
+        return EFI_UNSUPPORTED;
+      }
+
+      Variable   = (OC_NVRAM_BINARY_VARIABLE *)(Buffer + Offset);
+      RecordSize = SectionEnd - Offset - sizeof (*Variable);
+      if (  (Variable->NameSize == 0)
+         || (Variable->NameSize > RecordSize)
+         || (Variable->DataSize > RecordSize - Variable->NameSize))
+      {
+        return EFI_UNSUPPORTED;
+      }
+
+      VariableName = (CHAR8 *)(Variable + 1);
+      if (VariableName[Variable->NameSize - 1] != '\0') {
+        return EFI_UNSUPPORTED;
+      }
+
+      RecordSize = ALIGN_VALUE (sizeof (*Variable) + Variable->NameSize + Variable->DataSize, sizeof (UINT32));
+      if (RecordSize > SectionEnd - Offset) {
+        return EFI_UNSUPPORTED;
+      }
+
+      if (Apply && !EFI_ERROR (Status)) {
+        OcSetNvramVariable (
+          VariableName,
+          &VariableGuid,
+          OPEN_CORE_NVRAM_NV_ATTR,
+          Variable->DataSize,
+          VariableName + Variable->NameSize,
+          SchemaEntry,
+          LegacyOverwrite
+          );
+      }
+
+      Offset += RecordSize;
+    }
+
+    Offset = SectionEnd;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Load NVRAM from binary file saved alongside nvram.plist.
+  The binary file is only used when it was produced from the current nvram.plist.
+
+  @param[in]  Buffer           Binary NVRAM file contents.
+  @param[in]  Size             Binary NVRAM file size.
+  @param[in]  LegacyOverwrite  OpenCore NVRAM LegacyOverwrite setting.
+
+  @retval EFI_SUCCESS          NVRAM was loaded.
+  @retval EFI_NOT_FOUND        Binary file is outdated.
+  @retval EFI_UNSUPPORTED      Binary file is damaged.
+**/
+STATIC
+EFI_STATUS
+InternalLoadBinaryNvram (
+  IN UINT8    *Buffer,
+  IN UINT32   Size,
+  IN BOOLEAN  LegacyOverwrite
+  )
+{
+  EFI_STATUS              Status;
+  OC_NVRAM_BINARY_HEADER  *Header;
+
+  if (Size < sizeof (*Header)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Header = (OC_NVRAM_BINARY_HEADER *)Buffer;
+  if (  (Header->Signature != OC_NVRAM_BINARY_SIGNATURE)
+     || (Header->Version != OC_NVRAM_BINARY_VERSION)
+     || (Header->Size != Size))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (!mPlistDigestValid || (CompareMem (Header->PlistDigest, mPlistDigest, sizeof (mPlistDigest)) != 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Validate everything first, so that damaged file is not partially applied.
+  //
+  Status = InternalProcessBinaryNvram (Buffer, Size, FALSE, LegacyOverwrite);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return InternalProcessBinaryNvram (Buffer, Size, TRUE, LegacyOverwrite);
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -128,6 +359,8 @@ LoadNvram (
   EFI_FILE_PROTOCOL      *NvramDir;
   UINT8                  *FileBuffer;
   UINT32                 FileSize;
+  UINT8                  *BinaryBuffer;
+  UINT32                 BinarySize;
   BOOLEAN                IsValid;
   OC_NVRAM_STORAGE       NvramStorage;
   UINT32                 GuidIndex;
@@ -135,6 +368,7 @@ LoadNvram (
   GUID                   VariableGuid;
   OC_ASSOC               *VariableMap;
   OC_NVRAM_LEGACY_ENTRY  *SchemaEntry;
+  UINT64                 StartTime;
 
   if ((mStorageContext != NULL) || (mLegacyMap != NULL)) {
     return EFI_ALREADY_STARTED;
@@ -147,13 +381,21 @@ LoadNvram (
   mStorageContext = StorageContext;
   mLegacyMap      = LegacyMap;
 
+  StartTime = GetPerformanceCounter ();
+
   Status = LocateNvramDir (&NvramDir);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  FileBuffer = OcReadFileFromDirectory (NvramDir, OPEN_CORE_NVRAM_FILENAME, &FileSize, NVRAM_PLIST_MAX_SIZE);
-  if (FileBuffer == NULL) {
+  BinaryBuffer = NULL;
+  BinarySize   = 0;
+  FileBuffer   = OcReadFileFromDirectory (NvramDir, OPEN_CORE_NVRAM_FILENAME, &FileSize, NVRAM_PLIST_MAX_SIZE);
+  if (FileBuffer != NULL) {
+    Sha256 (mPlistDigest, FileBuffer, FileSize);
+    mPlistDigestValid = TRUE;
+    BinaryBuffer      = OcReadFileFromDirectory (NvramDir, OPEN_CORE_NVRAM_BINARY_FILENAME, &BinarySize, NVRAM_PLIST_MAX_SIZE);
+  } else {
     FileBuffer = OcReadFileFromDirectory (NvramDir, OPEN_CORE_NVRAM_FALLBACK_FILENAME, &FileSize, NVRAM_PLIST_MAX_SIZE);
   }
 
@@ -162,6 +404,24 @@ LoadNvram (
     return EFI_NOT_FOUND;
   }
 
+  if (BinaryBuffer != NULL) {
+    Status = InternalLoadBinaryNvram (BinaryBuffer, BinarySize, LegacyOverwrite);
+    FreePool (BinaryBuffer);
+    if (!EFI_ERROR (Status)) {
+      FreePool (FileBuffer);
+      mBinaryCurrent = TRUE;
+      DEBUG ((
+        DEBUG_INFO,
+        "OCVR: Loaded NVRAM from %s in %Lu us\n",
+        OPEN_CORE_NVRAM_BINARY_FILENAME,
+        DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000)
+        ));
+      return EFI_SUCCESS;
+    }
+
+    DEBUG ((DEBUG_INFO, "OCVR: Ignoring %s - %r\n", OPEN_CORE_NVRAM_BINARY_FILENAME, Status));
+  }
+
   OC_NVRAM_STORAGE_CONSTRUCT (&NvramStorage, sizeof (NvramStorage));
   IsValid = ParseSerialized (&NvramStorage, &mNvramStorageRootSchema, FileBuffer, FileSize, NULL);
   FreePool (FileBuffer);
@@ -217,6 +477,12 @@ LoadNvram (
 
   OC_NVRAM_STORAGE_DESTRUCT (&NvramStorage, sizeof (NvramStorage));
 
+  DEBUG ((
+    DEBUG_INFO,
+    "OCVR: Loaded NVRAM from plist in %Lu us\n",
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000)
+    ));
+
   return EFI_SUCCESS;
 }
 
@@ -239,93 +505,174 @@ DeleteFile (
   return Status;
 }
 
-//
-// Serialize one section at a time, NVRAM scan per section.
-//
+/**
+  Reserve zeroed space at the end of binary buffer, resizing if necessary.
+
+  @param[in,out]  Buffer  Binary buffer.
+  @param[in]      Size    Size to reserve.
+
+  @return Pointer to reserved space or NULL when out of memory.
+**/
 STATIC
-OC_PROCESS_VARIABLE_RESULT
-EFIAPI
-SerializeSectionVariables (
-  IN EFI_GUID  *Guid,
-  IN CHAR16    *Name,
-  IN VOID      *Context
+VOID *
+InternalBinaryBufferReserve (
+  IN OUT NVRAM_BINARY_BUFFER  *Buffer,
+  IN     UINTN                Size
   )
 {
-  EFI_STATUS          Status;
-  NVRAM_SAVE_CONTEXT  *SaveContext;
-  UINT32              Attributes;
-  UINTN               DataSize;
-  UINTN               Base64Size;
-  UINTN               Base64Pos;
+  UINTN  NewSize;
+  UINT8  *NewData;
+  VOID   *Result;
+
+  if (Size > Buffer->AllocatedSize - Buffer->Size) {
+    NewSize = MAX (Buffer->AllocatedSize, BASE_1KB);
+    while (Size > NewSize - Buffer->Size) {
+      if (BaseOverflowMulUN (NewSize, 2, &NewSize)) {
+        return NULL;
+      }
+    }
 
-  ASSERT (Context != NULL);
-  SaveContext = Context;
+    NewData = ReallocatePool (Buffer->AllocatedSize, NewSize, Buffer->Data);
+    if (NewData == NULL) {
+      return NULL;
+    }
+
+    Buffer->Data          = NewData;
+    Buffer->AllocatedSize = NewSize;
+  }
+
+  Result        = Buffer->Data + Buffer->Size;
+  Buffer->Size += Size;
+  ZeroMem (Result, Size);
+  return Result;
+}
+
+STATIC
+VOID
+InternalBinaryBufferFree (
+  IN OUT NVRAM_BINARY_BUFFER  *Buffer
+  )
+{
+  if (Buffer->Data != NULL) {
+    FreePool (Buffer->Data);
+  }
 
-  if (!CompareGuid (Guid, &SaveContext->SectionGuid)) {
-    return OcProcessVariableContinue;
+  ZeroMem (Buffer, sizeof (*Buffer));
+}
+
+/**
+  Allocate section cache on first save.
+  Sections follow legacy map order, same as in nvram.plist.
+**/
+STATIC
+EFI_STATUS
+InternalInitSectionCache (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      GuidIndex;
+
+  if (mSectionCache != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  mSectionCache = AllocateZeroPool (mLegacyMap->Count * sizeof (*mSectionCache));
+  if (mSectionCache == NULL) {
+    return EFI_OUT_OF_RESOURCES;
   }
 
-  if (!OcVariableIsAllowedBySchemaEntry (SaveContext->SchemaEntry, Guid, Name, OcStringFormatUnicode)) {
-    return OcProcessVariableContinue;
+  for (GuidIndex = 0; GuidIndex < mLegacyMap->Count; ++GuidIndex) {
+    Status = OcProcessVariableGuid (
+               OC_BLOB_GET (mLegacyMap->Keys[GuidIndex]),
+               &mSectionCache[GuidIndex].Guid,
+               mLegacyMap,
+               &mSectionCache[GuidIndex].SchemaEntry
+               );
+    mSectionCache[GuidIndex].Enabled = !EFI_ERROR (Status);
   }
 
+  mSectionCount = mLegacyMap->Count;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read variable into save context data buffer.
+**/
+STATIC
+EFI_STATUS
+InternalReadVariable (
+  IN OUT NVRAM_SAVE_CONTEXT  *SaveContext,
+  IN     EFI_GUID            *Guid,
+  IN     CHAR16              *Name,
+  OUT    UINT32              *Attributes,
+  OUT    UINTN               *DataSize
+  )
+{
+  EFI_STATUS  Status;
+
   do {
-    DataSize = SaveContext->DataBufferSize;
-    Status   = gRT->GetVariable (
-                      Name,
-                      Guid,
-                      &Attributes,
-                      &DataSize,
-                      SaveContext->DataBuffer
-                      );
+    *DataSize = SaveContext->DataBufferSize;
+    Status    = gRT->GetVariable (
+                       Name,
+                       Guid,
+                       Attributes,
+                       DataSize,
+                       SaveContext->DataBuffer
+                       );
     if (Status == EFI_BUFFER_TOO_SMALL) {
-      while (DataSize > SaveContext->DataBufferSize) {
+      while (*DataSize > SaveContext->DataBufferSize) {
         if (BaseOverflowMulUN (SaveContext->DataBufferSize, 2, &SaveContext->DataBufferSize)) {
-          SaveContext->Status = EFI_OUT_OF_RESOURCES;
-          return OcProcessVariableAbort;
+          return EFI_OUT_OF_RESOURCES;
         }
       }
 
       FreePool (SaveContext->DataBuffer);
       SaveContext->DataBuffer = AllocatePool (SaveContext->DataBufferSize);
       if (SaveContext->DataBuffer == NULL) {
-        SaveContext->Status = EFI_OUT_OF_RESOURCES;
-        return OcProcessVariableAbort;
+        return EFI_OUT_OF_RESOURCES;
       }
     }
   } while (Status == EFI_BUFFER_TOO_SMALL);
 
-  if (EFI_ERROR (Status)) {
-    SaveContext->Status = Status;
-    return OcProcessVariableAbort;
-  }
+  return Status;
+}
 
-  //
-  // Only save non-volatile variables; also, match launchd script and only save
-  // variables which it can save, i.e. runtime accessible.
-  //
-  if (  ((Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)
-     || ((Attributes & EFI_VARIABLE_NON_VOLATILE) == 0))
-  {
-    DEBUG ((DEBUG_VERBOSE, "NVRAM %g:%s skipped w/ attributes 0x%X\n", Guid, Name, Attributes));
-    return OcProcessVariableContinue;
-  }
+/**
+  Append variable from save context data buffer to section plist and binary fragments.
+**/
+STATIC
+EFI_STATUS
+InternalSerializeVariable (
+  IN OUT NVRAM_SAVE_CONTEXT   *SaveContext,
+  IN OUT NVRAM_SECTION_CACHE  *Section,
+  IN     CHAR16               *Name,
+  IN     UINTN                DataSize
+  )
+{
+  EFI_STATUS                Status;
+  UINTN                     Base64Size;
+  UINTN                     Base64Pos;
+  UINTN                     NameSize;
+  UINTN                     RecordSize;
+  UINTN                     Index;
+  OC_NVRAM_BINARY_VARIABLE  *Variable;
+  CHAR8                     *VariableName;
 
   Base64Size = 0;
   Base64Encode (SaveContext->DataBuffer, DataSize, NULL, &Base64Size);
   if (Base64Size > SaveContext->Base64BufferSize) {
     while (Base64Size > SaveContext->Base64BufferSize) {
       if (BaseOverflowMulUN (SaveContext->Base64BufferSize, 2, &SaveContext->Base64BufferSize)) {
-        SaveContext->Status = EFI_OUT_OF_RESOURCES;
-        return OcProcessVariableAbort;
+        return EFI_OUT_OF_RESOURCES;
       }
     }
 
     FreePool (SaveContext->Base64Buffer);
     SaveContext->Base64Buffer = AllocatePool (SaveContext->Base64BufferSize);
     if (SaveContext->Base64Buffer == NULL) {
-      SaveContext->Status = EFI_OUT_OF_RESOURCES;
-      return OcProcessVariableAbort;
+      return EFI_OUT_OF_RESOURCES;
     }
   }
 
@@ -335,7 +682,7 @@ SerializeSectionVariables (
   // %c works around BasePrintLibSPrintMarker converting \n to \r\n.
   //
   Status = OcAsciiStringBufferSPrint (
-             SaveContext->StringBuffer,
+             Section->Plist,
              "\t\t\t<key>%s</key>%c"
              "\t\t\t<data>%c",
              Name,
@@ -343,96 +690,169 @@ SerializeSectionVariables (
              '\n'
              );
   if (EFI_ERROR (Status)) {
-    SaveContext->Status = Status;
-    return OcProcessVariableAbort;
+    return Status;
   }
 
   for (Base64Pos = 0; Base64Pos < (Base64Size - 1); Base64Pos += BASE64_CHUNK_SIZE) {
     Status = OcAsciiStringBufferAppend (
-               SaveContext->StringBuffer,
+               Section->Plist,
                "\t\t\t"
                );
     if (EFI_ERROR (Status)) {
-      SaveContext->Status = Status;
-      return OcProcessVariableAbort;
+      return Status;
     }
 
     Status = OcAsciiStringBufferAppendN (
-               SaveContext->StringBuffer,
+               Section->Plist,
                &SaveContext->Base64Buffer[Base64Pos],
                BASE64_CHUNK_SIZE
                );
     if (EFI_ERROR (Status)) {
-      SaveContext->Status = Status;
-      return OcProcessVariableAbort;
+      return Status;
     }
 
     Status = OcAsciiStringBufferAppend (
-               SaveContext->StringBuffer,
+               Section->Plist,
                "\n"
                );
     if (EFI_ERROR (Status)) {
-      SaveContext->Status = Status;
-      return OcProcessVariableAbort;
+      return Status;
     }
   }
 
   Status = OcAsciiStringBufferAppend (
-             SaveContext->StringBuffer,
+             Section->Plist,
              "\t\t\t</data>\n"
              );
   if (EFI_ERROR (Status)) {
-    SaveContext->Status = Status;
-    return OcProcessVariableAbort;
+    return Status;
   }
 
-  return OcProcessVariableContinue;
+  //
+  // Binary names are stored as ASCII, the same way %s prints them to nvram.plist.
+  //
+  NameSize   = StrLen (Name) + 1;
+  RecordSize = ALIGN_VALUE (sizeof (*Variable) + NameSize + DataSize, sizeof (UINT32));
+  if ((DataSize > MAX_UINT32) || (RecordSize > NVRAM_PLIST_MAX_SIZE)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Variable = InternalBinaryBufferReserve (&Section->Binary, RecordSize);
+  if (Variable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Variable->NameSize = (UINT32)NameSize;
+  Variable->DataSize = (UINT32)DataSize;
+  VariableName       = (CHAR8 *)(Variable + 1);
+  for (Index = 0; Index < NameSize - 1; ++Index) {
+    VariableName[Index] = (CHAR8)Name[Index];
+  }
+
+  CopyMem (VariableName + NameSize, SaveContext->DataBuffer, DataSize);
+  ++Section->VariableCount;
+
+  return EFI_SUCCESS;
 }
 
+//
+// Hash or serialize all sections within a single NVRAM scan.
+//
 STATIC
-EFI_STATUS
+OC_PROCESS_VARIABLE_RESULT
 EFIAPI
-SaveNvram (
-  VOID
+ProcessSectionVariables (
+  IN EFI_GUID  *Guid,
+  IN CHAR16    *Name,
+  IN VOID      *Context
   )
 {
-  EFI_STATUS          Status;
-  EFI_FILE_PROTOCOL   *NvramDir;
-  UINT32              GuidIndex;
-  NVRAM_SAVE_CONTEXT  Context;
+  EFI_STATUS           Status;
+  NVRAM_SAVE_CONTEXT   *SaveContext;
+  NVRAM_SECTION_CACHE  *Section;
+  UINT32               SectionIndex;
+  BOOLEAN              HasData;
+  UINT32               Attributes;
+  UINTN                DataSize;
+  UINT32               DataSize32;
 
-  Status = LocateNvramDir (&NvramDir);
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
+  ASSERT (Context != NULL);
+  SaveContext = Context;
 
-  Context.Status = EFI_SUCCESS;
+  HasData    = FALSE;
+  DataSize   = 0;
+  Attributes = 0;
 
-  Context.DataBufferSize = BASE_1KB;
-  Context.DataBuffer     = AllocatePool (Context.DataBufferSize);
-  if (Context.DataBuffer == NULL) {
-    NvramDir->Close (NvramDir);
-    return EFI_OUT_OF_RESOURCES;
-  }
+  for (SectionIndex = 0; SectionIndex < mSectionCount; ++SectionIndex) {
+    Section = &mSectionCache[SectionIndex];
+    if (  !Section->Enabled
+       || (SaveContext->Serialize && !Section->Dirty)
+       || !CompareGuid (Guid, &Section->Guid))
+    {
+      continue;
+    }
 
-  Context.Base64BufferSize = BASE_1KB;
-  Context.Base64Buffer     = AllocatePool (Context.Base64BufferSize);
-  if (Context.Base64Buffer == NULL) {
-    NvramDir->Close (NvramDir);
-    FreePool (Context.DataBuffer);
-    return EFI_OUT_OF_RESOURCES;
+    if (!OcVariableIsAllowedBySchemaEntry (Section->SchemaEntry, Guid, Name, OcStringFormatUnicode)) {
+      continue;
+    }
+
+    if (!HasData) {
+      Status = InternalReadVariable (SaveContext, Guid, Name, &Attributes, &DataSize);
+      if (EFI_ERROR (Status)) {
+        SaveContext->Status = Status;
+        return OcProcessVariableAbort;
+      }
+
+      HasData = TRUE;
+
+      //
+      // Only save non-volatile variables; also, match launchd script and only save
+      // variables which it can save, i.e. runtime accessible.
+      //
+      if (  ((Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)
+         || ((Attributes & EFI_VARIABLE_NON_VOLATILE) == 0))
+      {
+        DEBUG ((DEBUG_VERBOSE, "NVRAM %g:%s skipped w/ attributes 0x%X\n", Guid, Name, Attributes));
+        return OcProcessVariableContinue;
+      }
+    }
+
+    if (SaveContext->Serialize) {
+      Status = InternalSerializeVariable (SaveContext, Section, Name, DataSize);
+      if (EFI_ERROR (Status)) {
+        SaveContext->Status = Status;
+        return OcProcessVariableAbort;
+      }
+    } else {
+      DataSize32 = (UINT32)DataSize;
+      Sha256Update (&Section->HashContext, (UINT8 *)Name, StrSize (Name));
+      Sha256Update (&Section->HashContext, (UINT8 *)&DataSize32, sizeof (DataSize32));
+      Sha256Update (&Section->HashContext, SaveContext->DataBuffer, DataSize);
+    }
   }
 
-  Context.StringBuffer = OcAsciiStringBufferInit ();
-  if (Context.StringBuffer == NULL) {
-    NvramDir->Close (NvramDir);
-    FreePool (Context.DataBuffer);
-    FreePool (Context.Base64Buffer);
+  return OcProcessVariableContinue;
+}
+
+/**
+  Build nvram.plist from cached sections.
+**/
+STATIC
+EFI_STATUS
+InternalBuildPlist (
+  OUT OC_ASCII_STRING_BUFFER  **StringBuffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      SectionIndex;
+
+  *StringBuffer = OcAsciiStringBufferInit ();
+  if (*StringBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
 
   Status = OcAsciiStringBufferAppend (
-             Context.StringBuffer,
+             *StringBuffer,
              "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
              "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
              "<plist version=\"1.0\">\n"
@@ -441,31 +861,16 @@ SaveNvram (
              "\t<dict>\n"
              );
 
-  if (EFI_ERROR (Status)) {
-    NvramDir->Close (NvramDir);
-    FreePool (Context.DataBuffer);
-    FreePool (Context.Base64Buffer);
-    OcAsciiStringBufferFree (&Context.StringBuffer);
-    return Status;
-  }
-
-  for (GuidIndex = 0; GuidIndex < mLegacyMap->Count; ++GuidIndex) {
-    Status = OcProcessVariableGuid (
-               OC_BLOB_GET (mLegacyMap->Keys[GuidIndex]),
-               &Context.SectionGuid,
-               mLegacyMap,
-               &Context.SchemaEntry
-               );
-    if (EFI_ERROR (Status)) {
-      Status = EFI_SUCCESS;
+  for (SectionIndex = 0; SectionIndex < mSectionCount && !EFI_ERROR (Status); ++SectionIndex) {
+    if (!mSectionCache[SectionIndex].Enabled) {
       continue;
     }
 
     Status = OcAsciiStringBufferSPrint (
-               Context.StringBuffer,
+               *StringBuffer,
                "\t\t<key>%g</key>%c"
                "\t\t<dict>%c",
-               &Context.SectionGuid,
+               &mSectionCache[SectionIndex].Guid,
                '\n',
                '\n'
                );
@@ -473,27 +878,24 @@ SaveNvram (
       break;
     }
 
-    OcScanVariables (SerializeSectionVariables, &Context);
-    Status = Context.Status;
+    Status = OcAsciiStringBufferAppendN (
+               *StringBuffer,
+               mSectionCache[SectionIndex].Plist->String,
+               mSectionCache[SectionIndex].Plist->StringLength
+               );
     if (EFI_ERROR (Status)) {
       break;
     }
 
     Status = OcAsciiStringBufferAppend (
-               Context.StringBuffer,
+               *StringBuffer,
                "\t\t</dict>\n"
                );
-    if (EFI_ERROR (Status)) {
-      break;
-    }
   }
 
-  FreePool (Context.DataBuffer);
-  FreePool (Context.Base64Buffer);
-
   if (!EFI_ERROR (Status)) {
     Status = OcAsciiStringBufferSPrint (
-               Context.StringBuffer,
+               *StringBuffer,
                "\t</dict>%c"
                "\t<key>Version</key>%c"
                "\t<integer>%u</integer>%c"
@@ -509,27 +911,265 @@ SaveNvram (
   }
 
   if (EFI_ERROR (Status)) {
-    NvramDir->Close (NvramDir);
-    OcAsciiStringBufferFree (&Context.StringBuffer);
+    OcAsciiStringBufferFree (StringBuffer);
+  }
+
+  return Status;
+}
+
+/**
+  Build binary NVRAM file from cached sections.
+**/
+STATIC
+EFI_STATUS
+InternalBuildBinary (
+  OUT NVRAM_BINARY_BUFFER  *Buffer
+  )
+{
+  OC_NVRAM_BINARY_HEADER   *Header;
+  OC_NVRAM_BINARY_SECTION  *Section;
+  UINT32                   SectionIndex;
+  UINT32                   SectionCount;
+  UINTN                    SectionSize;
+  VOID                     *Data;
+
+  ZeroMem (Buffer, sizeof (*Buffer));
+
+  if (InternalBinaryBufferReserve (Buffer, sizeof (*Header)) == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SectionCount = 0;
+  for (SectionIndex = 0; SectionIndex < mSectionCount; ++SectionIndex) {
+    if (!mSectionCache[SectionIndex].Enabled) {
+      continue;
+    }
+
+    SectionSize = sizeof (*Section) + mSectionCache[SectionIndex].Binary.Size;
+    Section     = InternalBinaryBufferReserve (Buffer, SectionSize);
+    if ((Section == NULL) || (Buffer->Size > NVRAM_PLIST_MAX_SIZE)) {
+      InternalBinaryBufferFree (Buffer);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CopyGuid (&Section->Guid, &mSectionCache[SectionIndex].Guid);
+    Section->Size          = (UINT32)SectionSize;
+    Section->VariableCount = mSectionCache[SectionIndex].VariableCount;
+    Data                   = Section + 1;
+    CopyMem (Data, mSectionCache[SectionIndex].Binary.Data, mSectionCache[SectionIndex].Binary.Size);
+    ++SectionCount;
+  }
+
+  Header               = (OC_NVRAM_BINARY_HEADER *)Buffer->Data;
+  Header->Signature    = OC_NVRAM_BINARY_SIGNATURE;
+  Header->Version      = OC_NVRAM_BINARY_VERSION;
+  Header->Size         = (UINT32)Buffer->Size;
+  Header->SectionCount = SectionCount;
+  CopyMem (Header->PlistDigest, mPlistDigest, sizeof (Header->PlistDigest));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write nvram.plist and binary NVRAM file, skipping unchanged files.
+
+  @param[in]  NvramDir      NVRAM directory.
+  @param[out] PlistWritten  TRUE when nvram.plist was written.
+**/
+STATIC
+EFI_STATUS
+InternalWriteNvram (
+  IN  EFI_FILE_PROTOCOL  *NvramDir,
+  OUT BOOLEAN            *PlistWritten
+  )
+{
+  EFI_STATUS              Status;
+  OC_ASCII_STRING_BUFFER  *StringBuffer;
+  NVRAM_BINARY_BUFFER     Binary;
+  UINT8                   Digest[SHA256_DIGEST_SIZE];
+
+  *PlistWritten = FALSE;
+
+  Status = InternalBuildPlist (&StringBuffer);
+  if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  DeleteFile (NvramDir, OPEN_CORE_NVRAM_FILENAME);
   STATIC_ASSERT (NVRAM_PLIST_MAX_SIZE <= MAX_UINT32, "NVRAM_PLIST_MAX_SIZE must be less than or equal to UINT32_MAX");
-  if (Context.StringBuffer->StringLength > NVRAM_PLIST_MAX_SIZE) {
-    Status = EFI_OUT_OF_RESOURCES;
-  } else {
+  if (StringBuffer->StringLength > NVRAM_PLIST_MAX_SIZE) {
+    OcAsciiStringBufferFree (&StringBuffer);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Sha256 (Digest, (UINT8 *)StringBuffer->String, StringBuffer->StringLength);
+
+  if (!mPlistDigestValid || (CompareMem (Digest, mPlistDigest, sizeof (Digest)) != 0)) {
+    mPlistDigestValid = FALSE;
+    mBinaryCurrent    = FALSE;
+
+    DeleteFile (NvramDir, OPEN_CORE_NVRAM_FILENAME);
     Status = OcSetFileData (
                NvramDir,
                OPEN_CORE_NVRAM_FILENAME,
-               Context.StringBuffer->String,
-               (UINT32)Context.StringBuffer->StringLength
+               StringBuffer->String,
+               (UINT32)StringBuffer->StringLength
                );
+    if (!EFI_ERROR (Status)) {
+      CopyMem (mPlistDigest, Digest, sizeof (mPlistDigest));
+      mPlistDigestValid = TRUE;
+      *PlistWritten     = TRUE;
+    }
+  }
+
+  OcAsciiStringBufferFree (&StringBuffer);
+
+  if (EFI_ERROR (Status) || mBinaryCurrent) {
+    return Status;
+  }
+
+  //
+  // Binary file is an optional accelerator, nvram.plist remains authoritative.
+  //
+  DeleteFile (NvramDir, OPEN_CORE_NVRAM_BINARY_FILENAME);
+  if (!EFI_ERROR (InternalBuildBinary (&Binary))) {
+    Status = OcSetFileData (
+               NvramDir,
+               OPEN_CORE_NVRAM_BINARY_FILENAME,
+               Binary.Data,
+               (UINT32)Binary.Size
+               );
+    mBinaryCurrent = !EFI_ERROR (Status);
+    InternalBinaryBufferFree (&Binary);
+  }
+
+  if (!mBinaryCurrent) {
+    DEBUG ((DEBUG_INFO, "OCVR: Failed to save %s\n", OPEN_CORE_NVRAM_BINARY_FILENAME));
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+SaveNvram (
+  VOID
+  )
+{
+  EFI_STATUS           Status;
+  EFI_FILE_PROTOCOL    *NvramDir;
+  UINT32               SectionIndex;
+  UINT32               DirtyCount;
+  NVRAM_SAVE_CONTEXT   Context;
+  NVRAM_SECTION_CACHE  *Section;
+  UINT8                Digest[SHA256_DIGEST_SIZE];
+  BOOLEAN              PlistWritten;
+  UINT64               StartTime;
+
+  StartTime = GetPerformanceCounter ();
+
+  Status = LocateNvramDir (&NvramDir);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = InternalInitSectionCache ();
+  if (EFI_ERROR (Status)) {
+    NvramDir->Close (NvramDir);
+    return Status;
+  }
+
+  Context.Status    = EFI_SUCCESS;
+  Context.Serialize = FALSE;
+
+  Context.DataBufferSize = BASE_1KB;
+  Context.DataBuffer     = AllocatePool (Context.DataBufferSize);
+  if (Context.DataBuffer == NULL) {
+    NvramDir->Close (NvramDir);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Context.Base64BufferSize = BASE_1KB;
+  Context.Base64Buffer     = AllocatePool (Context.Base64BufferSize);
+  if (Context.Base64Buffer == NULL) {
+    NvramDir->Close (NvramDir);
+    FreePool (Context.DataBuffer);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // First pass only hashes variable contents to find changed sections.
+  //
+  for (SectionIndex = 0; SectionIndex < mSectionCount; ++SectionIndex) {
+    Sha256Init (&mSectionCache[SectionIndex].HashContext);
+  }
+
+  OcScanVariables (ProcessSectionVariables, &Context);
+  Status = Context.Status;
+
+  DirtyCount = 0;
+  for (SectionIndex = 0; SectionIndex < mSectionCount && !EFI_ERROR (Status); ++SectionIndex) {
+    Section = &mSectionCache[SectionIndex];
+    if (!Section->Enabled) {
+      continue;
+    }
+
+    Sha256Final (&Section->HashContext, Digest);
+    Section->Dirty = !Section->Cached || (CompareMem (Digest, Section->Digest, sizeof (Digest)) != 0);
+    if (!Section->Dirty) {
+      continue;
+    }
+
+    ++DirtyCount;
+    CopyMem (Section->Digest, Digest, sizeof (Digest));
+    Section->Cached        = FALSE;
+    Section->VariableCount = 0;
+    Section->Binary.Size   = 0;
+    if (Section->Plist != NULL) {
+      OcAsciiStringBufferFree (&Section->Plist);
+    }
+
+    Section->Plist = OcAsciiStringBufferInit ();
+    if (Section->Plist == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  //
+  // Second pass serializes changed sections only.
+  //
+  if (!EFI_ERROR (Status) && (DirtyCount > 0)) {
+    Context.Serialize = TRUE;
+    OcScanVariables (ProcessSectionVariables, &Context);
+    Status = Context.Status;
+  }
+
+  FreePool (Context.DataBuffer);
+  FreePool (Context.Base64Buffer);
+
+  PlistWritten = FALSE;
+  if (!EFI_ERROR (Status)) {
+    for (SectionIndex = 0; SectionIndex < mSectionCount; ++SectionIndex) {
+      if (mSectionCache[SectionIndex].Enabled) {
+        mSectionCache[SectionIndex].Cached = TRUE;
+      }
+    }
+
+    Status = InternalWriteNvram (NvramDir, &PlistWritten);
   }
 
-  OcAsciiStringBufferFree (&Context.StringBuffer);
   NvramDir->Close (NvramDir);
 
+  DEBUG ((
+    DEBUG_INFO,
+    "OCVR: Saved NVRAM in %Lu us, %u/%u sections changed, %a - %r\n",
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000),
+    DirtyCount,
+    mSectionCount,
+    PlistWritten ? "written" : "unchanged",
+    Status
+    ));
+
   return Status;
 }
 
@@ -551,6 +1191,10 @@ ResetNvram (
 
   Status    = DeleteFile (NvramDir, OPEN_CORE_NVRAM_FILENAME);
   AltStatus = DeleteFile (NvramDir, OPEN_CORE_NVRAM_FALLBACK_FILENAME);
+  DeleteFile (NvramDir, OPEN_CORE_NVRAM_BINARY_FILENAME);
+
+  mPlistDigestValid = FALSE;
+  mBinaryCurrent    = FALSE;
 
   NvramDir->Close (NvramDir);
 
@@ -593,6 +1237,10 @@ SwitchToFallback (
 
   DeleteFile (NvramDir, OPEN_CORE_NVRAM_USED_FILENAME);
   DeleteFile (NvramDir, OPEN_CORE_NVRAM_FILENAME);
+  DeleteFile (NvramDir, OPEN_CORE_NVRAM_BINARY_FILENAME);
+
+  mPlistDigestValid = FALSE;
+  mBinaryCurrent    = FALSE;
   Status = OcSetFileData (
              NvramDir,
              OPEN_CORE_NVRAM_USED_FILENAME,
@@ -47,11 +47,6 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/OcMiscLib.h>
 #include <Library/OcStringLib.h>
 
-/**
-  Minimal extra allocation size during export.
-**/
-#define XML_EXPORT_MIN_ALLOCATION_SIZE  4096
-
 #define XML_PLIST_HEADER  "<?xml version=\"1.0\" encoding=\"UTF-8\"?><!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">"
 
 struct XML_NODE_LIST_;
@@ -70,6 +65,12 @@ struct XML_NODE_ {
   CONST CHAR8      *Content;
   XML_NODE         *Real;
   XML_NODE_LIST    *Children;
+  //
+  // Location of the node text in the parsed buffer. Zero length for nodes
+  // created or changed after parsing.
+  //
+  UINT32           SourceOffset;
+  UINT32           SourceLength;
 };
 
 struct XML_NODE_LIST_ {
@@ -214,11 +215,13 @@ XmlNodeCreate (
   Node = AllocatePool (sizeof (XML_NODE));
 
   if (Node != NULL) {
-    Node->Name       = Name;
-    Node->Attributes = Attributes;
-    Node->Content    = Content;
-    Node->Real       = Real;
-    Node->Children   = Children;
+    Node->Name         = Name;
+    Node->Attributes   = Attributes;
+    Node->Content      = Content;
+    Node->Real         = Real;
+    Node->Children     = Children;
+    Node->SourceOffset = 0;
+    Node->SourceLength = 0;
   }
 
   return Node;
@@ -1005,121 +1008,180 @@ XmlParseContent (
 }
 
 /**
-  Print to growing buffer always preserving one byte extra.
+  Calculate exported node size.
+
+  When exporting from source, nodes whose text no longer matches the parsed
+  buffer due to changes in their subtree lose their source location, so that
+  only the remaining ones are copied verbatim.
 
-  @param[in,out]  Buffer       A pointer to the buffer holding contents.
-  @param[in,out]  AllocSize    Size of Buffer to be allocated.
-  @param[in,out]  CurrentSize  Current size of Buffer before appending.
-  @param[in]      Data         Data to be appended.
-  @param[in]      DataLength   Length of Data.
+  @param[in,out]  Node        A pointer to the XML node.
+  @param[in]      UseSource   TRUE to account for verbatim copies from source.
+  @param[in]      Skip        Levels of XML contents to be skipped.
+  @param[out]     Size        Exported node size.
+
+  @retval  TRUE on success.
 **/
 STATIC
-VOID
-XmlBufferAppend (
-  IN OUT  CHAR8        **Buffer,
-  IN OUT  UINT32       *AllocSize,
-  IN OUT  UINT32       *CurrentSize,
-  IN      CONST CHAR8  *Data,
-  IN      UINT32       DataLength
+BOOLEAN
+XmlNodeExportSize (
+  IN OUT  XML_NODE  *Node,
+  IN      BOOLEAN   UseSource,
+  IN      UINT32    Skip,
+  OUT     UINT32    *Size
   )
 {
-  CHAR8   *NewBuffer;
-  UINT32  NewSize;
+  UINT32   Index;
+  UINT32   ChildSize;
+  UINT32   NameLength;
+  UINT32   TagSize;
+  BOOLEAN  Changed;
 
-  ASSERT (Buffer      != NULL);
-  ASSERT (AllocSize   != NULL);
-  ASSERT (CurrentSize != NULL);
-  ASSERT (Data        != NULL);
+  ASSERT (Node != NULL);
+  ASSERT (Size != NULL);
 
-  NewSize = *AllocSize;
+  *Size   = 0;
+  Changed = !UseSource || (Node->SourceLength == 0);
 
-  if (NewSize - *CurrentSize <= DataLength) {
-    if (DataLength + 1 <= XML_EXPORT_MIN_ALLOCATION_SIZE) {
-      NewSize += XML_EXPORT_MIN_ALLOCATION_SIZE;
-    } else {
-      NewSize += DataLength + 1;
+  if (Node->Children != NULL) {
+    for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
+      if (  !XmlNodeExportSize (Node->Children->NodeList[Index], UseSource, Skip != 0 ? Skip - 1 : 0, &ChildSize)
+         || BaseOverflowAddU32 (*Size, ChildSize, Size))
+      {
+        return FALSE;
+      }
+
+      if (Node->Children->NodeList[Index]->SourceLength == 0) {
+        Changed = TRUE;
+      }
     }
+  }
+
+  if (Skip != 0) {
+    return TRUE;
+  }
+
+  if (!Changed) {
+    *Size = Node->SourceLength;
+    return TRUE;
+  }
+
+  if (UseSource) {
+    Node->SourceLength = 0;
+  }
+
+  NameLength = (UINT32)AsciiStrLen (Node->Name);
 
-    NewBuffer = AllocatePool (NewSize);
-    if (NewBuffer == NULL) {
-      XML_USAGE_ERROR ("XmlBufferAppend::failed to allocate");
-      return;
+  //
+  // <Name Attributes>Content</Name> or <Name Attributes/>
+  //
+  TagSize = L_STR_LEN ("<") + NameLength;
+
+  if (Node->Attributes != NULL) {
+    TagSize += L_STR_LEN (" ") + (UINT32)AsciiStrLen (Node->Attributes);
+  }
+
+  if ((Node->Children != NULL) || (Node->Content != NULL)) {
+    if (Node->Children == NULL) {
+      TagSize += (UINT32)AsciiStrLen (Node->Content);
     }
 
-    CopyMem (NewBuffer, *Buffer, *CurrentSize);
-    FreePool (*Buffer);
-    *Buffer    = NewBuffer;
-    *AllocSize = NewSize;
+    TagSize += L_STR_LEN (">") + L_STR_LEN ("</") + NameLength + L_STR_LEN (">");
+  } else {
+    TagSize += L_STR_LEN ("/>");
   }
 
-  CopyMem (&(*Buffer)[*CurrentSize], Data, DataLength);
-  *CurrentSize += DataLength;
+  return !BaseOverflowAddU32 (*Size, TagSize, Size);
 }
 
 /**
-  Print node to growing buffer always preserving one byte extra.
+  Append data to the export buffer.
 
-  @param[in]      Node         A pointer to the XML node.
-  @param[in,out]  Buffer       A pointer to the buffer holding contents exported.
-  @param[in,out]  AllocSize    Size of Buffer to be allocated.
-  @param[in,out]  CurrentSize  Current size of Buffer.
-  @param[in]      Skip         Levels of XML contents to be skipped.
+  @param[out]  Buffer      Export buffer position.
+  @param[in]   Data        Data to be appended.
+  @param[in]   DataLength  Length of Data.
+
+  @return  Export buffer position after the appended data.
 **/
 STATIC
-VOID
+CHAR8 *
+XmlBufferAppend (
+  OUT  CHAR8        *Buffer,
+  IN   CONST CHAR8  *Data,
+  IN   UINT32       DataLength
+  )
+{
+  CopyMem (Buffer, Data, DataLength);
+  return Buffer + DataLength;
+}
+
+/**
+  Print node to the buffer sized by XmlNodeExportSize.
+
+  @param[in]   Node    A pointer to the XML node.
+  @param[in]   Source  Unmodified parsed buffer contents. Optional.
+  @param[in]   Skip    Levels of XML contents to be skipped.
+  @param[out]  Buffer  Export buffer position.
+
+  @return  Export buffer position after the node.
+**/
+STATIC
+CHAR8 *
 XmlNodeExportRecursive (
-  IN      CONST XML_NODE  *Node,
-  IN OUT  CHAR8           **Buffer,
-  IN OUT  UINT32          *AllocSize,
-  IN OUT  UINT32          *CurrentSize,
-  IN      UINT32          Skip
+  IN   CONST XML_NODE  *Node,
+  IN   CONST CHAR8     *Source  OPTIONAL,
+  IN   UINT32          Skip,
+  OUT  CHAR8           *Buffer
   )
 {
   UINT32  Index;
   UINT32  NameLength;
 
-  ASSERT (Node        != NULL);
-  ASSERT (Buffer      != NULL);
-  ASSERT (AllocSize   != NULL);
-  ASSERT (CurrentSize != NULL);
+  ASSERT (Node   != NULL);
+  ASSERT (Buffer != NULL);
 
   if (Skip != 0) {
     if (Node->Children != NULL) {
       for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
-        XmlNodeExportRecursive (Node->Children->NodeList[Index], Buffer, AllocSize, CurrentSize, Skip - 1);
+        Buffer = XmlNodeExportRecursive (Node->Children->NodeList[Index], Source, Skip - 1, Buffer);
       }
     }
 
-    return;
+    return Buffer;
+  }
+
+  if ((Source != NULL) && (Node->SourceLength != 0)) {
+    return XmlBufferAppend (Buffer, &Source[Node->SourceOffset], Node->SourceLength);
   }
 
   NameLength = (UINT32)AsciiStrLen (Node->Name);
 
-  XmlBufferAppend (Buffer, AllocSize, CurrentSize, "<", L_STR_LEN ("<"));
-  XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Name, NameLength);
+  Buffer = XmlBufferAppend (Buffer, "<", L_STR_LEN ("<"));
+  Buffer = XmlBufferAppend (Buffer, Node->Name, NameLength);
 
   if (Node->Attributes != NULL) {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, " ", L_STR_LEN (" "));
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Attributes, (UINT32)AsciiStrLen (Node->Attributes));
+    Buffer = XmlBufferAppend (Buffer, " ", L_STR_LEN (" "));
+    Buffer = XmlBufferAppend (Buffer, Node->Attributes, (UINT32)AsciiStrLen (Node->Attributes));
   }
 
   if ((Node->Children != NULL) || (Node->Content != NULL)) {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, ">", L_STR_LEN (">"));
+    Buffer = XmlBufferAppend (Buffer, ">", L_STR_LEN (">"));
 
     if (Node->Children != NULL) {
       for (Index = 0; Index < Node->Children->NodeCount; ++Index) {
-        XmlNodeExportRecursive (Node->Children->NodeList[Index], Buffer, AllocSize, CurrentSize, 0);
+        Buffer = XmlNodeExportRecursive (Node->Children->NodeList[Index], Source, 0, Buffer);
       }
     } else {
-      XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Content, (UINT32)AsciiStrLen (Node->Content));
+      Buffer = XmlBufferAppend (Buffer, Node->Content, (UINT32)AsciiStrLen (Node->Content));
     }
 
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, "</", L_STR_LEN ("</"));
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, Node->Name, NameLength);
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, ">", L_STR_LEN (">"));
+    Buffer = XmlBufferAppend (Buffer, "</", L_STR_LEN ("</"));
+    Buffer = XmlBufferAppend (Buffer, Node->Name, NameLength);
+    Buffer = XmlBufferAppend (Buffer, ">", L_STR_LEN (">"));
   } else {
-    XmlBufferAppend (Buffer, AllocSize, CurrentSize, "/>", L_STR_LEN ("/>"));
+    Buffer = XmlBufferAppend (Buffer, "/>", L_STR_LEN ("/>"));
   }
+
+  return Buffer;
 }
 
 /**
@@ -1154,6 +1216,7 @@ XmlParseNode (
   CONST CHAR8  *Attributes;
   XML_NODE     *Node;
   XML_NODE     *Child;
+  UINT32       SourceOffset;
   UINT32       ReferenceNumber;
   BOOLEAN      IsReference;
   BOOLEAN      SelfClosing;
@@ -1182,7 +1245,10 @@ XmlParseNode (
     return NULL;
   }
 
-  XmlSkipWhitespace (Parser);
+  //
+  // Node text starts at `<' right before the tag name.
+  //
+  SourceOffset = (UINT32)(TagOpen - Parser->Buffer) - 1;
 
   Node = XmlNodeCreate (TagOpen, Attributes, NULL, XmlNodeReal (References, Attributes), NULL);
   if (Node == NULL) {
@@ -1194,9 +1260,14 @@ XmlParseNode (
   // If tag ends with `/' it's self closing, skip content lookup.
   //
   if (SelfClosing) {
+    Node->SourceOffset = SourceOffset;
+    Node->SourceLength = Parser->Position - SourceOffset;
+    XmlSkipWhitespace (Parser);
     return Node;
   }
 
+  XmlSkipWhitespace (Parser);
+
   //
   // If the content does not start with '<', a text content is assumed.
   //
@@ -1301,6 +1372,9 @@ XmlParseNode (
     return NULL;
   }
 
+  Node->SourceOffset = SourceOffset;
+  Node->SourceLength = Parser->Position - SourceOffset;
+
   return Node;
 }
 
@@ -1363,6 +1437,58 @@ XmlDocumentParse (
   return Document;
 }
 
+BOOLEAN
+XmlDocumentExportSize (
+  IN OUT  XML_DOCUMENT  *Document,
+  IN      CONST CHAR8   *Source  OPTIONAL,
+  IN      UINT32        Skip,
+  IN      BOOLEAN       PrependPlistInfo,
+  OUT     UINT32        *Length
+  )
+{
+  ASSERT (Document != NULL);
+  ASSERT (Length   != NULL);
+
+  if (!XmlNodeExportSize (Document->Root, Source != NULL, Skip, Length)) {
+    return FALSE;
+  }
+
+  if (PrependPlistInfo && BaseOverflowAddU32 (*Length, L_STR_LEN (XML_PLIST_HEADER), Length)) {
+    return FALSE;
+  }
+
+  //
+  // Leave room for the null terminator.
+  //
+  return *Length < MAX_UINT32;
+}
+
+UINT32
+XmlDocumentExportToBuffer (
+  IN   CONST XML_DOCUMENT  *Document,
+  IN   CONST CHAR8         *Source  OPTIONAL,
+  IN   UINT32              Skip,
+  IN   BOOLEAN             PrependPlistInfo,
+  OUT  CHAR8               *Buffer
+  )
+{
+  CHAR8  *Walker;
+
+  ASSERT (Document != NULL);
+  ASSERT (Buffer   != NULL);
+
+  Walker = Buffer;
+
+  if (PrependPlistInfo) {
+    Walker = XmlBufferAppend (Walker, XML_PLIST_HEADER, L_STR_LEN (XML_PLIST_HEADER));
+  }
+
+  Walker  = XmlNodeExportRecursive (Document->Root, Source, Skip, Walker);
+  *Walker = '\0';
+
+  return (UINT32)(Walker - Buffer);
+}
+
 CHAR8 *
 XmlDocumentExport (
   IN   CONST XML_DOCUMENT  *Document,
@@ -1372,62 +1498,35 @@ XmlDocumentExport (
   )
 {
   CHAR8   *Buffer;
-  CHAR8   *NewBuffer;
-  UINT32  AllocSize;
-  UINT32  CurrentSize;
-  UINT32  NewSize;
+  UINT32  ExportSize;
 
   ASSERT (Document != NULL);
 
-  AllocSize = Document->Buffer.Length + 1;
-  Buffer    = AllocatePool (AllocSize);
-  if (Buffer == NULL) {
-    XML_USAGE_ERROR ("XmlDocumentExport::failed to allocate");
+  //
+  // Without source nodes are not changed while calculating size.
+  //
+  if (!XmlNodeExportSize (Document->Root, FALSE, Skip, &ExportSize)) {
     return NULL;
   }
 
-  CurrentSize = 0;
-  XmlNodeExportRecursive (Document->Root, &Buffer, &AllocSize, &CurrentSize, Skip);
-
-  if (PrependPlistInfo) {
-    //
-    // XmlNodeExportRecursive returns a size that does not include the null terminator,
-    // but the allocated buffer does. During this reallocation, we count the null terminator
-    // of the plist header instead to ensure allocated buffer is the proper size.
-    //
-    if (BaseOverflowAddU32 (CurrentSize, L_STR_SIZE (XML_PLIST_HEADER), &NewSize)) {
-      FreePool (Buffer);
-      return NULL;
-    }
-
-    NewBuffer = AllocatePool (NewSize);
-    if (NewBuffer == NULL) {
-      FreePool (Buffer);
-      XML_USAGE_ERROR ("XmlDocumentExport::failed to allocate");
-      return NULL;
-    }
-
-    CopyMem (NewBuffer, XML_PLIST_HEADER, L_STR_SIZE_NT (XML_PLIST_HEADER));
-    CopyMem (&NewBuffer[L_STR_LEN (XML_PLIST_HEADER)], Buffer, CurrentSize);
-    FreePool (Buffer);
+  if (  (PrependPlistInfo && BaseOverflowAddU32 (ExportSize, L_STR_LEN (XML_PLIST_HEADER), &ExportSize))
+     || (ExportSize == MAX_UINT32))
+  {
+    return NULL;
+  }
 
-    //
-    // Null terminator is not included in size returned by XmlBufferAppend.
-    //
-    CurrentSize = NewSize - 1;
-    Buffer      = NewBuffer;
+  Buffer = AllocatePool (ExportSize + 1);
+  if (Buffer == NULL) {
+    XML_USAGE_ERROR ("XmlDocumentExport::failed to allocate");
+    return NULL;
   }
 
+  ExportSize = XmlDocumentExportToBuffer (Document, NULL, Skip, PrependPlistInfo, Buffer);
+
   if (Length != NULL) {
-    *Length = CurrentSize;
+    *Length = ExportSize;
   }
 
-  //
-  // Null terminator is not included in size returned by XmlBufferAppend,
-  // but the buffer is allocated to include it.
-  //
-  Buffer[CurrentSize] = '\0';
-
   return Buffer;
 }
 
@@ -1483,10 +1582,12 @@ XmlNodeChangeContent (
   ASSERT (Content != NULL);
 
   if (Node->Real != NULL) {
-    Node->Real->Content = Content;
+    Node->Real->Content      = Content;
+    Node->Real->SourceLength = 0;
   }
 
-  Node->Content = Content;
+  Node->Content      = Content;
+  Node->SourceLength = 0;
 }
 
 UINT32
@@ -1600,6 +1701,8 @@ XmlNodeAppend (
     return NULL;
   }
 
+  Node->SourceLength = 0;
+
   return NewNode;
 }
 
@@ -1658,6 +1761,8 @@ XmlNodeRemoveByIndex (
   //
   ZeroMem (&Node->Children->NodeList[Node->Children->NodeCount-1], sizeof (*Node->Children->NodeList));
   --Node->Children->NodeCount;
+
+  Node->SourceLength = 0;
 }
 
 VOID
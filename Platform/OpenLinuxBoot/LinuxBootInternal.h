@@ -373,6 +373,34 @@ InternalAutodetectLinux (
   OUT  UINTN              *NumEntries
   );
 
+/*
+  Per-partition scan result cache.
+  Returns copies of entries found by previous scan of the device, if the
+  fingerprint of relevant directory listings and file modification times
+  is unchanged. Fingerprint is returned in any case for InternalCacheEntries.
+*/
+BOOLEAN
+InternalGetCachedEntries (
+  IN   EFI_HANDLE         Device,
+  IN   EFI_FILE_PROTOCOL  *RootDirectory,
+  OUT  UINT64             *Fingerprint,
+  OUT  EFI_STATUS         *Status,
+  OUT  OC_PICKER_ENTRY    **Entries,
+  OUT  UINTN              *NumEntries
+  );
+
+/*
+  Store copies of entries found by full scan of the device.
+*/
+VOID
+InternalCacheEntries (
+  IN   EFI_HANDLE             Device,
+  IN   UINT64                 Fingerprint,
+  IN   EFI_STATUS             Status,
+  IN   CONST OC_PICKER_ENTRY  *Entries,
+  IN   UINTN                  NumEntries
+  );
+
 /*
   Insert root=PARTUUID=... option.
 */
@@ -17,6 +17,7 @@
 #include <Library/OcFileLib.h>
 #include <Library/OcFlexArrayLib.h>
 #include <Library/OcStringLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
 #include <Protocol/OcBootEntry.h>
@@ -105,6 +106,9 @@ OcGetLinuxBootEntries (
   EFI_FILE_PROTOCOL                *RootDirectory;
   UINT32                           FileSystemPolicy;
   CONST EFI_PARTITION_ENTRY        *PartitionEntry;
+  UINT64                           StartTime;
+  UINT64                           Fingerprint;
+  BOOLEAN                          Cached;
 
   ASSERT (PickerContext != NULL);
   ASSERT (Entries     != NULL);
@@ -228,35 +232,62 @@ OcGetLinuxBootEntries (
     &gPartuuid
     ));
 
+  StartTime = GetPerformanceCounter ();
+
   //
-  // Scan for boot loader spec & blscfg entries (Fedora-like).
+  // Reuse entries found by previous scan if nothing relevant changed on the partition.
   //
-  Status = InternalScanLoaderEntries (
+  Cached = InternalGetCachedEntries (
+             Device,
              RootDirectory,
+             &Fingerprint,
+             &Status,
              Entries,
              NumEntries
              );
 
-  //
-  // Note: As currently structured, will fall through to autodetect
-  // if no /loader/entries/*.conf files are present, but also if there
-  // are only unusable files in there.
-  //
-  if (  EFI_ERROR (Status)
-     && ((gLinuxBootFlags & LINUX_BOOT_ALLOW_AUTODETECT) != 0))
-  {
+  if (!Cached) {
     //
-    // Auto-detect vmlinuz and initrd files on own root filesystem (Debian-like).
+    // Scan for boot loader spec & blscfg entries (Fedora-like).
     //
-    Status = InternalAutodetectLinux (
+    Status = InternalScanLoaderEntries (
                RootDirectory,
                Entries,
                NumEntries
                );
+
+    //
+    // Note: As currently structured, will fall through to autodetect
+    // if no /loader/entries/*.conf files are present, but also if there
+    // are only unusable files in there.
+    //
+    if (  EFI_ERROR (Status)
+       && ((gLinuxBootFlags & LINUX_BOOT_ALLOW_AUTODETECT) != 0))
+    {
+      //
+      // Auto-detect vmlinuz and initrd files on own root filesystem (Debian-like).
+      //
+      Status = InternalAutodetectLinux (
+                 RootDirectory,
+                 Entries,
+                 NumEntries
+                 );
+    }
+
+    InternalCacheEntries (Device, Fingerprint, Status, *Entries, *NumEntries);
   }
 
   RootDirectory->Close (RootDirectory);
 
+  DEBUG ((
+    DEBUG_INFO,
+    "LNX: %a scan of %g took %Lu ms - %r\n",
+    Cached ? "Cached" : "Full",
+    &gPartuuid,
+    DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 1000000),
+    Status
+    ));
+
   return Status;
 }
 
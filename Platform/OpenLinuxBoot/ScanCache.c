@@ -0,0 +1,362 @@
+/** @file
+  Per-partition cache of discovered Linux boot entries.
+
+  Entries are reused while the modification times of the directories and
+  files which determine them stay unchanged, so that picker re-scans do not
+  re-read and re-parse loader entries, grub.cfg and os-release over slow
+  filesystem drivers.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include "LinuxBootInternal.h"
+
+#include <Uefi.h>
+#include <Guid/FileInfo.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcFileLib.h>
+#include <Library/OcFlexArrayLib.h>
+
+#define FNV1A_64_OFFSET  0xCBF29CE484222325ULL
+#define FNV1A_64_PRIME   0x00000100000001B3ULL
+
+/*
+  Directories whose listings (names, sizes and modification times of entries)
+  determine discovered entries. Listings cover loader entry files, kernels,
+  initrds, disk labels and grub.cfg/grubenv without opening each file.
+*/
+STATIC CONST CHAR16  *mFingerprintDirs[] = {
+  L"\\",
+  L"\\boot",
+  L"\\loader\\entries",
+  L"\\boot\\loader\\entries",
+  L"\\grub2",
+  L"\\boot\\grub2"
+};
+
+/*
+  Files and directories outside of the listed directories which are read
+  or probed for during autodetect: the root filesystem check and the ostree
+  root option fixup.
+*/
+STATIC CONST CHAR16  *mFingerprintFiles[] = {
+  L"\\etc\\os-release",
+  L"\\etc\\default\\grub",
+  L"\\bin\\sh",
+  L"\\ostree"
+};
+
+typedef struct SCAN_CACHE_ENTRY_ {
+  EFI_HANDLE         Device;
+  EFI_GUID           Partuuid;
+  BOOLEAN            HideAuxiliary;
+  UINT32             PickerAttributes;
+  UINT64             Fingerprint;
+  EFI_STATUS         Status;
+  OC_PICKER_ENTRY    *Entries;
+  UINTN              NumEntries;
+} SCAN_CACHE_ENTRY;
+
+STATIC OC_FLEX_ARRAY  *mScanCache;
+
+STATIC
+VOID
+FingerprintAdd (
+  IN OUT UINT64      *Fingerprint,
+  IN     CONST VOID  *Data,
+  IN     UINTN       Size
+  )
+{
+  CONST UINT8  *Walker;
+  UINTN        Index;
+
+  Walker = Data;
+  for (Index = 0; Index < Size; ++Index) {
+    *Fingerprint ^= Walker[Index];
+    *Fingerprint  = MultU64x64 (*Fingerprint, FNV1A_64_PRIME);
+  }
+}
+
+STATIC
+VOID
+FingerprintAddTime (
+  IN OUT UINT64          *Fingerprint,
+  IN     CONST EFI_TIME  *Time
+  )
+{
+  //
+  // Do not hash padding, drivers are not required to clear it.
+  //
+  FingerprintAdd (Fingerprint, &Time->Year, sizeof (Time->Year));
+  FingerprintAdd (Fingerprint, &Time->Month, sizeof (Time->Month));
+  FingerprintAdd (Fingerprint, &Time->Day, sizeof (Time->Day));
+  FingerprintAdd (Fingerprint, &Time->Hour, sizeof (Time->Hour));
+  FingerprintAdd (Fingerprint, &Time->Minute, sizeof (Time->Minute));
+  FingerprintAdd (Fingerprint, &Time->Second, sizeof (Time->Second));
+  FingerprintAdd (Fingerprint, &Time->Nanosecond, sizeof (Time->Nanosecond));
+}
+
+STATIC
+EFI_STATUS
+FingerprintDirectoryEntry (
+  EFI_FILE_HANDLE  Directory,
+  EFI_FILE_INFO    *FileInfo,
+  UINTN            FileInfoSize,
+  VOID             *Context
+  )
+{
+  UINT64  *Fingerprint;
+
+  Fingerprint = Context;
+
+  FingerprintAdd (Fingerprint, FileInfo->FileName, StrSize (FileInfo->FileName));
+  FingerprintAdd (Fingerprint, &FileInfo->FileSize, sizeof (FileInfo->FileSize));
+  FingerprintAdd (Fingerprint, &FileInfo->Attribute, sizeof (FileInfo->Attribute));
+  FingerprintAddTime (Fingerprint, &FileInfo->ModificationTime);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+UINT64
+GetPartitionFingerprint (
+  IN EFI_FILE_PROTOCOL  *RootDirectory
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *File;
+  UINTN              Index;
+  UINT64             Fingerprint;
+  EFI_TIME           ModificationTime;
+  UINT32             FileSize;
+
+  Fingerprint = FNV1A_64_OFFSET;
+
+  for (Index = 0; Index < ARRAY_SIZE (mFingerprintDirs); ++Index) {
+    FingerprintAdd (&Fingerprint, mFingerprintDirs[Index], StrSize (mFingerprintDirs[Index]));
+
+    Status = OcSafeFileOpen (RootDirectory, &File, (CHAR16 *)mFingerprintDirs[Index], EFI_FILE_MODE_READ, 0);
+    if (!EFI_ERROR (Status)) {
+      Status = OcScanDirectory (File, FingerprintDirectoryEntry, &Fingerprint);
+      File->Close (File);
+    }
+
+    FingerprintAdd (&Fingerprint, &Status, sizeof (Status));
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mFingerprintFiles); ++Index) {
+    FingerprintAdd (&Fingerprint, mFingerprintFiles[Index], StrSize (mFingerprintFiles[Index]));
+
+    Status = OcSafeFileOpen (RootDirectory, &File, (CHAR16 *)mFingerprintFiles[Index], EFI_FILE_MODE_READ, 0);
+    if (!EFI_ERROR (Status)) {
+      Status = OcGetFileModificationTime (File, &ModificationTime);
+      if (!EFI_ERROR (Status)) {
+        FingerprintAddTime (&Fingerprint, &ModificationTime);
+        Status = OcGetFileSize (File, &FileSize);
+        if (!EFI_ERROR (Status)) {
+          FingerprintAdd (&Fingerprint, &FileSize, sizeof (FileSize));
+        }
+      }
+
+      File->Close (File);
+    }
+
+    FingerprintAdd (&Fingerprint, &Status, sizeof (Status));
+  }
+
+  return Fingerprint;
+}
+
+STATIC
+CHAR8 *
+CopyEntryString (
+  IN CONST CHAR8  *String,
+  IN OUT BOOLEAN  *Failed
+  )
+{
+  CHAR8  *Copy;
+
+  if (String == NULL) {
+    return NULL;
+  }
+
+  Copy = AllocateCopyPool (AsciiStrSize (String), String);
+  if (Copy == NULL) {
+    *Failed = TRUE;
+  }
+
+  return Copy;
+}
+
+STATIC
+EFI_STATUS
+CopyPickerEntries (
+  IN  CONST OC_PICKER_ENTRY  *Entries,
+  IN        UINTN            NumEntries,
+  OUT       OC_PICKER_ENTRY  **Copy
+  )
+{
+  OC_PICKER_ENTRY  *Target;
+  UINTN            Index;
+  UINTN            FreeIndex;
+  BOOLEAN          Failed;
+
+  Target = AllocateCopyPool (NumEntries * sizeof (OC_PICKER_ENTRY), Entries);
+  if (Target == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Failed = FALSE;
+  for (Index = 0; Index < NumEntries; ++Index) {
+    Target[Index].Id        = CopyEntryString (Entries[Index].Id, &Failed);
+    Target[Index].Name      = CopyEntryString (Entries[Index].Name, &Failed);
+    Target[Index].Path      = CopyEntryString (Entries[Index].Path, &Failed);
+    Target[Index].Arguments = CopyEntryString (Entries[Index].Arguments, &Failed);
+    Target[Index].Flavour   = CopyEntryString (Entries[Index].Flavour, &Failed);
+    if (Failed) {
+      for (FreeIndex = 0; FreeIndex <= Index; ++FreeIndex) {
+        InternalFreePickerEntry (&Target[FreeIndex]);
+      }
+
+      FreePool (Target);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  *Copy = Target;
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+FreeScanCacheEntry (
+  IN SCAN_CACHE_ENTRY  *Entry
+  )
+{
+  UINTN  Index;
+
+  if (Entry->Entries != NULL) {
+    for (Index = 0; Index < Entry->NumEntries; ++Index) {
+      InternalFreePickerEntry (&Entry->Entries[Index]);
+    }
+
+    FreePool (Entry->Entries);
+    Entry->Entries = NULL;
+  }
+
+  Entry->NumEntries = 0;
+}
+
+STATIC
+SCAN_CACHE_ENTRY *
+FindScanCacheEntry (
+  IN EFI_HANDLE  Device
+  )
+{
+  UINTN             Index;
+  SCAN_CACHE_ENTRY  *Entry;
+
+  if (mScanCache == NULL) {
+    return NULL;
+  }
+
+  for (Index = 0; Index < mScanCache->Count; ++Index) {
+    Entry = OcFlexArrayItemAt (mScanCache, Index);
+    if (  (Entry->Device == Device)
+       && CompareGuid (&Entry->Partuuid, &gPartuuid)
+       && (Entry->HideAuxiliary == gPickerContext->HideAuxiliary)
+       && (Entry->PickerAttributes == gPickerContext->PickerAttributes))
+    {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+BOOLEAN
+InternalGetCachedEntries (
+  IN   EFI_HANDLE         Device,
+  IN   EFI_FILE_PROTOCOL  *RootDirectory,
+  OUT  UINT64             *Fingerprint,
+  OUT  EFI_STATUS         *Status,
+  OUT  OC_PICKER_ENTRY    **Entries,
+  OUT  UINTN              *NumEntries
+  )
+{
+  SCAN_CACHE_ENTRY  *Entry;
+
+  *Fingerprint = GetPartitionFingerprint (RootDirectory);
+
+  Entry = FindScanCacheEntry (Device);
+  if ((Entry == NULL) || (Entry->Fingerprint != *Fingerprint)) {
+    return FALSE;
+  }
+
+  if (EFI_ERROR (Entry->Status)) {
+    *Status = Entry->Status;
+    return TRUE;
+  }
+
+  *Status = CopyPickerEntries (Entry->Entries, Entry->NumEntries, Entries);
+  if (EFI_ERROR (*Status)) {
+    return FALSE;
+  }
+
+  *NumEntries = Entry->NumEntries;
+  return TRUE;
+}
+
+VOID
+InternalCacheEntries (
+  IN   EFI_HANDLE             Device,
+  IN   UINT64                 Fingerprint,
+  IN   EFI_STATUS             Status,
+  IN   CONST OC_PICKER_ENTRY  *Entries,
+  IN   UINTN                  NumEntries
+  )
+{
+  SCAN_CACHE_ENTRY  *Entry;
+
+  if (mScanCache == NULL) {
+    mScanCache = OcFlexArrayInit (sizeof (SCAN_CACHE_ENTRY), (OC_FLEX_ARRAY_FREE_ITEM)FreeScanCacheEntry);
+    if (mScanCache == NULL) {
+      return;
+    }
+  }
+
+  Entry = FindScanCacheEntry (Device);
+  if (Entry == NULL) {
+    Entry = OcFlexArrayAddItem (mScanCache);
+    if (Entry == NULL) {
+      OcFlexArrayFree (&mScanCache);
+      return;
+    }
+
+    Entry->Device = Device;
+    CopyGuid (&Entry->Partuuid, &gPartuuid);
+    Entry->HideAuxiliary    = gPickerContext->HideAuxiliary;
+    Entry->PickerAttributes = gPickerContext->PickerAttributes;
+  } else {
+    FreeScanCacheEntry (Entry);
+  }
+
+  Entry->Fingerprint = Fingerprint;
+  Entry->Status      = Status;
+
+  if (!EFI_ERROR (Status)) {
+    if (EFI_ERROR (CopyPickerEntries (Entries, NumEntries, &Entry->Entries))) {
+      //
+      // Force rescan next time.
+      //
+      Entry->Fingerprint = ~Fingerprint;
+      return;
+    }
+
+    Entry->NumEntries = NumEntries;
+  }
+}
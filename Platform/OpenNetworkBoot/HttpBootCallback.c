@@ -126,6 +126,13 @@ OpenNetworkBootHttpBootCallback (
           }
 
           mUriValidated = TRUE;
+
+          //
+          // Chunk verification follows the body, which is sent again on each GET.
+          //
+          if (HttpMessage->Data.Request->Method == HttpMethodGet) {
+            HttpBootChunklistRestart ();
+          }
         }
       }
 
@@ -180,6 +187,17 @@ OpenNetworkBootHttpBootCallback (
 
       break;
 
+    //
+    // Verify DMG chunks as they arrive, when the chunklist was fetched first,
+    // and abort the download on the first chunk which does not match.
+    //
+    case HttpBootHttpEntityBody:
+      if ((Data != NULL) && !HttpBootChunklistUpdate (Data, DataLength)) {
+        return EFI_SECURITY_VIOLATION;
+      }
+
+      break;
+
     default:
       break;
   }
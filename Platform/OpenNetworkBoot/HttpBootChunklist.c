@@ -0,0 +1,133 @@
+/** @file
+  Verification of DMG chunks against a chunklist while they are downloaded.
+
+  HTTP Boot passes the entity body to its callback in download order, so
+  chunks can be hashed as they arrive and a bad image rejected without
+  waiting for the rest of it. The chunklist signature is checked before
+  the download starts, and again on the original buffer when the DMG
+  is loaded.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include "HttpBootChunklist.h"
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcAppleChunklistLib.h>
+#include <Library/OcAppleKeysLib.h>
+
+STATIC OC_APPLE_CHUNKLIST_CONTEXT  mChunklistContext;
+STATIC VOID                        *mChunklistBuffer;
+STATIC UINT64                      mChunklistDataSize;
+STATIC BOOLEAN                     mChunklistValid;
+
+EFI_STATUS
+HttpBootChunklistStart (
+  IN CONST VOID  *Chunklist,
+  IN UINT32      ChunklistSize
+  )
+{
+  ASSERT (Chunklist != NULL);
+  ASSERT (mChunklistBuffer == NULL);
+
+  if (ChunklistSize == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Context initialisation reverses the signature in place,
+  // the original buffer is verified again when the DMG is loaded.
+  //
+  mChunklistBuffer = AllocateCopyPool (ChunklistSize, Chunklist);
+  if (mChunklistBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (!OcAppleChunklistInitializeContext (&mChunklistContext, mChunklistBuffer, ChunklistSize)) {
+    FreePool (mChunklistBuffer);
+    mChunklistBuffer = NULL;
+    return EFI_UNSUPPORTED;
+  }
+
+  if (  !OcAppleChunklistVerifySignature (&mChunklistContext, PkDataBase[0].PublicKey)
+     && !OcAppleChunklistVerifySignature (&mChunklistContext, PkDataBase[1].PublicKey))
+  {
+    FreePool (mChunklistBuffer);
+    mChunklistBuffer = NULL;
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  HttpBootChunklistRestart ();
+
+  return EFI_SUCCESS;
+}
+
+VOID
+HttpBootChunklistRestart (
+  VOID
+  )
+{
+  if (mChunklistBuffer == NULL) {
+    return;
+  }
+
+  OcAppleChunklistVerifyDataInit (&mChunklistContext);
+  mChunklistDataSize = 0;
+  mChunklistValid    = TRUE;
+}
+
+BOOLEAN
+HttpBootChunklistUpdate (
+  IN CONST VOID  *Data,
+  IN UINTN       DataSize
+  )
+{
+  if ((mChunklistBuffer == NULL) || (DataSize == 0)) {
+    return TRUE;
+  }
+
+  if (!mChunklistValid) {
+    return FALSE;
+  }
+
+  mChunklistValid     = OcAppleChunklistVerifyDataUpdate (&mChunklistContext, Data, DataSize);
+  mChunklistDataSize += DataSize;
+
+  if (!mChunklistValid) {
+    DEBUG ((DEBUG_WARN, "NETB: DMG chunk %u does not match chunklist, aborting\n", (UINT32)mChunklistContext.ChunkIndex));
+  }
+
+  return mChunklistValid;
+}
+
+EFI_STATUS
+HttpBootChunklistFinish (
+  IN UINTN  FileSize
+  )
+{
+  EFI_STATUS  Status;
+
+  if (mChunklistBuffer == NULL) {
+    return EFI_NOT_STARTED;
+  }
+
+  if (!mChunklistValid) {
+    Status = EFI_SECURITY_VIOLATION;
+  } else if ((mChunklistDataSize != FileSize) || (mChunklistDataSize == 0)) {
+    Status = EFI_NOT_READY;
+  } else if (!OcAppleChunklistVerifyDataFinal (&mChunklistContext)) {
+    Status = EFI_SECURITY_VIOLATION;
+  } else {
+    Status = EFI_SUCCESS;
+  }
+
+  FreePool (mChunklistBuffer);
+  mChunklistBuffer   = NULL;
+  mChunklistDataSize = 0;
+  mChunklistValid    = FALSE;
+
+  return Status;
+}
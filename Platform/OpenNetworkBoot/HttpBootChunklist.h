@@ -0,0 +1,72 @@
+/** @file
+  Verification of DMG chunks against a chunklist while they are downloaded.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#ifndef HTTP_BOOT_CHUNKLIST_H
+#define HTTP_BOOT_CHUNKLIST_H
+
+#include <Uefi.h>
+
+/**
+  Start verifying the next download against a chunklist.
+  The chunklist buffer is copied and is not modified.
+
+  @param[in] Chunklist      Chunklist file contents.
+  @param[in] ChunklistSize  Chunklist file size.
+
+  @retval EFI_SUCCESS             Verification started.
+  @retval EFI_UNSUPPORTED         Chunklist is malformed.
+  @retval EFI_SECURITY_VIOLATION  Chunklist is not signed by Apple.
+  @retval EFI_OUT_OF_RESOURCES    Memory allocation failure.
+**/
+EFI_STATUS
+HttpBootChunklistStart (
+  IN CONST VOID  *Chunklist,
+  IN UINT32      ChunklistSize
+  );
+
+/**
+  Restart verification from the first chunk, e.g. when the body
+  is requested again. Does nothing when verification is not started.
+**/
+VOID
+HttpBootChunklistRestart (
+  VOID
+  );
+
+/**
+  Verify the next portion of the downloaded body.
+  Does nothing when verification is not started.
+
+  @param[in] Data      Body data following previously passed data.
+  @param[in] DataSize  Size of Data in bytes.
+
+  @retval TRUE   All chunks completed so far are valid.
+  @retval FALSE  The data failed verification, the download should be aborted.
+**/
+BOOLEAN
+HttpBootChunklistUpdate (
+  IN CONST VOID  *Data,
+  IN UINTN       DataSize
+  );
+
+/**
+  Finish verification and release its resources.
+
+  @param[in] FileSize  Size of the downloaded file.
+
+  @retval EFI_SUCCESS             The whole file was passed and all chunks are valid.
+  @retval EFI_SECURITY_VIOLATION  The data failed verification.
+  @retval EFI_NOT_READY           The data was not seen in full, e.g. the body
+                                  callback is not used by HTTP Boot driver.
+  @retval EFI_NOT_STARTED         Verification was not started.
+**/
+EFI_STATUS
+HttpBootChunklistFinish (
+  IN UINTN  FileSize
+  );
+
+#endif // HTTP_BOOT_CHUNKLIST_H
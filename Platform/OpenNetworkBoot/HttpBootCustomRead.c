@@ -55,6 +55,76 @@ SetDmgPreloadChunklist (
   return EFI_SUCCESS;
 }
 
+//
+// Fetch .chunklist before .dmg, when .dmg is requested directly, so that
+// .dmg chunks can be verified while they are downloaded.
+// Returns EFI_UNSUPPORTED when the URI is not known to be a .dmg URI.
+//
+STATIC
+EFI_STATUS
+PrefetchDmgChunklist (
+  IN     EFI_DEVICE_PATH_PROTOCOL             *DevicePath,
+  IN OUT OC_APPLE_DISK_IMAGE_PRELOAD_CONTEXT  *DmgPreloadContext
+  )
+{
+  EFI_STATUS                Status;
+  CHAR8                     *ChunklistUri;
+  EFI_DEVICE_PATH_PROTOCOL  *ChunklistLoadFile;
+  EFI_DEVICE_PATH_PROTOCOL  *ChunklistDevicePath;
+  VOID                      *Data;
+  UINT32                    DataSize;
+
+  //
+  // URI may also come from DHCP, this is only known once it has been loaded.
+  //
+  if (GetUriNode (DevicePath) == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = ExtractOtherUriFromDevicePath (DevicePath, ".dmg", ".chunklist", &ChunklistUri, FALSE);
+  if (Status == EFI_NOT_FOUND) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = HttpBootAddUri (DevicePath, ChunklistUri, OcStringFormatAscii, &ChunklistLoadFile);
+  if (EFI_ERROR (Status)) {
+    FreePool (ChunklistUri);
+    return Status;
+  }
+
+  Data                = NULL;
+  DataSize            = 0;
+  ChunklistDevicePath = BmExpandLoadFiles (ChunklistLoadFile, &Data, &DataSize, TRUE);
+  FreePool (ChunklistLoadFile);
+
+  //
+  // Sort out cramped spacing between the two HTTP Boot calls.
+  //
+  Print (L"\n");
+
+  if (ChunklistDevicePath == NULL) {
+    DEBUG ((DEBUG_INFO, "NETB: Failed to fetch required matching file %a\n", ChunklistUri));
+    FreePool (ChunklistUri);
+    return EFI_NOT_FOUND;
+  }
+
+  FreePool (ChunklistUri);
+  FreePool (ChunklistDevicePath);
+
+  //
+  // Chunklist is forced to application/efi and never loaded as RAM disk.
+  //
+  if (DataSize == 0) {
+    return EFI_LOAD_ERROR;
+  }
+
+  return SetDmgPreloadChunklist (DmgPreloadContext, &Data, &DataSize);
+}
+
 STATIC
 VOID
 FreeDmgPreloadContext (
@@ -63,9 +133,11 @@ FreeDmgPreloadContext (
 {
   if (DmgPreloadContext->ChunklistBuffer != NULL) {
     FreePool (DmgPreloadContext->ChunklistBuffer);
+    DmgPreloadContext->ChunklistBuffer = NULL;
   }
 
   DmgPreloadContext->ChunklistFileSize = 0;
+  DmgPreloadContext->DmgFileVerified   = FALSE;
   if (DmgPreloadContext->DmgFile != NULL) {
     DmgPreloadContext->DmgFile->Close (DmgPreloadContext->DmgFile);
     DmgPreloadContext->DmgFile = NULL;
@@ -145,9 +217,11 @@ HttpBootCustomRead (
   )
 {
   EFI_STATUS                Status;
+  EFI_STATUS                VerifyStatus;
   CUSTOM_FREE_CONTEXT       *CustomFreeContext;
   CHAR8                     *OtherUri;
   BOOLEAN                   GotDmgFirst;
+  BOOLEAN                   GotChunklistFirst;
   EFI_DEVICE_PATH_PROTOCOL  *OtherLoadFile;
   EFI_DEVICE_PATH_PROTOCOL  *OtherDevicePath;
 
@@ -163,6 +237,33 @@ HttpBootCustomRead (
 
   OcConsoleControlSetMode (EfiConsoleControlScreenText);
 
+  //
+  // With a signed .dmg requested by URI, get its .chunklist before
+  // downloading the (potentially multi-GB) image, so that the image is
+  // verified as it arrives and the download aborts on the first bad chunk.
+  //
+  GotChunklistFirst = FALSE;
+  if (DmgLoading == OcDmgLoadingAppleSigned) {
+    Status = PrefetchDmgChunklist (ChosenEntry->DevicePath, DmgPreloadContext);
+    if (!EFI_ERROR (Status)) {
+      Status = HttpBootChunklistStart (
+                 DmgPreloadContext->ChunklistBuffer,
+                 DmgPreloadContext->ChunklistFileSize
+                 );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_WARN, "NETB: DMG chunklist is not usable - %r\n", Status));
+        FreeDmgPreloadContext (DmgPreloadContext);
+        FreePool (CustomFreeContext);
+        return Status;
+      }
+
+      GotChunklistFirst = TRUE;
+    } else if (Status != EFI_UNSUPPORTED) {
+      FreePool (CustomFreeContext);
+      return Status;
+    }
+  }
+
   //
   // Load the first (or only) file. This method has been extended to
   // abort early (avoiding a pointless, long, slow load of a DMG) if DmgLoading
@@ -170,7 +271,17 @@ HttpBootCustomRead (
   //
   *DevicePath = BmExpandLoadFiles (ChosenEntry->DevicePath, Data, DataSize, TRUE);
 
+  if (GotChunklistFirst) {
+    VerifyStatus = HttpBootChunklistFinish ((*DevicePath != NULL) ? *DataSize : 0);
+    if (VerifyStatus == EFI_SUCCESS) {
+      DmgPreloadContext->DmgFileVerified = TRUE;
+    } else {
+      DEBUG ((DEBUG_INFO, "NETB: DMG was not verified during download - %r\n", VerifyStatus));
+    }
+  }
+
   if (*DevicePath == NULL) {
+    FreeDmgPreloadContext (DmgPreloadContext);
     FreePool (CustomFreeContext);
     return EFI_NOT_FOUND;
   }
@@ -217,7 +328,7 @@ HttpBootCustomRead (
     // Always require .dmg if .chunklist was fetched first; only fetch (and
     // require) .chunklist after .dmg when it will be used.
     //
-    if (!GotDmgFirst || (DmgLoading == OcDmgLoadingAppleSigned)) {
+    if (!GotDmgFirst || ((DmgLoading == OcDmgLoadingAppleSigned) && !GotChunklistFirst)) {
       Status = HttpBootAddUri (ChosenEntry->DevicePath, OtherUri, OcStringFormatAscii, &OtherLoadFile);
       if (!EFI_ERROR (Status)) {
         //
@@ -250,6 +361,13 @@ HttpBootCustomRead (
     FreePool (OtherUri);
   }
 
+  //
+  // Prefetched chunklist is of no use when the file was not loaded as .dmg.
+  //
+  if (!EFI_ERROR (Status) && GotChunklistFirst && (DmgPreloadContext->DmgFile == NULL)) {
+    FreeDmgPreloadContext (DmgPreloadContext);
+  }
+
   //
   // Sort out OC debug messages following HTTP Boot progress message on the same line, after completion.
   //
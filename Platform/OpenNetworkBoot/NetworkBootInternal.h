@@ -29,6 +29,8 @@
 #include <Guid/ImageAuthentication.h>
 #include <Guid/TlsAuthentication.h>
 
+#include "HttpBootChunklist.h"
+
 /////
 // Ip4Config2Impl.h
 //
@@ -21,6 +21,23 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Partition.h"
 
+//
+// Default GPT entry array size, 128 entries of 128 bytes.
+//
+#define GPT_READ_WINDOW_ENTRIES_SIZE  SIZE_16KB
+
+//
+// Disk areas holding the primary and the backup GPT, each read with a single
+// request while the partition table of one disk is being validated.
+//
+#define GPT_READ_WINDOW_COUNT  2
+
+typedef struct {
+  UINT64    Offset;
+  UINTN     Size;
+  UINT8     *Buffer;
+} GPT_READ_WINDOW;
+
 /**
   Install child handles if the Handle supports GPT partition structure.
 
@@ -30,6 +47,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
   @param[in]  BlockIo     Parent BlockIo interface.
   @param[in]  DiskIo      Disk Io protocol.
+  @param[in]  Windows     GPT read windows of the disk.
   @param[in]  Lba         The starting Lba of the Partition Table
   @param[out] PartHeader  Stores the partition table that is read
 
@@ -41,6 +59,7 @@ BOOLEAN
 PartitionValidGptTable (
   IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
   IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN  GPT_READ_WINDOW             *Windows,
   IN  EFI_LBA                     Lba,
   OUT EFI_PARTITION_TABLE_HEADER  *PartHeader
   );
@@ -51,6 +70,7 @@ PartitionValidGptTable (
 
   @param[in]  BlockIo     Parent BlockIo interface
   @param[in]  DiskIo      Disk Io Protocol.
+  @param[in]  Windows     GPT read windows of the disk.
   @param[in]  PartHeader  Partition table header structure
 
   @retval TRUE      the CRC is valid
@@ -61,6 +81,7 @@ BOOLEAN
 PartitionCheckGptEntryArrayCRC (
   IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
   IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN  GPT_READ_WINDOW             *Windows,
   IN  EFI_PARTITION_TABLE_HEADER  *PartHeader
   );
 
@@ -68,9 +89,10 @@ PartitionCheckGptEntryArrayCRC (
   Restore Partition Table to its alternate place
   (Primary -> Backup or Backup -> Primary).
 
-  @param[in]  BlockIo     Parent BlockIo interface.
-  @param[in]  DiskIo      Disk Io Protocol.
-  @param[in]  PartHeader  Partition table header structure.
+  @param[in]      BlockIo     Parent BlockIo interface.
+  @param[in]      DiskIo      Disk Io Protocol.
+  @param[in,out]  Windows     GPT read windows of the disk, dropped here.
+  @param[in]      PartHeader  Partition table header structure.
 
   @retval TRUE      Restoring succeeds
   @retval FALSE     Restoring failed
@@ -78,9 +100,10 @@ PartitionCheckGptEntryArrayCRC (
 **/
 BOOLEAN
 PartitionRestoreGptTable (
-  IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
-  IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
-  IN  EFI_PARTITION_TABLE_HEADER  *PartHeader
+  IN     EFI_BLOCK_IO_PROTOCOL       *BlockIo,
+  IN     EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN OUT GPT_READ_WINDOW             *Windows,
+  IN     EFI_PARTITION_TABLE_HEADER  *PartHeader
   );
 
 /**
@@ -161,6 +184,305 @@ PartitionSetCrc (
   IN OUT EFI_TABLE_HEADER  *Hdr
   );
 
+/**
+  Read disk area into GPT read window.
+  The window is left empty on failure, so that reads fall back to the disk.
+
+  @param[in]  DiskIo    Disk Io protocol.
+  @param[in]  MediaId   Block I/O media identifier.
+  @param[out] Window    Window to fill.
+  @param[in]  Lba       First block of the area.
+  @param[in]  Blocks    Number of blocks in the area.
+  @param[in]  BlockSize Block size.
+**/
+STATIC
+VOID
+PartitionGptLoadReadWindow (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  OUT GPT_READ_WINDOW       *Window,
+  IN  EFI_LBA               Lba,
+  IN  UINTN                 Blocks,
+  IN  UINT32                BlockSize
+  )
+{
+  EFI_STATUS  Status;
+
+  Window->Offset = MultU64x32 (Lba, BlockSize);
+  Window->Size   = Blocks * BlockSize;
+  Window->Buffer = AllocatePool (Window->Size);
+  if (Window->Buffer == NULL) {
+    Window->Size = 0;
+    return;
+  }
+
+  Status = DiskIo->ReadDisk (
+                     DiskIo,
+                     MediaId,
+                     Window->Offset,
+                     Window->Size,
+                     Window->Buffer
+                     );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((EFI_D_INFO, " GPT window read at %lx error - %r\n", Window->Offset, Status));
+    FreePool (Window->Buffer);
+    Window->Buffer = NULL;
+    Window->Size   = 0;
+  }
+}
+
+/**
+  Drop GPT read windows, e.g. after the partition table was written to.
+
+  @param[in,out] Windows  GPT read windows to drop.
+**/
+STATIC
+VOID
+PartitionGptFreeReadWindows (
+  IN OUT GPT_READ_WINDOW  *Windows
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < GPT_READ_WINDOW_COUNT; ++Index) {
+    if (Windows[Index].Buffer != NULL) {
+      FreePool (Windows[Index].Buffer);
+    }
+  }
+
+  ZeroMem (Windows, GPT_READ_WINDOW_COUNT * sizeof (*Windows));
+}
+
+/**
+  Read disk area from GPT read windows when it is fully contained in one,
+  and from the disk otherwise.
+
+  @param[in]  DiskIo      Disk Io protocol.
+  @param[in]  MediaId     Block I/O media identifier.
+  @param[in]  Windows     GPT read windows of the disk.
+  @param[in]  Offset      Disk offset in bytes.
+  @param[in]  BufferSize  Number of bytes to read.
+  @param[out] Buffer      Destination buffer.
+
+  @retval EFI_SUCCESS  The area was read.
+  @retval other        Disk read error.
+**/
+STATIC
+EFI_STATUS
+PartitionGptReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *DiskIo,
+  IN  UINT32                MediaId,
+  IN  GPT_READ_WINDOW       *Windows,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  UINTN            Index;
+  GPT_READ_WINDOW  *Window;
+
+  for (Index = 0; Index < GPT_READ_WINDOW_COUNT; ++Index) {
+    Window = &Windows[Index];
+    if (  (Window->Size >= BufferSize)
+       && (Offset >= Window->Offset)
+       && (Offset - Window->Offset <= Window->Size - BufferSize))
+    {
+      CopyMem (Buffer, Window->Buffer + (UINTN)(Offset - Window->Offset), BufferSize);
+      return EFI_SUCCESS;
+    }
+  }
+
+  return DiskIo->ReadDisk (
+                   DiskIo,
+                   MediaId,
+                   Offset,
+                   BufferSize,
+                   Buffer
+                   );
+}
+
+/**
+  Publish verified partition entries on the disk handle for reuse by later
+  driver starts and by OcFileLib. Previous instances are uninstalled but
+  never freed, as pointers into them may still be in use.
+
+  @param[in]  Handle       Parent Handle.
+  @param[in]  PartEntries  Partition entries to publish.
+
+  @retval EFI_SUCCESS  PartEntries are owned by the disk handle now.
+  @retval other        PartEntries were not published.
+**/
+STATIC
+EFI_STATUS
+PartitionGptPublishEntries (
+  IN EFI_HANDLE            Handle,
+  IN OC_PARTITION_ENTRIES  *PartEntries
+  )
+{
+  EFI_STATUS            Status;
+  OC_PARTITION_ENTRIES  *CachedEntries;
+
+  Status = gBS->HandleProtocol (
+                  Handle,
+                  &gOcPartitionEntriesProtocolGuid,
+                  (VOID **)&CachedEntries
+                  );
+  if (!EFI_ERROR (Status)) {
+    gBS->UninstallMultipleProtocolInterfaces (
+           Handle,
+           &gOcPartitionEntriesProtocolGuid,
+           CachedEntries,
+           NULL
+           );
+  }
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &Handle,
+                  &gOcPartitionEntriesProtocolGuid,
+                  PartEntries,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((EFI_D_INFO, " Partition entries caching error - %r\n", Status));
+  }
+
+  return Status;
+}
+
+/**
+  Install child handles for GPT partition entries.
+
+  @param[in]  This        Calling context.
+  @param[in]  Handle      Parent Handle.
+  @param[in]  DiskIo      Parent DiskIo interface.
+  @param[in]  DiskIo2     Parent DiskIo2 interface.
+  @param[in]  BlockIo     Parent BlockIo interface.
+  @param[in]  BlockIo2    Parent BlockIo2 interface.
+  @param[in]  DevicePath  Parent Device Path.
+  @param[in]  PartHeader  Partition table header structure.
+  @param[in]  PartEntry   The partition entry array.
+
+  @retval EFI_SUCCESS           Child handles were processed.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation error.
+**/
+STATIC
+EFI_STATUS
+PartitionGptInstallChildren (
+  IN  EFI_DRIVER_BINDING_PROTOCOL  *This,
+  IN  EFI_HANDLE                   Handle,
+  IN  EFI_DISK_IO_PROTOCOL         *DiskIo,
+  IN  EFI_DISK_IO2_PROTOCOL        *DiskIo2,
+  IN  EFI_BLOCK_IO_PROTOCOL        *BlockIo,
+  IN  EFI_BLOCK_IO2_PROTOCOL       *BlockIo2,
+  IN  EFI_DEVICE_PATH_PROTOCOL     *DevicePath,
+  IN  EFI_PARTITION_TABLE_HEADER   *PartHeader,
+  IN  EFI_PARTITION_ENTRY          *PartEntry
+  )
+{
+  UINT32                         BlockSize;
+  EFI_PARTITION_ENTRY            *Entry;
+  EFI_PARTITION_ENTRY_STATUS     *PEntryStatus;
+  UINTN                          Index;
+  HARDDRIVE_DEVICE_PATH          HdDev;
+  EFI_PARTITION_INFO_PROTOCOL    PartitionInfo;
+  APPLE_PARTITION_INFO_PROTOCOL  ApplePartitionInfo;
+
+  BlockSize = BlockIo->Media->BlockSize;
+
+  DEBUG ((EFI_D_INFO, " Number of partition entries: %d\n", PartHeader->NumberOfPartitionEntries));
+
+  PEntryStatus = AllocateZeroPool (PartHeader->NumberOfPartitionEntries * sizeof (EFI_PARTITION_ENTRY_STATUS));
+  if (PEntryStatus == NULL) {
+    DEBUG ((EFI_D_ERROR, "Allocate pool error\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Check the integrity of partition entries
+  //
+  PartitionCheckGptEntry (PartHeader, PartEntry, PEntryStatus);
+
+  //
+  // Create child device handles
+  //
+  for (Index = 0; Index < PartHeader->NumberOfPartitionEntries; Index++) {
+    Entry = (EFI_PARTITION_ENTRY *)((UINT8 *)PartEntry + Index * PartHeader->SizeOfPartitionEntry);
+    if (CompareGuid (&Entry->PartitionTypeGUID, &gEfiPartTypeUnusedGuid) ||
+        PEntryStatus[Index].OutOfRange ||
+        PEntryStatus[Index].Overlap ||
+        PEntryStatus[Index].OsSpecific
+        )
+    {
+      //
+      // Don't use null EFI Partition Entries, Invalid Partition Entries or OS specific
+      // partition Entries
+      //
+      continue;
+    }
+
+    ZeroMem (&HdDev, sizeof (HdDev));
+    HdDev.Header.Type    = MEDIA_DEVICE_PATH;
+    HdDev.Header.SubType = MEDIA_HARDDRIVE_DP;
+    SetDevicePathNodeLength (&HdDev.Header, sizeof (HdDev));
+
+    HdDev.PartitionNumber = (UINT32)Index + 1;
+    HdDev.MBRType         = MBR_TYPE_EFI_PARTITION_TABLE_HEADER;
+    HdDev.SignatureType   = SIGNATURE_TYPE_GUID;
+    HdDev.PartitionStart  = Entry->StartingLBA;
+    HdDev.PartitionSize   = Entry->EndingLBA - Entry->StartingLBA + 1;
+    CopyMem (HdDev.Signature, &Entry->UniquePartitionGUID, sizeof (EFI_GUID));
+
+    ZeroMem (&PartitionInfo, sizeof (EFI_PARTITION_INFO_PROTOCOL));
+    PartitionInfo.Revision = EFI_PARTITION_INFO_PROTOCOL_REVISION;
+    PartitionInfo.Type     = PARTITION_TYPE_GPT;
+    if (CompareGuid (&Entry->PartitionTypeGUID, &gEfiPartTypeSystemPartGuid)) {
+      PartitionInfo.System = 1;
+    }
+
+    CopyMem (&PartitionInfo.Info.Gpt, Entry, sizeof (EFI_PARTITION_ENTRY));
+
+    ZeroMem (&ApplePartitionInfo, sizeof (APPLE_PARTITION_INFO_PROTOCOL));
+    ApplePartitionInfo.Revision        = APPLE_PARTITION_INFO_REVISION;
+    ApplePartitionInfo.PartitionNumber = HdDev.PartitionNumber;
+    ApplePartitionInfo.MBRType         = HdDev.MBRType;
+    ApplePartitionInfo.SignatureType   = HdDev.SignatureType;
+    ApplePartitionInfo.PartitionStart  = HdDev.PartitionStart;
+    ApplePartitionInfo.PartitionSize   = HdDev.PartitionSize;
+    ApplePartitionInfo.Attributes      = Entry->Attributes;
+    CopyMem (&ApplePartitionInfo.Signature, HdDev.Signature, sizeof (EFI_GUID));
+    CopyMem (ApplePartitionInfo.PartitionName, Entry->PartitionName, 36 * sizeof (UINT16));
+    CopyMem (&ApplePartitionInfo.PartitionType, &Entry->PartitionTypeGUID, sizeof (EFI_GUID));
+
+    DEBUG ((EFI_D_INFO, " Index : %d\n", (UINT32)Index));
+    DEBUG ((EFI_D_INFO, " Start LBA : %lx\n", (UINT64)HdDev.PartitionStart));
+    DEBUG ((EFI_D_INFO, " End LBA : %lx\n", (UINT64)Entry->EndingLBA));
+    DEBUG ((EFI_D_INFO, " Partition size: %lx\n", (UINT64)HdDev.PartitionSize));
+    DEBUG ((EFI_D_INFO, " Start : %lx", MultU64x32 (Entry->StartingLBA, BlockSize)));
+    DEBUG ((EFI_D_INFO, " End : %lx\n", MultU64x32 (Entry->EndingLBA, BlockSize)));
+
+    PartitionInstallChildHandle (
+      This,
+      Handle,
+      DiskIo,
+      DiskIo2,
+      BlockIo,
+      BlockIo2,
+      DevicePath,
+      (EFI_DEVICE_PATH_PROTOCOL *)&HdDev,
+      &PartitionInfo,
+      &ApplePartitionInfo,
+      Entry->StartingLBA,
+      Entry->EndingLBA,
+      BlockSize,
+      &Entry->PartitionTypeGUID
+      );
+  }
+
+  FreePool (PEntryStatus);
+
+  return EFI_SUCCESS;
+}
+
 /**
   Install child handles if the Handle supports GPT partition structure.
 
@@ -193,27 +515,25 @@ PartitionInstallGptChildHandles (
   IN  EFI_DEVICE_PATH_PROTOCOL     *DevicePath
   )
 {
-  EFI_STATUS                     Status;
-  UINT32                         BlockSize;
-  EFI_LBA                        LastBlock;
-  MASTER_BOOT_RECORD             *ProtectiveMbr;
-  EFI_PARTITION_TABLE_HEADER     *PrimaryHeader;
-  EFI_PARTITION_TABLE_HEADER     *BackupHeader;
-  EFI_PARTITION_ENTRY            *PartEntry;
-  EFI_PARTITION_ENTRY            *Entry;
-  EFI_PARTITION_ENTRY_STATUS     *PEntryStatus;
-  UINTN                          Index;
-  EFI_STATUS                     GptValidStatus;
-  HARDDRIVE_DEVICE_PATH          HdDev;
-  UINT32                         MediaId;
-  EFI_PARTITION_INFO_PROTOCOL    PartitionInfo;
-  APPLE_PARTITION_INFO_PROTOCOL  ApplePartitionInfo;
+  EFI_STATUS                  Status;
+  UINT32                      BlockSize;
+  EFI_LBA                     LastBlock;
+  MASTER_BOOT_RECORD          *ProtectiveMbr;
+  EFI_PARTITION_TABLE_HEADER  *PrimaryHeader;
+  EFI_PARTITION_TABLE_HEADER  *BackupHeader;
+  OC_PARTITION_ENTRIES        *PartEntries;
+  UINTN                       PartEntriesSize;
+  GPT_READ_WINDOW             Windows[GPT_READ_WINDOW_COUNT];
+  UINTN                       WindowBlocks;
+  UINTN                       Index;
+  EFI_STATUS                  GptValidStatus;
+  UINT32                      MediaId;
+  BOOLEAN                     PrimaryValid;
 
   ProtectiveMbr = NULL;
   PrimaryHeader = NULL;
   BackupHeader  = NULL;
-  PartEntry     = NULL;
-  PEntryStatus  = NULL;
+  PartEntries   = NULL;
 
   BlockSize = BlockIo->Media->BlockSize;
   LastBlock = BlockIo->Media->LastBlock;
@@ -231,24 +551,89 @@ PartitionInstallGptChildHandles (
     return EFI_NOT_FOUND;
   }
 
+  //
+  // Reuse the entries verified on a previous start for the same media
+  // as long as the primary header is unchanged.
+  //
+  Status = gBS->HandleProtocol (
+                  Handle,
+                  &gOcPartitionEntriesProtocolGuid,
+                  (VOID **)&PartEntries
+                  );
+  if (!EFI_ERROR (Status) && PartEntries->Verified && (PartEntries->MediaId == MediaId)) {
+    PrimaryHeader = AllocatePool (BlockSize);
+    if (PrimaryHeader == NULL) {
+      return EFI_NOT_FOUND;
+    }
+
+    Status = DiskIo->ReadDisk (
+                       DiskIo,
+                       MediaId,
+                       MultU64x32 (PRIMARY_PART_HEADER_LBA, BlockSize),
+                       BlockSize,
+                       PrimaryHeader
+                       );
+    if (  !EFI_ERROR (Status)
+       && (CompareMem (PrimaryHeader, &PartEntries->Header, sizeof (EFI_PARTITION_TABLE_HEADER)) == 0))
+    {
+      DEBUG ((EFI_D_INFO, " Using cached partition entries\n"));
+      Status = PartitionGptInstallChildren (
+                 This,
+                 Handle,
+                 DiskIo,
+                 DiskIo2,
+                 BlockIo,
+                 BlockIo2,
+                 DevicePath,
+                 &PartEntries->Header,
+                 PartEntries->FirstEntry
+                 );
+      FreePool (PrimaryHeader);
+      if (EFI_ERROR (Status)) {
+        return EFI_NOT_FOUND;
+      }
+
+      return EFI_SUCCESS;
+    }
+
+    DEBUG ((EFI_D_INFO, " Cached partition entries are stale - %r\n", Status));
+    FreePool (PrimaryHeader);
+    PrimaryHeader = NULL;
+  }
+
+  PartEntries = NULL;
+
+  //
+  // Read the MBR, the primary header and the default sized entry array
+  // with a single request.
+  //
+  WindowBlocks = 2 + GPT_READ_WINDOW_ENTRIES_SIZE / BlockSize;
+  if ((WindowBlocks == 2) || (LastBlock < 2 * WindowBlocks)) {
+    WindowBlocks = 1;
+  }
+
+  ZeroMem (Windows, sizeof (Windows));
+  PartitionGptLoadReadWindow (DiskIo, MediaId, &Windows[0], 0, WindowBlocks, BlockSize);
+
   //
   // Allocate a buffer for the Protective MBR
   //
   ProtectiveMbr = AllocatePool (BlockSize);
   if (ProtectiveMbr == NULL) {
-    return EFI_NOT_FOUND;
+    goto Done;
   }
 
   //
   // Read the Protective MBR from LBA #0
   //
-  Status = DiskIo->ReadDisk (
-                     DiskIo,
-                     MediaId,
-                     0,
-                     BlockSize,
-                     ProtectiveMbr
-                     );
+  Status = PartitionGptReadDisk (
+             DiskIo,
+             MediaId,
+             Windows,
+             0,
+             BlockSize,
+             ProtectiveMbr
+             );
   if (EFI_ERROR (Status)) {
     GptValidStatus = Status;
     goto Done;
@@ -271,6 +656,20 @@ PartitionInstallGptChildHandles (
     goto Done;
   }
 
+  //
+  // Read the backup entry array and header with a single request as well.
+  //
+  if (WindowBlocks > 1) {
+    PartitionGptLoadReadWindow (
+      DiskIo,
+      MediaId,
+      &Windows[1],
+      LastBlock - (WindowBlocks - 2),
+      WindowBlocks - 1,
+      BlockSize
+      );
+  }
+
   //
   // Allocate the GPT structures
   //
@@ -287,31 +686,33 @@ PartitionInstallGptChildHandles (
   //
   // Check primary and backup partition tables
   //
-  if (!PartitionValidGptTable (BlockIo, DiskIo, PRIMARY_PART_HEADER_LBA, PrimaryHeader)) {
+  PrimaryValid = PartitionValidGptTable (BlockIo, DiskIo, Windows, PRIMARY_PART_HEADER_LBA, PrimaryHeader);
+  if (!PrimaryValid) {
     DEBUG ((EFI_D_INFO, " Not Valid primary partition table\n"));
 
-    if (!PartitionValidGptTable (BlockIo, DiskIo, LastBlock, BackupHeader)) {
+    if (!PartitionValidGptTable (BlockIo, DiskIo, Windows, LastBlock, BackupHeader)) {
       DEBUG ((EFI_D_INFO, " Not Valid backup partition table\n"));
       goto Done;
     } else {
       DEBUG ((EFI_D_INFO, " Valid backup partition table\n"));
       DEBUG ((EFI_D_INFO, " Restore primary partition table by the backup\n"));
-      if (!PartitionRestoreGptTable (BlockIo, DiskIo, BackupHeader)) {
+      if (!PartitionRestoreGptTable (BlockIo, DiskIo, Windows, BackupHeader)) {
         DEBUG ((EFI_D_INFO, " Restore primary partition table error\n"));
       }
 
-      if (PartitionValidGptTable (BlockIo, DiskIo, BackupHeader->AlternateLBA, PrimaryHeader)) {
+      PrimaryValid = PartitionValidGptTable (BlockIo, DiskIo, Windows, BackupHeader->AlternateLBA, PrimaryHeader);
+      if (PrimaryValid) {
         DEBUG ((EFI_D_INFO, " Restore backup partition table success\n"));
       }
     }
-  } else if (!PartitionValidGptTable (BlockIo, DiskIo, PrimaryHeader->AlternateLBA, BackupHeader)) {
+  } else if (!PartitionValidGptTable (BlockIo, DiskIo, Windows, PrimaryHeader->AlternateLBA, BackupHeader)) {
     DEBUG ((EFI_D_INFO, " Valid primary and !Valid backup partition table\n"));
     DEBUG ((EFI_D_INFO, " Restore backup partition table by the primary\n"));
-    if (!PartitionRestoreGptTable (BlockIo, DiskIo, PrimaryHeader)) {
+    if (!PartitionRestoreGptTable (BlockIo, DiskIo, Windows, PrimaryHeader)) {
       DEBUG ((EFI_D_INFO, " Restore backup partition table error\n"));
     }
 
-    if (PartitionValidGptTable (BlockIo, DiskIo, PrimaryHeader->AlternateLBA, BackupHeader)) {
+    if (PartitionValidGptTable (BlockIo, DiskIo, Windows, PrimaryHeader->AlternateLBA, BackupHeader)) {
       DEBUG ((EFI_D_INFO, " Restore backup partition table success\n"));
     }
   }
@@ -321,19 +722,25 @@ PartitionInstallGptChildHandles (
   //
   // Read the EFI Partition Entries
   //
-  PartEntry = AllocatePool (PrimaryHeader->NumberOfPartitionEntries * PrimaryHeader->SizeOfPartitionEntry);
-  if (PartEntry == NULL) {
+  PartEntriesSize = (UINTN)PrimaryHeader->NumberOfPartitionEntries * PrimaryHeader->SizeOfPartitionEntry;
+  if (PartEntriesSize > MAX_UINTN - sizeof (OC_PARTITION_ENTRIES)) {
+    goto Done;
+  }
+
+  PartEntries = AllocatePool (sizeof (OC_PARTITION_ENTRIES) + PartEntriesSize);
+  if (PartEntries == NULL) {
     DEBUG ((EFI_D_ERROR, "Allocate pool error\n"));
     goto Done;
   }
 
-  Status = DiskIo->ReadDisk (
-                     DiskIo,
-                     MediaId,
-                     MultU64x32 (PrimaryHeader->PartitionEntryLBA, BlockSize),
-                     PrimaryHeader->NumberOfPartitionEntries * (PrimaryHeader->SizeOfPartitionEntry),
-                     PartEntry
-                     );
+  Status = PartitionGptReadDisk (
+             DiskIo,
+             MediaId,
+             Windows,
+             MultU64x32 (PrimaryHeader->PartitionEntryLBA, BlockSize),
+             PartEntriesSize,
+             PartEntries->FirstEntry
+             );
   if (EFI_ERROR (Status)) {
     GptValidStatus = Status;
     DEBUG ((EFI_D_ERROR, " Partition Entry ReadDisk error\n"));
@@ -342,103 +749,48 @@ PartitionInstallGptChildHandles (
 
   DEBUG ((EFI_D_INFO, " Partition entries read block success\n"));
 
-  DEBUG ((EFI_D_INFO, " Number of partition entries: %d\n", PrimaryHeader->NumberOfPartitionEntries));
-
-  PEntryStatus = AllocateZeroPool (PrimaryHeader->NumberOfPartitionEntries * sizeof (EFI_PARTITION_ENTRY_STATUS));
-  if (PEntryStatus == NULL) {
-    DEBUG ((EFI_D_ERROR, "Allocate pool error\n"));
+  Status = PartitionGptInstallChildren (
+             This,
+             Handle,
+             DiskIo,
+             DiskIo2,
+             BlockIo,
+             BlockIo2,
+             DevicePath,
+             PrimaryHeader,
+             PartEntries->FirstEntry
+             );
+  if (EFI_ERROR (Status)) {
     goto Done;
   }
 
-  //
-  // Check the integrity of partition entries
-  //
-  PartitionCheckGptEntry (PrimaryHeader, PartEntry, PEntryStatus);
-
   //
   // If we got this far the GPT layout of the disk is valid and we should return true
   //
   GptValidStatus = EFI_SUCCESS;
 
   //
-  // Create child device handles
+  // Entries read through a header that passed the CRC checks can be reused
+  // until the media changes.
   //
-  for (Index = 0; Index < PrimaryHeader->NumberOfPartitionEntries; Index++) {
-    Entry = (EFI_PARTITION_ENTRY *)((UINT8 *)PartEntry + Index * PrimaryHeader->SizeOfPartitionEntry);
-    if (CompareGuid (&Entry->PartitionTypeGUID, &gEfiPartTypeUnusedGuid) ||
-        PEntryStatus[Index].OutOfRange ||
-        PEntryStatus[Index].Overlap ||
-        PEntryStatus[Index].OsSpecific
-        )
-    {
-      //
-      // Don't use null EFI Partition Entries, Invalid Partition Entries or OS specific
-      // partition Entries
-      //
-      continue;
+  if (PrimaryValid) {
+    PartEntries->MediaId            = MediaId;
+    PartEntries->Verified           = TRUE;
+    CopyMem (&PartEntries->Header, PrimaryHeader, sizeof (PartEntries->Header));
+    PartEntries->NumPartitions      = PrimaryHeader->NumberOfPartitionEntries;
+    PartEntries->PartitionEntrySize = PrimaryHeader->SizeOfPartitionEntry;
+
+    Status = PartitionGptPublishEntries (Handle, PartEntries);
+    if (!EFI_ERROR (Status)) {
+      PartEntries = NULL;
     }
-
-    ZeroMem (&HdDev, sizeof (HdDev));
-    HdDev.Header.Type    = MEDIA_DEVICE_PATH;
-    HdDev.Header.SubType = MEDIA_HARDDRIVE_DP;
-    SetDevicePathNodeLength (&HdDev.Header, sizeof (HdDev));
-
-    HdDev.PartitionNumber = (UINT32)Index + 1;
-    HdDev.MBRType         = MBR_TYPE_EFI_PARTITION_TABLE_HEADER;
-    HdDev.SignatureType   = SIGNATURE_TYPE_GUID;
-    HdDev.PartitionStart  = Entry->StartingLBA;
-    HdDev.PartitionSize   = Entry->EndingLBA - Entry->StartingLBA + 1;
-    CopyMem (HdDev.Signature, &Entry->UniquePartitionGUID, sizeof (EFI_GUID));
-
-    ZeroMem (&PartitionInfo, sizeof (EFI_PARTITION_INFO_PROTOCOL));
-    PartitionInfo.Revision = EFI_PARTITION_INFO_PROTOCOL_REVISION;
-    PartitionInfo.Type     = PARTITION_TYPE_GPT;
-    if (CompareGuid (&Entry->PartitionTypeGUID, &gEfiPartTypeSystemPartGuid)) {
-      PartitionInfo.System = 1;
-    }
-
-    CopyMem (&PartitionInfo.Info.Gpt, Entry, sizeof (EFI_PARTITION_ENTRY));
-
-    ZeroMem (&ApplePartitionInfo, sizeof (APPLE_PARTITION_INFO_PROTOCOL));
-    ApplePartitionInfo.Revision        = APPLE_PARTITION_INFO_REVISION;
-    ApplePartitionInfo.PartitionNumber = HdDev.PartitionNumber;
-    ApplePartitionInfo.MBRType         = HdDev.MBRType;
-    ApplePartitionInfo.SignatureType   = HdDev.SignatureType;
-    ApplePartitionInfo.PartitionStart  = HdDev.PartitionStart;
-    ApplePartitionInfo.PartitionSize   = HdDev.PartitionSize;
-    ApplePartitionInfo.Attributes      = PartEntry[Index].Attributes;
-    CopyMem (&ApplePartitionInfo.Signature, HdDev.Signature, sizeof (EFI_GUID));
-    CopyMem (ApplePartitionInfo.PartitionName, PartEntry[Index].PartitionName, 36 * sizeof (UINT16));
-    CopyMem (&ApplePartitionInfo.PartitionType, &PartEntry[Index].PartitionTypeGUID, sizeof (EFI_GUID));
-
-    DEBUG ((EFI_D_INFO, " Index : %d\n", (UINT32)Index));
-    DEBUG ((EFI_D_INFO, " Start LBA : %lx\n", (UINT64)HdDev.PartitionStart));
-    DEBUG ((EFI_D_INFO, " End LBA : %lx\n", (UINT64)Entry->EndingLBA));
-    DEBUG ((EFI_D_INFO, " Partition size: %lx\n", (UINT64)HdDev.PartitionSize));
-    DEBUG ((EFI_D_INFO, " Start : %lx", MultU64x32 (Entry->StartingLBA, BlockSize)));
-    DEBUG ((EFI_D_INFO, " End : %lx\n", MultU64x32 (Entry->EndingLBA, BlockSize)));
-
-    Status = PartitionInstallChildHandle (
-               This,
-               Handle,
-               DiskIo,
-               DiskIo2,
-               BlockIo,
-               BlockIo2,
-               DevicePath,
-               (EFI_DEVICE_PATH_PROTOCOL *)&HdDev,
-               &PartitionInfo,
-               &ApplePartitionInfo,
-               Entry->StartingLBA,
-               Entry->EndingLBA,
-               BlockSize,
-               &Entry->PartitionTypeGUID
-               );
   }
 
   DEBUG ((EFI_D_INFO, "Prepare to Free Pool\n"));
 
 Done:
+  PartitionGptFreeReadWindows (Windows);
+
   if (ProtectiveMbr != NULL) {
     FreePool (ProtectiveMbr);
   }
@@ -451,12 +803,8 @@ Done:
     FreePool (BackupHeader);
   }
 
-  if (PartEntry != NULL) {
-    FreePool (PartEntry);
-  }
-
-  if (PEntryStatus != NULL) {
-    FreePool (PEntryStatus);
+  if (PartEntries != NULL) {
+    FreePool (PartEntries);
   }
 
   return GptValidStatus;
@@ -471,6 +819,7 @@ Done:
 
   @param[in]  BlockIo     Parent BlockIo interface.
   @param[in]  DiskIo      Disk Io protocol.
+  @param[in]  Windows     GPT read windows of the disk.
   @param[in]  Lba         The starting Lba of the Partition Table
   @param[out] PartHeader  Stores the partition table that is read
 
@@ -482,6 +831,7 @@ BOOLEAN
 PartitionValidGptTable (
   IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
   IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN  GPT_READ_WINDOW             *Windows,
   IN  EFI_LBA                     Lba,
   OUT EFI_PARTITION_TABLE_HEADER  *PartHeader
   )
@@ -503,13 +853,14 @@ PartitionValidGptTable (
   //
   // Read the EFI Partition Table Header
   //
-  Status = DiskIo->ReadDisk (
-                     DiskIo,
-                     MediaId,
-                     MultU64x32 (Lba, BlockSize),
-                     BlockSize,
-                     PartHdr
-                     );
+  Status = PartitionGptReadDisk (
+             DiskIo,
+             MediaId,
+             Windows,
+             MultU64x32 (Lba, BlockSize),
+             BlockSize,
+             PartHdr
+             );
   if (EFI_ERROR (Status)) {
     FreePool (PartHdr);
     return FALSE;
@@ -535,7 +886,7 @@ PartitionValidGptTable (
   }
 
   CopyMem (PartHeader, PartHdr, sizeof (EFI_PARTITION_TABLE_HEADER));
-  if (!PartitionCheckGptEntryArrayCRC (BlockIo, DiskIo, PartHeader)) {
+  if (!PartitionCheckGptEntryArrayCRC (BlockIo, DiskIo, Windows, PartHeader)) {
     FreePool (PartHdr);
     return FALSE;
   }
@@ -551,6 +902,7 @@ PartitionValidGptTable (
 
   @param[in]  BlockIo     Parent BlockIo interface
   @param[in]  DiskIo      Disk Io Protocol.
+  @param[in]  Windows     GPT read windows of the disk.
   @param[in]  PartHeader  Partition table header structure
 
   @retval TRUE      the CRC is valid
@@ -561,6 +913,7 @@ BOOLEAN
 PartitionCheckGptEntryArrayCRC (
   IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
   IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN  GPT_READ_WINDOW             *Windows,
   IN  EFI_PARTITION_TABLE_HEADER  *PartHeader
   )
 {
@@ -578,13 +931,14 @@ PartitionCheckGptEntryArrayCRC (
     return FALSE;
   }
 
-  Status = DiskIo->ReadDisk (
-                     DiskIo,
-                     BlockIo->Media->MediaId,
-                     MultU64x32 (PartHeader->PartitionEntryLBA, BlockIo->Media->BlockSize),
-                     PartHeader->NumberOfPartitionEntries * PartHeader->SizeOfPartitionEntry,
-                     Ptr
-                     );
+  Status = PartitionGptReadDisk (
+             DiskIo,
+             BlockIo->Media->MediaId,
+             Windows,
+             MultU64x32 (PartHeader->PartitionEntryLBA, BlockIo->Media->BlockSize),
+             PartHeader->NumberOfPartitionEntries * PartHeader->SizeOfPartitionEntry,
+             Ptr
+             );
   if (EFI_ERROR (Status)) {
     FreePool (Ptr);
     return FALSE;
@@ -608,9 +962,10 @@ PartitionCheckGptEntryArrayCRC (
   Restore Partition Table to its alternate place
   (Primary -> Backup or Backup -> Primary).
 
-  @param[in]  BlockIo     Parent BlockIo interface.
-  @param[in]  DiskIo      Disk Io Protocol.
-  @param[in]  PartHeader  Partition table header structure.
+  @param[in]      BlockIo     Parent BlockIo interface.
+  @param[in]      DiskIo      Disk Io Protocol.
+  @param[in,out]  Windows     GPT read windows of the disk, dropped here.
+  @param[in]      PartHeader  Partition table header structure.
 
   @retval TRUE      Restoring succeeds
   @retval FALSE     Restoring failed
@@ -618,9 +973,10 @@ PartitionCheckGptEntryArrayCRC (
 **/
 BOOLEAN
 PartitionRestoreGptTable (
-  IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
-  IN  EFI_DISK_IO_PROTOCOL        *DiskIo,
-  IN  EFI_PARTITION_TABLE_HEADER  *PartHeader
+  IN     EFI_BLOCK_IO_PROTOCOL       *BlockIo,
+  IN     EFI_DISK_IO_PROTOCOL        *DiskIo,
+  IN OUT GPT_READ_WINDOW             *Windows,
+  IN     EFI_PARTITION_TABLE_HEADER  *PartHeader
   )
 {
   EFI_STATUS                  Status;
@@ -636,6 +992,11 @@ PartitionRestoreGptTable (
   BlockSize = BlockIo->Media->BlockSize;
   MediaId   = BlockIo->Media->MediaId;
 
+  //
+  // Cached disk areas become stale once the partition table is written to.
+  //
+  PartitionGptFreeReadWindows (Windows);
+
   PartHdr = AllocateZeroPool (BlockSize);
 
   if (PartHdr == NULL) {
@@ -63,6 +63,33 @@ STATIC BOOLEAN                      mKernelStarted;
 STATIC BOOLEAN  mInsideVarService;
 #endif
 
+/**
+  Snapshot of variable names as presented with BootVariableRedirect,
+  rebuilt at every enumeration start and dropped on SetVariable.
+  Names are referenced by offset to stay valid after virtual address change.
+**/
+#define OC_VARIABLE_SNAPSHOT_ENTRIES    512
+#define OC_VARIABLE_SNAPSHOT_POOL_SIZE  (48 * OC_VARIABLE_NAME_SIZE)
+
+typedef struct {
+  EFI_GUID    Guid;
+  UINT16      NameOffset;
+  UINT16      NameSize;
+  BOOLEAN     BootRedirect;
+} OC_VARIABLE_SNAPSHOT_ENTRY;
+
+STATIC OC_VARIABLE_SNAPSHOT_ENTRY  mVarSnapshot[OC_VARIABLE_SNAPSHOT_ENTRIES];
+STATIC CHAR16                      mVarSnapshotPool[OC_VARIABLE_SNAPSHOT_POOL_SIZE];
+STATIC UINTN                       mVarSnapshotCount;
+STATIC UINTN                       mVarSnapshotPoolUsed;
+STATIC UINTN                       mVarSnapshotCursor;
+STATIC BOOLEAN                     mVarSnapshotValid;
+#ifdef OC_DEBUG_VAR_SERVICE
+STATIC UINT64  mNextVarCalls;
+STATIC UINT64  mNextVarSnapshotHits;
+STATIC UINT64  mNextVarTicks;
+#endif
+
 STATIC
 VOID
 Cr0QuirkPrologue (
@@ -242,6 +269,204 @@ IsOcBootVar (
   return TRUE;
 }
 
+STATIC
+BOOLEAN
+VarSnapshotAdd (
+  IN CONST EFI_GUID  *Guid,
+  IN UINTN           NameOffset,
+  IN UINTN           NameSize,
+  IN BOOLEAN         BootRedirect
+  )
+{
+  OC_VARIABLE_SNAPSHOT_ENTRY  *Entry;
+
+  if (mVarSnapshotCount == OC_VARIABLE_SNAPSHOT_ENTRIES) {
+    return FALSE;
+  }
+
+  Entry = &mVarSnapshot[mVarSnapshotCount];
+  CopyGuid (&Entry->Guid, Guid);
+  Entry->NameOffset   = (UINT16)NameOffset;
+  Entry->NameSize     = (UINT16)NameSize;
+  Entry->BootRedirect = BootRedirect;
+  ++mVarSnapshotCount;
+  return TRUE;
+}
+
+/**
+  Build the variable list as returned by WrapGetNextVariableName with
+  BootVariableRedirect: all variables but EfiBoot ones in firmware order,
+  followed by OC boot variables renamed to EfiBoot ones.
+  The snapshot stays invalid when the variables do not fit.
+**/
+STATIC
+VOID
+VarSnapshotBuild (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+  UINTN       Count;
+  UINTN       Size;
+  CHAR16      TempName[OC_VARIABLE_NAME_SIZE];
+  EFI_GUID    TempGuid;
+
+  mVarSnapshotValid    = FALSE;
+  mVarSnapshotCount    = 0;
+  mVarSnapshotPoolUsed = 0;
+  mVarSnapshotCursor   = 0;
+
+  TempName[0] = L'\0';
+  ZeroMem (&TempGuid, sizeof (TempGuid));
+
+  while (TRUE) {
+    Size   = sizeof (TempName);
+    Status = mStoredGetNextVariableName (&Size, TempName, &TempGuid);
+    if (Status == EFI_NOT_FOUND) {
+      break;
+    }
+
+    if (EFI_ERROR (Status)) {
+      return;
+    }
+
+    if (IsEfiBootVar (TempName, &TempGuid, NULL)) {
+      continue;
+    }
+
+    Size = StrSize (TempName); ///< Not guaranteed to be updated with EFI_SUCCESS.
+    if (Size / sizeof (CHAR16) > OC_VARIABLE_SNAPSHOT_POOL_SIZE - mVarSnapshotPoolUsed) {
+      return;
+    }
+
+    if (!VarSnapshotAdd (&TempGuid, mVarSnapshotPoolUsed, Size, FALSE)) {
+      return;
+    }
+
+    CopyMem (&mVarSnapshotPool[mVarSnapshotPoolUsed], TempName, Size);
+    mVarSnapshotPoolUsed += Size / sizeof (CHAR16);
+  }
+
+  //
+  // Renamed boot variables share the name with the original one, as both
+  // prefixes have the same length.
+  //
+  STATIC_ASSERT (
+    L_STR_LEN (OC_VENDOR_BOOT_VARIABLE_PREFIX) == L_STR_LEN (L"Boot"),
+    "Boot variable prefixes must have the same length"
+    );
+
+  Count = mVarSnapshotCount;
+  for (Index = 0; Index < Count; ++Index) {
+    if (IsOcBootVar (&mVarSnapshotPool[mVarSnapshot[Index].NameOffset], &mVarSnapshot[Index].Guid, NULL)) {
+      if (!VarSnapshotAdd (
+             &gEfiGlobalVariableGuid,
+             mVarSnapshot[Index].NameOffset,
+             mVarSnapshot[Index].NameSize,
+             TRUE
+             ))
+      {
+        return;
+      }
+    }
+  }
+
+  mVarSnapshotValid = TRUE;
+}
+
+STATIC
+BOOLEAN
+VarSnapshotEntryMatches (
+  IN UINTN           Index,
+  IN CONST CHAR16    *VariableName,
+  IN CONST EFI_GUID  *VendorGuid
+  )
+{
+  OC_VARIABLE_SNAPSHOT_ENTRY  *Entry;
+  CONST CHAR16                *Name;
+
+  Entry = &mVarSnapshot[Index];
+  if (!CompareGuid (&Entry->Guid, VendorGuid)) {
+    return FALSE;
+  }
+
+  Name = &mVarSnapshotPool[Entry->NameOffset];
+  if (Entry->BootRedirect) {
+    if (StrnCmp (VariableName, L"Boot", L_STR_LEN (L"Boot")) != 0) {
+      return FALSE;
+    }
+
+    Name         += L_STR_LEN (L"Boot");
+    VariableName += L_STR_LEN (L"Boot");
+  }
+
+  return StrCmp (Name, VariableName) == 0;
+}
+
+/**
+  Return the variable following VariableName from the snapshot.
+
+  @retval EFI_UNSUPPORTED  VariableName is not in the snapshot.
+  @retval other            Status to be returned to the caller.
+**/
+STATIC
+EFI_STATUS
+VarSnapshotGetNext (
+  IN OUT UINTN     *VariableNameSize,
+  IN OUT CHAR16    *VariableName,
+  IN OUT EFI_GUID  *VendorGuid
+  )
+{
+  UINTN                       Index;
+  OC_VARIABLE_SNAPSHOT_ENTRY  *Entry;
+
+  if (VariableName[0] == L'\0') {
+    Index = 0;
+  } else {
+    //
+    // Sequential enumeration passes the entry returned last.
+    //
+    if (  (mVarSnapshotCursor < mVarSnapshotCount)
+       && VarSnapshotEntryMatches (mVarSnapshotCursor, VariableName, VendorGuid))
+    {
+      Index = mVarSnapshotCursor;
+    } else {
+      for (Index = 0; Index < mVarSnapshotCount; ++Index) {
+        if (VarSnapshotEntryMatches (Index, VariableName, VendorGuid)) {
+          break;
+        }
+      }
+
+      if (Index == mVarSnapshotCount) {
+        return EFI_UNSUPPORTED;
+      }
+    }
+
+    ++Index;
+  }
+
+  if (Index == mVarSnapshotCount) {
+    return EFI_NOT_FOUND;
+  }
+
+  Entry = &mVarSnapshot[Index];
+  if (*VariableNameSize < Entry->NameSize) {
+    *VariableNameSize = Entry->NameSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  CopyGuid (VendorGuid, &Entry->Guid);
+  CopyMem (VariableName, &mVarSnapshotPool[Entry->NameOffset], Entry->NameSize);
+  if (Entry->BootRedirect) {
+    CopyMem (VariableName, L"Boot", L_STR_SIZE_NT (L"Boot"));
+  }
+
+  *VariableNameSize  = Entry->NameSize; ///< This is NOT explicitly required by the spec.
+  mVarSnapshotCursor = Index;
+  return EFI_SUCCESS;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -427,8 +652,7 @@ WrapGetVariable (
 
 STATIC
 EFI_STATUS
-EFIAPI
-WrapGetNextVariableName (
+InternalGetNextVariableName (
   IN OUT UINTN     *VariableNameSize,
   IN OUT CHAR16    *VariableName,
   IN OUT EFI_GUID  *VendorGuid
@@ -444,15 +668,6 @@ WrapGetNextVariableName (
   BOOLEAN     Wp;
   BOOLEAN     Ts;
 
- #ifdef OC_DEBUG_VAR_SERVICE
-  if (!mInsideVarService) {
-    mInsideVarService = TRUE;
-    DEBUG ((DEBUG_INFO, "NEXVAR %g:%s (%u/%u)\n", VendorGuid, VariableName, (UINT32)*VariableNameSize));
-    mInsideVarService = FALSE;
-  }
-
- #endif
-
   //
   // Perform initial checks as per spec. Last check is part of:
   // Null-terminator is not found in the first VariableNameSize
@@ -491,6 +706,25 @@ WrapGetNextVariableName (
     return Status;
   }
 
+  //
+  // Serve enumeration from the snapshot, which is built once per enumeration
+  // and avoids walking the firmware variable list for every boot variable.
+  //
+  if (VariableName[0] == L'\0') {
+    VarSnapshotBuild ();
+  }
+
+  if (mVarSnapshotValid) {
+    Status = VarSnapshotGetNext (VariableNameSize, VariableName, VendorGuid);
+    if (Status != EFI_UNSUPPORTED) {
+ #ifdef OC_DEBUG_VAR_SERVICE
+      ++mNextVarSnapshotHits;
+ #endif
+      Cr0QuirkEpilogue (Ints, Wp, Ts);
+      return Status;
+    }
+  }
+
   //
   // Copy vendor and variable name to internal buffer.
   //
@@ -641,6 +875,49 @@ WrapGetNextVariableName (
   return EFI_NOT_FOUND;
 }
 
+STATIC
+EFI_STATUS
+EFIAPI
+WrapGetNextVariableName (
+  IN OUT UINTN     *VariableNameSize,
+  IN OUT CHAR16    *VariableName,
+  IN OUT EFI_GUID  *VendorGuid
+  )
+{
+  EFI_STATUS  Status;
+
+ #ifdef OC_DEBUG_VAR_SERVICE
+  UINT64  StartTsc;
+
+  if (!mInsideVarService) {
+    mInsideVarService = TRUE;
+    DEBUG ((DEBUG_INFO, "NEXVAR %g:%s (%u/%u)\n", VendorGuid, VariableName, (UINT32)*VariableNameSize));
+    if ((VariableName != NULL) && (VariableName[0] == L'\0') && (mNextVarCalls > 0)) {
+      DEBUG ((
+        DEBUG_INFO,
+        "NEXVAR %Lu calls, %Lu from snapshot, %Lu ticks\n",
+        mNextVarCalls,
+        mNextVarSnapshotHits,
+        mNextVarTicks
+        ));
+    }
+
+    mInsideVarService = FALSE;
+  }
+
+  StartTsc = AsmReadTsc ();
+ #endif
+
+  Status = InternalGetNextVariableName (VariableNameSize, VariableName, VendorGuid);
+
+ #ifdef OC_DEBUG_VAR_SERVICE
+  ++mNextVarCalls;
+  mNextVarTicks += AsmReadTsc () - StartTsc;
+ #endif
+
+  return Status;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -730,6 +1007,13 @@ WrapSetVariable (
              Data
              );
 
+  //
+  // Variable list may have changed, continue enumeration without snapshot.
+  //
+  if (!EFI_ERROR (Status)) {
+    mVarSnapshotValid = FALSE;
+  }
+
   Cr0QuirkEpilogue (Ints, Wp, Ts);
 
   return Status;
@@ -27,6 +27,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Variable.h"
 #include "VariableNonVolatile.h"
+#include "VariableIndex.h"
 #include "VariableParsing.h"
 #include "VariableRuntimeCache.h"
 
@@ -148,6 +149,11 @@ UpdateVariableStore (
   FvVolHdr = 0;
   DataPtr  = DataPtrIndex;
 
+  //
+  // Any store update may add a variable header, rebuild the index on next lookup.
+  //
+  VariableIndexInvalidate ();
+
   //
   // Check if the Data is Volatile.
   //
@@ -794,6 +800,11 @@ Reclaim (
   }
 
 Done:
+  //
+  // Variable header offsets change after reclaim.
+  //
+  VariableIndexInvalidate ();
+
   DoneStatus = EFI_SUCCESS;
   if (IsVolatile || mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
     DoneStatus = SynchronizeRuntimeVariableCache (
@@ -2250,6 +2261,7 @@ UpdateVariable (
       // Update the memory copy of Flash region.
       //
       CopyMem ((UINT8 *)mNvVariableCache + mVariableModuleGlobal->NonVolatileLastVariableOffset, (UINT8 *)NextVariable, VarSize);
+      VariableIndexInvalidate ();
     } else {
       //
       // Emulated non-volatile variable mode.
@@ -3807,6 +3819,8 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved  = 0;
   VolatileVariableStore->Reserved1 = 0;
 
+  VariableIndexInvalidate ();
+
   return EFI_SUCCESS;
 }
 
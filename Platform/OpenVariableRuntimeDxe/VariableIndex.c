@@ -0,0 +1,322 @@
+/** @file
+  Hashed (GUID, name) index over the variable stores used to avoid
+  walking every variable header on each lookup.
+
+  Each indexed store keeps an open addressing table of header offsets
+  relative to the first variable header. Offsets stay valid when the
+  store is mapped to virtual addresses or copied to the runtime cache,
+  and the whole table is rebuilt with a single walk after the store
+  contents change.
+
+Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableIndex.h"
+
+#define VARIABLE_INDEX_AMBIGUOUS  BIT31
+
+typedef struct {
+  ///
+  /// Hash of the vendor GUID and variable name.
+  ///
+  UINT32    Hash;
+  ///
+  /// Variable header offset from the first header plus one, 0 for an unused bucket.
+  /// VARIABLE_INDEX_AMBIGUOUS is set when several headers share the same key.
+  ///
+  UINT32    Offset;
+} VARIABLE_INDEX_ENTRY;
+
+typedef struct {
+  UINTN                   StartPtr;
+  UINTN                   EndPtr;
+  UINT32                  Generation;
+  UINT32                  LastUsed;
+  BOOLEAN                 AuthFormat;
+  BOOLEAN                 Usable;
+  VARIABLE_INDEX_ENTRY    Entries[VARIABLE_INDEX_BUCKETS];
+} VARIABLE_INDEX_STORE;
+
+STATIC VARIABLE_INDEX_STORE  mVariableIndex[VARIABLE_INDEX_MAX_STORES];
+STATIC UINT32                mVariableIndexGeneration = 1;
+STATIC UINT32                mVariableIndexTick;
+
+/**
+  Check whether the variable header can be returned by FindVariableEx.
+
+  @param[in] Variable  Pointer to the Variable Header.
+
+  @retval TRUE  Variable is in VAR_ADDED or IN_DELETED_TRANSITION state.
+**/
+STATIC
+BOOLEAN
+VariableIndexIsLive (
+  IN VARIABLE_HEADER  *Variable
+  )
+{
+  return (BOOLEAN)(
+    (Variable->State == VAR_ADDED)
+    || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))
+    );
+}
+
+/**
+  Compute FNV-1a hash of the vendor GUID and variable name.
+
+  @param[in]  VendorGuid    Vendor GUID.
+  @param[in]  VariableName  Variable name.
+  @param[in]  MaxNameSize   Maximum name size in bytes to look at.
+  @param[out] NameSize      Name size in bytes including the terminator,
+                            0 when no terminator is found within MaxNameSize.
+
+  @return Key hash.
+**/
+STATIC
+UINT32
+VariableIndexHash (
+  IN  CONST EFI_GUID  *VendorGuid,
+  IN  CONST CHAR16    *VariableName,
+  IN  UINTN           MaxNameSize,
+  OUT UINTN           *NameSize
+  )
+{
+  CONST UINT8  *Bytes;
+  UINT32       Hash;
+  UINTN        Index;
+  UINTN        MaxLength;
+
+  Hash  = 2166136261U;
+  Bytes = (CONST UINT8 *)VendorGuid;
+  for (Index = 0; Index < sizeof (EFI_GUID); ++Index) {
+    Hash = (Hash ^ Bytes[Index]) * 16777619U;
+  }
+
+  *NameSize = 0;
+  MaxLength = MaxNameSize / sizeof (CHAR16);
+  for (Index = 0; Index < MaxLength; ++Index) {
+    if (VariableName[Index] == L'\0') {
+      *NameSize = (Index + 1) * sizeof (CHAR16);
+      break;
+    }
+
+    Hash = (Hash ^ VariableName[Index]) * 16777619U;
+  }
+
+  return Hash;
+}
+
+/**
+  Check whether the variable header has the requested key.
+
+  @param[in] Variable      Pointer to the Variable Header.
+  @param[in] VendorGuid    Vendor GUID.
+  @param[in] VariableName  Variable name.
+  @param[in] NameSize      Variable name size in bytes including the terminator.
+  @param[in] AuthFormat    TRUE indicates authenticated variables are used.
+
+  @retval TRUE  Key matches.
+**/
+STATIC
+BOOLEAN
+VariableIndexMatches (
+  IN VARIABLE_HEADER  *Variable,
+  IN CONST EFI_GUID   *VendorGuid,
+  IN CONST CHAR16     *VariableName,
+  IN UINTN            NameSize,
+  IN BOOLEAN          AuthFormat
+  )
+{
+  return (BOOLEAN)(
+    (NameSizeOfVariable (Variable, AuthFormat) == NameSize)
+    && CompareGuid (GetVendorGuidPtr (Variable, AuthFormat), VendorGuid)
+    && (CompareMem (GetVariableNamePtr (Variable, AuthFormat), VariableName, NameSize) == 0)
+    );
+}
+
+/**
+  Rebuild variable store index with a single walk over the store.
+  The index is left unusable when the store cannot be fully indexed.
+
+  @param[in,out] Store       Variable store index.
+  @param[in]     StartPtr    Pointer to the first variable header in the store.
+  @param[in]     EndPtr      Pointer to the end of the variable store.
+  @param[in]     AuthFormat  TRUE indicates authenticated variables are used.
+**/
+STATIC
+VOID
+VariableIndexBuild (
+  IN OUT VARIABLE_INDEX_STORE  *Store,
+  IN     VARIABLE_HEADER       *StartPtr,
+  IN     VARIABLE_HEADER       *EndPtr,
+  IN     BOOLEAN               AuthFormat
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *Existing;
+  CHAR16           *VariableName;
+  EFI_GUID         *VendorGuid;
+  UINTN            NameSize;
+  UINTN            HashedNameSize;
+  UINT32           Hash;
+  UINT32           Bucket;
+  UINT32           Count;
+
+  ZeroMem (Store->Entries, sizeof (Store->Entries));
+  Store->StartPtr   = (UINTN)StartPtr;
+  Store->EndPtr     = (UINTN)EndPtr;
+  Store->AuthFormat = AuthFormat;
+  Store->Generation = mVariableIndexGeneration;
+  Store->Usable     = FALSE;
+
+  if (((UINTN)EndPtr < (UINTN)StartPtr) || ((UINTN)EndPtr - (UINTN)StartPtr >= VARIABLE_INDEX_AMBIGUOUS)) {
+    return;
+  }
+
+  Count = 0;
+
+  for ( Variable = StartPtr
+        ; IsValidVariableHeader (Variable, EndPtr)
+        ; Variable = GetNextVariablePtr (Variable, AuthFormat)
+        )
+  {
+    if (!VariableIndexIsLive (Variable)) {
+      continue;
+    }
+
+    if (Count == VARIABLE_INDEX_MAX_ENTRIES) {
+      return;
+    }
+
+    VariableName = GetVariableNamePtr (Variable, AuthFormat);
+    VendorGuid   = GetVendorGuidPtr (Variable, AuthFormat);
+    NameSize     = NameSizeOfVariable (Variable, AuthFormat);
+    if (NameSize > (UINTN)EndPtr - (UINTN)VariableName) {
+      return;
+    }
+
+    //
+    // Names without a terminator exactly at the end are left to the linear walk.
+    //
+    Hash = VariableIndexHash (VendorGuid, VariableName, NameSize, &HashedNameSize);
+    if (HashedNameSize != NameSize) {
+      return;
+    }
+
+    Bucket = Hash & (VARIABLE_INDEX_BUCKETS - 1);
+    while (Store->Entries[Bucket].Offset != 0) {
+      if (Store->Entries[Bucket].Hash == Hash) {
+        Existing = (VARIABLE_HEADER *)(
+                                       (UINTN)StartPtr
+                                       + (Store->Entries[Bucket].Offset & ~VARIABLE_INDEX_AMBIGUOUS) - 1
+                                       );
+        if (VariableIndexMatches (Existing, VendorGuid, VariableName, NameSize, AuthFormat)) {
+          Store->Entries[Bucket].Offset |= VARIABLE_INDEX_AMBIGUOUS;
+          break;
+        }
+      }
+
+      Bucket = (Bucket + 1) & (VARIABLE_INDEX_BUCKETS - 1);
+    }
+
+    if (Store->Entries[Bucket].Offset == 0) {
+      Store->Entries[Bucket].Hash   = Hash;
+      Store->Entries[Bucket].Offset = (UINT32)((UINTN)Variable - (UINTN)StartPtr) + 1;
+      ++Count;
+    }
+  }
+
+  Store->Usable = TRUE;
+}
+
+VOID
+VariableIndexInvalidate (
+  VOID
+  )
+{
+  ++mVariableIndexGeneration;
+  if (mVariableIndexGeneration == 0) {
+    mVariableIndexGeneration = 1;
+  }
+}
+
+EFI_STATUS
+VariableIndexFind (
+  IN  VARIABLE_HEADER  *StartPtr,
+  IN  VARIABLE_HEADER  *EndPtr,
+  IN  CONST CHAR16     *VariableName,
+  IN  CONST EFI_GUID   *VendorGuid,
+  IN  BOOLEAN          AuthFormat,
+  OUT VARIABLE_HEADER  **Variable
+  )
+{
+  VARIABLE_INDEX_STORE  *Store;
+  VARIABLE_INDEX_STORE  *Victim;
+  VARIABLE_HEADER       *Candidate;
+  UINTN                 Index;
+  UINTN                 NameSize;
+  UINT32                Hash;
+  UINT32                Bucket;
+
+  ASSERT (VariableName[0] != L'\0');
+
+  Store  = NULL;
+  Victim = &mVariableIndex[0];
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; ++Index) {
+    if (  (mVariableIndex[Index].StartPtr == (UINTN)StartPtr)
+       && (mVariableIndex[Index].EndPtr == (UINTN)EndPtr)
+       && (mVariableIndex[Index].AuthFormat == AuthFormat))
+    {
+      Store = &mVariableIndex[Index];
+      break;
+    }
+
+    if (mVariableIndex[Index].LastUsed < Victim->LastUsed) {
+      Victim = &mVariableIndex[Index];
+    }
+  }
+
+  if (Store == NULL) {
+    Store = Victim;
+    VariableIndexBuild (Store, StartPtr, EndPtr, AuthFormat);
+  } else if (Store->Generation != mVariableIndexGeneration) {
+    VariableIndexBuild (Store, StartPtr, EndPtr, AuthFormat);
+  }
+
+  Store->LastUsed = ++mVariableIndexTick;
+
+  if (!Store->Usable) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Hash   = VariableIndexHash (VendorGuid, VariableName, MAX_UINTN, &NameSize);
+  Bucket = Hash & (VARIABLE_INDEX_BUCKETS - 1);
+
+  while (Store->Entries[Bucket].Offset != 0) {
+    if (Store->Entries[Bucket].Hash == Hash) {
+      Candidate = (VARIABLE_HEADER *)(
+                                      (UINTN)StartPtr
+                                      + (Store->Entries[Bucket].Offset & ~VARIABLE_INDEX_AMBIGUOUS) - 1
+                                      );
+      if (VariableIndexMatches (Candidate, VendorGuid, VariableName, NameSize, AuthFormat)) {
+        //
+        // Several headers with the same key need IN_DELETED_TRANSITION resolution.
+        // State changes in place are not tracked, so recheck it as well.
+        //
+        if (  ((Store->Entries[Bucket].Offset & VARIABLE_INDEX_AMBIGUOUS) != 0)
+           || !VariableIndexIsLive (Candidate))
+        {
+          return EFI_UNSUPPORTED;
+        }
+
+        *Variable = Candidate;
+        return EFI_SUCCESS;
+      }
+    }
+
+    Bucket = (Bucket + 1) & (VARIABLE_INDEX_BUCKETS - 1);
+  }
+
+  return EFI_NOT_FOUND;
+}
@@ -0,0 +1,72 @@
+/** @file
+  Hashed (GUID, name) index over the variable stores used to avoid
+  walking every variable header on each lookup.
+
+Copyright (c) 2026, Acidanthera. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_INDEX_H_
+#define _VARIABLE_INDEX_H_
+
+#include "VariableParsing.h"
+
+///
+/// Number of variable stores indexed at the same time (volatile, HOB, NV).
+///
+#define VARIABLE_INDEX_MAX_STORES  3
+
+///
+/// Number of hash buckets per variable store, must be a power of two.
+///
+#define VARIABLE_INDEX_BUCKETS  2048
+
+///
+/// Maximum number of live variable headers per indexed store.
+/// Stores with more variables are searched linearly.
+///
+#define VARIABLE_INDEX_MAX_ENTRIES  ((VARIABLE_INDEX_BUCKETS / 4) * 3)
+
+/**
+  Invalidate all variable store indices.
+
+  Must be called whenever a variable header is added to any indexed
+  store, or a store is rewritten (e.g. during reclaim). The indices
+  are rebuilt lazily on the next lookup.
+**/
+VOID
+VariableIndexInvalidate (
+  VOID
+  );
+
+/**
+  Find the variable in the specified variable store by its index.
+
+  The index only answers for variables with exactly one header in
+  VAR_ADDED or IN_DELETED_TRANSITION state, which is the usual case.
+  EFI_VARIABLE_RUNTIME_ACCESS attribute is not checked.
+
+  @param[in]  StartPtr      Pointer to the first variable header in the store.
+  @param[in]  EndPtr        Pointer to the end of the variable store.
+  @param[in]  VariableName  Name of the variable to be found, must not be empty.
+  @param[in]  VendorGuid    Vendor GUID to be found.
+  @param[in]  AuthFormat    TRUE indicates authenticated variables are used.
+                            FALSE indicates authenticated variables are not used.
+  @param[out] Variable      Variable header found.
+
+  @retval EFI_SUCCESS       Variable found successfully.
+  @retval EFI_NOT_FOUND     Variable not found.
+  @retval EFI_UNSUPPORTED   The index cannot answer, the store must be walked.
+**/
+EFI_STATUS
+VariableIndexFind (
+  IN  VARIABLE_HEADER  *StartPtr,
+  IN  VARIABLE_HEADER  *EndPtr,
+  IN  CONST CHAR16     *VariableName,
+  IN  CONST EFI_GUID   *VendorGuid,
+  IN  BOOLEAN          AuthFormat,
+  OUT VARIABLE_HEADER  **Variable
+  );
+
+#endif
@@ -8,6 +8,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "VariableParsing.h"
+#include "VariableIndex.h"
 
 /**
 
@@ -468,11 +469,40 @@ FindVariableEx (
   IN     BOOLEAN                 AuthFormat
   )
 {
+  EFI_STATUS       Status;
   VARIABLE_HEADER  *InDeletedVariable;
+  VARIABLE_HEADER  *Variable;
   VOID             *Point;
 
   PtrTrack->InDeletedTransitionPtr = NULL;
 
+  //
+  // Try the store index first, it answers for the common case of a single header.
+  //
+  if (VariableName[0] != 0) {
+    Status = VariableIndexFind (
+               PtrTrack->StartPtr,
+               PtrTrack->EndPtr,
+               VariableName,
+               VendorGuid,
+               AuthFormat,
+               &Variable
+               );
+    if (Status == EFI_SUCCESS) {
+      if (IgnoreRtCheck || !AtRuntime () || ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) != 0)) {
+        PtrTrack->CurrPtr = Variable;
+        return EFI_SUCCESS;
+      }
+
+      Status = EFI_NOT_FOUND;
+    }
+
+    if (Status == EFI_NOT_FOUND) {
+      PtrTrack->CurrPtr = NULL;
+      return EFI_NOT_FOUND;
+    }
+  }
+
   //
   // Find the variable by walk through HOB, volatile and non-volatile variable store.
   //
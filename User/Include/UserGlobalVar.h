@@ -85,5 +85,6 @@ extern EFI_GUID  gOcVendorVariableGuid;
 extern EFI_GUID  gOcCustomSmbios3TableGuid;
 extern EFI_GUID  gOcCustomSmbiosTableGuid;
 extern EFI_GUID  gOcAudioProtocolGuid;
+extern EFI_GUID  gOcAppleKeyMapChangedEventGroupGuid;
 
 #endif // OC_USER_GLOBAL_VAR_H
@@ -0,0 +1,21 @@
+/** @file
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#ifndef OC_USER_TIMER_H
+#define OC_USER_TIMER_H
+
+#include <Uefi.h>
+
+/**
+  Get current timestamp in microseconds.
+
+  @return  Current timestamp in microseconds.
+**/
+UINT64
+GetCurrentTimestamp (
+  VOID
+  );
+
+#endif // OC_USER_TIMER_H
@@ -197,6 +197,9 @@ EFI_GUID  gOcCustomSmbiosTableGuid = {
 EFI_GUID  gOcAudioProtocolGuid = {
   0x4B228577, 0x6274, 0x4A48, { 0x82, 0xAE, 0x07, 0x13, 0xA1, 0x17, 0x19, 0x87 }
 };
+EFI_GUID  gOcAppleKeyMapChangedEventGroupGuid = {
+  0xA1376417, 0xC94B, 0x4B0B, { 0xA2, 0xA1, 0x9D, 0x35, 0x56, 0xD9, 0xDC, 0xE6 }
+};
 EFI_GUID  gAppleEfiCertificateGuid = {
   0x45E7BC51, 0x913C, 0x42AC, { 0x96, 0xA2, 0x10, 0x71, 0x2F, 0xFB, 0xEB, 0xA7 }
 };
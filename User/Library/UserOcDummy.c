@@ -270,6 +270,28 @@ OcGetNewestFileFromDirectory (
   return EFI_UNSUPPORTED;
 }
 
+EFI_STATUS
+OcGetSortedFilesFromDirectory (
+  IN     EFI_FILE_PROTOCOL  *Directory,
+  IN     CHAR16             *FileNameStartsWith OPTIONAL,
+  OUT EFI_FILE_INFO         ***FileInfos,
+  OUT UINTN                 *FileInfoCount
+  )
+{
+  ASSERT (FALSE);
+
+  return EFI_UNSUPPORTED;
+}
+
+VOID
+OcFreeSortedFilesFromDirectory (
+  IN EFI_FILE_INFO  **FileInfos,
+  IN UINTN          FileInfoCount
+  )
+{
+  ASSERT (FALSE);
+}
+
 VOID
 OcImageLoaderRegisterConfigure (
   IN OC_IMAGE_LOADER_CONFIGURE  Configure  OPTIONAL
@@ -0,0 +1,335 @@
+/** @file
+  Measure OcBlitLib frame rate for full screen transfers at every
+  rotation and check that the image survives a round trip.
+
+  Usage: Blit [seconds per test]
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcBlitLib.h>
+
+#include <UserMemory.h>
+#include <UserTimer.h>
+
+#define DEFAULT_TEST_SECONDS  2
+
+typedef struct {
+  UINT32    Width;
+  UINT32    Height;
+} BLIT_RESOLUTION;
+
+STATIC BLIT_RESOLUTION  mResolutions[] = {
+  { 3840, 2160 },
+  { 5120, 2880 }
+};
+
+STATIC UINT32  mRotations[] = { 0, 90, 180, 270 };
+
+/**
+  Create blit configuration for a frame buffer with 32-pixel scan line padding.
+**/
+STATIC
+OC_BLIT_CONFIGURE *
+CreateConfigure (
+  IN  UINT32                     Width,
+  IN  UINT32                     Height,
+  IN  UINT32                     Rotation,
+  IN  EFI_GRAPHICS_PIXEL_FORMAT  PixelFormat,
+  OUT UINT32                     **FrameBuffer
+  )
+{
+  RETURN_STATUS                         Status;
+  EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  Info;
+  OC_BLIT_CONFIGURE                     *Configure;
+  UINTN                                 ConfigureSize;
+
+  ZeroMem (&Info, sizeof (Info));
+  Info.HorizontalResolution = Width;
+  Info.VerticalResolution   = Height;
+  Info.PixelFormat          = PixelFormat;
+  Info.PixelsPerScanLine    = ALIGN_VALUE (Width, 32);
+
+  *FrameBuffer = AllocateZeroPool ((UINTN)Info.PixelsPerScanLine * Height * sizeof (UINT32));
+  if (*FrameBuffer == NULL) {
+    return NULL;
+  }
+
+  ConfigureSize = 0;
+  Status        = OcBlitConfigure (*FrameBuffer, &Info, Rotation, NULL, &ConfigureSize);
+  if (Status != RETURN_BUFFER_TOO_SMALL) {
+    FreePool (*FrameBuffer);
+    return NULL;
+  }
+
+  Configure = AllocatePool (ConfigureSize);
+  if (Configure == NULL) {
+    FreePool (*FrameBuffer);
+    return NULL;
+  }
+
+  Status = OcBlitConfigure (*FrameBuffer, &Info, Rotation, Configure, &ConfigureSize);
+  if (RETURN_ERROR (Status)) {
+    FreePool (Configure);
+    FreePool (*FrameBuffer);
+    return NULL;
+  }
+
+  return Configure;
+}
+
+/**
+  Render the operation repeatedly for the given time.
+
+  @retval Frames per second multiplied by 10.
+**/
+STATIC
+UINT64
+MeasureFrameRate (
+  IN OC_BLIT_CONFIGURE                  *Configure,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL      *Buffer,
+  IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION  Operation,
+  IN UINTN                              Width,
+  IN UINTN                              Height,
+  IN UINT64                             Duration
+  )
+{
+  UINT64  StartTime;
+  UINT64  Time;
+  UINT64  Frames;
+
+  Frames    = 0;
+  StartTime = GetCurrentTimestamp ();
+  do {
+    OcBlitRender (Configure, Buffer, Operation, 0, 0, 0, 0, Width, Height, 0);
+    ++Frames;
+    Time = GetCurrentTimestamp () - StartTime;
+  } while (Time < Duration);
+
+  return (Frames * 10000000ULL) / Time;
+}
+
+/**
+  Draw an odd sized rectangle into the screen and read it back.
+**/
+STATIC
+BOOLEAN
+CheckRoundTrip (
+  IN OC_BLIT_CONFIGURE              *Configure,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Buffer,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Readback
+  )
+{
+  UINTN   Width;
+  UINTN   Height;
+  UINTN   Delta;
+  UINTN   Index;
+  UINT32  *Pixels;
+
+  Width  = Configure->RotatedWidth - 37;
+  Height = Configure->RotatedHeight - 21;
+  Delta  = Configure->RotatedWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+
+  Pixels = (UINT32 *)Buffer;
+  for (Index = 0; Index < (UINTN)Configure->RotatedWidth * Configure->RotatedHeight; ++Index) {
+    Pixels[Index] = (UINT32)(Index * 2654435761U) & 0x00FFFFFFU;
+  }
+
+  ZeroMem (Readback, (UINTN)Configure->RotatedWidth * Configure->RotatedHeight * sizeof (*Readback));
+
+  OcBlitRender (Configure, Buffer, EfiBltBufferToVideo, 3, 5, 11, 7, Width, Height, Delta);
+  OcBlitRender (Configure, Readback, EfiBltVideoToBltBuffer, 11, 7, 3, 5, Width, Height, Delta);
+
+  for (Index = 0; Index < Height; ++Index) {
+    if (CompareMem (
+          &Buffer[(Index + 5) * Configure->RotatedWidth + 3],
+          &Readback[(Index + 5) * Configure->RotatedWidth + 3],
+          Width * sizeof (*Buffer)
+          ) != 0)
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  EFI_GRAPHICS_PIXEL_FORMAT      PixelFormat;
+  OC_BLIT_CONFIGURE              *Configure;
+  UINT32                         *FrameBuffer;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Buffer;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Readback;
+  UINTN                          Size;
+  UINTN                          ResolutionIndex;
+  UINTN                          RotationIndex;
+  UINT64                         Duration;
+  UINT64                         ToVideo;
+  UINT64                         ToBuffer;
+  BOOLEAN                        Valid;
+  int                            Result;
+
+  Duration = DEFAULT_TEST_SECONDS;
+  if (argc > 1) {
+    Duration = strtoul (argv[1], NULL, 0);
+    if (Duration == 0) {
+      DEBUG ((DEBUG_ERROR, "Usage: %a [seconds per test]\n", argv[0]));
+      return -1;
+    }
+  }
+
+  Duration *= 1000000ULL;
+  Result    = 0;
+
+  for (ResolutionIndex = 0; ResolutionIndex < ARRAY_SIZE (mResolutions); ++ResolutionIndex) {
+    Size     = (UINTN)mResolutions[ResolutionIndex].Width * mResolutions[ResolutionIndex].Height * sizeof (*Buffer);
+    Buffer   = AllocateZeroPool (Size);
+    Readback = AllocateZeroPool (Size);
+    if ((Buffer == NULL) || (Readback == NULL)) {
+      DEBUG ((DEBUG_ERROR, "Buffer allocation failed\n"));
+      return -1;
+    }
+
+    for (RotationIndex = 0; RotationIndex < ARRAY_SIZE (mRotations); ++RotationIndex) {
+      for (PixelFormat = PixelRedGreenBlueReserved8BitPerColor; PixelFormat <= PixelBlueGreenRedReserved8BitPerColor; ++PixelFormat) {
+        Configure = CreateConfigure (
+                      mResolutions[ResolutionIndex].Width,
+                      mResolutions[ResolutionIndex].Height,
+                      mRotations[RotationIndex],
+                      PixelFormat,
+                      &FrameBuffer
+                      );
+        if (Configure == NULL) {
+          DEBUG ((DEBUG_ERROR, "Blit configuration failed\n"));
+          return -1;
+        }
+
+        Valid = CheckRoundTrip (Configure, Buffer, Readback);
+        if (!Valid) {
+          Result = -1;
+        }
+
+        ToVideo = MeasureFrameRate (
+                    Configure,
+                    Buffer,
+                    EfiBltBufferToVideo,
+                    Configure->RotatedWidth,
+                    Configure->RotatedHeight,
+                    Duration
+                    );
+        ToBuffer = MeasureFrameRate (
+                     Configure,
+                     Readback,
+                     EfiBltVideoToBltBuffer,
+                     Configure->RotatedWidth,
+                     Configure->RotatedHeight,
+                     Duration
+                     );
+
+        DEBUG ((
+          DEBUG_ERROR,
+          "%ux%u %a rotation %3u - buffer to video %Lu.%Lu FPS, video to buffer %Lu.%Lu FPS, round trip %a\n",
+          mResolutions[ResolutionIndex].Width,
+          mResolutions[ResolutionIndex].Height,
+          PixelFormat == PixelBlueGreenRedReserved8BitPerColor ? "BGR" : "RGB",
+          mRotations[RotationIndex],
+          ToVideo / 10,
+          ToVideo % 10,
+          ToBuffer / 10,
+          ToBuffer % 10,
+          Valid ? "OK" : "FAILED"
+          ));
+
+        FreePool (Configure);
+        FreePool (FrameBuffer);
+      }
+    }
+
+    FreePool (Buffer);
+    FreePool (Readback);
+  }
+
+  return Result;
+}
+
+int
+LLVMFuzzerTestOneInput (
+  const uint8_t  *Data,
+  size_t         Size
+  )
+{
+  STATIC OC_BLIT_CONFIGURE              *Configure[ARRAY_SIZE (mRotations)];
+  STATIC UINT32                         *FrameBuffer[ARRAY_SIZE (mRotations)];
+  STATIC EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Buffer[64 * 48];
+  OC_BLIT_CONFIGURE                     *Current;
+  UINTN                                 Index;
+  UINTN                                 Coordinates[6];
+
+  //
+  // Rotation followed by source, destination and size for each rectangle.
+  //
+  if (Configure[0] == NULL) {
+    for (Index = 0; Index < ARRAY_SIZE (mRotations); ++Index) {
+      Configure[Index] = CreateConfigure (48, 64, mRotations[Index], PixelRedGreenBlueReserved8BitPerColor, &FrameBuffer[Index]);
+      if (Configure[Index] == NULL) {
+        abort ();
+      }
+    }
+  }
+
+  while (Size >= 1 + ARRAY_SIZE (Coordinates)) {
+    Current = Configure[Data[0] % ARRAY_SIZE (mRotations)];
+    for (Index = 0; Index < ARRAY_SIZE (Coordinates); ++Index) {
+      Coordinates[Index] = Data[1 + Index] % 64;
+    }
+
+    Data += 1 + ARRAY_SIZE (Coordinates);
+    Size -= 1 + ARRAY_SIZE (Coordinates);
+
+    //
+    // Screen rectangles are validated by OcBlitRender, buffer ones are up to the caller.
+    //
+    if ((Coordinates[0] + Coordinates[4] > 48) || (Coordinates[1] + Coordinates[5] > 64)) {
+      continue;
+    }
+
+    OcBlitRender (
+      Current,
+      Buffer,
+      EfiBltBufferToVideo,
+      Coordinates[0],
+      Coordinates[1],
+      Coordinates[2],
+      Coordinates[3],
+      Coordinates[4],
+      Coordinates[5],
+      48 * sizeof (*Buffer)
+      );
+    OcBlitRender (
+      Current,
+      Buffer,
+      EfiBltVideoToBltBuffer,
+      Coordinates[2],
+      Coordinates[3],
+      Coordinates[0],
+      Coordinates[1],
+      Coordinates[4],
+      Coordinates[5],
+      48 * sizeof (*Buffer)
+      );
+  }
+
+  return 0;
+}
@@ -0,0 +1,457 @@
+/** @file
+  Check OcCompressionLib LZSS and LZVN decoders against the reference
+  scalar decoders and measure their throughput on compressed kernels.
+
+  Usage: Compression [kernelcache...]
+
+  Without arguments synthetic LZSS data is used.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Uefi.h>
+
+#include <IndustryStandard/AppleCompressedBinaryImage.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcCompressionLib.h>
+
+#include <UserFile.h>
+#include <UserTimer.h>
+
+#define BENCHMARK_ROUNDS    10
+#define SYNTHETIC_SIZE      (16 * 1024 * 1024)
+#define FUZZ_MAX_OUT_SIZE   (256 * 1024)
+
+#define LZSS_N          4096
+#define LZSS_F          18
+#define LZSS_THRESHOLD  2
+
+typedef
+UINTN
+(*DECOMPRESS_FUNC) (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen,
+  IN  UINT8  *Src,
+  IN  UINTN  SrcLen
+  );
+
+UINTN
+DecompressLZVNReference (
+  OUT UINT8        *Dst,
+  IN  UINTN        DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINTN        SrcLen
+  );
+
+/**
+  Original ring buffer LZSS decoder. The whole ring is initialised with
+  spaces, so that streams referencing bytes never written decode the same
+  way as with the output buffer based decoder.
+**/
+STATIC
+UINT32
+DecompressLZSSReference (
+  OUT UINT8   *Dst,
+  IN  UINT32  DstLen,
+  IN  UINT8   *Src,
+  IN  UINT32  SrcLen
+  )
+{
+  UINT8        TextBuf[LZSS_N + LZSS_F - 1];
+  UINT8        *DstStart;
+  CONST UINT8  *DstEnd;
+  CONST UINT8  *SrcEnd;
+  INT32        I;
+  INT32        J;
+  INT32        K;
+  INT32        R;
+  UINT8        C;
+  UINT32       Flags;
+
+  DstStart = Dst;
+  DstEnd   = Dst + DstLen;
+  SrcEnd   = Src + SrcLen;
+
+  SetMem (TextBuf, sizeof (TextBuf), ' ');
+  R     = LZSS_N - LZSS_F;
+  Flags = 0;
+  while (TRUE) {
+    if (((Flags >>= 1) & 0x100) == 0) {
+      if (Src >= SrcEnd) {
+        break;
+      }
+
+      C     = *Src++;
+      Flags = C | 0xFF00;
+    }
+
+    if ((Flags & 1) != 0) {
+      if ((Src >= SrcEnd) || (Dst >= DstEnd)) {
+        break;
+      }
+
+      C          = *Src++;
+      *Dst++     = C;
+      TextBuf[R] = C;
+      R          = (R + 1) & (LZSS_N - 1);
+    } else {
+      if (SrcEnd - Src < 2) {
+        break;
+      }
+
+      I    = *Src++;
+      J    = *Src++;
+      I   |= (J & 0xF0) << 4;
+      J    = (J & 0x0F) + LZSS_THRESHOLD;
+      for (K = 0; K <= J; K++) {
+        C = TextBuf[(I + K) & (LZSS_N - 1)];
+        if (Dst >= DstEnd) {
+          break;
+        }
+
+        *Dst++     = C;
+        TextBuf[R] = C;
+        R          = (R + 1) & (LZSS_N - 1);
+      }
+    }
+  }
+
+  return (UINT32)(Dst - DstStart);
+}
+
+STATIC
+UINTN
+DecompressLZSSFast (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen,
+  IN  UINT8  *Src,
+  IN  UINTN  SrcLen
+  )
+{
+  return DecompressLZSS (Dst, (UINT32)DstLen, Src, (UINT32)SrcLen);
+}
+
+STATIC
+UINTN
+DecompressLZSSSlow (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen,
+  IN  UINT8  *Src,
+  IN  UINTN  SrcLen
+  )
+{
+  return DecompressLZSSReference (Dst, (UINT32)DstLen, Src, (UINT32)SrcLen);
+}
+
+STATIC
+UINTN
+DecompressLZVNFast (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen,
+  IN  UINT8  *Src,
+  IN  UINTN  SrcLen
+  )
+{
+  return DecompressLZVN (Dst, DstLen, Src, SrcLen);
+}
+
+STATIC
+UINTN
+DecompressLZVNSlow (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen,
+  IN  UINT8  *Src,
+  IN  UINTN  SrcLen
+  )
+{
+  return DecompressLZVNReference (Dst, DstLen, Src, SrcLen);
+}
+
+/**
+  Decompress the stream repeatedly and report the best round.
+
+  @retval Throughput in megabytes of decompressed data per second.
+**/
+STATIC
+UINT64
+MeasureThroughput (
+  IN  DECOMPRESS_FUNC  Decompress,
+  OUT UINT8            *Dst,
+  IN  UINTN            DstLen,
+  IN  UINT8            *Src,
+  IN  UINTN            SrcLen,
+  OUT UINTN            *Result
+  )
+{
+  UINTN   Index;
+  UINT64  StartTime;
+  UINT64  Time;
+  UINT64  BestTime;
+
+  BestTime = MAX_UINT64;
+  for (Index = 0; Index < BENCHMARK_ROUNDS; ++Index) {
+    StartTime = GetCurrentTimestamp ();
+    *Result   = Decompress (Dst, DstLen, Src, SrcLen);
+    Time      = GetCurrentTimestamp () - StartTime;
+    BestTime  = MIN (BestTime, MAX (Time, 1));
+  }
+
+  return DstLen / BestTime;
+}
+
+/**
+  Benchmark fast and reference decoders on the stream and check that
+  they produce the same result.
+**/
+STATIC
+BOOLEAN
+BenchmarkStream (
+  IN CONST CHAR8  *Name,
+  IN BOOLEAN      IsLzvn,
+  IN UINT8        *Src,
+  IN UINTN        SrcLen,
+  IN UINTN        DstLen
+  )
+{
+  UINT8    *Fast;
+  UINT8    *Slow;
+  UINTN    FastSize;
+  UINTN    SlowSize;
+  UINT64   FastRate;
+  UINT64   SlowRate;
+  BOOLEAN  Valid;
+
+  Fast = AllocatePool (DstLen);
+  Slow = AllocatePool (DstLen);
+  if ((Fast == NULL) || (Slow == NULL)) {
+    DEBUG ((DEBUG_ERROR, "Buffer allocation failed\n"));
+    abort ();
+  }
+
+  FastRate = MeasureThroughput (IsLzvn ? DecompressLZVNFast : DecompressLZSSFast, Fast, DstLen, Src, SrcLen, &FastSize);
+  SlowRate = MeasureThroughput (IsLzvn ? DecompressLZVNSlow : DecompressLZSSSlow, Slow, DstLen, Src, SrcLen, &SlowSize);
+  Valid    = FastSize == DstLen && SlowSize == DstLen && CompareMem (Fast, Slow, DstLen) == 0;
+
+  DEBUG ((
+    DEBUG_ERROR,
+    "%a %a %u -> %u bytes - fast %Lu MB/s, reference %Lu MB/s, result %a\n",
+    Name,
+    IsLzvn ? "LZVN" : "LZSS",
+    (UINT32)SrcLen,
+    (UINT32)DstLen,
+    FastRate,
+    SlowRate,
+    Valid ? "OK" : "FAILED"
+    ));
+
+  FreePool (Fast);
+  FreePool (Slow);
+  return Valid;
+}
+
+/**
+  Benchmark a compressed kernel image with comp header.
+**/
+STATIC
+BOOLEAN
+BenchmarkKernel (
+  IN CONST CHAR8  *FileName
+  )
+{
+  UINT8             *Buffer;
+  UINT32            Size;
+  MACH_COMP_HEADER  *CompHeader;
+  UINT32            CompressedSize;
+  UINT32            DecompressedSize;
+  BOOLEAN           Valid;
+
+  Buffer = UserReadFile (FileName, &Size);
+  if (Buffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a read fail\n", FileName));
+    return FALSE;
+  }
+
+  CompHeader = (MACH_COMP_HEADER *)Buffer;
+  if (  (Size < sizeof (*CompHeader))
+     || (CompHeader->Signature != MACH_COMPRESSED_BINARY_INVERT_SIGNATURE)
+     || (  (CompHeader->Compression != MACH_COMPRESSED_BINARY_INVERT_LZVN)
+        && (CompHeader->Compression != MACH_COMPRESSED_BINARY_INVERT_LZSS)))
+  {
+    DEBUG ((DEBUG_ERROR, "%a is not a compressed kernel\n", FileName));
+    FreePool (Buffer);
+    return FALSE;
+  }
+
+  CompressedSize   = SwapBytes32 (CompHeader->Compressed);
+  DecompressedSize = SwapBytes32 (CompHeader->Decompressed);
+  if (  (CompressedSize > Size - sizeof (*CompHeader))
+     || (DecompressedSize == 0)
+     || (DecompressedSize > OC_COMPRESSION_MAX_LENGTH))
+  {
+    DEBUG ((DEBUG_ERROR, "%a has invalid comp %u or decomp %u\n", FileName, CompressedSize, DecompressedSize));
+    FreePool (Buffer);
+    return FALSE;
+  }
+
+  Valid = BenchmarkStream (
+            FileName,
+            CompHeader->Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN,
+            Buffer + sizeof (*CompHeader),
+            CompressedSize,
+            DecompressedSize
+            );
+
+  FreePool (Buffer);
+  return Valid;
+}
+
+/**
+  Benchmark LZSS on repetitive data with mixed match distances.
+**/
+STATIC
+BOOLEAN
+BenchmarkSynthetic (
+  VOID
+  )
+{
+  UINT8    *Plain;
+  UINT8    *Compressed;
+  UINT8    *CompressedEnd;
+  UINT32   Index;
+  UINT32   Seed;
+  UINT32   Distance;
+  UINT32   Length;
+  BOOLEAN  Valid;
+
+  Plain      = AllocatePool (SYNTHETIC_SIZE);
+  Compressed = AllocatePool (SYNTHETIC_SIZE * 2);
+  if ((Plain == NULL) || (Compressed == NULL)) {
+    DEBUG ((DEBUG_ERROR, "Buffer allocation failed\n"));
+    abort ();
+  }
+
+  //
+  // Random literals mixed with repeats of 3 to 18 bytes at any distance
+  // within the window.
+  //
+  Seed  = 1;
+  Index = 0;
+  while (Index < SYNTHETIC_SIZE) {
+    Seed = Seed * 1103515245U + 12345U;
+    if ((Index < LZSS_N) || (((Seed >> 16) & 7) == 0)) {
+      Plain[Index++] = (UINT8)(Seed >> 24);
+      continue;
+    }
+
+    Distance = 1 + (Seed >> 4) % (LZSS_N - 1);
+    Length   = MIN (LZSS_THRESHOLD + 1 + (Seed >> 28), SYNTHETIC_SIZE - Index);
+    while (Length-- > 0) {
+      Plain[Index] = Plain[Index - Distance];
+      ++Index;
+    }
+  }
+
+  CompressedEnd = CompressLZSS (Compressed, SYNTHETIC_SIZE * 2, Plain, SYNTHETIC_SIZE);
+  if (CompressedEnd == NULL) {
+    DEBUG ((DEBUG_ERROR, "Synthetic data compression failed\n"));
+    abort ();
+  }
+
+  Valid = BenchmarkStream ("synthetic", FALSE, Compressed, CompressedEnd - Compressed, SYNTHETIC_SIZE);
+
+  FreePool (Plain);
+  FreePool (Compressed);
+  return Valid;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  int  Index;
+  int  Result;
+
+  Result = 0;
+
+  if (argc < 2) {
+    return BenchmarkSynthetic () ? 0 : -1;
+  }
+
+  for (Index = 1; Index < argc; ++Index) {
+    if (!BenchmarkKernel (argv[Index])) {
+      Result = -1;
+    }
+  }
+
+  return Result;
+}
+
+int
+LLVMFuzzerTestOneInput (
+  const uint8_t  *Data,
+  size_t         Size
+  )
+{
+  STATIC UINT8  *Fast;
+  STATIC UINT8  *Slow;
+  STATIC UINT8  *Compressed;
+  UINT8         *CompressedEnd;
+  UINTN         DstLen;
+  UINTN         FastSize;
+  UINTN         SlowSize;
+
+  //
+  // Output size followed by the stream, which is also compressed
+  // and decompressed as LZSS.
+  //
+  if (Size < 2) {
+    return 0;
+  }
+
+  if (Fast == NULL) {
+    Fast       = AllocatePool (FUZZ_MAX_OUT_SIZE);
+    Slow       = AllocatePool (FUZZ_MAX_OUT_SIZE);
+    Compressed = AllocatePool (FUZZ_MAX_OUT_SIZE * 2);
+    if ((Fast == NULL) || (Slow == NULL) || (Compressed == NULL)) {
+      abort ();
+    }
+  }
+
+  DstLen = ((Data[0] << 8) | Data[1]) * 4;
+  Data  += 2;
+  Size  -= 2;
+
+  FastSize = DecompressLZVN (Fast, DstLen, (UINT8 *)Data, Size);
+  SlowSize = DecompressLZVNReference (Slow, DstLen, (UINT8 *)Data, Size);
+  if ((FastSize != SlowSize) || (CompareMem (Fast, Slow, FastSize) != 0)) {
+    abort ();
+  }
+
+  FastSize = DecompressLZSS (Fast, (UINT32)DstLen, (UINT8 *)Data, (UINT32)Size);
+  SlowSize = DecompressLZSSReference (Slow, (UINT32)DstLen, (UINT8 *)Data, (UINT32)Size);
+  if ((FastSize != SlowSize) || (CompareMem (Fast, Slow, FastSize) != 0)) {
+    abort ();
+  }
+
+  if (Size <= FUZZ_MAX_OUT_SIZE) {
+    CompressedEnd = CompressLZSS (Compressed, FUZZ_MAX_OUT_SIZE * 2, (UINT8 *)Data, (UINT32)Size);
+    if (CompressedEnd != NULL) {
+      FastSize = DecompressLZSS (Fast, (UINT32)Size, Compressed, (UINT32)(CompressedEnd - Compressed));
+      if ((FastSize != Size) || (CompareMem (Fast, Data, Size) != 0)) {
+        abort ();
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,351 @@
+/** @file
+  Check OcConfigurationLib incremental reload and binary snapshots
+  against full plist parsing.
+
+  Usage: Config <config.plist>
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdlib.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcConfigurationLib.h>
+
+#include <UserFile.h>
+
+typedef struct {
+  UINT32    Count;
+  CHAR8     Path[OC_SERIALIZE_PATH_MAX];
+} REPORT_CONTEXT;
+
+STATIC
+VOID
+ReportPath (
+  IN  VOID         *Context  OPTIONAL,
+  IN  CONST CHAR8  *Path
+  )
+{
+  REPORT_CONTEXT  *Report;
+
+  Report = Context;
+  ++Report->Count;
+  AsciiStrCpyS (Report->Path, sizeof (Report->Path), Path);
+  DEBUG ((DEBUG_ERROR, "Changed %a\n", Path));
+}
+
+STATIC
+XML_NODE *
+GetDictValue (
+  IN XML_NODE     *Dict,
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32       Index;
+  CONST CHAR8  *Key;
+  XML_NODE     *Value;
+
+  if (Dict == NULL) {
+    return NULL;
+  }
+
+  for (Index = 0; Index < PlistDictChildren (Dict); ++Index) {
+    Key = PlistKeyValue (PlistDictChild (Dict, Index, &Value));
+    if ((Key != NULL) && (AsciiStrCmp (Key, Name) == 0)) {
+      return PlistNodeCast (Value, PLIST_NODE_TYPE_ANY);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Parse configuration from scratch and export its snapshot.
+**/
+STATIC
+VOID *
+ExportFullSnapshot (
+  IN  CONST VOID  *Buffer,
+  IN  UINT32      Size,
+  OUT UINT32      *SnapshotSize
+  )
+{
+  OC_GLOBAL_CONFIG  Config;
+  EFI_STATUS        Status;
+  VOID              *Copy;
+  VOID              *Snapshot;
+
+  Copy = AllocateCopyPool (Size, Buffer);
+  if (Copy == NULL) {
+    return NULL;
+  }
+
+  Status = OcConfigurationInit (&Config, Copy, Size, NULL);
+  FreePool (Copy);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Snapshot = OcConfigurationExportSnapshot (&Config, SnapshotSize);
+  OcConfigurationFree (&Config);
+  return Snapshot;
+}
+
+/**
+  Import snapshot, export it again and compare the results.
+**/
+STATIC
+BOOLEAN
+CheckSnapshotRoundTrip (
+  IN CONST VOID  *Snapshot,
+  IN UINT32      SnapshotSize
+  )
+{
+  OC_GLOBAL_CONFIG  Config;
+  EFI_STATUS        Status;
+  VOID              *NewSnapshot;
+  UINT32            NewSnapshotSize;
+  BOOLEAN           Result;
+
+  Status = OcConfigurationInitFromSnapshot (&Config, Snapshot, SnapshotSize);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  NewSnapshot = OcConfigurationExportSnapshot (&Config, &NewSnapshotSize);
+  OcConfigurationFree (&Config);
+  if (NewSnapshot == NULL) {
+    return FALSE;
+  }
+
+  Result = (NewSnapshotSize == SnapshotSize) && (CompareMem (NewSnapshot, Snapshot, SnapshotSize) == 0);
+  FreePool (NewSnapshot);
+  return Result;
+}
+
+/**
+  Reload configuration from First and then from Second, and compare
+  the result with parsing Second from scratch.
+**/
+STATIC
+BOOLEAN
+CheckReload (
+  IN  CONST VOID      *First,
+  IN  UINT32          FirstSize,
+  IN  CONST VOID      *Second,
+  IN  UINT32          SecondSize,
+  OUT UINT32          *ChangedSections,
+  IN  REPORT_CONTEXT  *Report  OPTIONAL
+  )
+{
+  OC_GLOBAL_CONFIG  Config;
+  XML_DOCUMENT      *Document;
+  EFI_STATUS        Status;
+  VOID              *FirstCopy;
+  VOID              *SecondCopy;
+  VOID              *Snapshot;
+  VOID              *FullSnapshot;
+  UINT32            SnapshotSize;
+  UINT32            FullSnapshotSize;
+  BOOLEAN           Result;
+
+  FullSnapshot = ExportFullSnapshot (Second, SecondSize, &FullSnapshotSize);
+  if (FullSnapshot == NULL) {
+    return FALSE;
+  }
+
+  FirstCopy  = AllocateCopyPool (FirstSize, First);
+  SecondCopy = AllocateCopyPool (SecondSize, Second);
+  if ((FirstCopy == NULL) || (SecondCopy == NULL)) {
+    abort ();
+  }
+
+  Result   = FALSE;
+  Document = NULL;
+  Status   = OcConfigurationReload (&Config, FirstCopy, FirstSize, &Document, NULL, NULL, NULL, NULL);
+  if (!EFI_ERROR (Status)) {
+    Status = OcConfigurationReload (
+               &Config,
+               SecondCopy,
+               SecondSize,
+               &Document,
+               ChangedSections,
+               Report != NULL ? ReportPath : NULL,
+               Report,
+               NULL
+               );
+    if (!EFI_ERROR (Status)) {
+      Snapshot = OcConfigurationExportSnapshot (&Config, &SnapshotSize);
+      if (Snapshot != NULL) {
+        Result = (SnapshotSize == FullSnapshotSize) && (CompareMem (Snapshot, FullSnapshot, SnapshotSize) == 0);
+        FreePool (Snapshot);
+      }
+    }
+
+    OcConfigurationFree (&Config);
+    XmlDocumentFree (Document);
+  }
+
+  FreePool (FirstCopy);
+  FreePool (SecondCopy);
+  FreePool (FullSnapshot);
+  return Result;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  UINT8           *ConfigBuffer;
+  UINT32          ConfigSize;
+  XML_DOCUMENT    *Document;
+  XML_NODE        *Timeout;
+  CHAR8           *Original;
+  CHAR8           *Modified;
+  UINT32          OriginalSize;
+  UINT32          ModifiedSize;
+  VOID            *Snapshot;
+  UINT32          SnapshotSize;
+  UINT32          Changed;
+  REPORT_CONTEXT  Report;
+  int             Result;
+
+  if (argc < 2) {
+    DEBUG ((DEBUG_ERROR, "Usage: %a <config.plist>\n", argv[0]));
+    return -1;
+  }
+
+  ConfigBuffer = UserReadFile (argv[1], &ConfigSize);
+  if (ConfigBuffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to read %a\n", argv[1]));
+    return -1;
+  }
+
+  Result = 0;
+
+  //
+  // Snapshot must import back to the same configuration and reject damage.
+  //
+  Snapshot = ExportFullSnapshot (ConfigBuffer, ConfigSize, &SnapshotSize);
+  if (Snapshot == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to export snapshot\n"));
+    return -1;
+  }
+
+  if (!CheckSnapshotRoundTrip (Snapshot, SnapshotSize)) {
+    DEBUG ((DEBUG_ERROR, "Snapshot round trip FAILED\n"));
+    Result = -1;
+  }
+
+  if (CheckSnapshotRoundTrip (Snapshot, SnapshotSize - 1)) {
+    DEBUG ((DEBUG_ERROR, "Truncated snapshot accepted\n"));
+    Result = -1;
+  }
+
+  DEBUG ((DEBUG_ERROR, "Snapshot of %u bytes plist is %u bytes\n", ConfigSize, SnapshotSize));
+  FreePool (Snapshot);
+
+  //
+  // Change Misc/Boot/Timeout and check that only Misc is reparsed.
+  //
+  Document = XmlDocumentParse ((CHAR8 *)ConfigBuffer, ConfigSize, FALSE);
+  if (Document == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to parse %a\n", argv[1]));
+    return -1;
+  }
+
+  Original = XmlDocumentExport (Document, &OriginalSize, 0, TRUE);
+  Timeout  = GetDictValue (
+               GetDictValue (
+                 GetDictValue (PlistNodeCast (PlistDocumentRoot (Document), PLIST_NODE_TYPE_DICT), "Misc"),
+                 "Boot"
+                 ),
+               "Timeout"
+               );
+  if ((Original == NULL) || (Timeout == NULL)) {
+    DEBUG ((DEBUG_ERROR, "Missing Misc/Boot/Timeout\n"));
+    return -1;
+  }
+
+  XmlNodeChangeContent (Timeout, AsciiStrCmp (XmlNodeContent (Timeout), "7") == 0 ? "8" : "7");
+  Modified = XmlDocumentExport (Document, &ModifiedSize, 0, TRUE);
+  XmlDocumentFree (Document);
+  if (Modified == NULL) {
+    return -1;
+  }
+
+  ZeroMem (&Report, sizeof (Report));
+  if (  !CheckReload (Original, OriginalSize, Modified, ModifiedSize, &Changed, &Report)
+     || (Changed != OC_CONFIG_SECTION_MISC)
+     || (Report.Count != 1)
+     || (AsciiStrCmp (Report.Path, "Misc/Boot/Timeout") != 0))
+  {
+    DEBUG ((DEBUG_ERROR, "Reload of changed value FAILED with %X sections\n", Changed));
+    Result = -1;
+  }
+
+  if (  !CheckReload (Modified, ModifiedSize, Modified, ModifiedSize, &Changed, NULL)
+     || (Changed != 0))
+  {
+    DEBUG ((DEBUG_ERROR, "Reload of unchanged config FAILED with %X sections\n", Changed));
+    Result = -1;
+  }
+
+  DEBUG ((DEBUG_ERROR, "Incremental reload and snapshot checks %a\n", Result == 0 ? "OK" : "FAILED"));
+
+  FreePool (Original);
+  FreePool (Modified);
+  FreePool (ConfigBuffer);
+
+  return Result;
+}
+
+int
+LLVMFuzzerTestOneInput (
+  const uint8_t  *Data,
+  size_t         Size
+  )
+{
+  UINT32  FirstSize;
+  UINT32  Changed;
+  VOID    *Snapshot;
+  UINT32  SnapshotSize;
+
+  if ((Size < 2) || (Size > MAX_UINT32)) {
+    return 0;
+  }
+
+  //
+  // Reloading the second half over the first one must match parsing it from scratch.
+  //
+  FirstSize = (UINT32)Size / 2;
+  Snapshot  = ExportFullSnapshot (Data + FirstSize, (UINT32)Size - FirstSize, &SnapshotSize);
+  if (Snapshot == NULL) {
+    return 0;
+  }
+
+  if (!CheckSnapshotRoundTrip (Snapshot, SnapshotSize)) {
+    abort ();
+  }
+
+  FreePool (Snapshot);
+
+  Snapshot = ExportFullSnapshot (Data, FirstSize, &SnapshotSize);
+  if (Snapshot == NULL) {
+    return 0;
+  }
+
+  FreePool (Snapshot);
+
+  if (!CheckReload (Data, FirstSize, Data + FirstSize, (UINT32)Size - FirstSize, &Changed, NULL)) {
+    abort ();
+  }
+
+  return 0;
+}
@@ -0,0 +1,446 @@
+/** @file
+  Check OcMiscLib MatchPattern, FindPattern and ApplyPatch against the
+  previous bytewise implementation.
+
+  Usage: DataPatch [rounds]
+
+  Each round builds a random case from a byte stream, as the fuzzer does,
+  with optional pattern and replace masks, Count, Skip, Limit and data and
+  pattern buffers at unaligned addresses ending at their allocation end.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcMiscLib.h>
+
+#include <UserPseudoRandom.h>
+
+#define DEFAULT_ROUNDS       1000000
+#define PATTERN_SIZE_MAX     40
+#define DATA_SIZE_MAX        512
+#define CASE_HEADER_SIZE     9
+#define CASE_SIZE_MAX        (CASE_HEADER_SIZE + 4 * PATTERN_SIZE_MAX + DATA_SIZE_MAX)
+#define PLANTED_MATCHES_MAX  3
+
+//
+// Case header flags.
+//
+#define CASE_PATTERN_MASK     BIT0
+#define CASE_REPLACE_MASK     BIT1
+#define CASE_LIMIT            BIT2
+#define CASE_MASKED_OUT       BIT3
+#define CASE_PATTERN_IN_MASK  BIT4
+#define CASE_ALPHABET_SHIFT   5
+
+/**
+  Original bytewise FindPattern without the DataSize check.
+**/
+STATIC
+BOOLEAN
+ReferenceFindPatternInternal (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize,
+  IN OUT UINT32    *DataOff
+  )
+{
+  UINT32  Index;
+  UINT32  LastOffset;
+  UINT32  CurrentOffset;
+
+  if (PatternSize == 0) {
+    return FALSE;
+  }
+
+  CurrentOffset = *DataOff;
+  LastOffset    = DataSize - PatternSize;
+
+  while (CurrentOffset <= LastOffset) {
+    for (Index = 0; Index < PatternSize; ++Index) {
+      if ((Data[CurrentOffset + Index] & (PatternMask != NULL ? PatternMask[Index] : 0xFF)) != Pattern[Index]) {
+        break;
+      }
+    }
+
+    if (Index == PatternSize) {
+      *DataOff = CurrentOffset;
+      return TRUE;
+    }
+
+    ++CurrentOffset;
+  }
+
+  return FALSE;
+}
+
+/**
+  Original bytewise FindPattern.
+**/
+STATIC
+BOOLEAN
+ReferenceFindPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize,
+  IN OUT UINT32    *DataOff
+  )
+{
+  if (DataSize < PatternSize) {
+    return FALSE;
+  }
+
+  return ReferenceFindPatternInternal (
+           Pattern,
+           PatternMask,
+           PatternSize,
+           Data,
+           DataSize,
+           DataOff
+           );
+}
+
+/**
+  Original bytewise ApplyPatch.
+**/
+STATIC
+UINT32
+ReferenceApplyPatch (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Replace,
+  IN CONST UINT8   *ReplaceMask OPTIONAL,
+  IN UINT8         *Data,
+  IN UINT32        DataSize,
+  IN UINT32        Count,
+  IN UINT32        Skip
+  )
+{
+  UINT32  ReplaceCount;
+  UINT32  DataOff;
+  UINT32  Index;
+
+  if (DataSize < PatternSize) {
+    return 0;
+  }
+
+  ReplaceCount = 0;
+  DataOff      = 0;
+
+  while (ReferenceFindPatternInternal (Pattern, PatternMask, PatternSize, Data, DataSize, &DataOff)) {
+    if (Skip > 0) {
+      --Skip;
+      DataOff += PatternSize;
+      continue;
+    }
+
+    if (ReplaceMask == NULL) {
+      CopyMem (&Data[DataOff], Replace, PatternSize);
+    } else {
+      for (Index = 0; Index < PatternSize; ++Index) {
+        Data[DataOff + Index] = (Data[DataOff + Index] & ~ReplaceMask[Index]) | (Replace[Index] & ReplaceMask[Index]);
+      }
+    }
+
+    ++ReplaceCount;
+    DataOff += PatternSize;
+
+    if (Count > 0) {
+      --Count;
+      if (Count == 0) {
+        break;
+      }
+    }
+  }
+
+  return ReplaceCount;
+}
+
+/**
+  Allocate Size bytes ending exactly at the allocation end, so that
+  reads past the buffer are caught by the sanitizers.
+
+  @param[in]  Size        Buffer size.
+  @param[in]  Misalign    Buffer start misalignment.
+  @param[out] Allocation  Allocation to free.
+
+  @return Buffer or NULL.
+**/
+STATIC
+UINT8 *
+AllocateUnaligned (
+  IN  UINT32  Size,
+  IN  UINT32  Misalign,
+  OUT VOID    **Allocation
+  )
+{
+  *Allocation = AllocateZeroPool (Size + Misalign + 1);
+  if (*Allocation == NULL) {
+    return NULL;
+  }
+
+  //
+  // Keep one spare byte in front so that empty buffers are valid pointers.
+  //
+  return (UINT8 *)*Allocation + 1 + Misalign;
+}
+
+/**
+  Run one case described by Input.
+
+  Header bytes are pattern size, buffer misalignment, flags, Count, Skip,
+  DataOff, Limit, planted match offset and planted match count. They are
+  followed by pattern, pattern mask, replace and replace mask bytes, and
+  the data.
+
+  @param[in] Input      Case description.
+  @param[in] InputSize  Case description size.
+
+  @retval TRUE when all functions matched the reference.
+**/
+STATIC
+BOOLEAN
+CheckCase (
+  IN CONST UINT8  *Input,
+  IN UINTN        InputSize
+  )
+{
+  BOOLEAN      Result;
+  CONST UINT8  *Header;
+  CONST UINT8  *Fields;
+  UINT32       FieldsSize;
+  UINT32       PatternSize;
+  UINT32       DataSize;
+  UINT32       PatchSize;
+  UINT32       Flags;
+  UINT32       Alphabet;
+  UINT32       Offset;
+  UINT32       RefOffset;
+  UINT32       Replaced;
+  UINT32       RefReplaced;
+  UINT32       Index;
+  UINT32       Planted;
+  UINT8        *Pattern;
+  UINT8        *PatternMask;
+  UINT8        *Replace;
+  UINT8        *ReplaceMask;
+  UINT8        *Data;
+  UINT8        *RefData;
+  VOID         *Allocations[6];
+  BOOLEAN      Found;
+  BOOLEAN      RefFound;
+  BOOLEAN      Matched;
+  BOOLEAN      RefMatched;
+
+  if (InputSize < CASE_HEADER_SIZE) {
+    return TRUE;
+  }
+
+  Header      = Input;
+  Fields      = Input + CASE_HEADER_SIZE;
+  FieldsSize  = (UINT32)MIN (InputSize - CASE_HEADER_SIZE, 4 * PATTERN_SIZE_MAX + DATA_SIZE_MAX);
+  PatternSize = Header[0] % PATTERN_SIZE_MAX;
+  Flags       = Header[2];
+  Alphabet    = 1U << (1 + (Flags >> CASE_ALPHABET_SHIFT));
+  DataSize    = FieldsSize - MIN (FieldsSize, 4 * PatternSize);
+
+  ZeroMem (Allocations, sizeof (Allocations));
+
+  Result      = TRUE;
+  Pattern     = AllocateUnaligned (PatternSize, Header[1] & 7U, &Allocations[0]);
+  PatternMask = AllocateUnaligned (PatternSize, (Header[1] >> 3) & 7U, &Allocations[1]);
+  Replace     = AllocateUnaligned (PatternSize, Header[1] >> 6, &Allocations[2]);
+  ReplaceMask = AllocateUnaligned (PatternSize, 3, &Allocations[3]);
+  Data        = AllocateUnaligned (DataSize, Header[8] & 7U, &Allocations[4]);
+  RefData     = AllocateUnaligned (DataSize, 0, &Allocations[5]);
+
+  for (Index = 0; Index < ARRAY_SIZE (Allocations); ++Index) {
+    if (Allocations[Index] == NULL) {
+      Result = FALSE;
+    }
+  }
+
+  if (!Result) {
+    for (Index = 0; Index < ARRAY_SIZE (Allocations); ++Index) {
+      if (Allocations[Index] != NULL) {
+        FreePool (Allocations[Index]);
+      }
+    }
+
+    return FALSE;
+  }
+
+  //
+  // Small alphabets make long and overlapping matches frequent.
+  //
+  for (Index = 0; Index < PatternSize; ++Index) {
+    Pattern[Index]     = Index < FieldsSize ? Fields[Index] : 0;
+    PatternMask[Index] = Index + PatternSize < FieldsSize ? Fields[Index + PatternSize] : 0xFF;
+    Replace[Index]     = Index + 2 * PatternSize < FieldsSize ? Fields[Index + 2 * PatternSize] : 0;
+    ReplaceMask[Index] = Index + 3 * PatternSize < FieldsSize ? Fields[Index + 3 * PatternSize] : 0xFF;
+
+    if (Alphabet < 256) {
+      Pattern[Index] = (UINT8)((Pattern[Index] % Alphabet) * 0x11);
+    }
+
+    if ((PatternMask[Index] & 1U) != 0) {
+      PatternMask[Index] = 0xFF;
+    }
+
+    if ((Flags & CASE_MASKED_OUT) != 0) {
+      PatternMask[Index] = 0;
+    }
+
+    if ((Flags & CASE_PATTERN_IN_MASK) != 0) {
+      Pattern[Index] &= PatternMask[Index];
+    }
+  }
+
+  Fields += FieldsSize - DataSize;
+  for (Index = 0; Index < DataSize; ++Index) {
+    Data[Index] = Alphabet < 256 ? (UINT8)((Fields[Index] % Alphabet) * 0x11) : Fields[Index];
+  }
+
+  //
+  // Plant a few masked pattern copies, which may overlap.
+  //
+  if ((PatternSize > 0) && (PatternSize <= DataSize)) {
+    for (Planted = 0; Planted < (Header[8] >> 3) % (PLANTED_MATCHES_MAX + 1); ++Planted) {
+      Offset = (Header[7] * (Planted + 1)) % (DataSize - PatternSize + 1);
+      for (Index = 0; Index < PatternSize; ++Index) {
+        Data[Offset + Index] = (Data[Offset + Index] & ~PatternMask[Index]) | (Pattern[Index] & PatternMask[Index]);
+      }
+    }
+  }
+
+  if (((Flags & CASE_PATTERN_MASK) == 0) && ((Flags & CASE_MASKED_OUT) == 0)) {
+    PatternMask = NULL;
+  }
+
+  if ((Flags & CASE_REPLACE_MASK) == 0) {
+    ReplaceMask = NULL;
+  }
+
+  //
+  // Every pattern offset for MatchPattern.
+  //
+  for (Offset = 0; (PatternSize > 0) && (Offset + PatternSize <= DataSize); ++Offset) {
+    Matched    = MatchPattern (Pattern, PatternMask, PatternSize, &Data[Offset]);
+    RefOffset  = 0;
+    RefMatched = ReferenceFindPattern (Pattern, PatternMask, PatternSize, &Data[Offset], PatternSize, &RefOffset);
+    if (Matched != RefMatched) {
+      DEBUG ((DEBUG_ERROR, "MatchPattern %u at %u of %u - %d vs %d\n", PatternSize, Offset, DataSize, Matched, RefMatched));
+      Result = FALSE;
+    }
+  }
+
+  //
+  // Requested start offset, followed by every next occurrence.
+  //
+  Offset    = Header[5];
+  RefOffset = Offset;
+  do {
+    Found    = FindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, &Offset);
+    RefFound = ReferenceFindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, &RefOffset);
+    if ((Found != RefFound) || (Offset != RefOffset)) {
+      DEBUG ((DEBUG_ERROR, "FindPattern %u in %u - %d at %u vs %d at %u\n", PatternSize, DataSize, Found, Offset, RefFound, RefOffset));
+      Result = FALSE;
+      break;
+    }
+
+    ++Offset;
+    ++RefOffset;
+  } while (Found);
+
+  //
+  // Limit truncates the size passed to ApplyPatch, the rest must stay intact.
+  //
+  PatchSize = DataSize;
+  if ((Flags & CASE_LIMIT) != 0) {
+    PatchSize = Header[6] % (DataSize + 1);
+  }
+
+  CopyMem (RefData, Data, DataSize);
+  Replaced    = ApplyPatch (Pattern, PatternMask, PatternSize, Replace, ReplaceMask, Data, PatchSize, Header[3] % 4, Header[4] % 3);
+  RefReplaced = ReferenceApplyPatch (Pattern, PatternMask, PatternSize, Replace, ReplaceMask, RefData, PatchSize, Header[3] % 4, Header[4] % 3);
+  if ((Replaced != RefReplaced) || (CompareMem (Data, RefData, DataSize) != 0)) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "ApplyPatch %u in %u of %u - count %u skip %u - %u vs %u replacements\n",
+      PatternSize,
+      PatchSize,
+      DataSize,
+      Header[3] % 4,
+      Header[4] % 3,
+      Replaced,
+      RefReplaced
+      ));
+    Result = FALSE;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (Allocations); ++Index) {
+    FreePool (Allocations[Index]);
+  }
+
+  return Result;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  STATIC UINT8  Input[CASE_SIZE_MAX];
+  UINT32        Rounds;
+  UINT32        Round;
+  UINT32        Size;
+  UINT32        Index;
+
+  Rounds = DEFAULT_ROUNDS;
+  if (argc > 1) {
+    Rounds = (UINT32)strtoul (argv[1], NULL, 0);
+  }
+
+  for (Round = 0; Round < Rounds; ++Round) {
+    Size = pseudo_random_between (CASE_HEADER_SIZE, CASE_SIZE_MAX);
+    for (Index = 0; Index < Size; ++Index) {
+      Input[Index] = (UINT8)pseudo_random ();
+    }
+
+    if (!CheckCase (Input, Size)) {
+      DEBUG ((DEBUG_ERROR, "[FAIL] Round %u\n", Round));
+      return -1;
+    }
+  }
+
+  DEBUG ((DEBUG_ERROR, "[OK] %u rounds\n", Rounds));
+  return 0;
+}
+
+int
+LLVMFuzzerTestOneInput (
+  const uint8_t  *Data,
+  size_t         Size
+  )
+{
+  if (!CheckCase (Data, Size)) {
+    abort ();
+  }
+
+  return 0;
+}
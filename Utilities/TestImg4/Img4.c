@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include <UserFile.h>
+#include <UserTimer.h>
 
 #include <Protocol/AppleSecureBoot.h>
 
@@ -188,18 +189,159 @@ VerifyImg4 (
   return 0;
 }
 
+STATIC
+INT32
+VerifyImg4Buffers (
+  IN CONST UINT8  *Image,
+  IN UINT32       ImgSize,
+  IN CONST UINT8  *Manifest,
+  IN UINT32       ManSize,
+  IN CONST CHAR8  *type
+  )
+{
+  DERImg4ManifestInfo  ManInfo;
+  DERReturn            RetVal;
+
+  RetVal = DERImg4ParseManifest (
+             &ManInfo,
+             Manifest,
+             ManSize,
+             SIGNATURE_32 (type[3], type[2], type[1], type[0])
+             );
+  if (RetVal != DR_Success) {
+    DEBUG ((DEBUG_ERROR, "\n !!! DERImg4ParseManifest failed - %d !!!\n", RetVal));
+    return -1;
+  }
+
+  if (SigVerifyShaHashBySize (Image, ImgSize, ManInfo.imageDigest, ManInfo.imageDigestSize) != 0) {
+    DEBUG ((DEBUG_ERROR, "\n!!! digest mismatch !!!\n"));
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+  Verify a secure boot file set (e.g. kernelcache, immutable kexts and root
+  hash sharing one apticket) Rounds times. The first round is reported
+  separately as later rounds reuse verified manifest signatures.
+**/
+STATIC
+INT32
+BenchmarkImg4 (
+  IN UINT32  Rounds,
+  IN INT32   argc,
+  IN CHAR8   *argv[]
+  )
+{
+  INT32   RetVal;
+  INT32   Index;
+  INT32   NumFiles;
+  UINT32  Round;
+  UINT8   **Images;
+  UINT8   **Manifests;
+  UINT32  *ImgSizes;
+  UINT32  *ManSizes;
+  UINT64  Start;
+  UINT64  FirstRound;
+  UINT64  Total;
+
+  NumFiles  = argc / 3;
+  Images    = AllocateZeroPool (NumFiles * sizeof (*Images));
+  Manifests = AllocateZeroPool (NumFiles * sizeof (*Manifests));
+  ImgSizes  = AllocateZeroPool (NumFiles * sizeof (*ImgSizes));
+  ManSizes  = AllocateZeroPool (NumFiles * sizeof (*ManSizes));
+  if ((Images == NULL) || (Manifests == NULL) || (ImgSizes == NULL) || (ManSizes == NULL)) {
+    DEBUG ((DEBUG_ERROR, "\n!!! allocation error !!!\n"));
+    return -1;
+  }
+
+  RetVal = 0;
+  for (Index = 0; Index < NumFiles && RetVal == 0; ++Index) {
+    if (AsciiStrLen (argv[Index * 3 + 2]) != 4) {
+      DEBUG ((DEBUG_ERROR, "Object types require exactly 4 characters.\n"));
+      RetVal = -1;
+      break;
+    }
+
+    Images[Index]    = UserReadFile (argv[Index * 3], &ImgSizes[Index]);
+    Manifests[Index] = UserReadFile (argv[Index * 3 + 1], &ManSizes[Index]);
+    if ((Images[Index] == NULL) || (Manifests[Index] == NULL)) {
+      DEBUG ((DEBUG_ERROR, "\n!!! read error !!!\n"));
+      RetVal = -1;
+    }
+  }
+
+  FirstRound = 0;
+  Total      = 0;
+  for (Round = 0; Round < Rounds && RetVal == 0; ++Round) {
+    Start = GetCurrentTimestamp ();
+    for (Index = 0; Index < NumFiles && RetVal == 0; ++Index) {
+      RetVal = VerifyImg4Buffers (
+                 Images[Index],
+                 ImgSizes[Index],
+                 Manifests[Index],
+                 ManSizes[Index],
+                 argv[Index * 3 + 2]
+                 );
+    }
+
+    if (Round == 0) {
+      FirstRound = GetCurrentTimestamp () - Start;
+    } else {
+      Total += GetCurrentTimestamp () - Start;
+    }
+  }
+
+  if (RetVal == 0) {
+    DEBUG ((DEBUG_ERROR, "Verified %d files, first round %Lu us\n", NumFiles, FirstRound));
+    if (Rounds > 1) {
+      DEBUG ((DEBUG_ERROR, "Next %u rounds %Lu us on average\n", Rounds - 1, Total / (Rounds - 1)));
+    }
+  }
+
+  for (Index = 0; Index < NumFiles; ++Index) {
+    if (Images[Index] != NULL) {
+      FreePool (Images[Index]);
+    }
+
+    if (Manifests[Index] != NULL) {
+      FreePool (Manifests[Index]);
+    }
+  }
+
+  FreePool (Images);
+  FreePool (Manifests);
+  FreePool (ImgSizes);
+  FreePool (ManSizes);
+
+  return RetVal;
+}
+
 int
 ENTRY_POINT (
   int   argc,
   char  *argv[]
   )
 {
-  INT32  RetVal;
-  INT32  Index;
+  INT32   RetVal;
+  INT32   Index;
+  UINT32  Rounds;
+
+  if ((argc > 2) && (AsciiStrCmp (argv[1], "-b") == 0)) {
+    Rounds = (UINT32)AsciiStrDecimalToUintn (argv[2]);
+    if ((Rounds == 0) || (argc < 6) || (((argc - 3) % 3) != 0)) {
+      DEBUG ((DEBUG_ERROR, "Usage: Img4 -b [rounds] ([image path] [manifest path] [object type])+\n"));
+      return -1;
+    }
+
+    return BenchmarkImg4 (Rounds, argc - 3, &argv[3]);
+  }
 
   if ((argc < 2) || (((argc % 3) != 1) && (argc != 2))) {
     DEBUG ((DEBUG_ERROR, "Usage: ./Img4 ([image path] [manifest path] [object type])*\n"));
     DEBUG ((DEBUG_ERROR, "Usage: Img4 [manifest path]\n"));
+    DEBUG ((DEBUG_ERROR, "Usage: Img4 -b [rounds] ([image path] [manifest path] [object type])+\n"));
     return -1;
   }
 
@@ -12,12 +12,14 @@
   WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 **/
 
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/OcTemplateLib.h>
 #include <Library/OcSerializeLib.h>
 #include <Library/OcMiscLib.h>
 #include <Library/OcAppleKernelLib.h>
+#include <Library/OcXmlLib.h>
 
 #include <string.h>
 #include <sys/time.h>
@@ -32,6 +34,12 @@ STATIC EFI_FILE_PROTOCOL  NilFileProtocol;
 STATIC UINT8   *mPrelinked    = NULL;
 STATIC UINT32  mPrelinkedSize = 0;
 
+//
+// Number of randomly modified copies of the prelinked info plist
+// to check verbatim exports with.
+//
+#define INFO_EXPORT_CHECK_ROUNDS  8
+
 STATIC
 CONST CHAR8
   KextInfoPlistData[] = {
@@ -581,6 +589,289 @@ OcGetFileSize (
   return EFI_SUCCESS;
 }
 
+/**
+  Count XML nodes in the subtree, or find the Index-th node in preorder.
+**/
+STATIC
+XML_NODE *
+GetXmlNodeByIndex (
+  IN     XML_NODE  *Node,
+  IN OUT UINT32    *Index
+  )
+{
+  XML_NODE  *Found;
+  UINT32    Child;
+
+  if (*Index == 0) {
+    return Node;
+  }
+
+  --*Index;
+
+  for (Child = 0; Child < XmlNodeChildren (Node); ++Child) {
+    Found = GetXmlNodeByIndex (XmlNodeChild (Node, Child), Index);
+    if (Found != NULL) {
+      return Found;
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+XML_NODE *
+GetRandomXmlNode (
+  IN     XML_DOCUMENT  *Document,
+  IN OUT UINT32        *Seed
+  )
+{
+  UINT32  Count;
+  UINT32  Index;
+
+  Count = MAX_UINT32;
+  GetXmlNodeByIndex (XmlDocumentRoot (Document), &Count);
+  Count = MAX_UINT32 - Count;
+
+  *Seed = *Seed * 1103515245U + 12345U;
+  Index = (*Seed >> 8) % Count;
+  return GetXmlNodeByIndex (XmlDocumentRoot (Document), &Index);
+}
+
+/**
+  Export the document into a new buffer and check the export size.
+**/
+STATIC
+CHAR8 *
+ExportXmlToBuffer (
+  IN  XML_DOCUMENT  *Document,
+  IN  CONST CHAR8   *Source  OPTIONAL,
+  OUT UINT32        *Length
+  )
+{
+  CHAR8   *Buffer;
+  UINT32  Written;
+
+  if (!XmlDocumentExportSize (Document, Source, 0, FALSE, Length)) {
+    return NULL;
+  }
+
+  Buffer = AllocatePool (*Length + 1);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+
+  SetMem (Buffer, *Length + 1, 0xFF);
+  Written = XmlDocumentExportToBuffer (Document, Source, 0, FALSE, Buffer);
+  if ((Written != *Length) || (Buffer[Written] != '\0') || (AsciiStrLen (Buffer) != Written)) {
+    DEBUG ((DEBUG_WARN, "[FAIL] Info export wrote %u bytes instead of %u\n", Written, *Length));
+    FreePool (Buffer);
+    return NULL;
+  }
+
+  return Buffer;
+}
+
+/**
+  Check that the plist reparses into a document with the same plain export.
+**/
+STATIC
+BOOLEAN
+CheckXmlReparse (
+  IN CHAR8        *Plist,
+  IN UINT32       PlistSize,
+  IN CONST CHAR8  *Expected,
+  IN UINT32       ExpectedSize
+  )
+{
+  XML_DOCUMENT  *Document;
+  CHAR8         *Exported;
+  UINT32        ExportedSize;
+  BOOLEAN       Result;
+
+  Document = XmlDocumentParse (Plist, PlistSize, TRUE);
+  if (Document == NULL) {
+    return FALSE;
+  }
+
+  Exported = XmlDocumentExport (Document, &ExportedSize, 0, FALSE);
+  XmlDocumentFree (Document);
+  if (Exported == NULL) {
+    return FALSE;
+  }
+
+  Result = (ExportedSize == ExpectedSize) && (CompareMem (Exported, Expected, ExpectedSize) == 0);
+  FreePool (Exported);
+  return Result;
+}
+
+/**
+  Check that the export is a verbatim copy of a part of the original plist.
+**/
+STATIC
+BOOLEAN
+IsVerbatimCopy (
+  IN CONST CHAR8  *Info,
+  IN UINT32       InfoSize,
+  IN CONST CHAR8  *Exported
+  )
+{
+  CHAR8    *Original;
+  BOOLEAN  Result;
+
+  Original = AllocateZeroPool (InfoSize + 1);
+  if (Original == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (Original, Info, InfoSize);
+  Result = AsciiStrStr (Original, Exported) != NULL;
+  FreePool (Original);
+  return Result;
+}
+
+/**
+  Optionally modify a parsed copy of the prelinked info plist and check that
+  exporting unchanged nodes verbatim from the original gives the same document.
+  Without modifications the whole document must be copied verbatim.
+**/
+STATIC
+BOOLEAN
+CheckInfoExport (
+  IN CONST CHAR8  *Info,
+  IN UINT32       InfoSize,
+  IN BOOLEAN      Modify,
+  IN UINT32       Seed
+  )
+{
+  CHAR8         *Copy;
+  XML_DOCUMENT  *Document;
+  XML_NODE      *Node;
+  XML_NODE      *Dict;
+  CHAR8         *Plain;
+  CHAR8         *Sized;
+  CHAR8         *Verbatim;
+  UINT32        PlainSize;
+  UINT32        SizedSize;
+  UINT32        VerbatimSize;
+  UINT32        Index;
+  BOOLEAN       Result;
+
+  Copy = AllocateCopyPool (InfoSize, Info);
+  if (Copy == NULL) {
+    return FALSE;
+  }
+
+  Document = XmlDocumentParse (Copy, InfoSize, TRUE);
+  if (Document == NULL) {
+    FreePool (Copy);
+    return FALSE;
+  }
+
+  if (Modify) {
+    //
+    // Removals go last, as changing content follows references to other nodes.
+    //
+    for (Index = 0; Index < 4; ++Index) {
+      Node = GetRandomXmlNode (Document, &Seed);
+      if ((XmlNodeChildren (Node) == 0) && (XmlNodeContent (Node) != NULL)) {
+        XmlNodeChangeContent (Node, "Changed");
+      }
+    }
+
+    for (Index = 0; Index < 2; ++Index) {
+      Node = GetRandomXmlNode (Document, &Seed);
+      if (XmlNodeChildren (Node) > 0) {
+        Dict = XmlNodeAppend (Node, "dict", NULL, NULL);
+        if (Dict != NULL) {
+          XmlNodeAppend (Dict, "key", NULL, "Injected");
+          XmlNodeAppend (Dict, "string", NULL, "Value");
+        }
+      }
+    }
+
+    for (Index = 0; Index < 2; ++Index) {
+      Node = GetRandomXmlNode (Document, &Seed);
+      if (XmlNodeChildren (Node) > 1) {
+        XmlNodeRemoveByIndex (Node, (Seed >> 8) % XmlNodeChildren (Node));
+      }
+    }
+  }
+
+  Result   = FALSE;
+  Sized    = NULL;
+  Verbatim = NULL;
+  Plain    = XmlDocumentExport (Document, &PlainSize, 0, FALSE);
+  if (Plain != NULL) {
+    Sized = ExportXmlToBuffer (Document, NULL, &SizedSize);
+    if (Sized != NULL) {
+      Verbatim = ExportXmlToBuffer (Document, Info, &VerbatimSize);
+    }
+
+    Result = Verbatim != NULL
+             && (SizedSize == PlainSize)
+             && (CompareMem (Sized, Plain, PlainSize) == 0)
+             && (Modify || IsVerbatimCopy (Info, InfoSize, Verbatim))
+             && CheckXmlReparse (Verbatim, VerbatimSize, Plain, PlainSize);
+  }
+
+  if (Plain != NULL) {
+    FreePool (Plain);
+  }
+
+  if (Sized != NULL) {
+    FreePool (Sized);
+  }
+
+  if (Verbatim != NULL) {
+    FreePool (Verbatim);
+  }
+
+  XmlDocumentFree (Document);
+  FreePool (Copy);
+  return Result;
+}
+
+/**
+  Check that the prelinked info written by PrelinkedInjectComplete
+  reparses into the injected document.
+**/
+STATIC
+BOOLEAN
+CheckInjectedInfo (
+  IN PRELINKED_CONTEXT  *Context
+  )
+{
+  CHAR8    *Info;
+  UINT32   InfoSize;
+  UINT32   InfoOffset;
+  CHAR8    *Expected;
+  UINT32   ExpectedSize;
+  BOOLEAN  Result;
+
+  InfoOffset = Context->Is32Bit ? Context->PrelinkedInfoSection->Section32.Offset
+                                : (UINT32)Context->PrelinkedInfoSection->Section64.Offset;
+  InfoSize = (UINT32)AsciiStrnLenS (
+                       (CHAR8 *)&Context->Prelinked[InfoOffset],
+                       Context->PrelinkedSize - InfoOffset
+                       );
+
+  Info     = AllocateCopyPool (InfoSize, &Context->Prelinked[InfoOffset]);
+  Expected = XmlDocumentExport (Context->PrelinkedInfoDocument, &ExpectedSize, 0, FALSE);
+  Result   = Info != NULL
+             && Expected != NULL
+             && CheckXmlReparse (Info, InfoSize, Expected, ExpectedSize);
+
+  if (Info != NULL) {
+    FreePool (Info);
+  }
+
+  if (Expected != NULL) {
+    FreePool (Expected);
+  }
+
+  return Result;
+}
+
 int
 WrapMain (
   int   argc,
@@ -718,6 +1009,23 @@ WrapMain (
 
   Status = PrelinkedContextInit (&Context, mPrelinked, mPrelinkedSize, AllocSize, FALSE);
   if (!EFI_ERROR (Status)) {
+    //
+    // Check verbatim exports against the original info before it is overwritten.
+    // The first round keeps the plist unmodified.
+    //
+    for (UINT32 Seed = 0; Seed <= INFO_EXPORT_CHECK_ROUNDS; ++Seed) {
+      if (!CheckInfoExport (
+             (CONST CHAR8 *)&mPrelinked[Context.Is32Bit ? Context.PrelinkedInfoSection->Section32.Offset : Context.PrelinkedInfoSection->Section64.Offset],
+             (UINT32)(Context.Is32Bit ? Context.PrelinkedInfoSection->Section32.Size : Context.PrelinkedInfoSection->Section64.Size),
+             Seed != 0,
+             Seed
+             ))
+      {
+        DEBUG ((DEBUG_WARN, "[FAIL] Prelinked info export check %u\n", Seed));
+        FailedToProcess = TRUE;
+      }
+    }
+
     ApplyKextPatches (&Context);
 
     Status = PrelinkedInjectPrepare (&Context, LinkedExpansion, ReservedExeSize);
@@ -839,6 +1147,13 @@ WrapMain (
     UserWriteFile ("out.bin", mPrelinked, Context.PrelinkedSize);
     if (!EFI_ERROR (Status)) {
       DEBUG ((DEBUG_WARN, "[OK] Prelink inject complete success\n"));
+
+      if (CheckInjectedInfo (&Context)) {
+        DEBUG ((DEBUG_WARN, "[OK] Prelinked info round trip success\n"));
+      } else {
+        DEBUG ((DEBUG_WARN, "[FAIL] Prelinked info round trip failure\n"));
+        FailedToProcess = TRUE;
+      }
     } else {
       DEBUG ((DEBUG_WARN, "[FAIL] Prelink inject complete error %r\n", Status));
       FailedToProcess = TRUE;
@@ -0,0 +1,289 @@
+/** @file
+  Feed a local DMG to OpenNetworkBoot chunklist verification the way
+  HTTP Boot body callback does, and compare the time taken with
+  downloading the whole image first and verifying it afterwards.
+
+  Usage: NetworkBoot <dmg> <chunklist> [fragment size]
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcAppleChunklistLib.h>
+#include <Library/OcAppleKeysLib.h>
+
+#include <UserFile.h>
+#include <UserMemory.h>
+#include <UserTimer.h>
+
+#include "HttpBootChunklist.h"
+
+//
+// Typical HTTP Boot body fragment size.
+//
+#define DEFAULT_FRAGMENT_SIZE  SIZE_16KB
+
+STATIC
+UINT64
+GetThroughput (
+  IN UINT64  Size,
+  IN UINT64  Time
+  )
+{
+  if (Time == 0) {
+    return 0;
+  }
+
+  return (Size * 1000000ULL) / (Time * SIZE_1MB);
+}
+
+/**
+  Read the image in fragments, copying each to the destination buffer
+  and passing it to the body verifier, as HTTP Boot callback does.
+**/
+STATIC
+EFI_STATUS
+DownloadPipelined (
+  IN  FILE    *DmgFile,
+  IN  UINT8   *Dmg,
+  IN  UINT32  DmgSize,
+  IN  UINT8   *Fragment,
+  IN  UINT32  FragmentSize,
+  IN  UINT8   *Chunklist,
+  IN  UINT32  ChunklistSize,
+  OUT UINT64  *Time
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      StartTime;
+  UINT32      Offset;
+  size_t      ReadSize;
+
+  StartTime = GetCurrentTimestamp ();
+
+  Status = HttpBootChunklistStart (Chunklist, ChunklistSize);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to start chunklist verification - %r\n", Status));
+    return Status;
+  }
+
+  Offset = 0;
+  while (Offset < DmgSize) {
+    ReadSize = fread (Fragment, 1, MIN (FragmentSize, DmgSize - Offset), DmgFile);
+    if (ReadSize == 0) {
+      break;
+    }
+
+    CopyMem (Dmg + Offset, Fragment, ReadSize);
+    Offset += (UINT32)ReadSize;
+
+    if (!HttpBootChunklistUpdate (Fragment, ReadSize)) {
+      DEBUG ((DEBUG_ERROR, "Aborted download at %u of %u bytes\n", Offset, DmgSize));
+      break;
+    }
+  }
+
+  Status = HttpBootChunklistFinish (Offset);
+  *Time  = GetCurrentTimestamp () - StartTime;
+
+  return Status;
+}
+
+/**
+  Read the whole image first, then verify it, as before pipelining.
+**/
+STATIC
+EFI_STATUS
+DownloadThenVerify (
+  IN  FILE    *DmgFile,
+  IN  UINT8   *Dmg,
+  IN  UINT32  DmgSize,
+  IN  UINT8   *Fragment,
+  IN  UINT32  FragmentSize,
+  IN  UINT8   *Chunklist,
+  IN  UINT32  ChunklistSize,
+  OUT UINT64  *Time
+  )
+{
+  OC_APPLE_CHUNKLIST_CONTEXT  Context;
+  UINT8                       *ChunklistCopy;
+  UINT64                      StartTime;
+  UINT32                      Offset;
+  size_t                      ReadSize;
+  BOOLEAN                     Result;
+
+  StartTime = GetCurrentTimestamp ();
+
+  Offset = 0;
+  while (Offset < DmgSize) {
+    ReadSize = fread (Fragment, 1, MIN (FragmentSize, DmgSize - Offset), DmgFile);
+    if (ReadSize == 0) {
+      break;
+    }
+
+    CopyMem (Dmg + Offset, Fragment, ReadSize);
+    Offset += (UINT32)ReadSize;
+  }
+
+  ChunklistCopy = AllocateCopyPool (ChunklistSize, Chunklist);
+  if (ChunklistCopy == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Result = OcAppleChunklistInitializeContext (&Context, ChunklistCopy, ChunklistSize);
+  if (Result) {
+    Result = OcAppleChunklistVerifySignature (&Context, PkDataBase[0].PublicKey)
+             || OcAppleChunklistVerifySignature (&Context, PkDataBase[1].PublicKey);
+  }
+
+  if (Result) {
+    OcAppleChunklistVerifyDataInit (&Context);
+    Result = OcAppleChunklistVerifyDataUpdate (&Context, Dmg, Offset)
+             && OcAppleChunklistVerifyDataFinal (&Context);
+  }
+
+  FreePool (ChunklistCopy);
+
+  *Time = GetCurrentTimestamp () - StartTime;
+
+  return Result ? EFI_SUCCESS : EFI_SECURITY_VIOLATION;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  EFI_STATUS  Status;
+  FILE        *DmgFile;
+  long        FileSize;
+  UINT32      DmgSize;
+  UINT8       *Dmg;
+  UINT8       *Chunklist;
+  UINT32      ChunklistSize;
+  UINT8       *Fragment;
+  UINT32      FragmentSize;
+  UINT64      PipelinedTime;
+  UINT64      SequentialTime;
+
+  //
+  // Limit pool allocation size to 3072 MB
+  //
+  SetPoolAllocationSizeLimit (BASE_1GB | BASE_2GB);
+
+  if (argc < 3) {
+    DEBUG ((DEBUG_ERROR, "Usage: %a <dmg> <chunklist> [fragment size]\n", argv[0]));
+    return -1;
+  }
+
+  FragmentSize = DEFAULT_FRAGMENT_SIZE;
+  if (argc > 3) {
+    FragmentSize = (UINT32)strtoul (argv[3], NULL, 0);
+    if (FragmentSize == 0) {
+      DEBUG ((DEBUG_ERROR, "Invalid fragment size %a\n", argv[3]));
+      return -1;
+    }
+  }
+
+  Chunklist = UserReadFile (argv[2], &ChunklistSize);
+  if (Chunklist == NULL) {
+    DEBUG ((DEBUG_ERROR, "Read fail %a\n", argv[2]));
+    return -1;
+  }
+
+  DmgFile = fopen (argv[1], "rb");
+  if (DmgFile == NULL) {
+    DEBUG ((DEBUG_ERROR, "Read fail %a\n", argv[1]));
+    FreePool (Chunklist);
+    return -1;
+  }
+
+  fseek (DmgFile, 0, SEEK_END);
+  FileSize = ftell (DmgFile);
+  if ((FileSize <= 0) || ((UINT64)FileSize > MAX_UINT32)) {
+    DEBUG ((DEBUG_ERROR, "Unsupported DMG size %Ld\n", (INT64)FileSize));
+    fclose (DmgFile);
+    FreePool (Chunklist);
+    return -1;
+  }
+
+  DmgSize  = (UINT32)FileSize;
+  Dmg      = AllocatePool (DmgSize);
+  Fragment = AllocatePool (FragmentSize);
+  if ((Dmg == NULL) || (Fragment == NULL)) {
+    DEBUG ((DEBUG_ERROR, "DMG data allocation failed\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+  } else {
+    //
+    // The first pass also warms up the file cache for the second one,
+    // run the old flow first so that the comparison does not favour the new one.
+    //
+    rewind (DmgFile);
+    Status = DownloadThenVerify (DmgFile, Dmg, DmgSize, Fragment, FragmentSize, Chunklist, ChunklistSize, &SequentialTime);
+    DEBUG ((
+      DEBUG_ERROR,
+      "Download then verify - %r, %Lu us, %Lu MB/s\n",
+      Status,
+      SequentialTime,
+      GetThroughput (DmgSize, SequentialTime)
+      ));
+
+    rewind (DmgFile);
+    Status = DownloadPipelined (DmgFile, Dmg, DmgSize, Fragment, FragmentSize, Chunklist, ChunklistSize, &PipelinedTime);
+    DEBUG ((
+      DEBUG_ERROR,
+      "Verify while downloading - %r, %Lu us, %Lu MB/s\n",
+      Status,
+      PipelinedTime,
+      GetThroughput (DmgSize, PipelinedTime)
+      ));
+  }
+
+  if (Dmg != NULL) {
+    FreePool (Dmg);
+  }
+
+  if (Fragment != NULL) {
+    FreePool (Fragment);
+  }
+
+  fclose (DmgFile);
+  FreePool (Chunklist);
+
+  return EFI_ERROR (Status) ? -1 : 0;
+}
+
+int
+LLVMFuzzerTestOneInput (
+  const uint8_t  *Data,
+  size_t         Size
+  )
+{
+  UINT32  Split;
+
+  //
+  // Chunklist followed by the data it describes, split in two fragments.
+  //
+  if ((Size < sizeof (UINT32)) || (Size > MAX_UINT32)) {
+    return 0;
+  }
+
+  Split = *(CONST UINT32 *)Data % (UINT32)(Size - sizeof (UINT32) + 1);
+  Data += sizeof (UINT32);
+  Size -= sizeof (UINT32);
+
+  if (!EFI_ERROR (HttpBootChunklistStart (Data, Split))) {
+    HttpBootChunklistUpdate (Data + Split, (Size - Split) / 2);
+    HttpBootChunklistUpdate (Data + Split + (Size - Split) / 2, Size - Split - (Size - Split) / 2);
+    HttpBootChunklistFinish (Size - Split);
+  }
+
+  return 0;
+}
@@ -24,6 +24,7 @@
 #include <Library/OcMainLib.h>
 
 #include <UserFile.h>
+#include <UserTimer.h>
 
 #define  OC_USER_FULL_PATH_MAX_SIZE  256
 
@@ -652,6 +653,137 @@ RunFixupWalkTest (
   return FailCount;
 }
 
+#define BENCH_QUIRK_ITERATIONS  5
+
+/**
+  Apply every quirk to each kernel, always starting from a pristine copy.
+  Only the quirk itself is timed, the best of several runs is reported.
+**/
+STATIC
+INT32
+RunQuirkBenchmark (
+  IN int   KernelCount,
+  IN char  **KernelPaths
+  )
+{
+  EFI_STATUS         Status;
+  PRELINKED_CONTEXT  Context;
+  PATCHER_CONTEXT    Patcher;
+  PATCHER_CONTEXT    *QuirkPatcher;
+  UINT8              *Kernel;
+  UINT8              *Copy;
+  UINT32             KernelSize;
+  UINT32             AllocSize;
+  UINT32             Version;
+  BOOLEAN            Is32Bit;
+  BOOLEAN            HasPrelinked;
+  UINT32             Quirk;
+  CONST CHAR8        *Identifier;
+  UINT32             Iteration;
+  UINT64             StartTime;
+  UINT64             Time;
+  UINT64             BestTime;
+  UINT64             TotalTime;
+  int                Index;
+
+  for (Index = 0; Index < KernelCount; ++Index) {
+    mPrelinked = UserReadFile (KernelPaths[Index], &mPrelinkedSize);
+    if (mPrelinked == NULL) {
+      DEBUG ((DEBUG_ERROR, "Read fail %a\n", KernelPaths[Index]));
+      return -1;
+    }
+
+    Status = ReadAppleKernel (
+               &NilFileProtocol,
+               FALSE,
+               &Is32Bit,
+               &Kernel,
+               &KernelSize,
+               &AllocSize,
+               0,
+               NULL
+               );
+    FreePool (mPrelinked);
+    mPrelinked = NULL;
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[FAIL] Kernel unpack failure %a - %r\n", KernelPaths[Index], Status));
+      return -1;
+    }
+
+    Version = OcKernelReadDarwinVersion (Kernel, KernelSize);
+    Copy    = AllocatePool (KernelSize);
+    if (Copy == NULL) {
+      FreePool (Kernel);
+      return -1;
+    }
+
+    DEBUG ((DEBUG_ERROR, "%a: version %u, %u bytes\n", KernelPaths[Index], Version, KernelSize));
+
+    TotalTime = 0;
+    for (Quirk = 0; Quirk < KernelQuirkMax; ++Quirk) {
+      Identifier = KernelGetQuirkIdentifier (Quirk);
+      BestTime   = MAX_UINT64;
+
+      for (Iteration = 0; Iteration < BENCH_QUIRK_ITERATIONS; ++Iteration) {
+        CopyMem (Copy, Kernel, KernelSize);
+        QuirkPatcher = &Patcher;
+        HasPrelinked = FALSE;
+
+        if (Identifier == NULL) {
+          Status = PatcherInitContextFromBuffer (&Patcher, Copy, KernelSize, Is32Bit);
+        } else {
+          Status       = PrelinkedContextInit (&Context, Copy, KernelSize, KernelSize, Is32Bit);
+          HasPrelinked = !EFI_ERROR (Status);
+          if (HasPrelinked) {
+            Status = PatcherInitContextFromPrelinked (&Patcher, &Context, Identifier);
+          }
+
+          //
+          // Kext quirks decide on their own whether a missing kext is fatal.
+          //
+          if (EFI_ERROR (Status)) {
+            QuirkPatcher = NULL;
+            Status       = EFI_SUCCESS;
+          }
+        }
+
+        if (!EFI_ERROR (Status)) {
+          StartTime = GetCurrentTimestamp ();
+          Status    = KernelApplyQuirk (Quirk, QuirkPatcher, Version);
+          Time      = GetCurrentTimestamp () - StartTime;
+          BestTime  = MIN (BestTime, Time);
+        }
+
+        if (HasPrelinked) {
+          PrelinkedContextFree (&Context);
+        }
+      }
+
+      if (BestTime == MAX_UINT64) {
+        DEBUG ((DEBUG_ERROR, "  quirk %2u kernel - patcher init failure %r\n", Quirk, Status));
+        continue;
+      }
+
+      TotalTime += BestTime;
+      DEBUG ((
+        DEBUG_ERROR,
+        "  quirk %2u %a - %r in %Lu us\n",
+        Quirk,
+        Identifier != NULL ? Identifier : "kernel",
+        Status,
+        BestTime
+        ));
+    }
+
+    DEBUG ((DEBUG_ERROR, "%a: all quirks in %Lu us\n", KernelPaths[Index], TotalTime));
+
+    FreePool (Copy);
+    FreePool (Kernel);
+  }
+
+  return 0;
+}
+
 int
 WrapMain (
   int   argc,
@@ -685,7 +817,8 @@ WrapMain (
 
   if (argc < 2) {
     DEBUG ((DEBUG_ERROR, "Usage: %a <path/to/OC/folder/> [path/to/kernel]\n", argv[0]));
-    DEBUG ((DEBUG_ERROR, "       %a --test-fixup-walk\n\n", argv[0]));
+    DEBUG ((DEBUG_ERROR, "       %a --test-fixup-walk\n", argv[0]));
+    DEBUG ((DEBUG_ERROR, "       %a --bench-quirks <path/to/kernel> [path/to/kernel...]\n\n", argv[0]));
     return -1;
   }
 
@@ -693,6 +826,10 @@ WrapMain (
     return RunFixupWalkTest () != 0 ? -1 : 0;
   }
 
+  if (AsciiStrCmp (argv[1], "--bench-quirks") == 0) {
+    return RunQuirkBenchmark (argc - 2, &argv[2]);
+  }
+
   FileName = argc > 2 ? argv[2] : "/System/Library/PrelinkedKernels/prelinkedkernel";
   if ((mPrelinked = UserReadFile (FileName, &mPrelinkedSize)) == NULL) {
     DEBUG ((DEBUG_ERROR, "Read fail %a\n", FileName));
@@ -0,0 +1,514 @@
+/** @file
+  Replay a recorded variable service trace against an emulated variable
+  store and compare indexed lookups with a linear store walk.
+
+  Trace format, one operation per line:
+    G <guid> <name>          - GetVariable
+    S <guid> <name> [size]   - SetVariable
+    D <guid> <name>          - SetVariable with zero size (delete)
+    N                        - Full GetNextVariableName enumeration
+  Lines starting with # are ignored.
+
+  Copyright (c) 2026, Acidanthera. All rights reserved.
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <stdio.h>
+
+#include <UserFile.h>
+#include <UserTimer.h>
+
+#include <Library/PrintLib.h>
+
+#include "VariableIndex.h"
+
+#define TRACE_STORE_SIZE         SIZE_256KB
+#define TRACE_MAX_NAME           64
+#define TRACE_DEFAULT_DATA_SIZE  16
+
+#define TRACE_SYNTHETIC_VARIABLES  400
+#define TRACE_SYNTHETIC_ROUNDS     50
+#define TRACE_SYNTHETIC_GETS       256
+
+typedef enum {
+  TraceGet,
+  TraceSet,
+  TraceDelete,
+  TraceEnumerate
+} TRACE_OP_TYPE;
+
+typedef struct {
+  TRACE_OP_TYPE    Type;
+  EFI_GUID         Guid;
+  CHAR16           Name[TRACE_MAX_NAME];
+  UINT32           DataSize;
+} TRACE_OP;
+
+typedef struct {
+  UINT64    LookupTime;
+  UINT64    EnumerateTime;
+  UINTN     Found;
+  UINTN     Enumerated;
+} TRACE_STATS;
+
+STATIC EFI_GUID  mTraceStoreGuid = EFI_VARIABLE_GUID;
+STATIC EFI_GUID  mTraceAppleGuid = {
+  0x7C436110, 0xAB2A, 0x4BBB, { 0xA8, 0x80, 0xFE, 0x41, 0x99, 0x5C, 0x9F, 0x82 }
+};
+STATIC EFI_GUID  mTraceGlobalGuid = {
+  0x8BE4DF61, 0x93CA, 0x11D2, { 0xAA, 0x0D, 0x00, 0xE0, 0x98, 0x03, 0x2B, 0x8C }
+};
+
+STATIC VARIABLE_STORE_HEADER  *mStore;
+STATIC UINTN                  mLastOffset;
+STATIC BOOLEAN                mUseIndex;
+
+BOOLEAN
+EFIAPI
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+STATIC
+VOID
+InitStore (
+  VOID
+  )
+{
+  SetMem (mStore, TRACE_STORE_SIZE, 0xFF);
+  CopyGuid (&mStore->Signature, &mTraceStoreGuid);
+  mStore->Size      = TRACE_STORE_SIZE;
+  mStore->Format    = VARIABLE_STORE_FORMATTED;
+  mStore->State     = VARIABLE_STORE_HEALTHY;
+  mStore->Reserved  = 0;
+  mStore->Reserved1 = 0;
+  mLastOffset       = (UINTN)GetStartPointer (mStore) - (UINTN)mStore;
+  VariableIndexInvalidate ();
+}
+
+/**
+  FindVariableEx store walk as it was before the index was added.
+**/
+STATIC
+EFI_STATUS
+LinearFindVariable (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  VARIABLE_HEADER  *InDeletedVariable;
+
+  PtrTrack->InDeletedTransitionPtr = NULL;
+  InDeletedVariable                = NULL;
+
+  for ( PtrTrack->CurrPtr = PtrTrack->StartPtr
+        ; IsValidVariableHeader (PtrTrack->CurrPtr, PtrTrack->EndPtr)
+        ; PtrTrack->CurrPtr = GetNextVariablePtr (PtrTrack->CurrPtr, FALSE)
+        )
+  {
+    if (  (  (PtrTrack->CurrPtr->State == VAR_ADDED)
+          || (PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)))
+       && CompareGuid (VendorGuid, GetVendorGuidPtr (PtrTrack->CurrPtr, FALSE))
+       && (CompareMem (VariableName, GetVariableNamePtr (PtrTrack->CurrPtr, FALSE), NameSizeOfVariable (PtrTrack->CurrPtr, FALSE)) == 0))
+    {
+      if (PtrTrack->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+        InDeletedVariable = PtrTrack->CurrPtr;
+      } else {
+        PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+        return EFI_SUCCESS;
+      }
+    }
+  }
+
+  PtrTrack->CurrPtr = InDeletedVariable;
+  return (PtrTrack->CurrPtr == NULL) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+TraceFind (
+  IN  CHAR16                  *VariableName,
+  IN  EFI_GUID                *VendorGuid,
+  OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  PtrTrack->StartPtr = GetStartPointer (mStore);
+  PtrTrack->EndPtr   = GetEndPointer (mStore);
+  PtrTrack->Volatile = FALSE;
+
+  if (mUseIndex) {
+    return FindVariableEx (VariableName, VendorGuid, FALSE, PtrTrack, FALSE);
+  }
+
+  return LinearFindVariable (VariableName, VendorGuid, PtrTrack);
+}
+
+/**
+  Drop deleted variables from the store, like Reclaim does.
+**/
+STATIC
+VOID
+ReclaimStore (
+  VOID
+  )
+{
+  UINT8            *Buffer;
+  UINT8            *CurrPtr;
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+
+  Buffer = AllocatePool (TRACE_STORE_SIZE);
+  if (Buffer == NULL) {
+    return;
+  }
+
+  SetMem (Buffer, TRACE_STORE_SIZE, 0xFF);
+  CopyMem (Buffer, mStore, sizeof (*mStore));
+  CurrPtr = (UINT8 *)GetStartPointer ((VARIABLE_STORE_HEADER *)Buffer);
+
+  for ( Variable = GetStartPointer (mStore)
+        ; IsValidVariableHeader (Variable, GetEndPointer (mStore))
+        ; Variable = NextVariable
+        )
+  {
+    NextVariable = GetNextVariablePtr (Variable, FALSE);
+    if (Variable->State == VAR_ADDED) {
+      CopyMem (CurrPtr, Variable, (UINTN)NextVariable - (UINTN)Variable);
+      CurrPtr += (UINTN)NextVariable - (UINTN)Variable;
+    }
+  }
+
+  CopyMem (mStore, Buffer, TRACE_STORE_SIZE);
+  mLastOffset = (UINTN)CurrPtr - (UINTN)Buffer;
+  FreePool (Buffer);
+
+  VariableIndexInvalidate ();
+}
+
+STATIC
+EFI_STATUS
+AppendVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    DataSize
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  UINTN            NameSize;
+  UINTN            VarSize;
+
+  NameSize = StrSize (VariableName);
+  VarSize  = GetVariableHeaderSize (FALSE) + NameSize + GET_PAD_SIZE (NameSize)
+             + DataSize + GET_PAD_SIZE (DataSize) + ALIGNMENT;
+
+  if (mLastOffset + VarSize > TRACE_STORE_SIZE) {
+    ReclaimStore ();
+    if (mLastOffset + VarSize > TRACE_STORE_SIZE) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Variable = (VARIABLE_HEADER *)((UINT8 *)mStore + mLastOffset);
+  ZeroMem (Variable, GetVariableHeaderSize (FALSE));
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = VAR_ADDED;
+  Variable->Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  SetNameSizeOfVariable (Variable, NameSize, FALSE);
+  SetDataSizeOfVariable (Variable, DataSize, FALSE);
+  CopyGuid (GetVendorGuidPtr (Variable, FALSE), VendorGuid);
+  CopyMem (GetVariableNamePtr (Variable, FALSE), VariableName, NameSize);
+  SetMem (GetVariableDataPtr (Variable, FALSE), DataSize, 0x5A);
+
+  mLastOffset = (UINTN)GetNextVariablePtr (Variable, FALSE) - (UINTN)mStore;
+  VariableIndexInvalidate ();
+  return EFI_SUCCESS;
+}
+
+STATIC
+UINTN
+EnumerateVariables (
+  VOID
+  )
+{
+  EFI_STATUS             Status;
+  VARIABLE_STORE_HEADER  *StoreList[VariableStoreTypeMax];
+  VARIABLE_HEADER        *Variable;
+  CHAR16                 VariableName[TRACE_MAX_NAME];
+  EFI_GUID               VendorGuid;
+  UINTN                  Count;
+
+  ZeroMem (StoreList, sizeof (StoreList));
+  StoreList[VariableStoreTypeNv] = mStore;
+
+  VariableName[0] = L'\0';
+  ZeroMem (&VendorGuid, sizeof (VendorGuid));
+  Count = 0;
+
+  while (TRUE) {
+    Status = VariableServiceGetNextVariableInternal (VariableName, &VendorGuid, StoreList, &Variable, FALSE);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    StrCpyS (VariableName, ARRAY_SIZE (VariableName), GetVariableNamePtr (Variable, FALSE));
+    CopyGuid (&VendorGuid, GetVendorGuidPtr (Variable, FALSE));
+    ++Count;
+  }
+
+  return Count;
+}
+
+STATIC
+EFI_STATUS
+ReplayTrace (
+  IN  TRACE_OP     *Ops,
+  IN  UINTN        OpCount,
+  IN  BOOLEAN      UseIndex,
+  OUT TRACE_STATS  *Stats
+  )
+{
+  EFI_STATUS              Status;
+  UINTN                   Index;
+  UINT64                  Start;
+  VARIABLE_POINTER_TRACK  PtrTrack;
+
+  ZeroMem (Stats, sizeof (*Stats));
+  mUseIndex = UseIndex;
+  InitStore ();
+
+  for (Index = 0; Index < OpCount; ++Index) {
+    if (Ops[Index].Type == TraceEnumerate) {
+      Start                 = GetCurrentTimestamp ();
+      Stats->Enumerated    += EnumerateVariables ();
+      Stats->EnumerateTime += GetCurrentTimestamp () - Start;
+      continue;
+    }
+
+    Start              = GetCurrentTimestamp ();
+    Status             = TraceFind (Ops[Index].Name, &Ops[Index].Guid, &PtrTrack);
+    Stats->LookupTime += GetCurrentTimestamp () - Start;
+
+    if (Ops[Index].Type == TraceGet) {
+      if (!EFI_ERROR (Status)) {
+        ++Stats->Found;
+      }
+
+      continue;
+    }
+
+    if (!EFI_ERROR (Status)) {
+      PtrTrack.CurrPtr->State &= VAR_DELETED;
+    }
+
+    if (Ops[Index].Type == TraceSet) {
+      Status = AppendVariable (Ops[Index].Name, &Ops[Index].Guid, Ops[Index].DataSize);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Store is full at operation %u\n", (UINT32)Index));
+        return Status;
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+TRACE_OP *
+LoadTrace (
+  IN  CONST CHAR8  *FileName,
+  OUT UINTN        *OpCount
+  )
+{
+  EFI_STATUS  Status;
+  CHAR8       *Buffer;
+  CHAR8       *Line;
+  CHAR8       *LineEnd;
+  UINT32      Size;
+  UINTN       Count;
+  TRACE_OP    *Ops;
+  CHAR8       Op;
+  CHAR8       AsciiGuid[40];
+  CHAR8       AsciiName[TRACE_MAX_NAME];
+  UINT32      DataSize;
+  INT32       Fields;
+
+  Buffer = (CHAR8 *)UserReadFile (FileName, &Size);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+
+  Count = 1;
+  for (Line = Buffer; *Line != '\0'; ++Line) {
+    if (*Line == '\n') {
+      ++Count;
+    }
+  }
+
+  Ops = AllocateZeroPool (Count * sizeof (*Ops));
+  if (Ops == NULL) {
+    FreePool (Buffer);
+    return NULL;
+  }
+
+  Count = 0;
+  for (Line = Buffer; *Line != '\0'; Line = LineEnd) {
+    LineEnd = Line;
+    while (*LineEnd != '\0' && *LineEnd != '\n') {
+      ++LineEnd;
+    }
+
+    if (*LineEnd == '\n') {
+      *LineEnd++ = '\0';
+    }
+
+    DataSize = TRACE_DEFAULT_DATA_SIZE;
+    Fields   = sscanf (Line, " %c %39s %63s %u", &Op, AsciiGuid, AsciiName, &DataSize);
+    if ((Fields < 1) || (Op == '#')) {
+      continue;
+    }
+
+    if (Op == 'N') {
+      Ops[Count++].Type = TraceEnumerate;
+      continue;
+    }
+
+    if ((Fields < 3) || ((Op != 'G') && (Op != 'S') && (Op != 'D'))) {
+      DEBUG ((DEBUG_ERROR, "Skipping malformed trace line %a\n", Line));
+      continue;
+    }
+
+    Status = AsciiStrToGuid (AsciiGuid, &Ops[Count].Guid);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Skipping trace line with invalid GUID %a\n", AsciiGuid));
+      continue;
+    }
+
+    AsciiStrToUnicodeStrS (AsciiName, Ops[Count].Name, ARRAY_SIZE (Ops[Count].Name));
+    Ops[Count].Type     = Op == 'G' ? TraceGet : (Op == 'S' ? TraceSet : TraceDelete);
+    Ops[Count].DataSize = DataSize;
+    ++Count;
+  }
+
+  FreePool (Buffer);
+  *OpCount = Count;
+  return Ops;
+}
+
+/**
+  Create a trace resembling macOS boot: a few hundred variables written
+  once, then repeated reads of a hot subset with occasional updates and
+  full enumerations.
+**/
+STATIC
+TRACE_OP *
+CreateSyntheticTrace (
+  OUT UINTN  *OpCount
+  )
+{
+  TRACE_OP  *Ops;
+  UINTN     Count;
+  UINTN     Index;
+  UINTN     Round;
+  UINT32    Seed;
+  UINT32    Variable;
+
+  Ops = AllocateZeroPool (
+          (TRACE_SYNTHETIC_VARIABLES + TRACE_SYNTHETIC_ROUNDS * (TRACE_SYNTHETIC_GETS + 1))
+          * sizeof (*Ops)
+          );
+  if (Ops == NULL) {
+    return NULL;
+  }
+
+  Count = 0;
+  for (Index = 0; Index < TRACE_SYNTHETIC_VARIABLES; ++Index) {
+    Ops[Count].Type = TraceSet;
+    CopyGuid (&Ops[Count].Guid, (Index % 8) == 0 ? &mTraceGlobalGuid : &mTraceAppleGuid);
+    UnicodeSPrint (Ops[Count].Name, sizeof (Ops[Count].Name), L"Variable%04u", (UINT32)Index);
+    Ops[Count].DataSize = TRACE_DEFAULT_DATA_SIZE + (UINT32)(Index % 64);
+    ++Count;
+  }
+
+  Seed = 0x1234567;
+  for (Round = 0; Round < TRACE_SYNTHETIC_ROUNDS; ++Round) {
+    for (Index = 0; Index < TRACE_SYNTHETIC_GETS; ++Index) {
+      Seed     = Seed * 1103515245U + 12345U;
+      Variable = (Seed >> 16) % TRACE_SYNTHETIC_VARIABLES;
+      CopyMem (&Ops[Count], &Ops[Variable], sizeof (*Ops));
+      Ops[Count].Type = (Index % 32) == 31 ? TraceSet : TraceGet;
+      ++Count;
+    }
+
+    Ops[Count++].Type = TraceEnumerate;
+  }
+
+  *OpCount = Count;
+  return Ops;
+}
+
+int
+ENTRY_POINT (
+  int   argc,
+  char  *argv[]
+  )
+{
+  EFI_STATUS   Status;
+  TRACE_OP     *Ops;
+  UINTN        OpCount;
+  TRACE_STATS  Linear;
+  TRACE_STATS  Indexed;
+
+  if (argc > 1) {
+    Ops = LoadTrace (argv[1], &OpCount);
+  } else {
+    Ops = CreateSyntheticTrace (&OpCount);
+  }
+
+  if (Ops == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to load trace\n"));
+    return -1;
+  }
+
+  mStore = AllocatePool (TRACE_STORE_SIZE);
+  if (mStore == NULL) {
+    FreePool (Ops);
+    return -1;
+  }
+
+  Status = ReplayTrace (Ops, OpCount, FALSE, &Linear);
+  if (!EFI_ERROR (Status)) {
+    Status = ReplayTrace (Ops, OpCount, TRUE, &Indexed);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Replayed %u operations\n", (UINT32)OpCount));
+    DEBUG ((
+      DEBUG_ERROR,
+      "Linear lookups %Lu us, indexed lookups %Lu us, enumeration %Lu us\n",
+      Linear.LookupTime,
+      Indexed.LookupTime,
+      Indexed.EnumerateTime
+      ));
+
+    if ((Linear.Found != Indexed.Found) || (Linear.Enumerated != Indexed.Enumerated)) {
+      DEBUG ((
+        DEBUG_ERROR,
+        "!!! Result mismatch: found %u/%u, enumerated %u/%u !!!\n",
+        (UINT32)Linear.Found,
+        (UINT32)Indexed.Found,
+        (UINT32)Linear.Enumerated,
+        (UINT32)Indexed.Enumerated
+        ));
+      Status = EFI_ABORTED;
+    }
+  }
+
+  FreePool (mStore);
+  FreePool (Ops);
+
+  return EFI_ERROR (Status) ? -1 : 0;
+}